@@ -0,0 +1,86 @@
+/*
+###############################################################################
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+#ifndef APP_BOARD_H_
+#define APP_BOARD_H_
+
+/*==================[inclusions]=============================================*/
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros and typedef]=====================================*/
+
+/* SCL and SDA need external pull-ups, a device answering at
+ * APP_BOARD_I2C_DEV_ADD is optional */
+#ifdef BOARD_frdmkl46z
+#include "bsp_frdmkl46z.h"
+#define APP_BOARD_SCL       EF_HAL_A5
+#define APP_BOARD_SDA       EF_HAL_A4
+#define APP_BOARD_LED       EF_HAL_GPIO_LED_RED
+#endif
+
+#ifdef BOARD_frdmkl43z
+#include "bsp_frdmkl43z.h"
+#define APP_BOARD_SCL       EF_HAL_A5
+#define APP_BOARD_SDA       EF_HAL_A4
+#define APP_BOARD_LED       EF_HAL_GPIO_LED_RED
+#endif
+
+#ifdef BOARD_nucleoF767ZI
+#include "bsp_nucleoF767ZI.h"
+#define APP_BOARD_SCL       EF_HAL_D15
+#define APP_BOARD_SDA       EF_HAL_D14
+#define APP_BOARD_LED       EF_HAL_GPIO_LED_LD1
+#endif
+
+#define APP_BOARD_I2C_DEV_ADD   0x1D
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+extern void appBoard_init(void);
+
+/** \brief sends a line of the report, only boards with a console print it */
+extern void appBoard_print(char *str);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+/*==================[end of file]============================================*/
+#endif /* APP_BOARD_H_ */
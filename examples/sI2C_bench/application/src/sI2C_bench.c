@@ -0,0 +1,267 @@
+/*
+###############################################################################
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/* Reports the SCL frequency reached by sI2C on this board and the cost of
+ * the pieces each bit is made of:
+ * - edge and read through efHal_gpio (function table and error handler)
+ * - edge and read through efHal_gpioFast (direct port access)
+ * - the cycle counter read used to time every half period
+ * - a whole transfer unthrottled and at 100 kHz, 400 kHz and 1 MHz
+ *
+ * Every bit takes 4 accesses plus 2 timed half periods, so the unthrottled
+ * transfer is the floor the requested frequencies are compared against.
+ */
+
+/*==================[inclusions]=============================================*/
+#include "appBoard.h"
+#include "efHal_gpio.h"
+#include "efHal_gpioFast.h"
+#include "sI2C.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stdio.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define LOOPS           100     /* short enough for a SysTick based counter */
+
+#define TRANSFERS       10
+
+#define RX_SIZE         4
+
+typedef struct
+{
+    uint32_t freq;
+    sI2C_dh_t dh;
+}bus_t;
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static bus_t bus[] =
+{
+    {0, NULL},
+    {100000, NULL},
+    {400000, NULL},
+    {1000000, NULL},
+};
+
+#define TOTAL_BUS   (sizeof(bus) / sizeof(bus[0]))
+
+static char str[80];
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+static void report(char *name, uint32_t cycles)
+{
+    snprintf(str, sizeof(str), "%s: %lu cycles\r\n", name, (unsigned long)cycles);
+    appBoard_print(str);
+}
+
+static uint32_t measureGpioEdge(void)
+{
+    uint32_t start;
+    int i;
+
+    start = efHal_gpioFast_cycles();
+
+    for (i = 0 ; i < LOOPS ; i++)
+        efHal_gpio_setPin(APP_BOARD_LED, i & 1);
+
+    return efHal_gpioFast_elapsed(start) / LOOPS;
+}
+
+static uint32_t measureGpioRead(void)
+{
+    uint32_t start;
+    int i;
+
+    start = efHal_gpioFast_cycles();
+
+    for (i = 0 ; i < LOOPS ; i++)
+        efHal_gpio_getPin(APP_BOARD_SDA);
+
+    return efHal_gpioFast_elapsed(start) / LOOPS;
+}
+
+static uint32_t measureFastEdge(efHal_gpioFast_t const *pFast)
+{
+    uint32_t start;
+    int i;
+
+    start = efHal_gpioFast_cycles();
+
+    for (i = 0 ; i < LOOPS / 2 ; i++)
+    {
+        efHal_gpioFast_drive0(pFast);
+        efHal_gpioFast_release(pFast);
+    }
+
+    return efHal_gpioFast_elapsed(start) / LOOPS;
+}
+
+static uint32_t measureFastRead(efHal_gpioFast_t const *pFast)
+{
+    uint32_t start;
+    int i;
+
+    start = efHal_gpioFast_cycles();
+
+    for (i = 0 ; i < LOOPS ; i++)
+        efHal_gpioFast_read(pFast);
+
+    return efHal_gpioFast_elapsed(start) / LOOPS;
+}
+
+static uint32_t measureCounter(void)
+{
+    uint32_t start;
+    int i;
+
+    start = efHal_gpioFast_cycles();
+
+    for (i = 0 ; i < LOOPS ; i++)
+        efHal_gpioFast_elapsed(start);
+
+    return efHal_gpioFast_elapsed(start) / LOOPS;
+}
+
+/* returns the SCL periods of one transfer, the start and the stop take
+ * about one period each */
+static uint32_t measureTransfer(sI2C_dh_t dh, uint32_t *pCycles)
+{
+    uint8_t rx[RX_SIZE];
+    efHal_i2c_seg_t seg;
+    uint32_t start;
+    uint32_t cycles = 0;
+    uint32_t clocks = 9;
+    int i;
+
+    seg.dir = EF_HAL_I2C_DIR_READ;
+    seg.flags = 0;
+    seg.pBuf = rx;
+    seg.size = RX_SIZE;
+
+    /* a bus without a device at APP_BOARD_I2C_DEV_ADD stops after the
+     * address */
+    if (sI2C_transfer(dh, APP_BOARD_I2C_DEV_ADD, NULL, 0, rx, 1) == EF_HAL_I2C_EC_NO_ERROR)
+        clocks += 9 * RX_SIZE;
+
+    for (i = 0 ; i < TRANSFERS ; i++)
+    {
+        taskENTER_CRITICAL();
+        start = efHal_gpioFast_cycles();
+        sI2C_transferSeg(dh, APP_BOARD_I2C_DEV_ADD, &seg, 1);
+        cycles += efHal_gpioFast_elapsed(start);
+        taskEXIT_CRITICAL();
+    }
+
+    *pCycles = cycles / TRANSFERS;
+
+    return clocks + 2;
+}
+
+static void bench_task(void *pvParameters)
+{
+    efHal_gpioFast_t fScl;
+    uint32_t gpioEdge, gpioRead, fastEdge, fastRead, counter;
+    uint32_t cycles;
+    uint32_t periods;
+    uint32_t freq;
+    int i;
+
+    appBoard_init();
+    sI2C_init();
+
+    efHal_gpio_confPin(APP_BOARD_LED, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
+
+    for (i = 0 ; i < TOTAL_BUS ; i++)
+        bus[i].dh = sI2C_open(APP_BOARD_SCL, APP_BOARD_SDA, bus[i].freq);
+
+    efHal_gpioFast_open(APP_BOARD_SCL, &fScl);
+
+    snprintf(str, sizeof(str), "core: %lu Hz\r\n", (unsigned long)efHal_gpioFast_freq());
+    appBoard_print(str);
+
+    taskENTER_CRITICAL();
+    gpioEdge = measureGpioEdge();
+    gpioRead = measureGpioRead();
+    fastEdge = measureFastEdge(&fScl);
+    fastRead = measureFastRead(&fScl);
+    counter = measureCounter();
+    taskEXIT_CRITICAL();
+
+    report("efHal_gpio edge", gpioEdge);
+    report("efHal_gpio read", gpioRead);
+    report("efHal_gpioFast edge", fastEdge);
+    report("efHal_gpioFast read", fastRead);
+    report("cycle counter", counter);
+
+    for (i = 0 ; i < TOTAL_BUS ; i++)
+    {
+        periods = measureTransfer(bus[i].dh, &cycles);
+        freq = (uint64_t)efHal_gpioFast_freq() * periods / cycles;
+
+        snprintf(str, sizeof(str), "SCL %lu Hz requested: %lu Hz, %lu cycles/bit\r\n",
+                (unsigned long)bus[i].freq, (unsigned long)freq,
+                (unsigned long)(cycles / periods));
+        appBoard_print(str);
+    }
+
+    for (;;)
+    {
+        vTaskDelay(1000 / portTICK_PERIOD_MS);
+        efHal_gpio_togglePin(APP_BOARD_LED);
+    }
+}
+
+/*==================[external functions definition]==========================*/
+int main(void)
+{
+    xTaskCreate(bench_task, "bench_task", 300, NULL, 0, NULL);
+
+    vTaskStartScheduler();
+    for (;;);
+}
+
+extern void vApplicationStackOverflowHook( TaskHandle_t xTask, char *pcTaskName )
+{
+    while (1);
+}
+
+/*==================[end of file]============================================*/
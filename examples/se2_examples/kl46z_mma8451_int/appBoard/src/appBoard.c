@@ -58,6 +58,8 @@ extern void appBoard_init(void)
 
     mma8451_init(efHal_dh_I2C0);
 
+    mma8451_configBegin();
+
     ctrlReg4.INT_EN_DRDY = 1;
     ctrlReg4.INT_EN_FF_MT = 0;
     ctrlReg4.INT_EN_PULSE = 0;
@@ -76,6 +78,8 @@ extern void appBoard_init(void)
     ctrlReg5.INT_CFG_ASLP = 0;
     mma8451_setCtrlReg5(ctrlReg5);
 
+    mma8451_configEnd();
+
     efHal_gpio_confInt(EF_HAL_INT1_ACCEL, EF_HAL_GPIO_INT_TYPE_FALLING_EDGE);
 }
 
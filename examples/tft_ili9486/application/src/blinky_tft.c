@@ -47,16 +47,18 @@
 #define MY_DISP_VER_RES 320
 #define MY_DISP_HOR_RES 480
 
-#define BUF_SIZE    (MY_DISP_VER_RES*12) // MY_DISP_HOR_RES * MY_DISP_VER_SER / 20
+/* two draw buffers, LVGL renders into one while the other is sent. Same
+ * RAM as the single buffer they replace */
+#define BUF_SIZE    (MY_DISP_VER_RES*6) // MY_DISP_HOR_RES * MY_DISP_VER_SER / 40
 
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
 static lv_disp_draw_buf_t draw_buf;
 static lv_color_t buf1[BUF_SIZE];
+static lv_color_t buf2[BUF_SIZE];
 static lv_disp_drv_t disp_drv;        /*Descriptor of a display driver*/
 static lv_indev_drv_t indev_drv;
-static int timeDownTouch;
 
 /*==================[external data definition]===============================*/
 
@@ -67,18 +69,26 @@ void lv_example_list_2(void);
 static void blinky_task(void *pvParameters)
 {
     ili9486_init(DISPLAY_ORIENTATION_HORIZONTAL, ILI9486_DC, ILI9486_RST, ILI9486_CS, ILI9486_BUS);
+    ili9486_startFlushTask(tskIDLE_PRIORITY + 1);
 
     touchScreen_init(TFT_XM, TFT_XP, TFT_YM, TFT_YP);
     touchScreen_conf(350, 3660, 550, 3558, MY_DISP_HOR_RES, MY_DISP_VER_RES);
     touchScreen_swapXY(1);
     touchScreen_enablePullUP(1);
 
+    /* the touch pins are also TFT bus pins, sampled between flushes */
+    touchScreen_startTask(tskIDLE_PRIORITY + 1, 20, ili9486_lockBus, ili9486_unlockBus);
+
     lv_init();
 
-    lv_disp_draw_buf_init(&draw_buf, buf1, NULL, BUF_SIZE);  /*Initialize the display buffer.*/
+    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, BUF_SIZE);  /*Initialize the display buffers.*/
 
     lv_disp_drv_init(&disp_drv);          /*Basic initialization*/
     disp_drv.flush_cb = ili9486_flush;    /*Set your driver function*/
+    disp_drv.wait_cb = ili9486_wait;      /*Block while both buffers are busy*/
+    disp_drv.draw_ctx_init = ili9486_draw_ctx_init;     /*Backgrounds are streamed*/
+    disp_drv.draw_ctx_deinit = ili9486_draw_ctx_deinit;
+    disp_drv.draw_ctx_size = sizeof(ili9486_draw_ctx_t);
     disp_drv.draw_buf = &draw_buf;        /*Assign the buffer to the display*/
     disp_drv.hor_res = MY_DISP_HOR_RES;   /*Set the horizontal resolution of the display*/
     disp_drv.ver_res = MY_DISP_VER_RES;   /*Set the vertical resolution of the display*/
@@ -93,17 +103,10 @@ static void blinky_task(void *pvParameters)
 
     for (;;)
     {
-        if (timeDownTouch == 0)
-        {
-            timeDownTouch = 20;
-            touchScreen_performRead();
-            efHal_gpio_confPin(TFT_YP, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
-            efHal_gpio_confPin(TFT_YM, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
-            efHal_gpio_confPin(TFT_XP, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
-            efHal_gpio_confPin(TFT_XM, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
-        }
-
         lv_timer_handler();
+
+        /* the flush task sends pixels meanwhile */
+        vTaskDelay(1);
     }
 }
 
@@ -112,7 +115,7 @@ int main(void)
 {
     appBoard_init();
 
-    xTaskCreate(blinky_task, "blinky_task", 600, NULL, 0, NULL);
+    xTaskCreate(blinky_task, "blinky_task", 600, NULL, tskIDLE_PRIORITY + 2, NULL);
 
     vTaskStartScheduler();
     for (;;);
@@ -126,9 +129,6 @@ extern void vApplicationStackOverflowHook( TaskHandle_t xTask, char *pcTaskName
 void vApplicationTickHook(void)
 {
     lv_tick_inc(1);
-
-    if (timeDownTouch)
-        timeDownTouch--;
 }
 
 /*==================[end of file]============================================*/
@@ -47,6 +47,7 @@
 #define configUSE_COUNTING_SEMAPHORES           1
 #define configUSE_QUEUE_SETS                    1
 #define configUSE_TASK_NOTIFICATIONS            1
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 5
 
 /* Software timer related configuration options. */
 #define configUSE_TIMERS                        0
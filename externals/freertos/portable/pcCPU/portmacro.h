@@ -120,6 +120,7 @@ extern void vPortYield( void );
 #define portYIELD()                 vPortYield()
 
 #define portEND_SWITCHING_ISR( xSwitchRequired ) if( xSwitchRequired ) vPortYieldFromISR()
+#define portYIELD_FROM_ISR( x )     portEND_SWITCHING_ISR( x )
 /*-----------------------------------------------------------*/
 
 
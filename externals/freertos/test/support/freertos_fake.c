@@ -0,0 +1,712 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "freertos_fake.h"
+#include "queue.h"
+#include "semphr.h"
+#include "pthread.h"
+#include "sched.h"
+#include "stdbool.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+#include "errno.h"
+
+/*==================[macros and typedef]=====================================*/
+
+struct tskTaskControlBlock
+{
+    TaskFunction_t pxTaskCode;
+    void *pvParameters;
+    pthread_t thread;
+    uint32_t notifyValue;
+    bool notified;
+    void *pvLocalStorage[configNUM_THREAD_LOCAL_STORAGE_POINTERS];
+};
+
+struct QueueDefinition
+{
+    uint8_t *pStorage;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t count;
+    UBaseType_t readIdx;
+    uint8_t type;
+    TaskHandle_t holder;            /* mutex only */
+    UBaseType_t recursion;          /* recursive mutex only */
+};
+
+typedef bool (*ready_t)(void *arg);
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/* held by the running task, waiting on changed releases it */
+static pthread_mutex_t cpu = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t changed;
+static struct timespec start;
+static struct tskTaskControlBlock mainTask;
+static __thread TaskHandle_t self;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+__attribute__((constructor))
+static void init(void)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&changed, &attr);
+    pthread_condattr_destroy(&attr);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* the test runs as a task from the very beginning */
+    mainTask.thread = pthread_self();
+    self = &mainTask;
+    pthread_mutex_lock(&cpu);
+}
+
+static void wakeAll(void)
+{
+    pthread_cond_broadcast(&changed);
+}
+
+static void deadlineAfter(struct timespec *ts, TickType_t ticks)
+{
+    uint64_t ns;
+
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ns = (uint64_t)ts->tv_nsec + (uint64_t)ticks * portTICK_PERIOD_MS * 1000000ull;
+    ts->tv_sec += ns / 1000000000ull;
+    ts->tv_nsec = ns % 1000000000ull;
+}
+
+/* blocks the running task until ready returns true or ticks expire */
+static bool waitFor(ready_t ready, void *arg, TickType_t ticks)
+{
+    struct timespec deadline;
+    int err = 0;
+
+    if (ticks != portMAX_DELAY)
+        deadlineAfter(&deadline, ticks);
+
+    while (!ready(arg))
+    {
+        if (ticks == 0 || err == ETIMEDOUT)
+            return false;
+
+        if (ticks == portMAX_DELAY)
+            pthread_cond_wait(&changed, &cpu);
+        else
+            err = pthread_cond_timedwait(&changed, &cpu, &deadline);
+    }
+
+    return true;
+}
+
+static bool never(void *arg)
+{
+    (void)arg;
+    return false;
+}
+
+static bool hasItems(void *arg)
+{
+    QueueHandle_t q = arg;
+    return q->count != 0;
+}
+
+static bool hasRoom(void *arg)
+{
+    QueueHandle_t q = arg;
+    return q->count < q->length;
+}
+
+static bool notifyValue(void *arg)
+{
+    (void)arg;
+    return self->notifyValue != 0;
+}
+
+static bool notified(void *arg)
+{
+    (void)arg;
+    return self->notified;
+}
+
+static void *taskEntry(void *arg)
+{
+    pthread_mutex_lock(&cpu);
+    self = arg;
+    self->pxTaskCode(self->pvParameters);
+    pthread_mutex_unlock(&cpu);
+
+    return NULL;
+}
+
+static QueueHandle_t newQueue(UBaseType_t length, UBaseType_t itemSize, uint8_t type)
+{
+    QueueHandle_t q = calloc(1, sizeof(*q));
+
+    q->pStorage = calloc(length, itemSize ? itemSize : 1);
+    q->length = length;
+    q->itemSize = itemSize;
+    q->type = type;
+
+    return q;
+}
+
+static bool isMutex(QueueHandle_t q)
+{
+    return q->type == queueQUEUE_TYPE_MUTEX ||
+           q->type == queueQUEUE_TYPE_RECURSIVE_MUTEX;
+}
+
+static void copyIn(QueueHandle_t q, const void *pvItem, BaseType_t xCopyPosition)
+{
+    UBaseType_t idx;
+
+    if (xCopyPosition == queueOVERWRITE && q->count == q->length)
+        q->count--;
+
+    if (xCopyPosition == queueSEND_TO_FRONT)
+    {
+        q->readIdx = (q->readIdx + q->length - 1) % q->length;
+        idx = q->readIdx;
+    }
+    else
+    {
+        idx = (q->readIdx + q->count) % q->length;
+    }
+
+    if (q->itemSize != 0)
+        memcpy(&q->pStorage[idx * q->itemSize], pvItem, q->itemSize);
+
+    q->count++;
+
+    if (isMutex(q))
+        q->holder = NULL;
+
+    wakeAll();
+}
+
+static void copyOut(QueueHandle_t q, void *pvBuffer)
+{
+    if (q->itemSize != 0 && pvBuffer != NULL)
+        memcpy(pvBuffer, &q->pStorage[q->readIdx * q->itemSize], q->itemSize);
+
+    q->readIdx = (q->readIdx + 1) % q->length;
+    q->count--;
+
+    if (isMutex(q))
+        q->holder = self;
+
+    wakeAll();
+}
+
+/*==================[external functions definition]==========================*/
+extern void freertos_fake_sleep(uint32_t ms)
+{
+    vTaskDelay(ms / portTICK_PERIOD_MS);
+}
+
+/* tasks */
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char * const pcName,
+        const configSTACK_DEPTH_TYPE usStackDepth, void * const pvParameters,
+        UBaseType_t uxPriority, TaskHandle_t * const pxCreatedTask)
+{
+    TaskHandle_t task = calloc(1, sizeof(*task));
+
+    (void)pcName;
+    (void)usStackDepth;
+    (void)uxPriority;
+
+    task->pxTaskCode = pxTaskCode;
+    task->pvParameters = pvParameters;
+
+    if (pthread_create(&task->thread, NULL, taskEntry, task) != 0)
+    {
+        free(task);
+        return errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+    }
+
+    pthread_detach(task->thread);
+
+    if (pxCreatedTask != NULL)
+        *pxCreatedTask = task;
+
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+    /* only a task can delete itself, the others stay blocked */
+    if (xTaskToDelete == NULL || xTaskToDelete == self)
+    {
+        pthread_mutex_unlock(&cpu);
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    if (xTicksToDelay == 0)
+        vPortYield();
+    else
+        waitFor(never, NULL, xTicksToDelay);
+}
+
+void vTaskDelayUntil(TickType_t * const pxPreviousWakeTime, const TickType_t xTimeIncrement)
+{
+    TickType_t wake = *pxPreviousWakeTime + xTimeIncrement;
+    TickType_t now = xTaskGetTickCount();
+
+    if ((int32_t)(wake - now) > 0)
+        vTaskDelay(wake - now);
+
+    *pxPreviousWakeTime = wake;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec now;
+    uint64_t ms;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ms = (uint64_t)(now.tv_sec - start.tv_sec) * 1000 +
+         (now.tv_nsec - start.tv_nsec) / 1000000;
+
+    return (TickType_t)(ms / portTICK_PERIOD_MS);
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return self;
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return taskSCHEDULER_RUNNING;
+}
+
+void vTaskSuspendAll(void)
+{
+    /* nothing else runs until the task blocks */
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+    return pdFALSE;
+}
+
+void vTaskSetTimeOutState(TimeOut_t * const pxTimeOut)
+{
+    pxTimeOut->xOverflowCount = 0;
+    pxTimeOut->xTimeOnEntering = xTaskGetTickCount();
+}
+
+BaseType_t xTaskCheckForTimeOut(TimeOut_t * const pxTimeOut, TickType_t * const pxTicksToWait)
+{
+    TickType_t elapsed;
+
+    if (*pxTicksToWait == portMAX_DELAY)
+        return pdFALSE;
+
+    elapsed = xTaskGetTickCount() - pxTimeOut->xTimeOnEntering;
+
+    if (elapsed >= *pxTicksToWait)
+    {
+        *pxTicksToWait = 0;
+        return pdTRUE;
+    }
+
+    *pxTicksToWait -= elapsed;
+    vTaskSetTimeOutState(pxTimeOut);
+
+    return pdFALSE;
+}
+
+void vTaskSetThreadLocalStoragePointer(TaskHandle_t xTaskToSet, BaseType_t xIndex, void *pvValue)
+{
+    TaskHandle_t task = xTaskToSet != NULL ? xTaskToSet : self;
+
+    task->pvLocalStorage[xIndex] = pvValue;
+}
+
+void *pvTaskGetThreadLocalStoragePointer(TaskHandle_t xTaskToQuery, BaseType_t xIndex)
+{
+    TaskHandle_t task = xTaskToQuery != NULL ? xTaskToQuery : self;
+
+    return task->pvLocalStorage[xIndex];
+}
+
+/* notifications */
+
+BaseType_t xTaskGenericNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue,
+        eNotifyAction eAction, uint32_t *pulPreviousNotificationValue)
+{
+    BaseType_t ret = pdPASS;
+
+    if (pulPreviousNotificationValue != NULL)
+        *pulPreviousNotificationValue = xTaskToNotify->notifyValue;
+
+    switch (eAction)
+    {
+        case eSetBits:
+            xTaskToNotify->notifyValue |= ulValue;
+            break;
+        case eIncrement:
+            xTaskToNotify->notifyValue++;
+            break;
+        case eSetValueWithOverwrite:
+            xTaskToNotify->notifyValue = ulValue;
+            break;
+        case eSetValueWithoutOverwrite:
+            if (xTaskToNotify->notified)
+                ret = pdFAIL;
+            else
+                xTaskToNotify->notifyValue = ulValue;
+            break;
+        default:
+            break;
+    }
+
+    if (ret == pdPASS)
+    {
+        xTaskToNotify->notified = true;
+        wakeAll();
+    }
+
+    return ret;
+}
+
+BaseType_t xTaskGenericNotifyFromISR(TaskHandle_t xTaskToNotify, uint32_t ulValue,
+        eNotifyAction eAction, uint32_t *pulPreviousNotificationValue,
+        BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken != NULL)
+        *pxHigherPriorityTaskWoken = pdTRUE;
+
+    return xTaskGenericNotify(xTaskToNotify, ulValue, eAction, pulPreviousNotificationValue);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    xTaskGenericNotifyFromISR(xTaskToNotify, 0, eIncrement, NULL, pxHigherPriorityTaskWoken);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    uint32_t ret;
+
+    waitFor(notifyValue, NULL, xTicksToWait);
+
+    ret = self->notifyValue;
+
+    if (ret != 0)
+    {
+        if (xClearCountOnExit)
+            self->notifyValue = 0;
+        else
+            self->notifyValue--;
+    }
+
+    self->notified = false;
+
+    return ret;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit,
+        uint32_t *pulNotificationValue, TickType_t xTicksToWait)
+{
+    bool ret;
+
+    if (!self->notified)
+        self->notifyValue &= ~ulBitsToClearOnEntry;
+
+    ret = waitFor(notified, NULL, xTicksToWait);
+
+    if (pulNotificationValue != NULL)
+        *pulNotificationValue = self->notifyValue;
+
+    if (ret)
+        self->notifyValue &= ~ulBitsToClearOnExit;
+
+    self->notified = false;
+
+    return ret ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xTaskNotifyStateClear(TaskHandle_t xTask)
+{
+    TaskHandle_t task = xTask != NULL ? xTask : self;
+    BaseType_t ret = task->notified ? pdPASS : pdFAIL;
+
+    task->notified = false;
+
+    return ret;
+}
+
+/* queues and semaphores */
+
+QueueHandle_t xQueueGenericCreate(const UBaseType_t uxQueueLength,
+        const UBaseType_t uxItemSize, const uint8_t ucQueueType)
+{
+    return newQueue(uxQueueLength, uxItemSize, ucQueueType);
+}
+
+QueueHandle_t xQueueCreateMutex(const uint8_t ucQueueType)
+{
+    QueueHandle_t q = newQueue(1, 0, ucQueueType);
+
+    q->count = 1;
+
+    return q;
+}
+
+QueueHandle_t xQueueCreateCountingSemaphore(const UBaseType_t uxMaxCount,
+        const UBaseType_t uxInitialCount)
+{
+    QueueHandle_t q = newQueue(uxMaxCount, 0, queueQUEUE_TYPE_COUNTING_SEMAPHORE);
+
+    q->count = uxInitialCount;
+
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t xQueue)
+{
+    free(xQueue->pStorage);
+    free(xQueue);
+}
+
+BaseType_t xQueueGenericReset(QueueHandle_t xQueue, BaseType_t xNewQueue)
+{
+    (void)xNewQueue;
+
+    xQueue->count = 0;
+    xQueue->readIdx = 0;
+    wakeAll();
+
+    return pdPASS;
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void * const pvItemToQueue,
+        TickType_t xTicksToWait, const BaseType_t xCopyPosition)
+{
+    if (xCopyPosition != queueOVERWRITE && !waitFor(hasRoom, xQueue, xTicksToWait))
+        return errQUEUE_FULL;
+
+    copyIn(xQueue, pvItemToQueue, xCopyPosition);
+
+    return pdPASS;
+}
+
+BaseType_t xQueueGenericSendFromISR(QueueHandle_t xQueue, const void * const pvItemToQueue,
+        BaseType_t * const pxHigherPriorityTaskWoken, const BaseType_t xCopyPosition)
+{
+    if (xCopyPosition != queueOVERWRITE && !hasRoom(xQueue))
+        return errQUEUE_FULL;
+
+    copyIn(xQueue, pvItemToQueue, xCopyPosition);
+
+    if (pxHigherPriorityTaskWoken != NULL)
+        *pxHigherPriorityTaskWoken = pdTRUE;
+
+    return pdPASS;
+}
+
+BaseType_t xQueueGiveFromISR(QueueHandle_t xQueue, BaseType_t * const pxHigherPriorityTaskWoken)
+{
+    return xQueueGenericSendFromISR(xQueue, NULL, pxHigherPriorityTaskWoken, queueSEND_TO_BACK);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void * const pvBuffer, TickType_t xTicksToWait)
+{
+    if (!waitFor(hasItems, xQueue, xTicksToWait))
+        return errQUEUE_EMPTY;
+
+    copyOut(xQueue, pvBuffer);
+
+    return pdPASS;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void * const pvBuffer, TickType_t xTicksToWait)
+{
+    if (!waitFor(hasItems, xQueue, xTicksToWait))
+        return errQUEUE_EMPTY;
+
+    memcpy(pvBuffer, &xQueue->pStorage[xQueue->readIdx * xQueue->itemSize], xQueue->itemSize);
+
+    return pdPASS;
+}
+
+BaseType_t xQueueSemaphoreTake(QueueHandle_t xQueue, TickType_t xTicksToWait)
+{
+    return xQueueReceive(xQueue, NULL, xTicksToWait);
+}
+
+BaseType_t xQueueReceiveFromISR(QueueHandle_t xQueue, void * const pvBuffer,
+        BaseType_t * const pxHigherPriorityTaskWoken)
+{
+    if (!hasItems(xQueue))
+        return pdFAIL;
+
+    copyOut(xQueue, pvBuffer);
+
+    if (pxHigherPriorityTaskWoken != NULL)
+        *pxHigherPriorityTaskWoken = pdTRUE;
+
+    return pdPASS;
+}
+
+BaseType_t xQueueTakeMutexRecursive(QueueHandle_t xMutex, TickType_t xTicksToWait)
+{
+    if (xMutex->holder == self)
+    {
+        xMutex->recursion++;
+        return pdPASS;
+    }
+
+    if (xQueueSemaphoreTake(xMutex, xTicksToWait) != pdPASS)
+        return pdFAIL;
+
+    xMutex->recursion = 1;
+
+    return pdPASS;
+}
+
+BaseType_t xQueueGiveMutexRecursive(QueueHandle_t xMutex)
+{
+    if (xMutex->holder != self)
+        return pdFAIL;
+
+    if (--xMutex->recursion == 0)
+        xQueueGenericSend(xMutex, NULL, 0, queueSEND_TO_BACK);
+
+    return pdPASS;
+}
+
+TaskHandle_t xQueueGetMutexHolder(QueueHandle_t xSemaphore)
+{
+    return xSemaphore->holder;
+}
+
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t xQueue)
+{
+    return xQueue->count;
+}
+
+UBaseType_t uxQueueMessagesWaitingFromISR(const QueueHandle_t xQueue)
+{
+    return xQueue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(const QueueHandle_t xQueue)
+{
+    return xQueue->length - xQueue->count;
+}
+
+/* port */
+
+void vPortEnterCritical(void)
+{
+    /* nothing else runs until the task blocks */
+}
+
+void vPortExitCritical(void)
+{
+}
+
+void vPortDisableInterrupts(void)
+{
+}
+
+void vPortEnableInterrupts(void)
+{
+}
+
+portBASE_TYPE xPortSetInterruptMask(void)
+{
+    return 0;
+}
+
+void vPortClearInterruptMask(portBASE_TYPE xMask)
+{
+    (void)xMask;
+}
+
+void vPortYield(void)
+{
+    pthread_mutex_unlock(&cpu);
+    sched_yield();
+    pthread_mutex_lock(&cpu);
+}
+
+void vPortYieldFromISR(void)
+{
+}
+
+void *pvPortMalloc(size_t xWantedSize)
+{
+    return malloc(xWantedSize);
+}
+
+void vPortFree(void *pv)
+{
+    free(pv);
+}
+
+void vAssertCalled(unsigned long ulLine, const char * const pcFileName)
+{
+    (void)ulLine;
+    (void)pcFileName;
+
+    abort();
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,79 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+#ifndef FREERTOS_FAKE_H_
+#define FREERTOS_FAKE_H_
+
+/*==================[inclusions]=============================================*/
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros and typedef]=====================================*/
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+
+/** \brief host implementation of the kernel API used by the modules
+ **
+ ** Lets unit tests run module code with real tasks, queues, semaphores and
+ ** notifications. Every task is a POSIX thread and only one of them runs at
+ ** a time: the running one gives the CPU away only when it blocks, so the
+ ** test itself (the main thread) acts as a task and code called from it
+ ** behaves as an ISR, it is never interleaved with another task. Ticks are
+ ** real time milliseconds.
+ **
+ ** Tasks are never deleted, objects created by a test stay alive until
+ ** the test program exits.
+ **/
+
+/** \brief releases the CPU for ms milliseconds of real time
+ **
+ ** Same as vTaskDelay, handy to let the tasks under test run.
+ **/
+extern void freertos_fake_sleep(uint32_t ms);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+/*==================[end of file]============================================*/
+#endif /* FREERTOS_FAKE_H_ */
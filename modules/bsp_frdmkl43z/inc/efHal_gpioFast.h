@@ -0,0 +1,107 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+#ifndef EF_HAL_GPIO_FAST_H
+#define EF_HAL_GPIO_FAST_H
+
+/*==================[inclusions]=============================================*/
+#include "efHal_gpio.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros and typedef]=====================================*/
+
+/** \brief direct register handle of an open drain pin
+ **
+ ** Open drain is emulated on the single cycle FGPIO port: the output latch
+ ** stays at 0 and the pin is driven low by turning it into an output, or
+ ** released by turning it back into an input. PDDR is read-modify-write,
+ ** so pins sharing the port must not change direction from an ISR while
+ ** a fast pin of the same port is in use.
+ **/
+typedef struct
+{
+    volatile uint32_t *pPDDR;
+    volatile const uint32_t *pPDIR;
+    uint32_t mask;
+}efHal_gpioFast_t;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+
+/** \brief configures a pin as open drain released and fills its fast handle
+ **
+ ** \param[in] id pin to be used
+ ** \param[out] pFast fast handle
+ **/
+extern void efHal_gpioFast_open(efHal_gpio_id_t id, efHal_gpioFast_t *pFast);
+
+/** \brief current value of the core cycle counter
+ **
+ ** Based on SysTick, only intervals shorter than one tick can be measured.
+ **/
+extern uint32_t efHal_gpioFast_cycles(void);
+
+/** \brief cycles elapsed since start, wrap around handled */
+extern uint32_t efHal_gpioFast_elapsed(uint32_t start);
+
+/** \brief frequency of the cycle counter in Hz */
+extern uint32_t efHal_gpioFast_freq(void);
+
+static inline void efHal_gpioFast_release(efHal_gpioFast_t const *pFast)
+{
+    *pFast->pPDDR &= ~pFast->mask;
+}
+
+static inline void efHal_gpioFast_drive0(efHal_gpioFast_t const *pFast)
+{
+    *pFast->pPDDR |= pFast->mask;
+}
+
+static inline bool efHal_gpioFast_read(efHal_gpioFast_t const *pFast)
+{
+    return (*pFast->pPDIR & pFast->mask) != 0;
+}
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+/*==================[end of file]============================================*/
+#endif /* EF_HAL_GPIO_FAST_H */
@@ -36,6 +36,7 @@
 /*==================[inclusions]=============================================*/
 #include "bsp_frdmkl46z_gpio.h"
 #include "efHal_internal.h"
+#include "efHal_gpioFast.h"
 
 #include "fsl_port.h"
 #include "fsl_gpio.h"
@@ -50,6 +51,33 @@ typedef struct
     uint32_t pin;
 }gpioStruct_t;
 
+/* TFT bus, data bit: pin
+ * bit 0: PTA13, bit 3: PTA12, bit 4: PTA4, bit 5: PTA5
+ * bit 1: PTD2, bit 2: PTD3
+ * bit 6: PTC8, bit 7: PTC9 */
+#define BUS_MASK_A      0x3030
+#define BUS_MASK_C      0x0300
+#define BUS_MASK_D      0x000C
+
+#define BUS_SET_A(d)    (((d) & 0x30) | (((d) & 0x01) << 13) | (((d) & 0x08) << 9))
+#define BUS_SET_C(d)    (((d) & 0xC0) << 2)
+#define BUS_SET_D(d)    (((d) & 0x06) << 1)
+#define BUS_WORD(d)     {BUS_SET_A(d), BUS_SET_C(d), BUS_SET_D(d)}
+
+/* pins set for a byte on each port of the bus */
+typedef struct
+{
+    uint16_t a;
+    uint16_t c;
+    uint16_t d;
+}busWord_t;
+
+/* bus writes go through the single cycle IOPORT */
+#define FGPIO_OF(g)     ((FGPIO_Type *)((uint32_t)(g) - GPIOA_BASE + FGPIOA_BASE))
+
+#define WR_FGPIO        FGPIO_OF(gpioStruct[EF_HAL_BUS_WR].gpio)
+#define WR_MASK         (1u << gpioStruct[EF_HAL_BUS_WR].pin)
+
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
@@ -83,6 +111,8 @@ static const gpioStruct_t gpioStruct[] =
 
 #define TOTAL_GPIO   (sizeof(gpioStruct) / sizeof(gpioStruct[0]))
 
+static const busWord_t busWord[256] = {EF_HAL_BUS_TABLE_256(BUS_WORD)};
+
 static const efHal_gpio_id_t gpioOut[] =
 {
     EF_HAL_GPIO_LED_GREEN,
@@ -232,26 +262,57 @@ static void confBus(efHal_gpio_busid_t id, efHal_gpio_dir_t dir, efHal_gpio_pull
     }
 }
 
+static inline void busPut(busWord_t const *w)
+{
+    FGPIOA->PCOR = BUS_MASK_A;
+    FGPIOA->PSOR = w->a;
+    FGPIOC->PCOR = BUS_MASK_C;
+    FGPIOC->PSOR = w->c;
+    FGPIOD->PCOR = BUS_MASK_D;
+    FGPIOD->PSOR = w->d;
+}
+
+static inline void busStrobe(void)
+{
+    WR_FGPIO->PCOR = WR_MASK;
+    WR_FGPIO->PSOR = WR_MASK;
+}
+
+/* WR high stored again, strobes with no busPut between them would leave it
+ * high for a single store */
+static inline void busHold(void)
+{
+    WR_FGPIO->PSOR = WR_MASK;
+}
+
 static void writeBus(efHal_gpio_busid_t id, void *pData, size_t length)
 {
-    uint8_t *dummy = pData;
+    uint8_t const *p = pData;
 
     if (id == EF_HAL_BUS_TFT)
     {
-        for (int i = 0 ; i < length ; i++)
+        while (length--)
         {
-            uint8_t d = dummy[i];
-
-            GPIO_PortClear(GPIOA, 0B0011000000110000);
-            GPIO_PortClear(GPIOD, 0B0000000000001100);
-            GPIO_PortClear(GPIOC, 0B0000001100000000);
-
-            GPIO_PortSet(GPIOA, (uint32_t)(d & 0b00110000) | ((uint32_t)(d & 0b00000001) << 13) | ((uint32_t)(d & 0b00001000) << 9) );
-            GPIO_PortSet(GPIOD, (uint32_t)(d & 0b00000110) << 1 );
-            GPIO_PortSet(GPIOC, (uint32_t)(d & 0b11000000) << 2 );
+            busPut(&busWord[*p++]);
+            busStrobe();
+        }
+    }
+    else
+    {
+        efErrorHdl_error(EF_ERROR_HDL_INVALID_PARAMETER, "busid");
+    }
+}
 
-            efHal_gpio_setPin(EF_HAL_BUS_WR, 0);
-            efHal_gpio_setPin(EF_HAL_BUS_WR, 1);
+static void writeBus16(efHal_gpio_busid_t id, uint16_t const *pData, size_t count)
+{
+    if (id == EF_HAL_BUS_TFT)
+    {
+        while (count--)
+        {
+            busPut(&busWord[*pData >> 8]);
+            busStrobe();
+            busPut(&busWord[*pData++ & 0xFF]);
+            busStrobe();
         }
     }
     else
@@ -260,6 +321,39 @@ static void writeBus(efHal_gpio_busid_t id, void *pData, size_t length)
     }
 }
 
+static void fillBus16(efHal_gpio_busid_t id, uint16_t value, size_t count)
+{
+    busWord_t const *hi = &busWord[value >> 8];
+    busWord_t const *lo = &busWord[value & 0xFF];
+
+    if (id != EF_HAL_BUS_TFT)
+    {
+        efErrorHdl_error(EF_ERROR_HDL_INVALID_PARAMETER, "busid");
+    }
+    else if (hi == lo)
+    {
+        /* e.g. black or white, the bus keeps its value */
+        busPut(hi);
+
+        while (count--)
+        {
+            busStrobe();
+            busHold();
+            busStrobe();
+            busHold();
+        }
+    }
+    else
+    {
+        while (count--)
+        {
+            busPut(hi);
+            busStrobe();
+            busPut(lo);
+            busStrobe();
+        }
+    }
+}
 
 static void identifyAndNotifyGpioHandler(GPIO_Type *gpio, int pin)
 {
@@ -293,6 +387,8 @@ extern void bsp_frdmkl46z_gpio_init(void)
     cb.confPin = confPin;
     cb.confBus = confBus;
     cb.writeBus = writeBus;
+    cb.writeBus16 = writeBus16;
+    cb.fillBus16 = fillBus16;
 
     efHal_internal_gpio_setCallBacks(cb);
 
@@ -335,6 +431,52 @@ extern void bsp_frdmkl46z_internal_gpio_confAsPWM(efHal_gpio_id_t id)
     PORT_SetPinConfig(gpioStruct[id].port, gpioStruct[id].pin, &port_pin_config);
 }
 
+extern void efHal_gpioFast_open(efHal_gpio_id_t id, efHal_gpioFast_t *pFast)
+{
+    FGPIO_Type *fgpio;
+    uint32_t mask = 1 << gpioStruct[id].pin;
+
+    /* same port through the single cycle IOPORT alias */
+    fgpio = (FGPIO_Type*)((uint32_t)gpioStruct[id].gpio - GPIOA_BASE + FGPIOA_BASE);
+
+    confPin(id, EF_HAL_GPIO_INPUT, EF_HAL_GPIO_PULL_DISABLE, 0);
+    fgpio->PCOR = mask;
+
+    pFast->pPDDR = &fgpio->PDDR;
+    pFast->pPDIR = &fgpio->PDIR;
+    pFast->mask = mask;
+
+    /* the scheduler takes over SysTick when started, until then it is
+     * left free running without interrupt for efHal_gpioFast_cycles */
+    if (!(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk))
+    {
+        SysTick->LOAD = SysTick_LOAD_RELOAD_Msk;
+        SysTick->VAL = 0;
+        SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+    }
+}
+
+extern uint32_t efHal_gpioFast_cycles(void)
+{
+    return SysTick->VAL;
+}
+
+extern uint32_t efHal_gpioFast_elapsed(uint32_t start)
+{
+    uint32_t now = SysTick->VAL;
+
+    /* SysTick counts down */
+    if (start < now)
+        start += SysTick->LOAD + 1;
+
+    return start - now;
+}
+
+extern uint32_t efHal_gpioFast_freq(void)
+{
+    return SystemCoreClock;
+}
+
 void PORTC_PORTD_IRQHandler(void)
 {
     uint32_t intFlags;
@@ -55,6 +55,11 @@
 /*==================[internal functions declaration]=========================*/
 static i2c_master_handle_t m_handle;
 
+/* segment list in progress, segLeft == 0 for simple transfers */
+static efHal_i2c_seg_t const *pSegs;
+static int32_t segLeft;
+static efHal_i2c_devAdd_t segDa;
+
 /*==================[internal data definition]===============================*/
 
 /*==================[external data definition]===============================*/
@@ -113,7 +118,64 @@ static efHal_i2c_ec_t bsp_frdmkl46z_i2c_deviceTransfer(void* param, efHal_i2c_de
 
     if (ret == EF_HAL_I2C_EC_NO_ERROR)
     {
-        I2C_MasterTransferNonBlocking(param, &m_handle, &masterXfer);
+        if (I2C_MasterTransferNonBlocking(param, &m_handle, &masterXfer) != kStatus_Success)
+            ret = EF_HAL_I2C_EC_UNKNOW;
+    }
+
+    return ret;
+}
+
+static status_t startSeg(I2C_Type *base, bool first)
+{
+    i2c_master_transfer_t masterXfer;
+    efHal_i2c_seg_t const *pSeg = pSegs;
+
+    memset(&masterXfer, 0, sizeof(masterXfer));
+    masterXfer.slaveAddress = segDa;
+    masterXfer.direction = pSeg->dir == EF_HAL_I2C_DIR_READ ? kI2C_Read : kI2C_Write;
+    masterXfer.data = pSeg->pBuf;
+    masterXfer.dataSize = pSeg->size;
+    masterXfer.flags = kI2C_TransferDefaultFlag;
+
+    if (pSeg->flags & EF_HAL_I2C_SEG_FLAG_NO_START)
+        masterXfer.flags |= kI2C_TransferNoStartFlag;
+    else if (!first && !(pSeg[-1].flags & EF_HAL_I2C_SEG_FLAG_STOP))
+        masterXfer.flags |= kI2C_TransferRepeatedStartFlag;
+
+    if (segLeft > 1 && !(pSeg->flags & EF_HAL_I2C_SEG_FLAG_STOP))
+        masterXfer.flags |= kI2C_TransferNoStopFlag;
+
+    return I2C_MasterTransferNonBlocking(base, &m_handle, &masterXfer);
+}
+
+static efHal_i2c_ec_t bsp_frdmkl46z_i2c_deviceTransferSeg(void* param, efHal_i2c_devAdd_t da, efHal_i2c_seg_t const *pSeg, int32_t nSeg)
+{
+    efHal_i2c_ec_t ret = EF_HAL_I2C_EC_NO_ERROR;
+    int32_t i;
+
+    /* the SDK only continues write segments without start, and a read
+     * can't be continued anyway since its last byte was NAKed */
+    for (i = 1 ; i < nSeg ; i++)
+    {
+        if ((pSeg[i].flags & EF_HAL_I2C_SEG_FLAG_NO_START) &&
+            pSeg[i].dir == EF_HAL_I2C_DIR_READ)
+        {
+            efErrorHdl_error(EF_HAL_I2C_EC_TRANSFER_UNSUPPORTED, "read NO_START");
+            ret = EF_HAL_I2C_EC_TRANSFER_UNSUPPORTED;
+        }
+    }
+
+    if (ret == EF_HAL_I2C_EC_NO_ERROR)
+    {
+        pSegs = pSeg;
+        segLeft = nSeg;
+        segDa = da;
+
+        if (startSeg(param, true) != kStatus_Success)
+        {
+            segLeft = 0;
+            ret = EF_HAL_I2C_EC_UNKNOW;
+        }
     }
 
     return ret;
@@ -122,24 +184,44 @@ static efHal_i2c_ec_t bsp_frdmkl46z_i2c_deviceTransfer(void* param, efHal_i2c_de
 static void i2c_master_callback(I2C_Type *base, i2c_master_handle_t *handle, status_t status, void *userData)
 {
     efHal_i2c_ec_t ec;
+    bool end = true;
 
-    switch (status)
+    /* next segment goes on from the interrupt, the bus is still ours */
+    if (status == kStatus_Success && segLeft > 1)
     {
-        case kStatus_Success:
-            ec = EF_HAL_I2C_EC_NO_ERROR;
-            break;
-
-        case kStatus_I2C_Nak:
-        case kStatus_I2C_Addr_Nak:
-            ec = EF_HAL_I2C_EC_NAK;
-            break;
-
-        default:
-            ec = EF_HAL_I2C_EC_UNKNOW;
-            break;
+        pSegs++;
+        segLeft--;
+
+        status = startSeg(base, false);
+
+        if (status == kStatus_Success)
+            end = false;
+        else
+            I2C_MasterStop(base);
     }
 
-    efHal_internal_i2c_endOfTransfer(userData, ec);
+    if (end)
+    {
+        segLeft = 0;
+
+        switch (status)
+        {
+            case kStatus_Success:
+                ec = EF_HAL_I2C_EC_NO_ERROR;
+                break;
+
+            case kStatus_I2C_Nak:
+            case kStatus_I2C_Addr_Nak:
+                ec = EF_HAL_I2C_EC_NAK;
+                break;
+
+            default:
+                ec = EF_HAL_I2C_EC_UNKNOW;
+                break;
+        }
+
+        efHal_internal_i2c_endOfTransfer(userData, ec);
+    }
 }
 
 static void i2c_configPins(void)
@@ -261,6 +343,8 @@ extern void bsp_frdmkl46z_i2c_init(void)
 
     efHal_dh_I2C0 = efHal_internal_i2c_deviceReg(bsp_frdmkl46z_i2c_deviceTransfer, I2C0);
 
+    efHal_internal_i2c_setTransferSeg(efHal_dh_I2C0, bsp_frdmkl46z_i2c_deviceTransferSeg);
+
     I2C_MasterTransferCreateHandle(I2C0, &m_handle, i2c_master_callback, efHal_dh_I2C0);
 }
 
@@ -77,6 +77,7 @@ static void lpsci_init(void)
     LPSCI_Init(UART0, &config, CLOCK_GetFreq(kCLOCK_CoreSysClk));
 
     LPSCI_EnableInterrupts(UART0, kLPSCI_RxDataRegFullInterruptEnable);
+    LPSCI_EnableInterrupts(UART0, kLPSCI_IdleLineInterruptEnable);
     LPSCI_EnableInterrupts(UART0, kLPSCI_TxDataRegEmptyInterruptEnable);
     LPSCI_EnableInterrupts(UART0, kLPSCI_TransmissionCompleteInterruptEnable);
 
@@ -153,6 +154,13 @@ void UART0_IRQHandler(void)
         efHal_internal_uart_putDataForRx(efHal_dh_UART0, &data);
     }
 
+    if ( (kLPSCI_IdleLineFlag)            & LPSCI_GetStatusFlags(UART0) &&
+         (kLPSCI_IdleLineInterruptEnable) & LPSCI_GetEnabledInterrupts(UART0) )
+    {
+        LPSCI_ClearStatusFlags(UART0, kLPSCI_IdleLineFlag);
+        efHal_internal_uart_rxIdle(efHal_dh_UART0);
+    }
+
     if ( (kLPSCI_TxDataRegEmptyFlag)            & LPSCI_GetStatusFlags(UART0) &&
          (kLPSCI_TxDataRegEmptyInterruptEnable) & LPSCI_GetEnabledInterrupts(UART0) )
     {
@@ -163,6 +171,7 @@ void UART0_IRQHandler(void)
             else
             {
                 LPSCI_DisableInterrupts(UART0, kLPSCI_TxDataRegEmptyInterruptEnable);
+                LPSCI_EnableInterrupts(UART0, kLPSCI_TransmissionCompleteInterruptEnable);
                 break;
             }
         }
@@ -173,6 +182,7 @@ void UART0_IRQHandler(void)
     {
         LPSCI_DisableInterrupts(UART0, kLPSCI_TransmissionCompleteInterruptEnable);
         LPSCI_ClearStatusFlags(UART0, kLPSCI_TransmissionCompleteFlag);
+        efHal_internal_uart_txComplete(efHal_dh_UART0);
     }
 }
 
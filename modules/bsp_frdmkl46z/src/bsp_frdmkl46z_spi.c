@@ -40,6 +40,7 @@
 
 #include "fsl_spi.h"
 #include "fsl_port.h"
+#include "fsl_gpio.h"
 #include "fsl_clock.h"
 #include "pin_mux.h"
 
@@ -48,12 +49,32 @@
 #define SPI_MASTER_SOURCE_CLOCK kCLOCK_BusClk
 #define SPI_MASTER_CLK_FREQ     CLOCK_GetFreq(kCLOCK_BusClk)
 
+#define SPI_PCS0_PORT           PORTE
+#define SPI_PCS0_GPIO           GPIOE
+#define SPI_PCS0_PIN            16U
+
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
 
 static spi_master_handle_t handle;
 
+static const port_pin_config_t port_spi_config = {
+	/* Internal pull-up resistor is disabled */
+	.pullSelect = kPORT_PullDisable,
+	/* Fast slew rate is configured */
+	.slewRate = kPORT_FastSlewRate,
+	/* Passive filter is disabled */
+	.passiveFilterEnable = kPORT_PassiveFilterDisable,
+	/* Low drive strength is configured */
+	.driveStrength = kPORT_LowDriveStrength,
+	/* Pin is configured as SPI0_x */
+	.mux = kPORT_MuxAlt2,
+};
+
+static int32_t baudRate;
+static bool initDone;
+
 /*==================[external data definition]===============================*/
 
 efHal_dh_t efHal_dh_SPI0;
@@ -65,73 +86,101 @@ static void SPI_MasterInterruptCallback(SPI_Type *base, spi_master_handle_t *mas
 }
 
 
-static void spi_ConfCB(void *param, int32_t clockFrec, efHal_spi_mode_t mode)
+/* pins and SPI0 are left untouched until a device uses the bus */
+static void spi_lazyInit(SPI_Type *base)
 {
+    spi_master_config_t userConfig;
 
-	const port_pin_config_t port_spi_config = {
-		/* Internal pull-up resistor is disabled */
-		.pullSelect = kPORT_PullDisable,
-		/* Fast slew rate is configured */
-		.slewRate = kPORT_FastSlewRate,
-		/* Passive filter is disabled */
-		.passiveFilterEnable = kPORT_PassiveFilterDisable,
-		/* Low drive strength is configured */
-		.driveStrength = kPORT_LowDriveStrength,
-		/* Pin is configured as SPI0_x */
-		.mux = kPORT_MuxAlt2,
-	};
-
-	PORT_SetPinConfig(PORTE, 16, &port_spi_config); //SPI0_SS
+	PORT_SetPinConfig(SPI_PCS0_PORT, SPI_PCS0_PIN, &port_spi_config); //SPI0_SS
 	PORT_SetPinConfig(PORTE, 17, &port_spi_config); //SPI0_SCK
 	PORT_SetPinConfig(PORTE, 18, &port_spi_config); //SPI0_MOSI
 	PORT_SetPinConfig(PORTE, 19, &port_spi_config); //SPI0_MISO
 
 	CLOCK_EnableClock(kCLOCK_Spi0);
 
-    SPI_MasterTransferCreateHandle(SPI0, &handle, SPI_MasterInterruptCallback, efHal_dh_SPI0);
-
-	spi_master_config_t userConfig;
+    SPI_MasterTransferCreateHandle(base, &handle, SPI_MasterInterruptCallback, efHal_dh_SPI0);
 
+    /* mode 0, default baud rate and PCS0 driven by SPI0, spi_ConfCB and
+     * spi_AutoCsCB set the device ones */
 	SPI_MasterGetDefaultConfig(&userConfig);
+	SPI_MasterInit(base, &userConfig, SPI_MASTER_CLK_FREQ);
+
+    baudRate = userConfig.baudRate_Bps;
+    initDone = true;
+}
 
-	/*
-	userConfig.enableMaster         = true;
-	userConfig.enableStopInWaitMode = false;
-	userConfig.polarity             = kSPI_ClockPolarityActiveHigh;
-	userConfig.phase                = kSPI_ClockPhaseFirstEdge;
-	userConfig.direction            = kSPI_MsbFirst;
-	userConfig.dataMode 			 = kSPI_8BitMode;
-	userConfig.txWatermark 		 = kSPI_TxFifoOneHalfEmpty;
-	userConfig.rxWatermark 		 = kSPI_RxFifoOneHalfFull;
-	userConfig.pinMode      		 = kSPI_PinModeNormal;
-	userConfig.outputMode   		 = kSPI_SlaveSelectAutomaticOutput;
-	userConfig.baudRate_Bps 		 = 500000U;
-	*/
-	userConfig.baudRate_Bps         = clockFrec;
-
-	switch (mode){
-		case EF_HAL_SPI_CPOL_0_CPHA_O:
-			userConfig.polarity = kSPI_ClockPolarityActiveHigh;
-			userConfig.phase = kSPI_ClockPhaseFirstEdge;
-			break;
-
-		case EF_HAL_SPI_CPOL_0_CPHA_1:
-			userConfig.polarity = kSPI_ClockPolarityActiveHigh;
-			userConfig.phase = kSPI_ClockPhaseSecondEdge;
-			break;
-
-		case EF_HAL_SPI_CPOL_1_CPHA_O:
-			userConfig.polarity = kSPI_ClockPolarityActiveLow;
-			userConfig.phase = kSPI_ClockPhaseFirstEdge;
-			break;
-
-		case EF_HAL_SPI_CPOL_1_CPHA_1:
-			userConfig.polarity = kSPI_ClockPolarityActiveLow;
-			userConfig.phase = kSPI_ClockPhaseSecondEdge;
-			break;
-	}
-
-	SPI_MasterInit(param, &userConfig, SPI_MASTER_CLK_FREQ);
+/* efHal only calls it when the configuration differs from the last one,
+ * here each register is written only if its content changes */
+static void spi_ConfCB(void *param, int32_t clockFrec, efHal_spi_mode_t mode)
+{
+    SPI_Type *base = param;
+    uint8_t c1;
+
+    if (!initDone)
+        spi_lazyInit(base);
+
+    c1 = base->C1 & ~(SPI_C1_CPOL_MASK | SPI_C1_CPHA_MASK);
+
+    switch (mode)
+    {
+        case EF_HAL_SPI_CPOL_0_CPHA_O:
+            c1 |= SPI_C1_CPOL(kSPI_ClockPolarityActiveHigh) | SPI_C1_CPHA(kSPI_ClockPhaseFirstEdge);
+            break;
+
+        case EF_HAL_SPI_CPOL_0_CPHA_1:
+            c1 |= SPI_C1_CPOL(kSPI_ClockPolarityActiveHigh) | SPI_C1_CPHA(kSPI_ClockPhaseSecondEdge);
+            break;
+
+        case EF_HAL_SPI_CPOL_1_CPHA_O:
+            c1 |= SPI_C1_CPOL(kSPI_ClockPolarityActiveLow) | SPI_C1_CPHA(kSPI_ClockPhaseFirstEdge);
+            break;
+
+        case EF_HAL_SPI_CPOL_1_CPHA_1:
+            c1 |= SPI_C1_CPOL(kSPI_ClockPolarityActiveLow) | SPI_C1_CPHA(kSPI_ClockPhaseSecondEdge);
+            break;
+    }
+
+    if (c1 != base->C1)
+    {
+        /* clock polarity and phase are changed with the module disabled */
+        base->C1 = c1 & ~SPI_C1_SPE_MASK;
+        base->C1 = c1;
+    }
+
+    if (clockFrec != baudRate)
+    {
+        SPI_MasterSetBaudRate(base, clockFrec, SPI_MASTER_CLK_FREQ);
+        baudRate = clockFrec;
+    }
+}
+
+/* PCS0 is driven by SPI0 for bus level transfers. For devices with a GPIO
+ * CS it's held high as GPIO, so it doesn't select the PCS0 device too */
+static void spi_AutoCsCB(void *param, bool enable)
+{
+    SPI_Type *base = param;
+    port_pin_config_t port_gpio_config = port_spi_config;
+    gpio_pin_config_t gpio_config = {kGPIO_DigitalOutput, 1};
+
+    if (!initDone)
+        spi_lazyInit(base);
+
+    /* SSOE and MODFEN are changed in an order that never makes PCS0 a mode
+     * fault input */
+    if (enable)
+    {
+        base->C1 |= SPI_C1_SSOE_MASK;
+        base->C2 |= SPI_C2_MODFEN_MASK;
+        PORT_SetPinConfig(SPI_PCS0_PORT, SPI_PCS0_PIN, &port_spi_config);
+    }
+    else
+    {
+        GPIO_PinInit(SPI_PCS0_GPIO, SPI_PCS0_PIN, &gpio_config);
+        port_gpio_config.mux = kPORT_MuxAsGpio;
+        PORT_SetPinConfig(SPI_PCS0_PORT, SPI_PCS0_PIN, &port_gpio_config);
+        base->C2 &= ~SPI_C2_MODFEN_MASK;
+        base->C1 &= ~SPI_C1_SSOE_MASK;
+    }
 }
 
 static void spi_TransferCB(void* param, void *pTx, void *pRx, size_t length)
@@ -153,6 +202,9 @@ extern void bsp_frdmkl46z_spi_init(void)
 
     cb.conf = spi_ConfCB;
     cb.transfer = spi_TransferCB;
+    cb.autoCs = spi_AutoCsCB;
+
+    initDone = false;
 
     efHal_dh_SPI0 = efHal_internal_spi_deviceReg(cb, SPI0);
 }
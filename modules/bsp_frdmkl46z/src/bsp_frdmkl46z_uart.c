@@ -75,6 +75,7 @@ static void uart_init(void)
     PORT_SetPinMux(PORTE, 1U, kPORT_MuxAlt3);
 
     UART_EnableInterrupts(UART1, kUART_RxDataRegFullInterruptEnable);
+    UART_EnableInterrupts(UART1, kUART_IdleLineInterruptEnable);
     UART_EnableInterrupts(UART1, kUART_TxDataRegEmptyInterruptEnable);
     UART_EnableInterrupts(UART1, kUART_TransmissionCompleteInterruptEnable);
 
@@ -151,6 +152,13 @@ void UART1_IRQHandler(void)
         efHal_internal_uart_putDataForRx(efHal_dh_UART1, &data);
     }
 
+    if ( (kUART_IdleLineFlag)            & UART_GetStatusFlags(UART1) &&
+         (kUART_IdleLineInterruptEnable) & UART_GetEnabledInterrupts(UART1) )
+    {
+        UART_ClearStatusFlags(UART1, kUART_IdleLineFlag);
+        efHal_internal_uart_rxIdle(efHal_dh_UART1);
+    }
+
     if ( (kUART_TxDataRegEmptyFlag)            & UART_GetStatusFlags(UART1) &&
          (kUART_TxDataRegEmptyInterruptEnable) & UART_GetEnabledInterrupts(UART1) )
     {
@@ -161,6 +169,7 @@ void UART1_IRQHandler(void)
             else
             {
                 UART_DisableInterrupts(UART1, kUART_TxDataRegEmptyInterruptEnable);
+                UART_EnableInterrupts(UART1, kUART_TransmissionCompleteInterruptEnable);
                 break;
             }
         }
@@ -171,6 +180,7 @@ void UART1_IRQHandler(void)
     {
         UART_DisableInterrupts(UART1, kUART_TransmissionCompleteInterruptEnable);
         UART_ClearStatusFlags(UART1, kUART_TransmissionCompleteFlag);
+        efHal_internal_uart_txComplete(efHal_dh_UART1);
     }
 }
 
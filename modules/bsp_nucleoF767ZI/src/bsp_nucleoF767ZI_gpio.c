@@ -36,6 +36,7 @@
 /*==================[inclusions]=============================================*/
 #include "bsp_nucleoF767ZI_gpio.h"
 #include "efHal_internal.h"
+#include "efHal_gpioFast.h"
 
 #include "main.h"
 
@@ -46,6 +47,32 @@ typedef struct
 	uint16_t GPIO_Pin;
 }gpioStruct_t;
 
+/* TFT bus, data bit: pin
+ * bit 0 D8 F12, bit 2 D2 F15, bit 4 D4 F14, bit 7 D7 F13
+ * bit 1 D9 D15
+ * bit 3 D3 E13, bit 5 D5 E11, bit 6 D6 E9
+ * BSRR sets the pin with its bit in the low half and resets it with the
+ * high half, so one store per port puts a byte */
+#define BSRR_BIT(d, bit, pin)   (((d) & (1 << (bit))) ? (uint32_t)(pin) : ((uint32_t)(pin) << 16))
+
+#define BSRR_F(d)       (BSRR_BIT(d, 0, GPIO_PIN_12) | BSRR_BIT(d, 2, GPIO_PIN_15) | \
+                         BSRR_BIT(d, 4, GPIO_PIN_14) | BSRR_BIT(d, 7, GPIO_PIN_13))
+#define BSRR_D(d)       (BSRR_BIT(d, 1, GPIO_PIN_15))
+#define BSRR_E(d)       (BSRR_BIT(d, 3, GPIO_PIN_13) | BSRR_BIT(d, 5, GPIO_PIN_11) | \
+                         BSRR_BIT(d, 6, GPIO_PIN_9))
+#define BUS_WORD(d)     {BSRR_F(d), BSRR_D(d), BSRR_E(d)}
+
+/* BSRR words of a byte for each port of the bus */
+typedef struct
+{
+    uint32_t f;
+    uint32_t d;
+    uint32_t e;
+}busWord_t;
+
+#define WR_PORT         gpioStruct[EF_HAL_BUS_WR].GPIOx
+#define WR_PIN          ((uint32_t)gpioStruct[EF_HAL_BUS_WR].GPIO_Pin)
+
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
@@ -85,6 +112,8 @@ static const gpioStruct_t gpioStruct[] =
 
 #define TOTAL_GPIO   (sizeof(gpioStruct) / sizeof(gpioStruct[0]))
 
+static const busWord_t busWord[256] = {EF_HAL_BUS_TABLE_256(BUS_WORD)};
+
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
@@ -172,53 +201,38 @@ static void confBus(efHal_gpio_busid_t id, efHal_gpio_dir_t dir, efHal_gpio_pull
     }
 }
 
+static inline void busPut(busWord_t const *w)
+{
+    GPIOF->BSRR = w->f;
+    GPIOD->BSRR = w->d;
+    GPIOE->BSRR = w->e;
+}
+
+static inline void busStrobe(void)
+{
+    /* WR low is stored twice to stretch the pulse, the ILI9486 needs 15 ns */
+    WR_PORT->BSRR = WR_PIN << 16;
+    WR_PORT->BSRR = WR_PIN << 16;
+    WR_PORT->BSRR = WR_PIN;
+}
+
+/* WR high stored again, strobes with no busPut between them would leave it
+ * high for a single store */
+static inline void busHold(void)
+{
+    WR_PORT->BSRR = WR_PIN;
+}
+
 static void writeBus(efHal_gpio_busid_t id, void *pData, size_t length)
 {
-    uint8_t *dummy = pData;
+    uint8_t const *p = pData;
 
     if (id == EF_HAL_BUS_TFT)
     {
-        for (int i = 0 ; i < length ; i++)
+        while (length--)
         {
-            uint8_t d = dummy[i];
-
-            // clear bits
-            // bit 0 D8 F12
-            // bit 2 D2 F15
-            // bit 4 D4 F14
-            // bit 7 D7 F13
-            GPIOF->BSRR = (GPIO_PIN_12|GPIO_PIN_15|GPIO_PIN_14|GPIO_PIN_13) << 16;
-
-            // bit 1 D9 D15
-            GPIOD->BSRR = (GPIO_PIN_15) << 16;
-
-            // bit 3 D3 E13
-            // bit 5 D5 E11
-            // bit 6 D6 E9
-            GPIOE->BSRR = (GPIO_PIN_13|GPIO_PIN_11|GPIO_PIN_9) << 16;
-
-            // set bits
-            if (d & 0b00000001)
-                GPIOF->BSRR = GPIO_PIN_12;
-            if (d & 0b00000100)
-                GPIOF->BSRR = GPIO_PIN_15;
-            if (d & 0b00010000)
-                GPIOF->BSRR = GPIO_PIN_14;
-            if (d & 0b10000000)
-                GPIOF->BSRR = GPIO_PIN_13;
-
-            if (d & 0b00000010)
-                GPIOD->BSRR = GPIO_PIN_15;
-
-            if (d & 0b00001000)
-                GPIOE->BSRR = GPIO_PIN_13;
-            if (d & 0b00100000)
-                GPIOE->BSRR = GPIO_PIN_11;
-            if (d & 0b01000000)
-                GPIOE->BSRR = GPIO_PIN_9;
-
-            efHal_gpio_setPin(EF_HAL_BUS_WR, 0);
-            efHal_gpio_setPin(EF_HAL_BUS_WR, 1);
+            busPut(&busWord[*p++]);
+            busStrobe();
         }
     }
     else
@@ -227,6 +241,58 @@ static void writeBus(efHal_gpio_busid_t id, void *pData, size_t length)
     }
 }
 
+static void writeBus16(efHal_gpio_busid_t id, uint16_t const *pData, size_t count)
+{
+    if (id == EF_HAL_BUS_TFT)
+    {
+        while (count--)
+        {
+            busPut(&busWord[*pData >> 8]);
+            busStrobe();
+            busPut(&busWord[*pData++ & 0xFF]);
+            busStrobe();
+        }
+    }
+    else
+    {
+        efErrorHdl_error(EF_ERROR_HDL_INVALID_PARAMETER, "busid");
+    }
+}
+
+static void fillBus16(efHal_gpio_busid_t id, uint16_t value, size_t count)
+{
+    busWord_t const *hi = &busWord[value >> 8];
+    busWord_t const *lo = &busWord[value & 0xFF];
+
+    if (id != EF_HAL_BUS_TFT)
+    {
+        efErrorHdl_error(EF_ERROR_HDL_INVALID_PARAMETER, "busid");
+    }
+    else if (hi == lo)
+    {
+        /* e.g. black or white, the bus keeps its value */
+        busPut(hi);
+
+        while (count--)
+        {
+            busStrobe();
+            busHold();
+            busStrobe();
+            busHold();
+        }
+    }
+    else
+    {
+        while (count--)
+        {
+            busPut(hi);
+            busStrobe();
+            busPut(lo);
+            busStrobe();
+        }
+    }
+}
+
 
 /*==================[external functions definition]==========================*/
 extern void bsp_nucleoF767ZI_gpio_init(void)
@@ -250,6 +316,8 @@ extern void bsp_nucleoF767ZI_gpio_init(void)
     cb.confPin = confPin;
     cb.confBus = confBus;
     cb.writeBus = writeBus;
+    cb.writeBus16 = writeBus16;
+    cb.fillBus16 = fillBus16;
 
     efHal_internal_gpio_setCallBacks(cb);
 }
@@ -270,5 +338,45 @@ extern void bsp_nucleoF767ZI_internal_gpio_confAsPWM(efHal_gpio_id_t id)
 
 }
 
+extern void efHal_gpioFast_open(efHal_gpio_id_t id, efHal_gpioFast_t *pFast)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    setPin(id, 1);
+
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+    GPIO_InitStruct.Pin = gpioStruct[id].GPIO_Pin;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    HAL_GPIO_Init(gpioStruct[id].GPIOx, &GPIO_InitStruct);
+
+    pFast->pBSRR = &gpioStruct[id].GPIOx->BSRR;
+    pFast->pIDR = &gpioStruct[id].GPIOx->IDR;
+    pFast->mask = gpioStruct[id].GPIO_Pin;
+
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->LAR = 0xC5ACCE55;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+}
+
+extern uint32_t efHal_gpioFast_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+extern uint32_t efHal_gpioFast_elapsed(uint32_t start)
+{
+    return DWT->CYCCNT - start;
+}
+
+extern uint32_t efHal_gpioFast_freq(void)
+{
+    return SystemCoreClock;
+}
+
 
 /*==================[end of file]============================================*/
@@ -0,0 +1,179 @@
+/*
+###############################################################################
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+#ifndef CANVAS_H_
+#define CANVAS_H_
+
+/*==================[inclusions]=============================================*/
+#include "stdint.h"
+#include "stdbool.h"
+#include "canvas_font.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros and typedef]=====================================*/
+
+/* 1bpp buffers are page organized like the SSD1306/SH1106 memory: each
+ * byte is a column of 8 pixels, bit 0 on top, and pages of width bytes
+ * follow each other */
+#define CANVAS_PAGES(height)            (((height) + 7) / 8)
+#define CANVAS_BUF_SIZE(width, height)  ((width) * CANVAS_PAGES(height))
+
+typedef enum
+{
+    CANVAS_COLOR_BLACK = 0,
+    CANVAS_COLOR_WHITE,
+}canvas_color_t;
+
+/* how a bitmap is combined with the canvas */
+typedef enum
+{
+    CANVAS_ROP_COPY = 0,
+    CANVAS_ROP_OR,
+    CANVAS_ROP_AND,
+    CANVAS_ROP_XOR,
+}canvas_rop_t;
+
+/* corners included */
+typedef struct
+{
+    int16_t x0;
+    int16_t y0;
+    int16_t x1;
+    int16_t y1;
+}canvas_rect_t;
+
+/* columns of a page changed since the last canvas_clearDirty(), empty if
+ * min > max */
+typedef struct
+{
+    int16_t min;
+    int16_t max;
+}canvas_span_t;
+
+/* page organized like the canvas buffer */
+typedef struct
+{
+    uint8_t const *pData;
+    int16_t width;
+    int16_t height;
+}canvas_bitmap_t;
+
+/* decoded glyph and its blank columns, up to 7 */
+typedef struct
+{
+    canvas_font_t const *pFont;     /* NULL if the entry is free */
+    uint16_t glyph;
+    uint8_t cols[CANVAS_PAGES(CANVAS_FONT_MAX_HEIGHT)][CANVAS_FONT_MAX_WIDTH + 7];
+}canvas_glyphCache_t;
+
+/* A canvas only touches its own memory, different canvases may be drawn
+ * from different tasks. Drawing on one canvas from several tasks needs a
+ * lock held by the callers */
+typedef struct
+{
+    uint8_t *pBuf;                  /* CANVAS_BUF_SIZE(width, height) bytes */
+    canvas_span_t *pDirty;          /* CANVAS_PAGES(height) spans */
+    int16_t width;
+    int16_t height;
+    canvas_rect_t clip;
+    canvas_font_t const *pFont;
+#if CANVAS_FONT_CACHE_SIZE
+    /* direct mapped, a glyph has only one possible entry */
+    canvas_glyphCache_t cache[CANVAS_FONT_CACHE_SIZE];
+#endif
+}canvas_t;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+
+/** \brief initializes a canvas on caller owned memory
+ **
+ ** The buffer is not cleared and every page is marked dirty. Text is drawn
+ ** with canvas_font5x7.
+ **
+ ** \param[out] c canvas
+ ** \param[in] pBuf buffer of CANVAS_BUF_SIZE(width, height) bytes
+ ** \param[in] pDirty CANVAS_PAGES(height) spans
+ ** \param[in] width width in pixels
+ ** \param[in] height height in pixels
+ **/
+extern void canvas_init(canvas_t *c, uint8_t *pBuf, canvas_span_t *pDirty, int16_t width, int16_t height);
+
+/** \brief limits drawing to a rectangle, NULL for the whole canvas */
+extern void canvas_setClip(canvas_t *c, canvas_rect_t const *pRect);
+
+extern void canvas_clearDirty(canvas_t *c);
+extern void canvas_setDirty(canvas_t *c, int16_t page, int16_t x0, int16_t x1);
+
+extern void canvas_clear(canvas_t *c, canvas_color_t color);
+extern void canvas_putPixel(canvas_t *c, int16_t x, int16_t y, canvas_color_t color);
+extern bool canvas_getPixel(canvas_t const *c, int16_t x, int16_t y);
+extern void canvas_line(canvas_t *c, int16_t x0, int16_t y0, int16_t x1, int16_t y1, canvas_color_t color);
+extern void canvas_rect(canvas_t *c, int16_t x0, int16_t y0, int16_t x1, int16_t y1, canvas_color_t color);
+extern void canvas_fillRect(canvas_t *c, int16_t x0, int16_t y0, int16_t x1, int16_t y1, canvas_color_t color);
+extern void canvas_circle(canvas_t *c, int16_t xc, int16_t yc, int16_t r, canvas_color_t color);
+extern void canvas_fillCircle(canvas_t *c, int16_t xc, int16_t yc, int16_t r, canvas_color_t color);
+
+/** \brief combines a bitmap with the canvas, its top left corner at x, y */
+extern void canvas_blit(canvas_t *c, int16_t x, int16_t y, canvas_bitmap_t const *pBmp, canvas_rop_t rop);
+
+extern void canvas_setFont(canvas_t *c, canvas_font_t const *pFont);
+
+/** \brief draws a character, its cell has the font height and the advance
+ ** of the glyph as width
+ **
+ ** \param[in] cp unicode code point, the missing glyph of the font is drawn
+ **            if it isn't in the font
+ ** \return advance of the glyph
+ **/
+extern int16_t canvas_putChar(canvas_t *c, int16_t x, int16_t y, uint32_t cp, canvas_color_t fg, canvas_color_t bg);
+
+/** \brief draws an UTF-8 string, with kerning if the font has it */
+extern void canvas_putString(canvas_t *c, int16_t x, int16_t y, char const *pStr, canvas_color_t fg, canvas_color_t bg);
+
+/** \brief width in pixels of an UTF-8 string drawn with canvas_putString */
+extern int16_t canvas_textWidth(canvas_t const *c, char const *pStr);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+/*==================[end of file]============================================*/
+#endif /* CANVAS_H_ */
@@ -0,0 +1,135 @@
+/*
+###############################################################################
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+#ifndef CANVAS_FONT_H_
+#define CANVAS_FONT_H_
+
+/*==================[inclusions]=============================================*/
+#include "stdint.h"
+#include "stddef.h"
+
+#if __has_include("canvas_config.h")
+    #include "canvas_config.h"
+#endif
+
+/* glyphs kept decoded by each canvas, 0 disables the cache */
+#ifndef CANVAS_FONT_CACHE_SIZE
+    #define CANVAS_FONT_CACHE_SIZE      32
+#endif
+
+/* largest glyph of the fonts used, sets the size of the cache entries.
+ * Wider glyphs and taller cells are cut */
+#ifndef CANVAS_FONT_MAX_WIDTH
+    #define CANVAS_FONT_MAX_WIDTH       8
+#endif
+
+#ifndef CANVAS_FONT_MAX_HEIGHT
+    #define CANVAS_FONT_MAX_HEIGHT      8
+#endif
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros and typedef]=====================================*/
+
+/* a bit offset is stored for each block of glyphs, the offset of the others
+ * is found adding the sizes of the previous glyphs of the block */
+#define CANVAS_FONT_INDEX_STEP          16
+
+/* Fonts are made by modules/canvas/tools/fontgen.py from BDF or TTF files.
+ *
+ * The pixels of a glyph are the rows from top to top + rows - 1 of width
+ * columns, the blank rows of the cell are not stored. They are bit packed
+ * column by column, top row first, starting at bit 0 of each byte, with no
+ * padding between glyphs. */
+typedef struct
+{
+    uint8_t box;                    /* width in bits 0-4, blank columns
+                                       after the glyph in bits 5-7 */
+    uint8_t rows;                   /* first row in bits 4-7, rows - 1 in
+                                       bits 0-3 */
+}canvas_fontGlyph_t;
+
+#define CANVAS_FONT_WIDTH(g)        ((g)->box & 0x1F)
+#define CANVAS_FONT_ADVANCE(g)      (CANVAS_FONT_WIDTH(g) + ((g)->box >> 5))
+#define CANVAS_FONT_TOP(g)          ((g)->rows >> 4)
+#define CANVAS_FONT_ROWS(g)         (((g)->rows & 0x0F) + 1)
+
+/* consecutive code points with glyphs */
+typedef struct
+{
+    uint32_t first;
+    uint16_t count;
+    uint16_t glyph;                 /* glyph of the first code point */
+}canvas_fontRange_t;
+
+/* sorted by left and right glyph */
+typedef struct
+{
+    uint16_t left;
+    uint16_t right;
+    int8_t adjust;                  /* added to the advance of left */
+}canvas_fontKern_t;
+
+typedef struct
+{
+    uint8_t height;                 /* cell height */
+    uint8_t nRanges;
+    uint16_t nGlyphs;
+    uint16_t nKern;
+    uint16_t missing;               /* glyph of code points not in the font */
+    canvas_fontRange_t const *pRanges;
+    canvas_fontGlyph_t const *pGlyphs;
+    uint16_t const *pIndex;         /* bit offset of every
+                                       CANVAS_FONT_INDEX_STEP glyphs */
+    uint8_t const *pBits;
+    canvas_fontKern_t const *pKern;
+}canvas_font_t;
+
+/*==================[external data declaration]==============================*/
+
+/* proportional 5x7 in a 8 rows cell, ASCII, degree and micro signs */
+extern canvas_font_t const canvas_font5x7;
+
+/*==================[external functions declaration]=========================*/
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+/*==================[end of file]============================================*/
+#endif /* CANVAS_FONT_H_ */
@@ -0,0 +1,733 @@
+/*
+###############################################################################
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "canvas.h"
+#include "string.h"
+#include "stdlib.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define FONT_PAGES          CANVAS_PAGES(CANVAS_FONT_MAX_HEIGHT)
+
+/* a glyph and its blank columns, up to 7 */
+#define FONT_COLS           (CANVAS_FONT_MAX_WIDTH + 7)
+
+/* previous glyph of the first one of a string */
+#define NO_GLYPH            0xFFFF
+
+#define REPLACEMENT_CHAR    0xFFFD
+
+typedef uint8_t glyphCols_t[FONT_PAGES][FONT_COLS];
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/* page of a row, rounding down also for rows above the canvas */
+static int16_t pageOf(int16_t y)
+{
+    return (y >= 0) ? y / 8 : -((7 - y) / 8);
+}
+
+/* rows of a page inside the clip rectangle */
+static uint8_t clipMask(canvas_t const *c, int16_t page)
+{
+    int16_t lo = c->clip.y0 - page * 8;
+    int16_t hi = c->clip.y1 - page * 8;
+
+    if (hi < 0 || lo > 7)
+        return 0;
+
+    if (lo < 0)
+        lo = 0;
+
+    if (hi > 7)
+        hi = 7;
+
+    return (0xFF << lo) & (0xFF >> (7 - hi));
+}
+
+static uint8_t rop8(uint8_t old, uint8_t bits, uint8_t mask, canvas_rop_t rop)
+{
+    switch (rop)
+    {
+        case CANVAS_ROP_OR:
+            return old | (bits & mask);
+
+        case CANVAS_ROP_AND:
+            return old & (bits | ~mask);
+
+        case CANVAS_ROP_XOR:
+            return old ^ (bits & mask);
+
+        default:
+            return (old & ~mask) | (bits & mask);
+    }
+}
+
+/* combines the rows selected by mask of a page byte */
+static void putBits(canvas_t *c, int16_t x, int16_t page, uint8_t bits, uint8_t mask, canvas_rop_t rop)
+{
+    uint8_t *p;
+    uint8_t old;
+
+    if (x < c->clip.x0 || x > c->clip.x1)
+        return;
+
+    mask &= clipMask(c, page);
+
+    if (mask == 0)
+        return;
+
+    p = &c->pBuf[page * c->width + x];
+    old = *p;
+
+    *p = rop8(old, bits, mask, rop);
+
+    if (*p != old)
+        canvas_setDirty(c, page, x, x);
+}
+
+/* n columns of 8 rows starting at y, which may span two pages. Source bytes
+ * are changed to (src & andBits) ^ xorBits, which gives the four fg and bg
+ * combinations of text. Each page is clipped once and gets one dirty span */
+static void blitCols(canvas_t *c, int16_t x, int16_t y, uint8_t const *pSrc, int16_t n,
+        uint8_t mask, uint8_t andBits, uint8_t xorBits, canvas_rop_t rop)
+{
+    int16_t page = pageOf(y);
+    int16_t shift = y - page * 8;
+    int16_t x0 = x;
+    int16_t x1 = x + n - 1;
+    int16_t half;
+    int16_t i;
+    int16_t first;
+    int16_t last;
+    uint8_t m;
+    uint8_t b;
+    uint8_t old;
+    uint8_t *pDst;
+
+    if (x0 < c->clip.x0)
+        x0 = c->clip.x0;
+
+    if (x1 > c->clip.x1)
+        x1 = c->clip.x1;
+
+    if (x0 > x1)
+        return;
+
+    pSrc += x0 - x;
+
+    for (half = 0 ; half < (shift ? 2 : 1) ; half++)
+    {
+        m = half ? mask >> (8 - shift) : mask << shift;
+        m &= clipMask(c, page + half);
+
+        if (m == 0)
+            continue;
+
+        pDst = &c->pBuf[(page + half) * c->width + x0];
+        first = -1;
+        last = -1;
+
+        if (shift == 0 && m == 0xFF && rop == CANVAS_ROP_COPY)
+        {
+            /* page aligned text and bitmaps */
+            for (i = 0 ; i <= x1 - x0 ; i++)
+            {
+                b = (pSrc[i] & andBits) ^ xorBits;
+
+                if (pDst[i] != b)
+                {
+                    pDst[i] = b;
+
+                    if (first < 0)
+                        first = i;
+
+                    last = i;
+                }
+            }
+        }
+        else
+        {
+            for (i = 0 ; i <= x1 - x0 ; i++)
+            {
+                b = (pSrc[i] & andBits) ^ xorBits;
+                b = half ? b >> (8 - shift) : b << shift;
+                old = pDst[i];
+                pDst[i] = rop8(old, b, m, rop);
+
+                if (pDst[i] != old)
+                {
+                    if (first < 0)
+                        first = i;
+
+                    last = i;
+                }
+            }
+        }
+
+        if (first >= 0)
+            canvas_setDirty(c, page + half, x0 + first, x0 + last);
+    }
+}
+
+static uint16_t glyphOf(canvas_font_t const *pFont, uint32_t cp)
+{
+    canvas_fontRange_t const *pRange = pFont->pRanges;
+    uint8_t i;
+
+    for (i = 0 ; i < pFont->nRanges ; i++, pRange++)
+    {
+        /* below first wraps around */
+        if (cp - pRange->first < pRange->count)
+            return pRange->glyph + (cp - pRange->first);
+    }
+
+    return pFont->missing;
+}
+
+static int16_t kernOf(canvas_font_t const *pFont, uint16_t left, uint16_t right)
+{
+    uint32_t key = ((uint32_t)left << 16) | right;
+    uint32_t k;
+    int32_t lo = 0;
+    int32_t hi = pFont->nKern - 1;
+    int32_t mid;
+
+    while (lo <= hi)
+    {
+        mid = (lo + hi) / 2;
+        k = ((uint32_t)pFont->pKern[mid].left << 16) | pFont->pKern[mid].right;
+
+        if (k == key)
+            return pFont->pKern[mid].adjust;
+
+        if (k < key)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+
+    return 0;
+}
+
+/* n bits (up to 16) starting at bit of a LSB first stream */
+static uint32_t readBits(uint8_t const *p, uint32_t bit, int16_t n)
+{
+    int16_t shift = bit & 0x07;
+    int16_t got = 8 - shift;
+    uint32_t v;
+
+    p += bit / 8;
+    v = *p++ >> shift;
+
+    while (got < n)
+    {
+        v |= (uint32_t)*p++ << got;
+        got += 8;
+    }
+
+    return v & ((1UL << n) - 1);
+}
+
+static void decodeGlyph(canvas_font_t const *pFont, uint16_t glyph, glyphCols_t cols)
+{
+    canvas_fontGlyph_t const *pGlyph = &pFont->pGlyphs[glyph];
+    uint32_t bit = pFont->pIndex[glyph / CANVAS_FONT_INDEX_STEP];
+    int16_t width = CANVAS_FONT_WIDTH(pGlyph);
+    int16_t rows = CANVAS_FONT_ROWS(pGlyph);
+    int16_t top = CANVAS_FONT_TOP(pGlyph);
+    uint16_t g;
+    int16_t col;
+    int16_t page;
+    uint32_t v;
+
+    /* offset of the glyph from the one of its block */
+    for (g = glyph & ~(CANVAS_FONT_INDEX_STEP - 1) ; g < glyph ; g++)
+        bit += CANVAS_FONT_WIDTH(&pFont->pGlyphs[g]) * CANVAS_FONT_ROWS(&pFont->pGlyphs[g]);
+
+    if (width > CANVAS_FONT_MAX_WIDTH)
+        width = CANVAS_FONT_MAX_WIDTH;
+
+    memset(cols, 0, sizeof(glyphCols_t));
+
+    for (col = 0 ; col < width ; col++)
+    {
+        v = readBits(pFont->pBits, bit, rows) << top;
+        bit += rows;
+
+        for (page = 0 ; page < FONT_PAGES ; page++)
+            cols[page][col] = v >> (page * 8);
+    }
+}
+
+static int16_t drawGlyph(canvas_t *c, int16_t x, int16_t y, uint16_t glyph, canvas_color_t fg, canvas_color_t bg)
+{
+    canvas_font_t const *pFont = c->pFont;
+    canvas_fontGlyph_t const *pGlyph = &pFont->pGlyphs[glyph];
+    int16_t advance = CANVAS_FONT_ADVANCE(pGlyph);
+    int16_t nCols = advance;
+    uint8_t andBits = (fg != bg) ? 0xFF : 0x00;
+    uint8_t xorBits = bg ? 0xFF : 0x00;
+    uint8_t mask;
+    int16_t page;
+    uint8_t const (*pCols)[FONT_COLS];
+#if CANVAS_FONT_CACHE_SIZE
+    canvas_glyphCache_t *pEntry;
+#else
+    glyphCols_t cols;
+#endif
+
+    if (x > c->clip.x1 || x + advance <= c->clip.x0 ||
+        y > c->clip.y1 || y + pFont->height <= c->clip.y0)
+    {
+        return advance;
+    }
+
+    if (nCols > FONT_COLS)
+        nCols = FONT_COLS;
+
+#if CANVAS_FONT_CACHE_SIZE
+    pEntry = &c->cache[(glyph + ((uintptr_t)pFont >> 2)) % CANVAS_FONT_CACHE_SIZE];
+
+    if (pEntry->pFont != pFont || pEntry->glyph != glyph)
+    {
+        decodeGlyph(pFont, glyph, pEntry->cols);
+        pEntry->pFont = pFont;
+        pEntry->glyph = glyph;
+    }
+
+    pCols = (uint8_t const (*)[FONT_COLS])pEntry->cols;
+#else
+    decodeGlyph(pFont, glyph, cols);
+    pCols = (uint8_t const (*)[FONT_COLS])cols;
+#endif
+
+    for (page = 0 ; page < CANVAS_PAGES(pFont->height) && page < FONT_PAGES ; page++)
+    {
+        mask = 0xFF;
+
+        /* rows below the cell in its last page */
+        if (page == CANVAS_PAGES(pFont->height) - 1 && (pFont->height & 0x07))
+            mask = 0xFF >> (8 - (pFont->height & 0x07));
+
+        blitCols(c, x, y + page * 8, pCols[page], nCols, mask, andBits, xorBits, CANVAS_ROP_COPY);
+    }
+
+    return advance;
+}
+
+/* decodes an UTF-8 sequence, invalid ones give REPLACEMENT_CHAR */
+static uint32_t nextCodePoint(char const **ppStr)
+{
+    uint8_t const *p = (uint8_t const *)*ppStr;
+    uint32_t cp = *p++;
+    int16_t more = 0;
+
+    if (cp >= 0xF0)
+    {
+        cp &= 0x07;
+        more = 3;
+    }
+    else if (cp >= 0xE0)
+    {
+        cp &= 0x0F;
+        more = 2;
+    }
+    else if (cp >= 0xC0)
+    {
+        cp &= 0x1F;
+        more = 1;
+    }
+    else if (cp >= 0x80)
+    {
+        cp = REPLACEMENT_CHAR;
+    }
+
+    while (more > 0 && (*p & 0xC0) == 0x80)
+    {
+        cp = (cp << 6) | (*p++ & 0x3F);
+        more--;
+    }
+
+    if (more > 0)
+        cp = REPLACEMENT_CHAR;
+
+    *ppStr = (char const *)p;
+
+    return cp;
+}
+
+static void swap(int16_t *a, int16_t *b)
+{
+    int16_t tmp = *a;
+
+    *a = *b;
+    *b = tmp;
+}
+
+/*==================[external functions definition]==========================*/
+
+extern void canvas_init(canvas_t *c, uint8_t *pBuf, canvas_span_t *pDirty, int16_t width, int16_t height)
+{
+    int16_t i;
+
+    c->pBuf = pBuf;
+    c->pDirty = pDirty;
+    c->width = width;
+    c->height = height;
+    c->pFont = &canvas_font5x7;
+
+#if CANVAS_FONT_CACHE_SIZE
+    for (i = 0 ; i < CANVAS_FONT_CACHE_SIZE ; i++)
+        c->cache[i].pFont = NULL;
+#endif
+
+    canvas_setClip(c, NULL);
+
+    for (i = 0 ; i < CANVAS_PAGES(height) ; i++)
+        canvas_setDirty(c, i, 0, width - 1);
+}
+
+extern void canvas_setClip(canvas_t *c, canvas_rect_t const *pRect)
+{
+    c->clip.x0 = 0;
+    c->clip.y0 = 0;
+    c->clip.x1 = c->width - 1;
+    c->clip.y1 = c->height - 1;
+
+    if (pRect != NULL)
+    {
+        if (pRect->x0 > c->clip.x0)
+            c->clip.x0 = pRect->x0;
+
+        if (pRect->y0 > c->clip.y0)
+            c->clip.y0 = pRect->y0;
+
+        if (pRect->x1 < c->clip.x1)
+            c->clip.x1 = pRect->x1;
+
+        if (pRect->y1 < c->clip.y1)
+            c->clip.y1 = pRect->y1;
+    }
+}
+
+extern void canvas_clearDirty(canvas_t *c)
+{
+    int16_t i;
+
+    for (i = 0 ; i < CANVAS_PAGES(c->height) ; i++)
+    {
+        c->pDirty[i].min = c->width;
+        c->pDirty[i].max = -1;
+    }
+}
+
+extern void canvas_setDirty(canvas_t *c, int16_t page, int16_t x0, int16_t x1)
+{
+    if (x0 < c->pDirty[page].min)
+        c->pDirty[page].min = x0;
+
+    if (x1 > c->pDirty[page].max)
+        c->pDirty[page].max = x1;
+}
+
+extern void canvas_clear(canvas_t *c, canvas_color_t color)
+{
+    canvas_fillRect(c, c->clip.x0, c->clip.y0, c->clip.x1, c->clip.y1, color);
+}
+
+extern void canvas_putPixel(canvas_t *c, int16_t x, int16_t y, canvas_color_t color)
+{
+    if (y < c->clip.y0 || y > c->clip.y1)
+        return;
+
+    putBits(c, x, y / 8, color ? 0xFF : 0x00, 1 << (y & 0x07), CANVAS_ROP_COPY);
+}
+
+extern bool canvas_getPixel(canvas_t const *c, int16_t x, int16_t y)
+{
+    if (x < 0 || x >= c->width || y < 0 || y >= c->height)
+        return false;
+
+    return (c->pBuf[(y / 8) * c->width + x] >> (y & 0x07)) & 1;
+}
+
+extern void canvas_line(canvas_t *c, int16_t x0, int16_t y0, int16_t x1, int16_t y1, canvas_color_t color)
+{
+    int16_t dx;
+    int16_t dy;
+    int16_t sx;
+    int16_t sy;
+    int32_t err;
+    int32_t e2;
+
+    if (x0 == x1 || y0 == y1)
+    {
+        canvas_fillRect(c, x0, y0, x1, y1, color);
+        return;
+    }
+
+    /* Bresenham, all octants */
+    dx = abs(x1 - x0);
+    dy = -abs(y1 - y0);
+    sx = x0 < x1 ? 1 : -1;
+    sy = y0 < y1 ? 1 : -1;
+    err = dx + dy;
+
+    for (;;)
+    {
+        canvas_putPixel(c, x0, y0, color);
+
+        if (x0 == x1 && y0 == y1)
+            break;
+
+        e2 = 2 * err;
+
+        if (e2 >= dy)
+        {
+            err += dy;
+            x0 += sx;
+        }
+
+        if (e2 <= dx)
+        {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+extern void canvas_rect(canvas_t *c, int16_t x0, int16_t y0, int16_t x1, int16_t y1, canvas_color_t color)
+{
+    canvas_fillRect(c, x0, y0, x1, y0, color);
+    canvas_fillRect(c, x0, y1, x1, y1, color);
+    canvas_fillRect(c, x0, y0, x0, y1, color);
+    canvas_fillRect(c, x1, y0, x1, y1, color);
+}
+
+extern void canvas_fillRect(canvas_t *c, int16_t x0, int16_t y0, int16_t x1, int16_t y1, canvas_color_t color)
+{
+    int16_t page;
+    uint8_t mask;
+    uint8_t *p;
+    int16_t x;
+
+    if (x0 > x1)
+        swap(&x0, &x1);
+
+    if (y0 > y1)
+        swap(&y0, &y1);
+
+    if (x0 < c->clip.x0)
+        x0 = c->clip.x0;
+
+    if (y0 < c->clip.y0)
+        y0 = c->clip.y0;
+
+    if (x1 > c->clip.x1)
+        x1 = c->clip.x1;
+
+    if (y1 > c->clip.y1)
+        y1 = c->clip.y1;
+
+    if (x0 > x1 || y0 > y1)
+        return;
+
+    /* one byte mask per page, memset when the whole page is covered */
+    for (page = y0 / 8 ; page <= y1 / 8 ; page++)
+    {
+        mask = 0xFF;
+
+        if (page == y0 / 8)
+            mask &= 0xFF << (y0 & 0x07);
+
+        if (page == y1 / 8)
+            mask &= 0xFF >> (7 - (y1 & 0x07));
+
+        p = &c->pBuf[page * c->width + x0];
+
+        if (mask == 0xFF)
+        {
+            memset(p, color ? 0xFF : 0x00, x1 - x0 + 1);
+        }
+        else if (color)
+        {
+            for (x = x0 ; x <= x1 ; x++)
+                *p++ |= mask;
+        }
+        else
+        {
+            for (x = x0 ; x <= x1 ; x++)
+                *p++ &= ~mask;
+        }
+
+        canvas_setDirty(c, page, x0, x1);
+    }
+}
+
+extern void canvas_circle(canvas_t *c, int16_t xc, int16_t yc, int16_t r, canvas_color_t color)
+{
+    int16_t x = r;
+    int16_t y = 0;
+    int32_t err = 1 - r;
+
+    /* midpoint, one octant mirrored 8 times */
+    while (x >= y)
+    {
+        canvas_putPixel(c, xc + x, yc + y, color);
+        canvas_putPixel(c, xc - x, yc + y, color);
+        canvas_putPixel(c, xc + x, yc - y, color);
+        canvas_putPixel(c, xc - x, yc - y, color);
+        canvas_putPixel(c, xc + y, yc + x, color);
+        canvas_putPixel(c, xc - y, yc + x, color);
+        canvas_putPixel(c, xc + y, yc - x, color);
+        canvas_putPixel(c, xc - y, yc - x, color);
+
+        y++;
+
+        if (err < 0)
+        {
+            err += 2 * y + 1;
+        }
+        else
+        {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+}
+
+extern void canvas_fillCircle(canvas_t *c, int16_t xc, int16_t yc, int16_t r, canvas_color_t color)
+{
+    int16_t x = r;
+    int16_t y = 0;
+    int32_t err = 1 - r;
+
+    /* same points as canvas_circle, joined by horizontal spans */
+    while (x >= y)
+    {
+        canvas_fillRect(c, xc - x, yc + y, xc + x, yc + y, color);
+        canvas_fillRect(c, xc - x, yc - y, xc + x, yc - y, color);
+        canvas_fillRect(c, xc - y, yc + x, xc + y, yc + x, color);
+        canvas_fillRect(c, xc - y, yc - x, xc + y, yc - x, color);
+
+        y++;
+
+        if (err < 0)
+        {
+            err += 2 * y + 1;
+        }
+        else
+        {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+}
+
+extern void canvas_blit(canvas_t *c, int16_t x, int16_t y, canvas_bitmap_t const *pBmp, canvas_rop_t rop)
+{
+    int16_t pages = CANVAS_PAGES(pBmp->height);
+    int16_t page;
+    uint8_t mask;
+
+    for (page = 0 ; page < pages ; page++)
+    {
+        mask = 0xFF;
+
+        /* rows below the bitmap in its last page */
+        if (page == pages - 1 && (pBmp->height & 0x07))
+            mask = 0xFF >> (8 - (pBmp->height & 0x07));
+
+        blitCols(c, x, y + page * 8, &pBmp->pData[page * pBmp->width], pBmp->width,
+                mask, 0xFF, 0x00, rop);
+    }
+}
+
+extern void canvas_setFont(canvas_t *c, canvas_font_t const *pFont)
+{
+    c->pFont = (pFont != NULL) ? pFont : &canvas_font5x7;
+}
+
+extern int16_t canvas_putChar(canvas_t *c, int16_t x, int16_t y, uint32_t cp, canvas_color_t fg, canvas_color_t bg)
+{
+    return drawGlyph(c, x, y, glyphOf(c->pFont, cp), fg, bg);
+}
+
+extern void canvas_putString(canvas_t *c, int16_t x, int16_t y, char const *pStr, canvas_color_t fg, canvas_color_t bg)
+{
+    uint16_t prev = NO_GLYPH;
+    uint16_t glyph;
+
+    while (*pStr != '\0' && x <= c->clip.x1)
+    {
+        glyph = glyphOf(c->pFont, nextCodePoint(&pStr));
+
+        if (prev != NO_GLYPH && c->pFont->nKern)
+            x += kernOf(c->pFont, prev, glyph);
+
+        x += drawGlyph(c, x, y, glyph, fg, bg);
+        prev = glyph;
+    }
+}
+
+extern int16_t canvas_textWidth(canvas_t const *c, char const *pStr)
+{
+    uint16_t prev = NO_GLYPH;
+    uint16_t glyph;
+    int16_t width = 0;
+
+    while (*pStr != '\0')
+    {
+        glyph = glyphOf(c->pFont, nextCodePoint(&pStr));
+
+        if (prev != NO_GLYPH && c->pFont->nKern)
+            width += kernOf(c->pFont, prev, glyph);
+
+        width += CANVAS_FONT_ADVANCE(&c->pFont->pGlyphs[glyph]);
+        prev = glyph;
+    }
+
+    return width;
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,210 @@
+/*
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+###############################################################################
+#                                                                             */
+
+/* generated by fontgen.py from 5x7.bdf, 98 glyphs, 553 bytes, with:
+ *   fontgen.py fonts/5x7.bdf --ranges 0x20-0x7f,0xb0,0xb5 --name canvas_font5x7 -o ../src/font_5x7.c
+ */
+
+/*==================[inclusions]=============================================*/
+#include "canvas_font.h"
+
+/*==================[macros and typedef]=====================================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static const canvas_fontRange_t ranges[] =
+{
+    {0x0020, 96, 0},
+    {0x00b0, 1, 96},
+    {0x00b5, 1, 97},
+};
+
+static const canvas_fontGlyph_t glyphs[] =
+{
+    {0x60, 0x00},    /* 0x0020 */
+    {0x21, 0x06},    /* 0x0021 '!' */
+    {0x23, 0x02},    /* 0x0022 '"' */
+    {0x25, 0x06},    /* 0x0023 '#' */
+    {0x25, 0x06},    /* 0x0024 '$' */
+    {0x25, 0x06},    /* 0x0025 '%' */
+    {0x25, 0x06},    /* 0x0026 '&' */
+    {0x22, 0x02},    /* 0x0027 ''' */
+    {0x23, 0x06},    /* 0x0028 '(' */
+    {0x23, 0x06},    /* 0x0029 ')' */
+    {0x25, 0x14},    /* 0x002a */
+    {0x25, 0x14},    /* 0x002b '+' */
+    {0x22, 0x52},    /* 0x002c ',' */
+    {0x25, 0x30},    /* 0x002d '-' */
+    {0x22, 0x51},    /* 0x002e '.' */
+    {0x25, 0x14},    /* 0x002f */
+    {0x25, 0x06},    /* 0x0030 '0' */
+    {0x23, 0x06},    /* 0x0031 '1' */
+    {0x25, 0x06},    /* 0x0032 '2' */
+    {0x25, 0x06},    /* 0x0033 '3' */
+    {0x25, 0x06},    /* 0x0034 '4' */
+    {0x25, 0x06},    /* 0x0035 '5' */
+    {0x25, 0x06},    /* 0x0036 '6' */
+    {0x25, 0x06},    /* 0x0037 '7' */
+    {0x25, 0x06},    /* 0x0038 '8' */
+    {0x25, 0x06},    /* 0x0039 '9' */
+    {0x22, 0x14},    /* 0x003a ':' */
+    {0x22, 0x25},    /* 0x003b ';' */
+    {0x24, 0x06},    /* 0x003c '<' */
+    {0x25, 0x22},    /* 0x003d '=' */
+    {0x24, 0x06},    /* 0x003e '>' */
+    {0x25, 0x06},    /* 0x003f '?' */
+    {0x25, 0x06},    /* 0x0040 '@' */
+    {0x25, 0x06},    /* 0x0041 'A' */
+    {0x25, 0x06},    /* 0x0042 'B' */
+    {0x25, 0x06},    /* 0x0043 'C' */
+    {0x25, 0x06},    /* 0x0044 'D' */
+    {0x25, 0x06},    /* 0x0045 'E' */
+    {0x25, 0x06},    /* 0x0046 'F' */
+    {0x25, 0x06},    /* 0x0047 'G' */
+    {0x25, 0x06},    /* 0x0048 'H' */
+    {0x23, 0x06},    /* 0x0049 'I' */
+    {0x25, 0x06},    /* 0x004a 'J' */
+    {0x25, 0x06},    /* 0x004b 'K' */
+    {0x25, 0x06},    /* 0x004c 'L' */
+    {0x25, 0x06},    /* 0x004d 'M' */
+    {0x25, 0x06},    /* 0x004e 'N' */
+    {0x25, 0x06},    /* 0x004f 'O' */
+    {0x25, 0x06},    /* 0x0050 'P' */
+    {0x25, 0x06},    /* 0x0051 'Q' */
+    {0x25, 0x06},    /* 0x0052 'R' */
+    {0x25, 0x06},    /* 0x0053 'S' */
+    {0x25, 0x06},    /* 0x0054 'T' */
+    {0x25, 0x06},    /* 0x0055 'U' */
+    {0x25, 0x06},    /* 0x0056 'V' */
+    {0x25, 0x06},    /* 0x0057 'W' */
+    {0x25, 0x06},    /* 0x0058 'X' */
+    {0x25, 0x06},    /* 0x0059 'Y' */
+    {0x25, 0x06},    /* 0x005a 'Z' */
+    {0x23, 0x06},    /* 0x005b '[' */
+    {0x25, 0x14},    /* 0x005c */
+    {0x23, 0x06},    /* 0x005d ']' */
+    {0x25, 0x02},    /* 0x005e '^' */
+    {0x25, 0x70},    /* 0x005f '_' */
+    {0x23, 0x02},    /* 0x0060 '`' */
+    {0x25, 0x24},    /* 0x0061 'a' */
+    {0x25, 0x06},    /* 0x0062 'b' */
+    {0x24, 0x24},    /* 0x0063 'c' */
+    {0x25, 0x06},    /* 0x0064 'd' */
+    {0x25, 0x24},    /* 0x0065 'e' */
+    {0x24, 0x06},    /* 0x0066 'f' */
+    {0x25, 0x25},    /* 0x0067 'g' */
+    {0x25, 0x06},    /* 0x0068 'h' */
+    {0x21, 0x06},    /* 0x0069 'i' */
+    {0x23, 0x07},    /* 0x006a 'j' */
+    {0x24, 0x06},    /* 0x006b 'k' */
+    {0x23, 0x06},    /* 0x006c 'l' */
+    {0x25, 0x24},    /* 0x006d 'm' */
+    {0x24, 0x24},    /* 0x006e 'n' */
+    {0x24, 0x24},    /* 0x006f 'o' */
+    {0x24, 0x25},    /* 0x0070 'p' */
+    {0x24, 0x25},    /* 0x0071 'q' */
+    {0x23, 0x24},    /* 0x0072 'r' */
+    {0x24, 0x24},    /* 0x0073 's' */
+    {0x23, 0x06},    /* 0x0074 't' */
+    {0x24, 0x24},    /* 0x0075 'u' */
+    {0x25, 0x24},    /* 0x0076 'v' */
+    {0x25, 0x24},    /* 0x0077 'w' */
+    {0x25, 0x24},    /* 0x0078 'x' */
+    {0x24, 0x25},    /* 0x0079 'y' */
+    {0x25, 0x24},    /* 0x007a 'z' */
+    {0x23, 0x06},    /* 0x007b '{' */
+    {0x21, 0x06},    /* 0x007c '|' */
+    {0x23, 0x06},    /* 0x007d '}' */
+    {0x25, 0x01},    /* 0x007e '~' */
+    {0x25, 0x06},    /* 0x007f */
+    {0x24, 0x03},    /* 0x00b0 */
+    {0x24, 0x25},    /* 0x00b5 */
+};
+
+static const uint16_t offsets[] =
+{
+    0, 294, 758, 1304, 1776, 2163, 2505,
+};
+
+static const uint8_t bits[] =
+{
+    0xdf, 0xe3, 0x94, 0x3f, 0xe5, 0x4f, 0x21, 0xa9, 0xfe, 0x2a, 0xc9, 0x68,
+    0x82, 0x20, 0x8b, 0x6d, 0xc9, 0xaa, 0x08, 0xda, 0x71, 0x44, 0xc1, 0xa0,
+    0x88, 0x43, 0xaa, 0xab, 0x84, 0x90, 0x4f, 0x48, 0xf7, 0x1f, 0x22, 0x22,
+    0x82, 0x2f, 0x9a, 0x2c, 0xfa, 0x84, 0x7f, 0xa0, 0x38, 0x9a, 0x4c, 0x1a,
+    0x45, 0xc1, 0x64, 0xd2, 0x86, 0xa1, 0x48, 0xfe, 0x90, 0x53, 0xb1, 0x58,
+    0xcc, 0xf1, 0x94, 0xc9, 0x24, 0x2c, 0x10, 0x4f, 0x14, 0x06, 0xb6, 0x64,
+    0x32, 0x69, 0x33, 0x24, 0x93, 0x29, 0xcf, 0xde, 0xeb, 0x86, 0xa0, 0x88,
+    0x82, 0x6d, 0xdb, 0xa0, 0x88, 0x82, 0x10, 0x04, 0xa2, 0x09, 0x83, 0x2c,
+    0x99, 0x0f, 0xfa, 0xfc, 0x89, 0x44, 0xc2, 0xff, 0x4f, 0x26, 0x93, 0x36,
+    0x5f, 0x30, 0x18, 0x14, 0xfd, 0x83, 0x41, 0x11, 0xe7, 0x9f, 0x4c, 0x26,
+    0x83, 0xff, 0x44, 0x22, 0x11, 0xf0, 0x05, 0x83, 0x51, 0xf9, 0x1f, 0x81,
+    0x40, 0xfc, 0x83, 0xff, 0x20, 0x08, 0x18, 0xfc, 0x05, 0xfe, 0x08, 0x8a,
+    0x28, 0xf8, 0x07, 0x02, 0x81, 0xc0, 0xbf, 0x80, 0x21, 0xf8, 0xff, 0x09,
+    0x08, 0xc8, 0xdf, 0x17, 0x0c, 0x06, 0x7d, 0xff, 0x44, 0x22, 0x61, 0xf0,
+    0x05, 0xa3, 0x21, 0xef, 0x3f, 0x91, 0x49, 0x19, 0x4d, 0xc9, 0x64, 0x52,
+    0x16, 0x08, 0xfc, 0x03, 0x81, 0x1f, 0x10, 0x08, 0xfc, 0x7d, 0x40, 0x40,
+    0xd0, 0xe7, 0x07, 0xc4, 0x01, 0x7f, 0x63, 0x0a, 0x82, 0x32, 0x1e, 0x10,
+    0xf0, 0x84, 0x41, 0x38, 0x9a, 0x2c, 0x0e, 0xff, 0xc1, 0x60, 0x10, 0x04,
+    0xc1, 0x60, 0xf0, 0x4f, 0x45, 0xfc, 0x11, 0x51, 0xad, 0xd5, 0xff, 0x91,
+    0x44, 0x22, 0xce, 0xc5, 0xa8, 0x70, 0x44, 0x22, 0xf2, 0xef, 0x6a, 0xad,
+    0x06, 0xe1, 0x4f, 0x08, 0x8c, 0x34, 0x4d, 0xbf, 0x3f, 0x82, 0x40, 0xc0,
+    0xf7, 0x01, 0x09, 0xfb, 0xfe, 0x10, 0x14, 0x31, 0xf8, 0x07, 0xfe, 0x60,
+    0x82, 0xff, 0x22, 0x7c, 0x17, 0xa3, 0xfb, 0x93, 0xc4, 0x30, 0x92, 0xe4,
+    0xff, 0x22, 0xc8, 0x5a, 0x13, 0xe1, 0x4f, 0x7c, 0x10, 0xfe, 0x83, 0x20,
+    0x3a, 0x0f, 0x32, 0xf8, 0xa2, 0x22, 0x2a, 0x1e, 0x28, 0xfa, 0xc5, 0x5c,
+    0x67, 0x44, 0xd8, 0x82, 0xff, 0xa0, 0x0d, 0x61, 0xd9, 0xff, 0xff, 0xff,
+    0xff, 0x2d, 0xd3, 0x7e, 0x08, 0xfa, 0x00,
+};
+
+/*==================[external data definition]===============================*/
+
+const canvas_font_t canvas_font5x7 =
+{
+    .height = 8,
+    .nRanges = 3,
+    .nGlyphs = 98,
+    .nKern = 0,
+    .missing = 95,
+    .pRanges = ranges,
+    .pGlyphs = glyphs,
+    .pIndex = offsets,
+    .pBits = bits,
+    .pKern = NULL,
+};
+
+/*==================[end of file]============================================*/
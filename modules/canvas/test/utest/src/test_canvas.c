@@ -0,0 +1,457 @@
+/*
+###############################################################################
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "unity.h"
+#include "canvas.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include "x86intrin.h"
+#define CYCLES()        __rdtsc()
+#else
+#define CYCLES()        clock()
+#endif
+
+/*==================[macros and typedef]=====================================*/
+
+#define WIDTH           128
+#define HEIGHT          64
+#define PAGES           CANVAS_PAGES(HEIGHT)
+
+#define PBM_MAX_SIZE    (32 + WIDTH * HEIGHT / 8)
+
+/* set to regenerate the golden images instead of comparing with them */
+#define UPDATE_GOLDEN_ENV   "CANVAS_UPDATE_GOLDEN"
+
+#define LOOPS           1000
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static uint8_t buf[CANVAS_BUF_SIZE(WIDTH, HEIGHT)];
+static canvas_span_t dirty[PAGES];
+static canvas_t c;
+
+/* 16x16 ring with a vertical bar, page organized */
+static uint8_t const ringData[32] =
+{
+    0xE0, 0x18, 0x04, 0x02, 0x02, 0x01, 0x01, 0xFF,
+    0xFF, 0x01, 0x01, 0x02, 0x02, 0x04, 0x18, 0xE0,
+    0x07, 0x18, 0x20, 0x40, 0x40, 0x80, 0x80, 0xFF,
+    0xFF, 0x80, 0x80, 0x40, 0x40, 0x20, 0x18, 0x07,
+};
+
+static canvas_bitmap_t const ring = {ringData, 16, 16};
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/* P4 image of the canvas, set pixels are black */
+static size_t toPbm(canvas_t const *pC, uint8_t *pPbm)
+{
+    size_t len;
+    int16_t x;
+    int16_t y;
+
+    len = sprintf((char *)pPbm, "P4\n%d %d\n", pC->width, pC->height);
+
+    for (y = 0 ; y < pC->height ; y++)
+    {
+        memset(&pPbm[len], 0, (pC->width + 7) / 8);
+
+        for (x = 0 ; x < pC->width ; x++)
+        {
+            if (canvas_getPixel(pC, x, y))
+                pPbm[len + x / 8] |= 0x80 >> (x % 8);
+        }
+
+        len += (pC->width + 7) / 8;
+    }
+
+    return len;
+}
+
+/* golden images are in test/utest/golden, next to the sources directory */
+static void goldenPath(char *pPath, size_t size, char const *pName, char const *pSuffix)
+{
+    char const *pFile = __FILE__;
+    char const *pEnd = pFile + strlen(pFile);
+    int seps = 0;
+
+    while (pEnd > pFile && seps < 2)
+    {
+        pEnd--;
+
+        if (*pEnd == '/' || *pEnd == '\\')
+            seps++;
+    }
+
+    if (seps < 2)
+        snprintf(pPath, size, "../golden/%s%s.pbm", pName, pSuffix);
+    else
+        snprintf(pPath, size, "%.*s/golden/%s%s.pbm", (int)(pEnd - pFile), pFile, pName, pSuffix);
+}
+
+static void writeFile(char const *pPath, uint8_t const *pData, size_t len)
+{
+    FILE *f = fopen(pPath, "wb");
+
+    TEST_ASSERT_NOT_NULL_MESSAGE(f, pPath);
+    TEST_ASSERT_EQUAL_UINT32(len, fwrite(pData, 1, len, f));
+    fclose(f);
+}
+
+/* compares the canvas with a golden image, the rendered one is left next
+ * to it as <name>_actual.pbm when they differ */
+static void assertGolden(canvas_t const *pC, char const *pName)
+{
+    static uint8_t pbm[PBM_MAX_SIZE];
+    static uint8_t golden[PBM_MAX_SIZE];
+    char path[512];
+    size_t len;
+    size_t goldenLen = 0;
+    FILE *f;
+
+    len = toPbm(pC, pbm);
+    goldenPath(path, sizeof(path), pName, "");
+
+    if (getenv(UPDATE_GOLDEN_ENV) != NULL)
+    {
+        writeFile(path, pbm, len);
+        return;
+    }
+
+    f = fopen(path, "rb");
+
+    if (f != NULL)
+    {
+        goldenLen = fread(golden, 1, sizeof(golden), f);
+        fclose(f);
+    }
+
+    if (goldenLen != len || memcmp(golden, pbm, len) != 0)
+    {
+        goldenPath(path, sizeof(path), pName, "_actual");
+        writeFile(path, pbm, len);
+        TEST_FAIL_MESSAGE(pName);
+    }
+}
+
+/*==================[external functions definition]==========================*/
+
+void setUp(void)
+{
+    canvas_init(&c, buf, dirty, WIDTH, HEIGHT);
+    canvas_clear(&c, CANVAS_COLOR_BLACK);
+    canvas_clearDirty(&c);
+}
+
+void tearDown(void)
+{
+}
+
+void test_canvas_dirtySpans(void)
+{
+    int i;
+
+    canvas_putPixel(&c, 10, 9, CANVAS_COLOR_WHITE);
+    canvas_putPixel(&c, 20, 15, CANVAS_COLOR_WHITE);
+
+    /* already black, nothing changes */
+    canvas_putPixel(&c, 50, 40, CANVAS_COLOR_BLACK);
+
+    for (i = 0 ; i < PAGES ; i++)
+    {
+        if (i == 1)
+        {
+            TEST_ASSERT_EQUAL_INT16(10, dirty[i].min);
+            TEST_ASSERT_EQUAL_INT16(20, dirty[i].max);
+        }
+        else
+        {
+            TEST_ASSERT_TRUE(dirty[i].min > dirty[i].max);
+        }
+    }
+
+    TEST_ASSERT_EQUAL_HEX8(0x02, buf[WIDTH + 10]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, buf[WIDTH + 20]);
+    TEST_ASSERT_TRUE(canvas_getPixel(&c, 10, 9));
+    TEST_ASSERT_FALSE(canvas_getPixel(&c, 10, 8));
+    TEST_ASSERT_FALSE(canvas_getPixel(&c, -1, 9));
+}
+
+void test_canvas_putChar_pageCrossing(void)
+{
+    static uint8_t const a[6] = {0x7e, 0x09, 0x09, 0x09, 0x7e, 0x00};
+    int i;
+
+    TEST_ASSERT_EQUAL_INT16(6, canvas_putChar(&c, 0, 0, 'A', CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK));
+    canvas_putChar(&c, 10, 13, 'A', CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+    canvas_putChar(&c, 20, 16, 'A', CANVAS_COLOR_BLACK, CANVAS_COLOR_WHITE);
+
+    for (i = 0 ; i < 6 ; i++)
+    {
+        TEST_ASSERT_EQUAL_HEX8(a[i], buf[i]);
+        TEST_ASSERT_EQUAL_HEX8((uint8_t)(a[i] << 5), buf[WIDTH + 10 + i]);
+        TEST_ASSERT_EQUAL_HEX8(a[i] >> 3, buf[2 * WIDTH + 10 + i]);
+        TEST_ASSERT_EQUAL_HEX8((uint8_t)~a[i], buf[2 * WIDTH + 20 + i]);
+    }
+}
+
+void test_canvas_font_proportional(void)
+{
+    static uint8_t const degree[5] = {0x06, 0x09, 0x09, 0x06, 0x00};
+    int i;
+
+    TEST_ASSERT_EQUAL_INT16(2, canvas_putChar(&c, 0, 0, 'i', CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK));
+    TEST_ASSERT_EQUAL_INT16(6, canvas_putChar(&c, 0, 0, 'm', CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK));
+    TEST_ASSERT_EQUAL_INT16(3, canvas_putChar(&c, 0, 0, ' ', CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK));
+    TEST_ASSERT_EQUAL_INT16(2 + 6 + 3, canvas_textWidth(&c, "im "));
+
+    /* UTF-8, in a sparse range */
+    canvas_clear(&c, CANVAS_COLOR_BLACK);
+    TEST_ASSERT_EQUAL_INT16(5, canvas_textWidth(&c, "\xc2\xb0"));
+    canvas_putString(&c, 0, 0, "\xc2\xb0" "C", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+
+    for (i = 0 ; i < 5 ; i++)
+        TEST_ASSERT_EQUAL_HEX8(degree[i], buf[i]);
+
+    TEST_ASSERT_EQUAL_HEX8(0x3e, buf[5]);
+
+    /* not in the font, a truncated sequence and a stray continuation byte */
+    canvas_clear(&c, CANVAS_COLOR_BLACK);
+    canvas_putString(&c, 0, 0, "\xe4\xb8\xad" "\x80" "\xe4\xb8", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+
+    for (i = 0 ; i < 18 ; i++)
+        TEST_ASSERT_EQUAL_HEX8((i % 6 == 5) ? 0x00 : 0x7f, buf[i]);
+
+    TEST_ASSERT_EQUAL_HEX8(0x00, buf[18]);
+}
+
+void test_canvas_font_kerning(void)
+{
+    /* glyphs of 'T' and 'o' */
+    static canvas_fontKern_t const kern[] = {{'T' - 0x20, 'o' - 0x20, -1}};
+    canvas_font_t kerned = canvas_font5x7;
+    int16_t wT;
+    int16_t wo;
+
+    kerned.pKern = kern;
+    kerned.nKern = 1;
+
+    wT = canvas_textWidth(&c, "T");
+    wo = canvas_textWidth(&c, "o");
+    TEST_ASSERT_EQUAL_INT16(wT + wo, canvas_textWidth(&c, "To"));
+
+    canvas_setFont(&c, &kerned);
+    TEST_ASSERT_EQUAL_INT16(wT + wo - 1, canvas_textWidth(&c, "To"));
+    TEST_ASSERT_EQUAL_INT16(wo + wT, canvas_textWidth(&c, "oT"));
+
+    canvas_putString(&c, 0, 0, "To", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+    TEST_ASSERT_EQUAL_HEX8(0x38, buf[wT - 1]);
+
+    canvas_setFont(&c, NULL);
+    TEST_ASSERT_TRUE(c.pFont == &canvas_font5x7);
+}
+
+void test_canvas_fillRect_pageMasks(void)
+{
+    int x;
+
+    canvas_fillRect(&c, 5, 12, 2, 3, CANVAS_COLOR_WHITE);
+    canvas_rect(&c, 30, 0, 40, 20, CANVAS_COLOR_WHITE);
+    canvas_fillRect(&c, 3, 4, 4, 4, CANVAS_COLOR_BLACK);
+
+    TEST_ASSERT_EQUAL_HEX8(0xF8, buf[2]);
+    TEST_ASSERT_EQUAL_HEX8(0xE8, buf[3]);
+    TEST_ASSERT_EQUAL_HEX8(0xF8, buf[5]);
+    TEST_ASSERT_EQUAL_HEX8(0x1F, buf[WIDTH + 2]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, buf[6]);
+
+    for (x = 31 ; x < 40 ; x++)
+    {
+        TEST_ASSERT_EQUAL_HEX8(0x01, buf[x]);
+        TEST_ASSERT_EQUAL_HEX8(0x00, buf[WIDTH + x]);
+        TEST_ASSERT_EQUAL_HEX8(0x10, buf[2 * WIDTH + x]);
+    }
+
+    TEST_ASSERT_EQUAL_HEX8(0xFF, buf[30]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, buf[WIDTH + 40]);
+    TEST_ASSERT_EQUAL_HEX8(0x1F, buf[2 * WIDTH + 40]);
+}
+
+void test_canvas_golden_shapes(void)
+{
+    int16_t i;
+
+    /* lines in every octant from the centre */
+    for (i = 0 ; i < 8 ; i++)
+    {
+        canvas_line(&c, 32, 32, 32 + (i < 4 ? 30 : -30), 32 + (i % 4) * 10 - 15, CANVAS_COLOR_WHITE);
+        canvas_line(&c, 32, 32, 32 + (i % 4) * 10 - 15, 32 + (i < 4 ? 30 : -30), CANVAS_COLOR_WHITE);
+    }
+
+    canvas_rect(&c, 66, 2, 125, 61, CANVAS_COLOR_WHITE);
+    canvas_circle(&c, 86, 20, 15, CANVAS_COLOR_WHITE);
+    canvas_fillCircle(&c, 108, 44, 14, CANVAS_COLOR_WHITE);
+    canvas_fillRect(&c, 70, 40, 90, 57, CANVAS_COLOR_WHITE);
+    canvas_fillCircle(&c, 80, 48, 6, CANVAS_COLOR_BLACK);
+
+    assertGolden(&c, "shapes");
+}
+
+void test_canvas_golden_clip(void)
+{
+    canvas_rect_t clip = {20, 10, 107, 53};
+
+    canvas_rect(&c, 19, 9, 108, 54, CANVAS_COLOR_WHITE);
+    canvas_setClip(&c, &clip);
+
+    /* everything partially outside of the clip rectangle */
+    canvas_fillCircle(&c, 20, 10, 25, CANVAS_COLOR_WHITE);
+    canvas_circle(&c, 107, 53, 20, CANVAS_COLOR_WHITE);
+    canvas_line(&c, 0, 63, 127, 0, CANVAS_COLOR_WHITE);
+    canvas_blit(&c, 100, 5, &ring, CANVAS_ROP_COPY);
+    canvas_putString(&c, 60, 50, "clipped text", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+    canvas_fillRect(&c, 60, 20, 127, 30, CANVAS_COLOR_WHITE);
+
+    canvas_setClip(&c, NULL);
+    canvas_putString(&c, 90, 0, "outside", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+
+    assertGolden(&c, "clip");
+}
+
+void test_canvas_golden_blit(void)
+{
+    canvas_rop_t rop;
+    int16_t x;
+
+    /* right half lit, each rop over both halves at an unaligned row */
+    canvas_fillRect(&c, 64, 0, 127, 63, CANVAS_COLOR_WHITE);
+
+    for (rop = CANVAS_ROP_COPY ; rop <= CANVAS_ROP_XOR ; rop++)
+    {
+        x = 4 + rop * 32;
+
+        canvas_blit(&c, x, 3, &ring, rop);
+        canvas_blit(&c, x + 8, 27, &ring, rop);
+    }
+
+    /* off the edges */
+    canvas_blit(&c, -8, 50, &ring, CANVAS_ROP_XOR);
+    canvas_blit(&c, 120, -5, &ring, CANVAS_ROP_XOR);
+    canvas_blit(&c, 60, 56, &ring, CANVAS_ROP_OR);
+
+    assertGolden(&c, "blit");
+}
+
+void test_canvas_golden_text(void)
+{
+    canvas_putString(&c, 0, 0, "The quick brown fox", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+    canvas_putString(&c, 3, 13, "jumps over the lazy", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+    canvas_fillRect(&c, 0, 26, 127, 36, CANVAS_COLOR_WHITE);
+    canvas_putString(&c, 5, 28, "inverse 0123456789", CANVAS_COLOR_BLACK, CANVAS_COLOR_WHITE);
+    canvas_putString(&c, 5, 40, "!\"#$%&'()*+,-./:;<=>?@", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+    canvas_putString(&c, -3, 59, "cut on two edges", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+    canvas_putChar(&c, 123, 50, 'W', CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+    canvas_putString(&c, 70, 50, "25\xc2\xb0" "C 3\xc2\xb5s", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+
+    assertGolden(&c, "text");
+}
+
+void test_canvas_golden_oddSize(void)
+{
+    static uint8_t oddBuf[CANVAS_BUF_SIZE(50, 21)];
+    static canvas_span_t oddDirty[CANVAS_PAGES(21)];
+    canvas_t odd;
+
+    canvas_init(&odd, oddBuf, oddDirty, 50, 21);
+    canvas_clear(&odd, CANVAS_COLOR_BLACK);
+
+    canvas_rect(&odd, 0, 0, 49, 20, CANVAS_COLOR_WHITE);
+    canvas_line(&odd, 0, 20, 49, 0, CANVAS_COLOR_WHITE);
+    canvas_fillCircle(&odd, 40, 16, 8, CANVAS_COLOR_WHITE);
+    canvas_putString(&odd, 2, 2, "50x21", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+    canvas_blit(&odd, 20, 10, &ring, CANVAS_ROP_XOR);
+
+    /* nothing written past the last row */
+    TEST_ASSERT_EQUAL_HEX8(0x00, oddBuf[2 * 50 + 40] & 0xE0);
+
+    assertGolden(&odd, "oddSize");
+}
+
+void test_canvas_bench(void)
+{
+    uint64_t start;
+    uint64_t glyph;
+    uint64_t fill;
+    uint64_t screen;
+    int i;
+    int16_t y;
+
+    start = CYCLES();
+    for (i = 0 ; i < LOOPS ; i++)
+        canvas_putChar(&c, i % 100, i % 50, 0x20 + i % 95, CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+    glyph = CYCLES() - start;
+
+    start = CYCLES();
+    for (i = 0 ; i < LOOPS ; i++)
+        canvas_fillRect(&c, 0, 0, WIDTH - 1, HEIGHT - 1, i & 1);
+    fill = CYCLES() - start;
+
+    /* 8 lines of text, about 200 glyphs */
+    start = CYCLES();
+    for (i = 0 ; i < LOOPS / 10 ; i++)
+    {
+        for (y = 0 ; y < HEIGHT ; y += 8)
+        {
+            canvas_putString(&c, 0, y, (i + y) & 8 ? "The quick brown fox jumps over" :
+                    "Lorem ipsum dolor sit amet, cons", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+        }
+    }
+    screen = CYCLES() - start;
+
+    printf("canvas: %lu cycles/glyph, %lu cycles/full screen fill, %lu cycles/text screen\n",
+            (unsigned long)(glyph / LOOPS), (unsigned long)(fill / LOOPS),
+            (unsigned long)(screen / (LOOPS / 10)));
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,356 @@
+#!/usr/bin/env python3
+###############################################################################
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+###############################################################################
+"""Converts a BDF or TTF font to a canvas_font_t C source.
+
+Examples:
+    fontgen.py fonts/5x7.bdf --ranges 0x20-0x7f,0xb0,0xb5 --name canvas_font5x7 -o ../src/font_5x7.c
+    fontgen.py DejaVuSans.ttf --size 12 --ranges 0x20-0x7e,0xb0 --name font12 -o font12.c
+
+TTF files need Pillow. See canvas_font.h for the format.
+"""
+
+import argparse
+import os
+import sys
+
+INDEX_STEP = 16         # CANVAS_FONT_INDEX_STEP
+MAX_WIDTH = 31
+MAX_SPACING = 7
+MAX_HEIGHT = 16
+
+
+class Glyph:
+    """cell rows of a glyph, each row a list of bits from left to right"""
+
+    def __init__(self, cp, rows, advance):
+        self.cp = cp
+        self.rows = rows
+        self.advance = advance
+
+    def width(self):
+        w = 0
+        for row in self.rows:
+            for x, bit in enumerate(row):
+                if bit:
+                    w = max(w, x + 1)
+        return w
+
+    def bit(self, x, y):
+        row = self.rows[y]
+        return x < len(row) and row[x]
+
+
+def parse_ranges(text):
+    cps = set()
+    for part in text.split(','):
+        if '-' in part:
+            lo, hi = part.split('-')
+            cps.update(range(int(lo, 0), int(hi, 0) + 1))
+        else:
+            cps.add(int(part, 0))
+    return cps
+
+
+def load_bdf(path):
+    glyphs = {}
+    ascent = descent = None
+    default = None
+    with open(path) as f:
+        lines = iter(f.read().splitlines())
+    for line in lines:
+        words = line.split()
+        if not words:
+            continue
+        if words[0] == 'FONT_ASCENT':
+            ascent = int(words[1])
+        elif words[0] == 'FONT_DESCENT':
+            descent = int(words[1])
+        elif words[0] == 'DEFAULT_CHAR':
+            default = int(words[1])
+        elif words[0] == 'STARTCHAR':
+            cp = advance = None
+            bbx = (0, 0, 0, 0)
+            bitmap = []
+            for line in lines:
+                words = line.split()
+                if words[0] == 'ENCODING':
+                    cp = int(words[1])
+                elif words[0] == 'DWIDTH':
+                    advance = int(words[1])
+                elif words[0] == 'BBX':
+                    bbx = tuple(int(v) for v in words[1:5])
+                elif words[0] == 'BITMAP':
+                    for line in lines:
+                        if line.strip() == 'ENDCHAR':
+                            break
+                        bitmap.append(int(line, 16))
+                    break
+            if cp is None or cp < 0:
+                continue
+            w, h, xoff, yoff = bbx
+            if xoff < 0:
+                sys.exit('glyph 0x%x: negative left bearing' % cp)
+            height = ascent + descent
+            rows = [[0] * (xoff + w) for _ in range(height)]
+            nbytes = (w + 7) // 8
+            for i, value in enumerate(bitmap):
+                y = ascent - (yoff + h) + i
+                if 0 <= y < height:
+                    for x in range(w):
+                        rows[y][xoff + x] = (value >> (nbytes * 8 - 1 - x)) & 1
+            glyphs[cp] = Glyph(cp, rows, advance)
+    if ascent is None or descent is None:
+        sys.exit('FONT_ASCENT and FONT_DESCENT are needed')
+    return glyphs, ascent + descent, default
+
+
+def load_ttf(path, size, cps):
+    try:
+        from PIL import Image, ImageDraw, ImageFont
+    except ImportError:
+        sys.exit('TTF fonts need Pillow (pip install pillow)')
+    font = ImageFont.truetype(path, size)
+    ascent, descent = font.getmetrics()
+    height = ascent + descent
+    glyphs = {}
+    for cp in sorted(cps):
+        ch = chr(cp)
+        if cp != 0x20 and font.getmask(ch).getbbox() is None:
+            continue
+        advance = int(round(font.getlength(ch)))
+        x0 = min(0, font.getbbox(ch)[0])
+        img = Image.new('1', (advance + MAX_WIDTH, height), 0)
+        ImageDraw.Draw(img).text((-x0, 0), ch, font=font, fill=1)
+        rows = [[img.getpixel((x, y)) and 1 or 0 for x in range(img.width)]
+                for y in range(height)]
+        glyphs[cp] = Glyph(cp, rows, advance)
+    return glyphs, height, None
+
+
+def kern_pairs(glyphs, height, max_kern, min_gap, chars):
+    """pairs of chars that can be brought closer keeping min_gap blank
+    columns between them, also diagonally"""
+
+    def edges(g, right):
+        w = g.width()
+        out = []
+        for y in range(height):
+            xs = [x for x in range(w) if g.bit(x, y)]
+            if not xs:
+                out.append(None)
+            elif right:
+                out.append(w - 1 - max(xs))
+            else:
+                out.append(min(xs))
+        return out
+
+    right = [edges(g, True) for g in glyphs]
+    left = [edges(g, False) for g in glyphs]
+    pairs = []
+    for i, gl in enumerate(glyphs):
+        if gl.width() == 0 or (chars and gl.cp not in chars):
+            continue
+        spacing = min(max(gl.advance - gl.width(), 0), MAX_SPACING)
+        for j, gr in enumerate(glyphs):
+            if chars and gr.cp not in chars:
+                continue
+            gap = None
+            for y in range(height):
+                if right[i][y] is None:
+                    continue
+                for yy in (y - 1, y, y + 1):
+                    if 0 <= yy < height and left[j][yy] is not None:
+                        g = right[i][y] + spacing + left[j][yy]
+                        gap = g if gap is None else min(gap, g)
+            if gap is None or gap <= min_gap:
+                continue
+            adjust = -min(max_kern, gap - min_gap, spacing)
+            if adjust:
+                pairs.append((i, j, adjust))
+    return pairs
+
+
+def pack(glyphs, height):
+    bits = []
+    metrics = []
+    index = []
+    for n, g in enumerate(glyphs):
+        if n % INDEX_STEP == 0:
+            index.append(len(bits))
+        w = g.width()
+        if w > MAX_WIDTH:
+            sys.exit('glyph 0x%x: width %d, up to %d columns are supported'
+                     % (g.cp, w, MAX_WIDTH))
+        # glyphs wider than their advance don't overlap the next one
+        spacing = min(max(g.advance - w, 0), MAX_SPACING)
+        used = [y for y in range(height) if any(g.bit(x, y) for x in range(w))]
+        top = used[0] if used else 0
+        rows = used[-1] - top + 1 if used else 1
+        if w == 0:
+            rows = 1
+        for x in range(w):
+            for y in range(top, top + rows):
+                bits.append(1 if g.bit(x, y) else 0)
+        metrics.append((w | (spacing << 5), (top << 4) | (rows - 1)))
+    if len(bits) > 0xFFFF:
+        sys.exit('too much glyph data for 16 bit offsets')
+    data = bytearray((len(bits) + 7) // 8)
+    for i, b in enumerate(bits):
+        if b:
+            data[i // 8] |= 1 << (i % 8)
+    return data, metrics, index
+
+
+def ranges_of(cps):
+    out = []
+    for n, cp in enumerate(cps):
+        if out and out[-1][0] + out[-1][1] == cp:
+            out[-1][1] += 1
+        else:
+            out.append([cp, 1, n])
+    return out
+
+
+def char_name(cp):
+    if 0x20 < cp < 0x7f and chr(cp) not in '\\/*':
+        return " '%s'" % chr(cp)
+    return ''
+
+
+def write_c(out, args, glyphs, height, missing, source):
+    data, metrics, index = pack(glyphs, height)
+    cps = [g.cp for g in glyphs]
+    ranges = ranges_of(cps)
+    chars = set(ord(ch) for ch in args.kern_chars) if args.kern_chars else None
+    pairs = kern_pairs(glyphs, height, args.kern, args.min_gap, chars) if args.kern else []
+    lic = open(__file__).read().split('"""')[0].splitlines()[2:35]
+    size = len(data) + 2 * len(metrics) + 2 * len(index) + 8 * len(ranges) + 6 * len(pairs)
+
+    w = out.write
+    w('/*\n')
+    for line in lic:
+        w(line + '\n')
+    w('#                                                                             */\n\n')
+    w('/* generated by fontgen.py from %s, %d glyphs, %d bytes, with:\n'
+      % (os.path.basename(source), len(glyphs), size))
+    w(' *   %s\n */\n\n' % ' '.join([os.path.basename(sys.argv[0])] + sys.argv[1:]))
+    w('/*==================[inclusions]=============================================*/\n')
+    w('#include "canvas_font.h"\n\n')
+    w('/*==================[macros and typedef]=====================================*/\n\n')
+    w('/*==================[internal functions declaration]=========================*/\n\n')
+    w('/*==================[internal data definition]===============================*/\n\n')
+    w('static const canvas_fontRange_t ranges[] =\n{\n')
+    for first, count, glyph in ranges:
+        w('    {0x%04x, %d, %d},\n' % (first, count, glyph))
+    w('};\n\n')
+    w('static const canvas_fontGlyph_t glyphs[] =\n{\n')
+    for g, (box, rows) in zip(glyphs, metrics):
+        w('    {0x%02x, 0x%02x},    /* 0x%04x%s */\n' % (box, rows, g.cp, char_name(g.cp)))
+    w('};\n\n')
+    w('static const uint16_t offsets[] =\n{\n')
+    for i in range(0, len(index), 8):
+        w('    ' + ' '.join('%d,' % v for v in index[i:i + 8]) + '\n')
+    w('};\n\n')
+    w('static const uint8_t bits[] =\n{\n')
+    for i in range(0, len(data), 12):
+        w('    ' + ' '.join('0x%02x,' % v for v in data[i:i + 12]) + '\n')
+    w('};\n\n')
+    if pairs:
+        w('static const canvas_fontKern_t kern[] =\n{\n')
+        for left, right, adjust in pairs:
+            w('    {%d, %d, %d},    /* 0x%04x%s 0x%04x%s */\n'
+              % (left, right, adjust, cps[left], char_name(cps[left]),
+                 cps[right], char_name(cps[right])))
+        w('};\n\n')
+    w('/*==================[external data definition]===============================*/\n\n')
+    w('const canvas_font_t %s =\n{\n' % args.name)
+    w('    .height = %d,\n' % height)
+    w('    .nRanges = %d,\n' % len(ranges))
+    w('    .nGlyphs = %d,\n' % len(glyphs))
+    w('    .nKern = %d,\n' % len(pairs))
+    w('    .missing = %d,\n' % (cps.index(missing) if missing in cps else 0))
+    w('    .pRanges = ranges,\n')
+    w('    .pGlyphs = glyphs,\n')
+    w('    .pIndex = offsets,\n')
+    w('    .pBits = bits,\n')
+    w('    .pKern = %s,\n' % ('kern' if pairs else 'NULL'))
+    w('};\n\n')
+    w('/*==================[end of file]============================================*/\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('font', help='BDF, TTF or OTF file')
+    parser.add_argument('--name', required=True, help='name of the canvas_font_t')
+    parser.add_argument('--size', type=int, default=8, help='pixel size of TTF fonts')
+    parser.add_argument('--ranges', default='0x20-0x7e',
+                        help='code points, e.g. 0x20-0x7e,0xb0 (all of a BDF if not given)')
+    parser.add_argument('--missing', type=lambda v: int(v, 0),
+                        help='code point drawn for the ones not in the font')
+    parser.add_argument('--kern', type=int, default=0,
+                        help='pixels pairs can be brought closer, 0 for no kerning')
+    parser.add_argument('--min-gap', type=int, default=2,
+                        help='blank columns left between kerned glyphs')
+    parser.add_argument('--kern-chars',
+                        help='only kern pairs of these characters, e.g. ATVYLo.,')
+    parser.add_argument('-o', '--output', help='C file, stdout if not given')
+    args = parser.parse_args()
+
+    if args.font.lower().endswith('.bdf'):
+        glyphs, height, default = load_bdf(args.font)
+        if '--ranges' in sys.argv:
+            cps = parse_ranges(args.ranges)
+            glyphs = {cp: g for cp, g in glyphs.items() if cp in cps}
+    else:
+        glyphs, height, default = load_ttf(args.font, args.size, parse_ranges(args.ranges))
+
+    if height > MAX_HEIGHT:
+        sys.exit('height %d, up to %d rows are supported' % (height, MAX_HEIGHT))
+
+    glyphs = [glyphs[cp] for cp in sorted(glyphs)]
+    missing = args.missing if args.missing is not None else default
+    if missing is None:
+        missing = ord('?')
+
+    if args.output:
+        with open(args.output, 'w') as out:
+            write_c(out, args, glyphs, height, missing, args.font)
+    else:
+        write_c(sys.stdout, args, glyphs, height, missing, args.font)
+
+
+if __name__ == '__main__':
+    main()
@@ -91,6 +91,17 @@ extern void efHal_gpio_confBus(efHal_gpio_busid_t id, efHal_gpio_dir_t dir, efHa
 extern void efHal_gpio_writeBus(efHal_gpio_busid_t id, void *pData, size_t length);
 extern void efHal_gpio_readBus(efHal_gpio_busid_t id, void *pData, size_t length);
 
+/** \brief writes 16 bit words to a 8 bit bus, high byte first
+ **
+ ** e.g. RGB565 pixels in CPU byte order
+ **/
+extern void efHal_gpio_writeBus16(efHal_gpio_busid_t id, uint16_t const *pData, size_t count);
+
+/** \brief writes the same 16 bit word count times to a 8 bit bus, high
+ ** byte first
+ **/
+extern void efHal_gpio_fillBus16(efHal_gpio_busid_t id, uint16_t value, size_t count);
+
 /*==================[cplusplus]==============================================*/
 #ifdef __cplusplus
 }
@@ -38,6 +38,7 @@
 /*==================[inclusions]=============================================*/
 #include "efHal.h"
 #include "stddef.h"
+#include "stdbool.h"
 
 /*==================[cplusplus]==============================================*/
 #ifdef __cplusplus
@@ -53,6 +54,7 @@ typedef enum
     EF_HAL_I2C_EC_INVALID_PARAMS = EF_ERROR_HDL_INVALID_PARAMETER,
     EF_HAL_I2C_EC_TRANSFER_UNSUPPORTED,
     EF_HAL_I2C_EC_NAK,
+    EF_HAL_I2C_EC_TIMEOUT,
     EF_HAL_I2C_EC_UNKNOW,
 }efHal_i2c_ec_t;
 
@@ -60,6 +62,51 @@ typedef uint8_t efHal_i2c_devAdd_t;
 
 typedef efHal_i2c_ec_t (*efHal_i2c_deviceTransfer_t)(void* param, efHal_i2c_devAdd_t da, void *pTx, size_t sTx, void *pRx, size_t sRx);
 
+typedef enum
+{
+    EF_HAL_I2C_DIR_WRITE = 0,
+    EF_HAL_I2C_DIR_READ,
+}efHal_i2c_dir_t;
+
+#define EF_HAL_I2C_SEG_FLAG_NO_START    0x01    /* continues previous segment: no start nor address, same direction */
+#define EF_HAL_I2C_SEG_FLAG_STOP        0x02    /* stop after this segment, next one sends a start */
+
+/* segments go in one bus transaction, by default each one begins with a
+ * repeated start and the stop is sent after the last one */
+typedef struct
+{
+    efHal_i2c_dir_t dir;
+    uint8_t flags;
+    void *pBuf;
+    size_t size;
+}efHal_i2c_seg_t;
+
+typedef efHal_i2c_ec_t (*efHal_i2c_deviceTransferSeg_t)(void* param, efHal_i2c_devAdd_t da, efHal_i2c_seg_t const *pSeg, int32_t nSeg);
+
+typedef struct efHal_i2c_xfer_s efHal_i2c_xfer_t;
+
+/* called in interrupt context (or in the context of a synchronous BSP), the
+ * transfer result is in xfer->ec. Can submit another transfer. */
+typedef void (*efHal_i2c_doneCB_t)(efHal_dh_t dh, efHal_i2c_xfer_t *xfer, void *ctx);
+
+struct efHal_i2c_xfer_s
+{
+    efHal_i2c_devAdd_t da;
+    void *pTx;
+    size_t sTx;
+    void *pRx;
+    size_t sRx;
+    efHal_i2c_seg_t const *pSeg;    /* used instead of pTx/pRx if nSeg != 0 */
+    int32_t nSeg;
+
+    /* set by efHal_i2c */
+    efHal_i2c_ec_t volatile ec;
+    bool volatile busy;             /* queued or in progress */
+    efHal_i2c_doneCB_t cb;
+    void *ctx;
+    efHal_i2c_xfer_t *next;
+};
+
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -67,6 +114,16 @@ typedef efHal_i2c_ec_t (*efHal_i2c_deviceTransfer_t)(void* param, efHal_i2c_devA
 extern void efHal_i2c_init(void);
 
 extern efHal_i2c_ec_t efHal_i2c_transfer(efHal_dh_t dh, efHal_i2c_devAdd_t da, void *pTx, size_t sTx, void *pRx, size_t sRx);
+extern efHal_i2c_ec_t efHal_i2c_transferSeg(efHal_dh_t dh, efHal_i2c_devAdd_t da, efHal_i2c_seg_t const *pSeg, int32_t nSeg);
+
+/** \brief queues a transfer on the bus and returns without waiting
+ **
+ ** The transfer is started as soon as the previous one ends, from the end of
+ ** transfer interrupt. xfer must remain valid until cb is called.
+ **
+ ** \return EF_HAL_I2C_EC_NO_ERROR if queued
+ **/
+extern efHal_i2c_ec_t efHal_i2c_submit(efHal_dh_t dh, efHal_i2c_xfer_t *xfer, efHal_i2c_doneCB_t cb, void *ctx);
 
 /*==================[cplusplus]==============================================*/
 #ifdef __cplusplus
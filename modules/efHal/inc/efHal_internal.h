@@ -70,6 +70,8 @@ typedef void (*efHal_gpio_confPin_t)(efHal_gpio_id_t id, efHal_gpio_dir_t dir, e
 typedef void (*efHal_gpio_confBus_t)(efHal_gpio_busid_t id, efHal_gpio_dir_t dir, efHal_gpio_pull_t pull);
 typedef void (*efHal_gpio_writeBus_t)(efHal_gpio_busid_t id, void *pData, size_t length);
 typedef void (*efHal_gpio_readBus_t)(efHal_gpio_busid_t id, void *pData, size_t length);
+typedef void (*efHal_gpio_writeBus16_t)(efHal_gpio_busid_t id, uint16_t const *pData, size_t count);
+typedef void (*efHal_gpio_fillBus16_t)(efHal_gpio_busid_t id, uint16_t value, size_t count);
 
 typedef struct
 {
@@ -81,6 +83,8 @@ typedef struct
     efHal_gpio_confBus_t confBus;
     efHal_gpio_writeBus_t writeBus;
     efHal_gpio_readBus_t readBus;
+    efHal_gpio_writeBus16_t writeBus16;     /* NULL: done with writeBus */
+    efHal_gpio_fillBus16_t fillBus16;       /* NULL: done with writeBus */
 
 }efHal_gpio_callBacks_t;
 
@@ -92,6 +96,16 @@ typedef struct
 #define EF_HAL_GPIO_TOTAL_WAIT_FOR_INT 1
 #endif
 
+/* 256 entry table initializer for the bus lookup tables of the BSPs, M(d)
+ * for each byte */
+#define EF_HAL_BUS_TABLE_4(M, d)    M(d), M((d) + 1), M((d) + 2), M((d) + 3)
+#define EF_HAL_BUS_TABLE_16(M, d)   EF_HAL_BUS_TABLE_4(M, d), EF_HAL_BUS_TABLE_4(M, (d) + 4), \
+                                    EF_HAL_BUS_TABLE_4(M, (d) + 8), EF_HAL_BUS_TABLE_4(M, (d) + 12)
+#define EF_HAL_BUS_TABLE_64(M, d)   EF_HAL_BUS_TABLE_16(M, d), EF_HAL_BUS_TABLE_16(M, (d) + 16), \
+                                    EF_HAL_BUS_TABLE_16(M, (d) + 32), EF_HAL_BUS_TABLE_16(M, (d) + 48)
+#define EF_HAL_BUS_TABLE_256(M)     EF_HAL_BUS_TABLE_64(M, 0), EF_HAL_BUS_TABLE_64(M, 64), \
+                                    EF_HAL_BUS_TABLE_64(M, 128), EF_HAL_BUS_TABLE_64(M, 192)
+
 /******************************* ANALOG ****************************************/
 
 typedef void (*efHal_analog_confAsAnalog_t)(efHal_gpio_id_t id);
@@ -157,11 +171,15 @@ typedef struct
 
 typedef void (*efHal_spi_confCB_t)(void *param, int32_t clockFrec, efHal_spi_mode_t mode);
 typedef void (*efHal_spi_transferCB_t)(void* param, void *pTx, void *pRx, size_t length);
+/* enable: the controller drives its CS during transfers, otherwise it leaves
+ * it deasserted and a device drives its own CS as GPIO */
+typedef void (*efHal_spi_autoCsCB_t)(void* param, bool enable);
 
 typedef struct
 {
     efHal_spi_confCB_t conf;
     efHal_spi_transferCB_t transfer;
+    efHal_spi_autoCsCB_t autoCs;            /* NULL: controller without CS */
 }efHal_spi_callBacks_t;
 
 /*==================[external data declaration]==============================*/
@@ -184,14 +202,21 @@ extern void efHal_internal_pwm_setCallBacks(efHal_pwm_callBacks_t cb);
 
 /******************************* I2C *****************************************/
 
+/* a deviceTransfer callback that returns EF_HAL_I2C_EC_NO_ERROR reports the
+ * result calling this once (it can be before returning), any other return
+ * value ends the transfer without calling it */
 extern void efHal_internal_i2c_endOfTransfer(efHal_internal_dhD_t *p_dhD, efHal_i2c_ec_t ec);
 extern efHal_dh_t efHal_internal_i2c_deviceReg(efHal_i2c_deviceTransfer_t cb_devTra, void* param);
+extern void efHal_internal_i2c_setTransferSeg(efHal_dh_t dh, efHal_i2c_deviceTransferSeg_t cb_devTraSeg);
 
 /******************************* UART ****************************************/
 
 extern efHal_dh_t efHal_internal_uart_deviceReg(efHal_uart_callBacks_t cb, void* param);
 extern void efHal_internal_uart_putDataForRx(efHal_dh_t dh, void *pData);
+extern void efHal_internal_uart_rxIdle(efHal_dh_t dh);
 extern bool efHal_internal_uart_getDataForTx(efHal_dh_t dh, void *pData);
+extern int32_t efHal_internal_uart_getDataForTxBulk(efHal_dh_t dh, void *pData, int32_t size);
+extern void efHal_internal_uart_txComplete(efHal_dh_t dh);
 extern void* efHal_internal_uart_getParam(efHal_dh_t dh);
 
 /******************************* SPI ****************************************/
@@ -37,6 +37,7 @@
 
 /*==================[inclusions]=============================================*/
 #include "efHal.h"
+#include "efHal_gpio.h"
 #include "stddef.h"
 
 /*==================[cplusplus]==============================================*/
@@ -54,6 +55,27 @@ typedef enum
     EF_HAL_SPI_CPOL_1_CPHA_1,
 }efHal_spi_mode_t;
 
+/* part of a transaction, gpio (e.g. D/C or CS) is set to gpioState before
+ * the segment is clocked out */
+typedef struct
+{
+    void *pTx;
+    void *pRx;
+    size_t length;
+    efHal_gpio_id_t gpio;           /* EF_HAL_INVALID_ID if not used */
+    bool gpioState;
+}efHal_spi_seg_t;
+
+/* a device on a bus, the bus is only reconfigured when the device using it
+ * changes and the new one needs a different clock or mode */
+typedef struct
+{
+    efHal_dh_t dh;                  /* bus */
+    int32_t clockFrec;
+    efHal_spi_mode_t mode;
+    efHal_gpio_id_t cs;             /* active low, EF_HAL_INVALID_ID: controller CS */
+}efHal_spi_dev_t;
+
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -62,8 +84,45 @@ extern void efHal_spi_init(void);
 
 extern void efHal_spi_config(efHal_dh_t dh, int32_t clockFrec, efHal_spi_mode_t mode);
 
+/** \brief transfer on the bus, CS is driven by the controller if it has one **/
 extern void efHal_spi_transfer(efHal_dh_t dh, void *pTx, void *pRx, size_t length);
 
+/** \brief clocks out a sequence of segments
+ **
+ ** The bus is taken once and the calling task is woken once, after the last
+ ** segment. Segments are chained from the end of transfer interrupt, so the
+ ** GPIO of a segment changes only when the previous one is shifted out.
+ ** A segment with length 0 only sets its GPIO. As efHal_spi_transfer, CS is
+ ** driven by the controller if it has one.
+ **/
+extern void efHal_spi_transaction(efHal_dh_t dh, efHal_spi_seg_t const *pSeg, int32_t nSeg);
+
+/** \brief fills a device descriptor and configures its CS pin deselected
+ **
+ ** \param[out] dev device descriptor, must remain valid while it is used
+ ** \param[in] dh bus handler
+ ** \param[in] clockFrec clock frequency in Hz
+ ** \param[in] mode clock polarity and phase
+ ** \param[in] cs chip select pin or EF_HAL_INVALID_ID to use the controller one
+ **/
+extern void efHal_spi_devInit(efHal_spi_dev_t *dev, efHal_dh_t dh, int32_t clockFrec, efHal_spi_mode_t mode, efHal_gpio_id_t cs);
+
+/** \brief takes the bus for a device and asserts its CS
+ **
+ ** Transfers of the same device keep CS asserted until efHal_spi_devDeselect.
+ ** efHal_spi_transfer and efHal_spi_config can't be called meanwhile.
+ **/
+extern void efHal_spi_devSelect(efHal_spi_dev_t *dev);
+
+/** \brief deasserts CS and releases the bus */
+extern void efHal_spi_devDeselect(efHal_spi_dev_t *dev);
+
+/** \brief transfer with a device, selects and deselects it if it wasn't */
+extern void efHal_spi_devTransfer(efHal_spi_dev_t *dev, void *pTx, void *pRx, size_t length);
+
+/** \brief transaction with a device, selects and deselects it if it wasn't */
+extern void efHal_spi_devTransaction(efHal_spi_dev_t *dev, efHal_spi_seg_t const *pSeg, int32_t nSeg);
+
 /*==================[cplusplus]==============================================*/
 #ifdef __cplusplus
 }
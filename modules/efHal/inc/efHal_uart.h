@@ -74,6 +74,21 @@ typedef struct
    efHal_uart_stopBits_t stopBits;
 }efHal_uart_conf_t;
 
+/* segment for efHal_uart_sendv, the buffer is not copied */
+typedef struct
+{
+    void const *pBuf;
+    int32_t size;
+}efHal_uart_iov_t;
+
+/* efHal_uart_recvFrame errors */
+#define EF_HAL_UART_FRAME_TOO_LONG      (-1)    /* frame consumed and dropped */
+#define EF_HAL_UART_FRAME_TIMEOUT       (-2)    /* part of the frame consumed */
+
+/* called from interrupt context once the last byte has left the shift
+ * register, from that point the segments belong to the caller again */
+typedef void (*efHal_uart_txDoneCB_t)(efHal_dh_t dh, void *ctx);
+
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -83,8 +98,44 @@ extern void efHal_uart_conf(efHal_dh_t dh, efHal_uart_conf_t const *cfg);
 extern uint32_t efHal_uart_getBaud(efHal_dh_t dh);
 extern uint32_t efHal_uart_getDataLength(efHal_dh_t dh);
 extern int32_t efHal_uart_send(efHal_dh_t dh, void *pBuf, int32_t size, TickType_t blockTime);
+extern int32_t efHal_uart_sendv(efHal_dh_t dh, efHal_uart_iov_t const *iov, int32_t n,
+        efHal_uart_txDoneCB_t cb, void *ctx);
 extern int32_t efHal_uart_recv(efHal_dh_t dh, void *pBuf, int32_t size, TickType_t blockTime);
 
+/** \brief receives once the RX threshold (or size) bytes are buffered or the
+ ** line goes idle after some bytes
+ **
+ ** The idle event is latched, a burst that ended before the call is returned
+ ** without waiting.
+ **/
+extern int32_t efHal_uart_recvBulk(efHal_dh_t dh, void *pBuf, int32_t size, TickType_t blockTime);
+
+/** \brief receives bytes up to and including delim
+ **
+ ** \return bytes stored in pBuf, they end with delim unless max bytes were
+ ** received first. On timeout the bytes not yet moved to pBuf (all of them
+ ** if the line is shorter than the RX ring) stay for the next call.
+ **/
+extern int32_t efHal_uart_recvUntil(efHal_dh_t dh, uint8_t delim, void *pBuf, int32_t max, TickType_t blockTime);
+
+/** \brief receives a frame preceded by its length byte
+ **
+ ** A frame that fits in the RX ring is consumed only once it is complete,
+ ** longer frames are consumed while they arrive.
+ **
+ ** \return the frame length (0 if no complete frame arrived before
+ ** blockTime), EF_HAL_UART_FRAME_TOO_LONG if it did not fit in max bytes or
+ ** EF_HAL_UART_FRAME_TIMEOUT if blockTime expired in the middle of a frame
+ ** longer than the RX ring. In the last case the start of the frame is
+ ** already consumed and its tail would be taken as the next length byte:
+ ** to resync drop input with efHal_uart_recv and a blockTime longer than
+ ** the sender's inter frame gap until it returns 0.
+ **/
+extern int32_t efHal_uart_recvFrame(efHal_dh_t dh, void *pBuf, int32_t max, TickType_t blockTime);
+
+/** \brief bytes that wake efHal_uart_recvBulk, 1 to the RX ring length **/
+extern void efHal_uart_setRxThreshold(efHal_dh_t dh, int32_t threshold);
+
 /*==================[cplusplus]==============================================*/
 #ifdef __cplusplus
 }
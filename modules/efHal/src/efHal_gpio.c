@@ -39,6 +39,9 @@
 
 /*==================[macros and typedef]=====================================*/
 
+/* words converted per writeBus call when the BSP has no 16 bit writer */
+#define BUS16_CHUNK     16
+
 typedef struct
 {
     efHal_gpio_callBackInt_t cbInt;
@@ -211,6 +214,58 @@ extern void efHal_gpio_writeBus(efHal_gpio_busid_t id, void *pData, size_t lengt
     }
 }
 
+extern void efHal_gpio_writeBus16(efHal_gpio_busid_t id, uint16_t const *pData, size_t count)
+{
+    uint8_t buf[2 * BUS16_CHUNK];
+    size_t n;
+    size_t i;
+
+    if (callBacks.writeBus16 != NULL)
+        callBacks.writeBus16(id, pData, count);
+    else
+    {
+        while (count)
+        {
+            n = (count < BUS16_CHUNK) ? count : BUS16_CHUNK;
+
+            for (i = 0 ; i < n ; i++)
+            {
+                buf[2*i] = pData[i] >> 8;
+                buf[2*i + 1] = pData[i];
+            }
+
+            efHal_gpio_writeBus(id, buf, 2 * n);
+            pData += n;
+            count -= n;
+        }
+    }
+}
+
+extern void efHal_gpio_fillBus16(efHal_gpio_busid_t id, uint16_t value, size_t count)
+{
+    uint8_t buf[2 * BUS16_CHUNK];
+    size_t n;
+    size_t i;
+
+    if (callBacks.fillBus16 != NULL)
+        callBacks.fillBus16(id, value, count);
+    else
+    {
+        for (i = 0 ; i < BUS16_CHUNK ; i++)
+        {
+            buf[2*i] = value >> 8;
+            buf[2*i + 1] = value;
+        }
+
+        while (count)
+        {
+            n = (count < BUS16_CHUNK) ? count : BUS16_CHUNK;
+            efHal_gpio_writeBus(id, buf, 2 * n);
+            count -= n;
+        }
+    }
+}
+
 extern void efHal_gpio_readBus(efHal_gpio_busid_t id, void *pData, size_t length)
 {
     if (callBacks.readBus != NULL)
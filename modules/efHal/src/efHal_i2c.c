@@ -42,7 +42,15 @@ typedef struct
 {
     efHal_internal_dhD_t head;
     efHal_i2c_deviceTransfer_t cb;
+    efHal_i2c_deviceTransferSeg_t cbSeg;
     void* param;
+    efHal_i2c_xfer_t *current;      /* in progress, NULL if the bus is idle */
+    efHal_i2c_xfer_t *pendHead;
+    efHal_i2c_xfer_t *pendTail;
+    bool starting;                  /* startQueue() running */
+    bool ended;                     /* current ended while starting */
+    bool completing;                /* done callback running, the bus is
+                                       not free for submit yet */
 }i2c_dhD_t;
 
 /*==================[internal functions declaration]=========================*/
@@ -55,6 +63,148 @@ typedef struct
 
 static i2c_dhD_t dhD[EF_HAL_I2C_TOTAL_DEVICES];
 
+/* the queue is touched from tasks and from the end of transfer interrupt,
+ * the FROM_ISR critical section is valid in both contexts */
+
+/* moves the first pending transfer in if the bus is free, critical section
+ * taken. Only the caller getting true starts it */
+static bool promote(i2c_dhD_t *p_dhD)
+{
+    bool ret = false;
+
+    if (p_dhD->current == NULL && !p_dhD->completing && p_dhD->pendHead != NULL)
+    {
+        p_dhD->current = p_dhD->pendHead;
+        p_dhD->pendHead = p_dhD->pendHead->next;
+        if (p_dhD->pendHead == NULL)
+            p_dhD->pendTail = NULL;
+
+        ret = true;
+    }
+
+    return ret;
+}
+
+/* completes current transfer, a transfer submitted by its callback is only
+ * queued */
+static void endCurrent(i2c_dhD_t *p_dhD, efHal_i2c_ec_t ec)
+{
+    efHal_i2c_xfer_t *xfer = p_dhD->current;
+    efHal_i2c_doneCB_t cb = xfer->cb;
+    void *ctx = xfer->ctx;
+    UBaseType_t savedIntStatus;
+
+    savedIntStatus = taskENTER_CRITICAL_FROM_ISR();
+    p_dhD->current = NULL;
+    p_dhD->completing = true;
+    taskEXIT_CRITICAL_FROM_ISR(savedIntStatus);
+
+    xfer->ec = ec;
+    xfer->busy = false;
+
+    if (cb != NULL)
+        cb(p_dhD, xfer, ctx);
+
+    savedIntStatus = taskENTER_CRITICAL_FROM_ISR();
+    p_dhD->completing = false;
+    taskEXIT_CRITICAL_FROM_ISR(savedIntStatus);
+}
+
+/* starts current transfer and, while they end before returning (errors
+ * or synchronous BSPs), the following ones */
+static void startQueue(i2c_dhD_t *p_dhD)
+{
+    efHal_i2c_xfer_t *xfer;
+    efHal_i2c_ec_t ec;
+    UBaseType_t savedIntStatus;
+    bool loop = true;
+
+    while (loop)
+    {
+        xfer = p_dhD->current;
+
+        if (xfer->nSeg == 0)
+            ec = p_dhD->cb(p_dhD->param, xfer->da, xfer->pTx, xfer->sTx, xfer->pRx, xfer->sRx);
+        else if (p_dhD->cbSeg != NULL)
+            ec = p_dhD->cbSeg(p_dhD->param, xfer->da, xfer->pSeg, xfer->nSeg);
+        else
+            ec = EF_HAL_I2C_EC_TRANSFER_UNSUPPORTED;
+
+        if (ec != EF_HAL_I2C_EC_NO_ERROR)
+            endCurrent(p_dhD, ec);
+
+        savedIntStatus = taskENTER_CRITICAL_FROM_ISR();
+
+        if (ec == EF_HAL_I2C_EC_NO_ERROR && !p_dhD->ended)
+        {
+            /* in progress, end of transfer will start the next one */
+            loop = false;
+        }
+        else
+        {
+            p_dhD->ended = false;
+            loop = promote(p_dhD);
+        }
+
+        if (!loop)
+            p_dhD->starting = false;
+
+        taskEXIT_CRITICAL_FROM_ISR(savedIntStatus);
+    }
+}
+
+static bool checkSeg(efHal_i2c_seg_t const *pSeg, int32_t nSeg)
+{
+    bool ret = (pSeg != NULL && nSeg > 0 &&
+            !(pSeg[0].flags & EF_HAL_I2C_SEG_FLAG_NO_START));
+    int32_t i;
+
+    for (i = 1 ; i < nSeg && ret ; i++)
+    {
+        if (pSeg[i].flags & EF_HAL_I2C_SEG_FLAG_NO_START)
+        {
+            ret = pSeg[i].dir == pSeg[i-1].dir &&
+                  !(pSeg[i-1].flags & EF_HAL_I2C_SEG_FLAG_STOP);
+        }
+    }
+
+    return ret;
+}
+
+static efHal_i2c_ec_t syncTransfer(efHal_dh_t dh, efHal_i2c_xfer_t *xfer);
+
+static void syncDone(efHal_dh_t dh, efHal_i2c_xfer_t *xfer, void *ctx)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    vTaskNotifyGiveFromISR(ctx, &xHigherPriorityTaskWoken);
+
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+static efHal_i2c_ec_t syncTransfer(efHal_dh_t dh, efHal_i2c_xfer_t *xfer)
+{
+    efHal_i2c_ec_t ret;
+
+    xTaskNotifyStateClear(NULL);
+
+    ret = efHal_i2c_submit(dh, xfer, syncDone, xTaskGetCurrentTaskHandle());
+
+    if (ret == EF_HAL_I2C_EC_NO_ERROR)
+    {
+        while (xfer->busy)
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        ret = xfer->ec;
+
+        if (ret != EF_HAL_I2C_EC_NO_ERROR)
+        {
+            efErrorHdl_error(ret, "I2C:ret");
+        }
+    }
+
+    return ret;
+}
 
 /*==================[external functions definition]==========================*/
 
@@ -66,40 +216,92 @@ extern void efHal_i2c_init(void)
     {
         dhD[i].head.mutex = NULL;
         dhD[i].cb = NULL;
+        dhD[i].cbSeg = NULL;
         dhD[i].param = NULL;
+        dhD[i].current = NULL;
+        dhD[i].pendHead = NULL;
+        dhD[i].pendTail = NULL;
+        dhD[i].starting = false;
+        dhD[i].ended = false;
+        dhD[i].completing = false;
     }
 }
 
 extern efHal_i2c_ec_t efHal_i2c_transfer(efHal_dh_t dh, efHal_i2c_devAdd_t da, void *pTx, size_t sTx, void *pRx, size_t sRx)
 {
-    efHal_i2c_ec_t ret;
+    efHal_i2c_xfer_t xfer;
+
+    xfer.da = da;
+    xfer.pTx = pTx;
+    xfer.sTx = sTx;
+    xfer.pRx = pRx;
+    xfer.sRx = sRx;
+    xfer.nSeg = 0;
+
+    return syncTransfer(dh, &xfer);
+}
+
+extern efHal_i2c_ec_t efHal_i2c_transferSeg(efHal_dh_t dh, efHal_i2c_devAdd_t da, efHal_i2c_seg_t const *pSeg, int32_t nSeg)
+{
+    efHal_i2c_xfer_t xfer;
+
+    xfer.da = da;
+    xfer.pSeg = pSeg;
+    xfer.nSeg = nSeg;
+
+    return syncTransfer(dh, &xfer);
+}
+
+extern efHal_i2c_ec_t efHal_i2c_submit(efHal_dh_t dh, efHal_i2c_xfer_t *xfer, efHal_i2c_doneCB_t cb, void *ctx)
+{
+    efHal_i2c_ec_t ret = EF_HAL_I2C_EC_NO_ERROR;
     i2c_dhD_t *p_dhD = dh;
-    uint32_t notifVal;
+    UBaseType_t savedIntStatus;
+    bool start = false;
 
     if (p_dhD == NULL)
     {
         efErrorHdl_error(EF_ERROR_HDL_NULL_POINTER, "p_dhD");
         ret = EF_HAL_I2C_EC_INVALID_HANDLER;
     }
+    else if (xfer == NULL)
+    {
+        efErrorHdl_error(EF_ERROR_HDL_NULL_POINTER, "xfer");
+        ret = EF_HAL_I2C_EC_INVALID_PARAMS;
+    }
+    else if (xfer->nSeg != 0 && !checkSeg(xfer->pSeg, xfer->nSeg))
+    {
+        efErrorHdl_error(EF_ERROR_HDL_INVALID_PARAMETER, "pSeg");
+        ret = EF_HAL_I2C_EC_INVALID_PARAMS;
+    }
     else
     {
-        xSemaphoreTake(p_dhD->head.mutex, portMAX_DELAY);
+        xfer->cb = cb;
+        xfer->ctx = ctx;
+        xfer->next = NULL;
+        xfer->busy = true;
 
-        p_dhD->head.taskHadle = xTaskGetCurrentTaskHandle();
-        xTaskNotifyStateClear(p_dhD->head.taskHadle);
-        ret = p_dhD->cb(p_dhD->param, da, pTx, sTx, pRx, sRx);
-        if (ret == EF_HAL_I2C_EC_NO_ERROR)
-        {
-            xTaskNotifyWait(0, 0, &notifVal, portMAX_DELAY);
-            ret = notifVal;
-        }
+        savedIntStatus = taskENTER_CRITICAL_FROM_ISR();
 
-        if (ret != EF_HAL_I2C_EC_NO_ERROR)
+        if (p_dhD->pendTail == NULL)
+            p_dhD->pendHead = xfer;
+        else
+            p_dhD->pendTail->next = xfer;
+
+        p_dhD->pendTail = xfer;
+
+        /* while startQueue() runs or a done callback is called, the one
+         * running them starts it */
+        if (!p_dhD->starting)
         {
-            efErrorHdl_error(ret, "I2C:ret");
+            start = promote(p_dhD);
+            p_dhD->starting = start;
         }
 
-        xSemaphoreGive(p_dhD->head.mutex);
+        taskEXIT_CRITICAL_FROM_ISR(savedIntStatus);
+
+        if (start)
+            startQueue(p_dhD);
     }
 
     return ret;
@@ -107,13 +309,34 @@ extern efHal_i2c_ec_t efHal_i2c_transfer(efHal_dh_t dh, efHal_i2c_devAdd_t da, v
 
 extern void efHal_internal_i2c_endOfTransfer(efHal_internal_dhD_t *p_dhD, efHal_i2c_ec_t ec)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    i2c_dhD_t *p_i2c_dhD = (i2c_dhD_t *)p_dhD;
+    UBaseType_t savedIntStatus;
+    bool start;
 
-    if (p_dhD != NULL)
+    if (p_i2c_dhD != NULL && p_i2c_dhD->current != NULL)
     {
-        xTaskNotifyFromISR(p_dhD->taskHadle, ec, eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
+        endCurrent(p_i2c_dhD, ec);
+
+        savedIntStatus = taskENTER_CRITICAL_FROM_ISR();
 
-        portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+        /* inside startQueue() (synchronous BSP, or interrupt before the
+         * BSP returned) the loop there starts the next one */
+        if (p_i2c_dhD->starting)
+        {
+            p_i2c_dhD->ended = true;
+            start = false;
+        }
+        else
+        {
+            start = promote(p_i2c_dhD);
+            p_i2c_dhD->starting = start;
+        }
+
+        taskEXIT_CRITICAL_FROM_ISR(savedIntStatus);
+
+        /* next transfer starts right here, without a task hop */
+        if (start)
+            startQueue(p_i2c_dhD);
     }
 }
 
@@ -129,6 +352,7 @@ extern efHal_dh_t efHal_internal_i2c_deviceReg(efHal_i2c_deviceTransfer_t cb_dev
     {
         ret->head.mutex = xSemaphoreCreateMutex();
         ret->cb = cb_devTra;
+        ret->cbSeg = NULL;
         ret->param = param;
     }
     else
@@ -141,4 +365,12 @@ extern efHal_dh_t efHal_internal_i2c_deviceReg(efHal_i2c_deviceTransfer_t cb_dev
     return ret;
 }
 
+extern void efHal_internal_i2c_setTransferSeg(efHal_dh_t dh, efHal_i2c_deviceTransferSeg_t cb_devTraSeg)
+{
+    i2c_dhD_t *p_dhD = dh;
+
+    if (p_dhD != NULL)
+        p_dhD->cbSeg = cb_devTraSeg;
+}
+
 /*==================[end of file]============================================*/
@@ -43,6 +43,18 @@ typedef struct
     efHal_internal_dhD_t head;
     efHal_spi_callBacks_t cb;
     void* param;
+    bool confValid;                 /* efHal_spi_config() was called */
+    int32_t confClockFrec;          /* set by efHal_spi_config() */
+    efHal_spi_mode_t confMode;
+    bool appliedValid;              /* the controller has been configured */
+    int32_t appliedClockFrec;       /* configuration in the controller */
+    efHal_spi_mode_t appliedMode;
+    bool appliedAutoCsValid;
+    bool appliedAutoCs;             /* controller CS enabled */
+    efHal_spi_dev_t *selected;
+    efHal_spi_seg_t const *pSeg;    /* transaction in progress */
+    int32_t nSeg;
+    int32_t segIdx;
 }spi_dhD_t;
 
 /*==================[internal functions declaration]=========================*/
@@ -55,6 +67,86 @@ typedef struct
 
 static spi_dhD_t dhD[EF_HAL_SPI_TOTAL_DEVICES];
 
+/* mutex taken */
+static void applyConf(spi_dhD_t *p_dhD, int32_t clockFrec, efHal_spi_mode_t mode)
+{
+    if (!p_dhD->appliedValid ||
+        p_dhD->appliedClockFrec != clockFrec ||
+        p_dhD->appliedMode != mode)
+    {
+        p_dhD->cb.conf(p_dhD->param, clockFrec, mode);
+        p_dhD->appliedValid = true;
+        p_dhD->appliedClockFrec = clockFrec;
+        p_dhD->appliedMode = mode;
+    }
+}
+
+/* mutex taken, the controller CS is changed before a GPIO CS is asserted */
+static void applyAutoCs(spi_dhD_t *p_dhD, bool enable)
+{
+    if (p_dhD->cb.autoCs != NULL &&
+        (!p_dhD->appliedAutoCsValid || p_dhD->appliedAutoCs != enable))
+    {
+        p_dhD->cb.autoCs(p_dhD->param, enable);
+        p_dhD->appliedAutoCsValid = true;
+        p_dhD->appliedAutoCs = enable;
+    }
+}
+
+/* starts the current segment or the next one with data, returns false at
+ * the end of the transaction. Called from task or interrupt context */
+static bool startSeg(spi_dhD_t *p_dhD)
+{
+    efHal_spi_seg_t const *pSeg;
+    bool ret = false;
+
+    while (!ret && p_dhD->segIdx < p_dhD->nSeg)
+    {
+        pSeg = &p_dhD->pSeg[p_dhD->segIdx];
+
+        if (pSeg->gpio != EF_HAL_INVALID_ID)
+            efHal_gpio_setPin(pSeg->gpio, pSeg->gpioState);
+
+        if (pSeg->length)
+        {
+            p_dhD->cb.transfer(p_dhD->param, pSeg->pTx, pSeg->pRx, pSeg->length);
+            ret = true;
+        }
+        else
+        {
+            p_dhD->segIdx++;
+        }
+    }
+
+    return ret;
+}
+
+/* mutex taken */
+static void transaction(spi_dhD_t *p_dhD, efHal_spi_seg_t const *pSeg, int32_t nSeg)
+{
+    p_dhD->pSeg = pSeg;
+    p_dhD->nSeg = nSeg;
+    p_dhD->segIdx = 0;
+
+    p_dhD->head.taskHadle = xTaskGetCurrentTaskHandle();
+    xTaskNotifyStateClear(p_dhD->head.taskHadle);
+
+    if (startSeg(p_dhD))
+        xTaskNotifyWait(0, 0, NULL, portMAX_DELAY);
+}
+
+/* mutex taken */
+static void transfer(spi_dhD_t *p_dhD, void *pTx, void *pRx, size_t length)
+{
+    efHal_spi_seg_t seg;
+
+    seg.pTx = pTx;
+    seg.pRx = pRx;
+    seg.length = length;
+    seg.gpio = EF_HAL_INVALID_ID;
+
+    transaction(p_dhD, &seg, 1);
+}
 
 /*==================[external functions definition]==========================*/
 
@@ -66,6 +158,10 @@ extern void efHal_spi_init(void)
     {
         dhD[i].head.mutex = NULL;
         dhD[i].param = NULL;
+        dhD[i].confValid = false;
+        dhD[i].appliedValid = false;
+        dhD[i].appliedAutoCsValid = false;
+        dhD[i].selected = NULL;
     }
 }
 
@@ -74,7 +170,10 @@ extern void efHal_spi_config(efHal_dh_t dh, int32_t clockFrec, efHal_spi_mode_t
     spi_dhD_t *p_dhD = dh;
 
     xSemaphoreTake(p_dhD->head.mutex, portMAX_DELAY);
-    p_dhD->cb.conf(p_dhD->param, clockFrec, mode);
+    p_dhD->confValid = true;
+    p_dhD->confClockFrec = clockFrec;
+    p_dhD->confMode = mode;
+    applyConf(p_dhD, clockFrec, mode);
     xSemaphoreGive(p_dhD->head.mutex);
 }
 
@@ -84,20 +183,118 @@ extern void efHal_spi_transfer(efHal_dh_t dh, void *pTx, void *pRx, size_t lengt
 
     xSemaphoreTake(p_dhD->head.mutex, portMAX_DELAY);
 
-    p_dhD->head.taskHadle = xTaskGetCurrentTaskHandle();
-    xTaskNotifyStateClear(p_dhD->head.taskHadle);
-    p_dhD->cb.transfer(p_dhD->param, pTx, pRx, length);
-    xTaskNotifyWait(0, 0, NULL, portMAX_DELAY);
+    /* a device may have left the controller with its own configuration */
+    if (p_dhD->confValid)
+        applyConf(p_dhD, p_dhD->confClockFrec, p_dhD->confMode);
+
+    /* bus level users rely on the controller CS */
+    applyAutoCs(p_dhD, true);
+
+    transfer(p_dhD, pTx, pRx, length);
+    xSemaphoreGive(p_dhD->head.mutex);
+}
+
+extern void efHal_spi_transaction(efHal_dh_t dh, efHal_spi_seg_t const *pSeg, int32_t nSeg)
+{
+    spi_dhD_t *p_dhD = dh;
+
+    xSemaphoreTake(p_dhD->head.mutex, portMAX_DELAY);
+
+    if (p_dhD->confValid)
+        applyConf(p_dhD, p_dhD->confClockFrec, p_dhD->confMode);
+
+    applyAutoCs(p_dhD, true);
+
+    transaction(p_dhD, pSeg, nSeg);
+    xSemaphoreGive(p_dhD->head.mutex);
+}
+
+extern void efHal_spi_devInit(efHal_spi_dev_t *dev, efHal_dh_t dh, int32_t clockFrec, efHal_spi_mode_t mode, efHal_gpio_id_t cs)
+{
+    dev->dh = dh;
+    dev->clockFrec = clockFrec;
+    dev->mode = mode;
+    dev->cs = cs;
+
+    if (cs != EF_HAL_INVALID_ID)
+        efHal_gpio_confPin(cs, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
+}
+
+extern void efHal_spi_devSelect(efHal_spi_dev_t *dev)
+{
+    spi_dhD_t *p_dhD = dev->dh;
+
+    xSemaphoreTake(p_dhD->head.mutex, portMAX_DELAY);
+
+    p_dhD->selected = dev;
+
+    applyConf(p_dhD, dev->clockFrec, dev->mode);
+
+    /* a device without CS pin uses the controller one */
+    applyAutoCs(p_dhD, dev->cs == EF_HAL_INVALID_ID);
+
+    if (dev->cs != EF_HAL_INVALID_ID)
+        efHal_gpio_setPin(dev->cs, 0);
+}
+
+extern void efHal_spi_devDeselect(efHal_spi_dev_t *dev)
+{
+    spi_dhD_t *p_dhD = dev->dh;
+
+    if (dev->cs != EF_HAL_INVALID_ID)
+        efHal_gpio_setPin(dev->cs, 1);
+
+    p_dhD->selected = NULL;
+
     xSemaphoreGive(p_dhD->head.mutex);
 }
 
+extern void efHal_spi_devTransfer(efHal_spi_dev_t *dev, void *pTx, void *pRx, size_t length)
+{
+    spi_dhD_t *p_dhD = dev->dh;
+
+    if (p_dhD->selected == dev)
+    {
+        transfer(p_dhD, pTx, pRx, length);
+    }
+    else
+    {
+        efHal_spi_devSelect(dev);
+        transfer(p_dhD, pTx, pRx, length);
+        efHal_spi_devDeselect(dev);
+    }
+}
+
+extern void efHal_spi_devTransaction(efHal_spi_dev_t *dev, efHal_spi_seg_t const *pSeg, int32_t nSeg)
+{
+    spi_dhD_t *p_dhD = dev->dh;
+
+    if (p_dhD->selected == dev)
+    {
+        transaction(p_dhD, pSeg, nSeg);
+    }
+    else
+    {
+        efHal_spi_devSelect(dev);
+        transaction(p_dhD, pSeg, nSeg);
+        efHal_spi_devDeselect(dev);
+    }
+}
+
 extern void efHal_internal_spi_endOfTransfer(efHal_internal_dhD_t *p_dhD)
 {
+    spi_dhD_t *p_spi_dhD = (spi_dhD_t *)p_dhD;
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    xTaskNotifyFromISR(p_dhD->taskHadle, 0, eNoAction, &xHigherPriorityTaskWoken);
+    p_spi_dhD->segIdx++;
 
-    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+    /* the task is woken only at the end of the transaction */
+    if (!startSeg(p_spi_dhD))
+    {
+        xTaskNotifyFromISR(p_dhD->taskHadle, 0, eNoAction, &xHigherPriorityTaskWoken);
+
+        portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+    }
 }
 
 extern efHal_dh_t efHal_internal_spi_deviceReg(efHal_spi_callBacks_t cb_dev, void* param)
@@ -36,26 +36,61 @@
 /*==================[inclusions]=============================================*/
 #include "efHal_uart.h"
 #include "efHal_internal.h"
+#include "string.h"
 
 /*==================[macros and typedef]=====================================*/
 
-#ifndef EF_HAL_UART_QUEUE_SEND_LENGTH
-#define EF_HAL_UART_QUEUE_SEND_LENGTH 16
+#ifndef EF_HAL_UART_TX_RING_LENGTH
+#define EF_HAL_UART_TX_RING_LENGTH 64       /* must be a power of 2 */
 #endif
 
-#ifndef EF_HAL_UART_QUEUE_RECV_LENGTH
-#define EF_HAL_UART_QUEUE_RECV_LENGTH 16
+#ifndef EF_HAL_UART_RX_RING_LENGTH
+#define EF_HAL_UART_RX_RING_LENGTH 64       /* must be a power of 2 */
 #endif
 
+#if (EF_HAL_UART_TX_RING_LENGTH & (EF_HAL_UART_TX_RING_LENGTH - 1)) != 0
+#error "EF_HAL_UART_TX_RING_LENGTH must be a power of 2"
+#endif
+
+#if (EF_HAL_UART_RX_RING_LENGTH & (EF_HAL_UART_RX_RING_LENGTH - 1)) != 0
+#error "EF_HAL_UART_RX_RING_LENGTH must be a power of 2"
+#endif
+
+/* single producer / single consumer byte ring, head and tail are free
+ * running indexes, each one written only by its owner */
+typedef struct
+{
+    uint8_t *pBuf;
+    uint32_t mask;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+}ringBuf_t;
 
 typedef struct
 {
     efHal_internal_dhD_t head;
     efHal_uart_callBacks_t cb;
     efHal_uart_conf_t conf;
-    QueueHandle_t qSend;
-    QueueHandle_t qRecv;
-    bool txHasEnded;
+    ringBuf_t txRing;
+    uint8_t txBuf[EF_HAL_UART_TX_RING_LENGTH];
+    TaskHandle_t volatile txTask;
+    efHal_uart_iov_t const * volatile txIov;   /* segments not yet sent */
+    int32_t txIovLeft;
+    int32_t txIovPos;
+    bool volatile txWaitTc;             /* sendv done, waiting shift register */
+    efHal_uart_txDoneCB_t txDoneCB;
+    void *txDoneCtx;
+    ringBuf_t rxRing;
+    uint8_t rxBuf[EF_HAL_UART_RX_RING_LENGTH];
+    SemaphoreHandle_t rxMutex;
+    TaskHandle_t volatile rxTask;
+    uint32_t volatile rxWakeLevel;      /* bytes needed to wake rxTask */
+    int32_t volatile rxDelim;           /* byte that wakes rxTask, -1: none */
+    bool volatile rxFrame;              /* wake level given by length prefix */
+    bool volatile rxWakeOnIdle;
+    bool volatile rxIdle;               /* line idle since the last byte */
+    int32_t rxThreshold;
+    bool volatile txHasEnded;
     void* param;
 }uart_dhD_t;
 
@@ -68,6 +103,246 @@ static uart_dhD_t dhD[EF_HAL_UART_TOTAL_DEVICES];
 
 /*==================[internal functions definition]==========================*/
 
+static void ringBuf_init(ringBuf_t *rb, uint8_t *pBuf, uint32_t length)
+{
+    rb->pBuf = pBuf;
+    rb->mask = length - 1;
+    rb->head = 0;
+    rb->tail = 0;
+}
+
+static inline uint32_t ringBuf_count(ringBuf_t const *rb)
+{
+    return rb->head - rb->tail;
+}
+
+static inline uint32_t ringBuf_free(ringBuf_t const *rb)
+{
+    return rb->mask + 1 - (rb->head - rb->tail);
+}
+
+static uint32_t ringBuf_write(ringBuf_t *rb, void const *pData, uint32_t size)
+{
+    uint32_t head = rb->head;
+    uint32_t idx = head & rb->mask;
+    uint32_t free = ringBuf_free(rb);
+    uint32_t chunk;
+
+    if (size > free)
+        size = free;
+
+    /* copy up to the end of the buffer and then wrap */
+    chunk = rb->mask + 1 - idx;
+    if (chunk > size)
+        chunk = size;
+
+    memcpy(&rb->pBuf[idx], pData, chunk);
+    memcpy(&rb->pBuf[0], (uint8_t const *)pData + chunk, size - chunk);
+
+    portMEMORY_BARRIER();
+    rb->head = head + size;
+
+    return size;
+}
+
+static uint32_t ringBuf_read(ringBuf_t *rb, void *pData, uint32_t size)
+{
+    uint32_t tail = rb->tail;
+    uint32_t idx = tail & rb->mask;
+    uint32_t count = ringBuf_count(rb);
+    uint32_t chunk;
+
+    if (size > count)
+        size = count;
+
+    chunk = rb->mask + 1 - idx;
+    if (chunk > size)
+        chunk = size;
+
+    memcpy(pData, &rb->pBuf[idx], chunk);
+    memcpy((uint8_t *)pData + chunk, &rb->pBuf[0], size - chunk);
+
+    portMEMORY_BARRIER();
+    rb->tail = tail + size;
+
+    return size;
+}
+
+static void ringBuf_skip(ringBuf_t *rb, uint32_t size)
+{
+    uint32_t count = ringBuf_count(rb);
+
+    if (size > count)
+        size = count;
+
+    rb->tail += size;
+}
+
+/* looks for data between offsets from and to (relative to tail), returns
+ * the offset following the match or 0 if not found */
+static uint32_t ringBuf_find(ringBuf_t const *rb, uint8_t data, uint32_t from, uint32_t to)
+{
+    uint32_t idx;
+    uint32_t chunk;
+    uint8_t const *pFound;
+
+    while (from < to)
+    {
+        idx = (rb->tail + from) & rb->mask;
+
+        chunk = rb->mask + 1 - idx;
+        if (chunk > to - from)
+            chunk = to - from;
+
+        pFound = memchr(&rb->pBuf[idx], data, chunk);
+
+        if (pFound != NULL)
+            return from + (pFound - &rb->pBuf[idx]) + 1;
+
+        from += chunk;
+    }
+
+    return 0;
+}
+
+static void startTx(uart_dhD_t *dhD)
+{
+    if (dhD->txHasEnded)
+    {
+        dhD->txHasEnded = false;
+        dhD->cb.dataReadyTx(dhD->param);
+    }
+}
+
+static bool txBusy(uart_dhD_t *dhD)
+{
+    return dhD->txIov != NULL || dhD->txWaitTc ||
+           ringBuf_count(&dhD->txRing) != 0;
+}
+
+/* copies bytes from the caller's segments straight to the BSP */
+static int32_t readIov(uart_dhD_t *dhD, uint8_t *pData, int32_t size)
+{
+    efHal_uart_iov_t const *iov = dhD->txIov;
+    int32_t ret = 0;
+    int32_t chunk;
+
+    while (ret < size && dhD->txIovLeft)
+    {
+        chunk = iov->size - dhD->txIovPos;
+        if (chunk > size - ret)
+            chunk = size - ret;
+
+        memcpy(&pData[ret], (uint8_t const *)iov->pBuf + dhD->txIovPos, chunk);
+        dhD->txIovPos += chunk;
+        ret += chunk;
+
+        if (dhD->txIovPos >= iov->size)
+        {
+            iov++;
+            dhD->txIovLeft--;
+            dhD->txIovPos = 0;
+        }
+    }
+
+    if (dhD->txIovLeft)
+    {
+        dhD->txIov = iov;
+    }
+    else
+    {
+        dhD->txIov = NULL;
+        dhD->txWaitTc = true;
+    }
+
+    return ret;
+}
+
+/* sets the condition checked by the ISR to wake the receiving task */
+static void armRx(uart_dhD_t *dhD, uint32_t wakeLevel, int32_t delim, bool frame, bool wakeOnIdle)
+{
+    dhD->rxWakeLevel = wakeLevel;
+    dhD->rxDelim = delim;
+    dhD->rxFrame = frame;
+    dhD->rxWakeOnIdle = wakeOnIdle;
+}
+
+/* the bytes in the ring end a burst and the armed call takes them */
+static bool rxIdleReady(uart_dhD_t *dhD, uint32_t count)
+{
+    return dhD->rxWakeOnIdle && dhD->rxIdle && count != 0;
+}
+
+/* sleeps until the ISR finds the armed condition or new data arrived since
+ * the caller saw seen bytes in the ring. Returns false on timeout. */
+static bool sleepRx(uart_dhD_t *dhD, uint32_t seen, TimeOut_t *pTimeOut, TickType_t *pBlockTime)
+{
+    bool ret = false;
+
+    if (xTaskCheckForTimeOut(pTimeOut, pBlockTime) == pdFALSE)
+    {
+        xTaskNotifyStateClear(NULL);
+        dhD->rxTask = xTaskGetCurrentTaskHandle();
+
+        /* data or idle could have arrived before rxTask was published */
+        if (ringBuf_count(&dhD->rxRing) == seen && !rxIdleReady(dhD, seen))
+            ulTaskNotifyTake(pdTRUE, *pBlockTime);
+
+        dhD->rxTask = NULL;
+        ret = true;
+    }
+
+    return ret;
+}
+
+/* waits until at least wakeLevel bytes are in the RX ring, the BSP reports
+ * an idle line (if wakeOnIdle) or blockTime expires. Returns the bytes
+ * available. */
+static uint32_t waitRx(uart_dhD_t *dhD, uint32_t wakeLevel, bool wakeOnIdle, TickType_t blockTime)
+{
+    TimeOut_t timeOut;
+    uint32_t count;
+
+    vTaskSetTimeOutState(&timeOut);
+    armRx(dhD, wakeLevel, -1, false, wakeOnIdle);
+
+    for (;;)
+    {
+        count = ringBuf_count(&dhD->rxRing);
+
+        if (count >= wakeLevel || rxIdleReady(dhD, count))
+            break;
+
+        if (!sleepRx(dhD, count, &timeOut, &blockTime))
+            break;
+    }
+
+    return count;
+}
+
+/* checks, from the ISR, the condition armed by the receiving task */
+static bool rxWakeUp(uart_dhD_t *dhD, uint8_t data)
+{
+    ringBuf_t const *rb = &dhD->rxRing;
+    uint32_t level = dhD->rxWakeLevel;
+
+    if (dhD->rxFrame)
+    {
+        level = 1 + rb->pBuf[rb->tail & rb->mask];
+
+        if (level > rb->mask + 1)
+            level = rb->mask + 1;
+    }
+
+    return ringBuf_count(rb) >= level || (int32_t)data == dhD->rxDelim;
+}
+
+static void notifyRxFromISR(uart_dhD_t *dhD, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    vTaskNotifyGiveFromISR(dhD->rxTask, pxHigherPriorityTaskWoken);
+    dhD->rxTask = NULL;
+}
+
 /*==================[external functions definition]==========================*/
 extern void efHal_uart_init(void)
 {
@@ -78,6 +353,15 @@ extern void efHal_uart_init(void)
         dhD[i].head.mutex = NULL;
         dhD[i].param = NULL;
         dhD[i].txHasEnded = true;
+        dhD[i].txTask = NULL;
+        dhD[i].txIov = NULL;
+        dhD[i].txWaitTc = false;
+        dhD[i].rxTask = NULL;
+        dhD[i].rxDelim = -1;
+        dhD[i].rxFrame = false;
+        dhD[i].rxWakeOnIdle = false;
+        dhD[i].rxIdle = false;
+        dhD[i].rxThreshold = 1;
     }
 }
 
@@ -126,25 +410,109 @@ extern int32_t efHal_uart_send(efHal_dh_t dh, void *pBuf, int32_t size, TickType
     {
         ret = dhD->cb.sendBuffer(dhD->param, pBuf, size, blockTime);
     }
-    else
+    else if (xSemaphoreTake(dhD->head.mutex, blockTime) == pdTRUE)
     {
         while (ret < size)
         {
-            if (xQueueSend(dhD->qSend, pBuf, blockTime) == pdTRUE)
+            ret += ringBuf_write(&dhD->txRing, (uint8_t *)pBuf + ret, size - ret);
+
+            startTx(dhD);
+
+            if (ret < size)
             {
-                if (dhD->txHasEnded)
+                /* ring full: sleep until the ISR makes room */
+                xTaskNotifyStateClear(NULL);
+                dhD->txTask = xTaskGetCurrentTaskHandle();
+
+                if (ringBuf_free(&dhD->txRing) == 0 &&
+                    ulTaskNotifyTake(pdTRUE, blockTime) == 0)
                 {
-                    dhD->txHasEnded = false;
-                    dhD->cb.dataReadyTx(dhD->param);
+                    dhD->txTask = NULL;
+                    break;
                 }
-                pBuf++;
-                ret++;
+
+                dhD->txTask = NULL;
+            }
+        }
+
+        xSemaphoreGive(dhD->head.mutex);
+    }
+
+    return ret;
+}
+
+extern int32_t efHal_uart_sendv(efHal_dh_t dh, efHal_uart_iov_t const *iov, int32_t n,
+        efHal_uart_txDoneCB_t cb, void *ctx)
+{
+    uart_dhD_t *dhD = dh;
+    int32_t ret = 0;
+    int32_t i;
+
+    if (dhD->cb.sendBuffer != NULL)
+    {
+        for (i = 0 ; i < n ; i++)
+            ret += dhD->cb.sendBuffer(dhD->param, (void *)iov[i].pBuf, iov[i].size, portMAX_DELAY);
+
+        if (cb != NULL)
+            cb(dh, ctx);
+    }
+    else
+    {
+        xSemaphoreTake(dhD->head.mutex, portMAX_DELAY);
+
+        /* the ISR serves the segments before the ring, so everything queued
+         * before must be gone to keep the byte order */
+        for (;;)
+        {
+            xTaskNotifyStateClear(NULL);
+            dhD->txTask = xTaskGetCurrentTaskHandle();
+
+            if (!txBusy(dhD))
+                break;
+
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        dhD->txTask = NULL;
+
+        /* trailing empty segments would never be consumed by the ISR */
+        while (n > 0 && iov[n-1].size == 0)
+            n--;
+
+        for (i = 0 ; i < n && ret >= 0 ; i++)
+        {
+            if (iov[i].size < 0)
+            {
+                efErrorHdl_error(EF_ERROR_HDL_INVALID_PARAMETER, "iov.size");
+                ret = -1;
             }
             else
             {
-                break;
+                ret += iov[i].size;
             }
         }
+
+        if (ret < 0)
+        {
+            ret = 0;
+        }
+        else if (ret == 0)
+        {
+            if (cb != NULL)
+                cb(dh, ctx);
+        }
+        else
+        {
+            dhD->txIovLeft = n;
+            dhD->txIovPos = 0;
+            dhD->txDoneCB = cb;
+            dhD->txDoneCtx = ctx;
+            portMEMORY_BARRIER();
+            dhD->txIov = iov;
+
+            startTx(dhD);
+        }
+
+        xSemaphoreGive(dhD->head.mutex);
     }
 
     return ret;
@@ -153,20 +521,206 @@ extern int32_t efHal_uart_send(efHal_dh_t dh, void *pBuf, int32_t size, TickType
 extern int32_t efHal_uart_recv(efHal_dh_t dh, void *pBuf, int32_t size, TickType_t blockTime)
 {
     uart_dhD_t *dhD = dh;
+    int32_t ret = 0;
+
+    if (size > 0 && xSemaphoreTake(dhD->rxMutex, blockTime) == pdTRUE)
+    {
+        if (waitRx(dhD, 1, false, blockTime))
+            ret = ringBuf_read(&dhD->rxRing, pBuf, size);
+
+        xSemaphoreGive(dhD->rxMutex);
+    }
+
+    return ret;
+}
+
+extern int32_t efHal_uart_recvBulk(efHal_dh_t dh, void *pBuf, int32_t size, TickType_t blockTime)
+{
+    uart_dhD_t *dhD = dh;
+    int32_t wakeLevel = dhD->rxThreshold;
+    int32_t ret = 0;
+
+    if (wakeLevel > size)
+        wakeLevel = size;
+
+    if (size > 0 && xSemaphoreTake(dhD->rxMutex, blockTime) == pdTRUE)
+    {
+        if (waitRx(dhD, wakeLevel, true, blockTime))
+            ret = ringBuf_read(&dhD->rxRing, pBuf, size);
+
+        xSemaphoreGive(dhD->rxMutex);
+    }
+
+    return ret;
+}
+
+extern int32_t efHal_uart_recvUntil(efHal_dh_t dh, uint8_t delim, void *pBuf, int32_t max, TickType_t blockTime)
+{
+    uart_dhD_t *dhD = dh;
+    ringBuf_t *rb = &dhD->rxRing;
+    TimeOut_t timeOut;
+    uint32_t count;
+    uint32_t limit;
+    uint32_t wakeLevel;
+    uint32_t found = 0;
+    uint32_t scanned = 0;
+    int32_t ret = 0;
+
+    if (max > 0 && xSemaphoreTake(dhD->rxMutex, blockTime) == pdTRUE)
+    {
+        vTaskSetTimeOutState(&timeOut);
+
+        for (;;)
+        {
+            /* wake on the delimiter or once the caller's buffer can be
+             * filled, whatever comes first */
+            wakeLevel = max - ret;
+            if (wakeLevel > EF_HAL_UART_RX_RING_LENGTH)
+                wakeLevel = EF_HAL_UART_RX_RING_LENGTH;
+
+            armRx(dhD, wakeLevel, delim, false, false);
+
+            count = ringBuf_count(rb);
+
+            limit = count;
+            if (limit > (uint32_t)(max - ret))
+                limit = max - ret;
 
+            found = ringBuf_find(rb, delim, scanned, limit);
+
+            if (found != 0 || limit == (uint32_t)(max - ret))
+            {
+                ret += ringBuf_read(rb, (uint8_t *)pBuf + ret, found ? found : limit);
+                break;
+            }
+
+            if (count == EF_HAL_UART_RX_RING_LENGTH)
+            {
+                /* ring full without delimiter: make room moving it out */
+                ret += ringBuf_read(rb, (uint8_t *)pBuf + ret, limit);
+                scanned = 0;
+            }
+            else
+            {
+                scanned = limit;
+
+                if (!sleepRx(dhD, count, &timeOut, &blockTime))
+                    break;
+            }
+        }
+
+        armRx(dhD, 1, -1, false, false);
+
+        xSemaphoreGive(dhD->rxMutex);
+    }
+
+    return ret;
+}
+
+extern int32_t efHal_uart_recvFrame(efHal_dh_t dh, void *pBuf, int32_t max, TickType_t blockTime)
+{
+    uart_dhD_t *dhD = dh;
+    ringBuf_t *rb = &dhD->rxRing;
+    TimeOut_t timeOut;
+    uint32_t count = 0;
+    uint32_t need;
+    uint32_t chunk;
+    uint8_t len;
+    int32_t remaining;
+    int32_t pos = 0;
     int32_t ret = 0;
 
-    while ((ret < size) &&
-           (xQueueReceive( dhD->qRecv, pBuf, blockTime) == pdTRUE) )
+    if (xSemaphoreTake(dhD->rxMutex, blockTime) == pdTRUE)
     {
-        ret++;
-        pBuf++;
-        blockTime = 0;
+        vTaskSetTimeOutState(&timeOut);
+        armRx(dhD, 1, -1, true, false);
+
+        /* the ISR wakes us once the whole frame is buffered (or the ring
+         * is full for frames longer than the ring) */
+        for (;;)
+        {
+            count = ringBuf_count(rb);
+
+            if (count != 0)
+            {
+                need = 1 + rb->pBuf[rb->tail & rb->mask];
+
+                if (need > EF_HAL_UART_RX_RING_LENGTH)
+                    need = EF_HAL_UART_RX_RING_LENGTH;
+
+                if (count >= need)
+                    break;
+            }
+
+            if (!sleepRx(dhD, count, &timeOut, &blockTime))
+            {
+                count = 0;
+                break;
+            }
+        }
+
+        if (count != 0)
+        {
+            ringBuf_read(rb, &len, sizeof(len));
+            remaining = len;
+
+            while (remaining > 0)
+            {
+                count = ringBuf_count(rb);
+
+                if (count == 0)
+                {
+                    armRx(dhD, remaining < EF_HAL_UART_RX_RING_LENGTH ?
+                            remaining : EF_HAL_UART_RX_RING_LENGTH, -1, false, false);
+
+                    if (!sleepRx(dhD, 0, &timeOut, &blockTime))
+                        break;
+                }
+                else
+                {
+                    if (count > (uint32_t)remaining)
+                        count = remaining;
+
+                    chunk = count;
+                    if (chunk > (uint32_t)(max - pos))
+                        chunk = max - pos;
+
+                    pos += ringBuf_read(rb, (uint8_t *)pBuf + pos, chunk);
+                    ringBuf_skip(rb, count - chunk);
+                    remaining -= count;
+                }
+            }
+
+            if (remaining != 0)
+                ret = EF_HAL_UART_FRAME_TIMEOUT;
+            else if (len > max)
+                ret = EF_HAL_UART_FRAME_TOO_LONG;
+            else
+                ret = len;
+        }
+
+        armRx(dhD, 1, -1, false, false);
+
+        xSemaphoreGive(dhD->rxMutex);
     }
 
     return ret;
 }
 
+extern void efHal_uart_setRxThreshold(efHal_dh_t dh, int32_t threshold)
+{
+    uart_dhD_t *dhD = dh;
+
+    if (threshold < 1 || threshold > EF_HAL_UART_RX_RING_LENGTH)
+    {
+        efErrorHdl_error(EF_ERROR_HDL_INVALID_PARAMETER, "threshold");
+    }
+    else
+    {
+        dhD->rxThreshold = threshold;
+    }
+}
+
 extern efHal_dh_t efHal_internal_uart_deviceReg(efHal_uart_callBacks_t cb, void* param)
 {
     uart_dhD_t *ret;
@@ -180,8 +734,9 @@ extern efHal_dh_t efHal_internal_uart_deviceReg(efHal_uart_callBacks_t cb, void*
         ret->head.mutex = xSemaphoreCreateMutex();
         ret->cb = cb;
         ret->param = param;
-        ret->qSend = xQueueCreate(EF_HAL_UART_QUEUE_SEND_LENGTH, sizeof(uint8_t));
-        ret->qRecv = xQueueCreate(EF_HAL_UART_QUEUE_RECV_LENGTH, sizeof(uint8_t));
+        ringBuf_init(&ret->txRing, ret->txBuf, EF_HAL_UART_TX_RING_LENGTH);
+        ret->rxMutex = xSemaphoreCreateMutex();
+        ringBuf_init(&ret->rxRing, ret->rxBuf, EF_HAL_UART_RX_RING_LENGTH);
     }
     else
     {
@@ -195,30 +750,55 @@ extern efHal_dh_t efHal_internal_uart_deviceReg(efHal_uart_callBacks_t cb, void*
 
 extern void efHal_internal_uart_putDataForRx(efHal_dh_t dh, void *pData)
 {
-    BaseType_t xHigherPriorityTaskWoken = false;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     uart_dhD_t *dhD = dh;
 
-    xQueueSendFromISR( dhD->qRecv, pData, &xHigherPriorityTaskWoken );
+    dhD->rxIdle = false;
+
+    /* if the ring is full the byte is dropped */
+    ringBuf_write(&dhD->rxRing, pData, 1);
+
+    if (dhD->rxTask != NULL && rxWakeUp(dhD, *(uint8_t *)pData))
+        notifyRxFromISR(dhD, &xHigherPriorityTaskWoken);
 
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
-extern bool efHal_internal_uart_getDataForTx(efHal_dh_t dh, void *pData)
+extern void efHal_internal_uart_rxIdle(efHal_dh_t dh)
 {
-    uint8_t data;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     uart_dhD_t *dhD = dh;
-    BaseType_t xHigherPriorityTaskWoken = false;
-    bool ret;
 
-    if (xQueueReceiveFromISR( dhD->qSend,(void *) &data, &xHigherPriorityTaskWoken) == pdTRUE)
+    /* latched, a reader arriving later takes the burst without waiting */
+    dhD->rxIdle = true;
+
+    if (dhD->rxTask != NULL && rxIdleReady(dhD, ringBuf_count(&dhD->rxRing)))
     {
-        *(uint8_t*)pData = data;
-        ret = true;
+        notifyRxFromISR(dhD, &xHigherPriorityTaskWoken);
     }
-    else
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+extern int32_t efHal_internal_uart_getDataForTxBulk(efHal_dh_t dh, void *pData, int32_t size)
+{
+    uart_dhD_t *dhD = dh;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    int32_t ret = 0;
+
+    if (dhD->txIov != NULL)
+        ret = readIov(dhD, pData, size);
+
+    ret += ringBuf_read(&dhD->txRing, (uint8_t *)pData + ret, size - ret);
+
+    if (ret == 0)
     {
         dhD->txHasEnded = true;
-        ret = false;
+    }
+    else if (dhD->txTask != NULL)
+    {
+        vTaskNotifyGiveFromISR(dhD->txTask, &xHigherPriorityTaskWoken);
+        dhD->txTask = NULL;
     }
 
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
@@ -226,6 +806,33 @@ extern bool efHal_internal_uart_getDataForTx(efHal_dh_t dh, void *pData)
     return ret;
 }
 
+extern void efHal_internal_uart_txComplete(efHal_dh_t dh)
+{
+    uart_dhD_t *dhD = dh;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if (dhD->txWaitTc)
+    {
+        dhD->txWaitTc = false;
+
+        if (dhD->txDoneCB != NULL)
+            dhD->txDoneCB(dh, dhD->txDoneCtx);
+
+        if (dhD->txTask != NULL)
+        {
+            vTaskNotifyGiveFromISR(dhD->txTask, &xHigherPriorityTaskWoken);
+            dhD->txTask = NULL;
+        }
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+extern bool efHal_internal_uart_getDataForTx(efHal_dh_t dh, void *pData)
+{
+    return efHal_internal_uart_getDataForTxBulk(dh, pData, 1) == 1;
+}
+
 extern void* efHal_internal_uart_getParam(efHal_dh_t dh)
 {
     uart_dhD_t *dhD = dh;
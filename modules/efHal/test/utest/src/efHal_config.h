@@ -45,6 +45,8 @@ extern "C" {
 /*==================[macros and typedef]=====================================*/
 
 #define EF_HAL_I2C_TOTAL_DEVICES    1
+#define EF_HAL_UART_TOTAL_DEVICES   2
+#define EF_HAL_SPI_TOTAL_DEVICES    1
 
 /*==================[external data declaration]==============================*/
 
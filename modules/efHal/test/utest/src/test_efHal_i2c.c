@@ -0,0 +1,308 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "unity.h"
+#include "efHal.h"
+#include "efHal_i2c.h"
+#include "efHal_internal.h"
+#include "string.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define MAX_LOG         16
+
+/* what the fake I2C controller saw */
+typedef struct
+{
+    efHal_i2c_xfer_t *started[MAX_LOG];     /* by start order, from da */
+    int32_t nStarted;
+    efHal_i2c_xfer_t *done[MAX_LOG];
+    int32_t nDone;
+    efHal_i2c_devAdd_t onWire;              /* 0 if idle */
+    int32_t doubleStarts;                   /* started with one on the wire */
+    bool sync;                              /* ends transfers before returning */
+    efHal_i2c_ec_t startEc;                 /* returned by the next start */
+}fakeBus_t;
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static efHal_dh_t dh;
+static fakeBus_t bus;
+static efHal_i2c_xfer_t xfers[4];
+
+/* submitted by doneCB when the transfer given as ctx ends */
+static efHal_i2c_xfer_t *pResubmit;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+static efHal_i2c_ec_t start(efHal_i2c_devAdd_t da)
+{
+    efHal_i2c_ec_t ec = bus.startEc;
+    int32_t i;
+
+    if (bus.onWire != 0)
+    {
+        /* the controller refuses it, as the KL46Z with kStatus_I2C_Busy */
+        bus.doubleStarts++;
+        return EF_HAL_I2C_EC_NAK;
+    }
+
+    bus.startEc = EF_HAL_I2C_EC_NO_ERROR;
+
+    for (i = 0 ; i < 4 ; i++)
+    {
+        if (xfers[i].da == da)
+            bus.started[bus.nStarted++] = &xfers[i];
+    }
+
+    if (ec != EF_HAL_I2C_EC_NO_ERROR)
+        return ec;
+
+    if (bus.sync)
+        efHal_internal_i2c_endOfTransfer((efHal_internal_dhD_t *)dh, EF_HAL_I2C_EC_NO_ERROR);
+    else
+        bus.onWire = da;
+
+    return EF_HAL_I2C_EC_NO_ERROR;
+}
+
+static efHal_i2c_ec_t busTransfer(void* param, efHal_i2c_devAdd_t da, void *pTx, size_t sTx, void *pRx, size_t sRx)
+{
+    return start(da);
+}
+
+static efHal_i2c_ec_t busTransferSeg(void* param, efHal_i2c_devAdd_t da, efHal_i2c_seg_t const *pSeg, int32_t nSeg)
+{
+    return start(da);
+}
+
+/* the end of transfer interrupt */
+static void endOfTransfer(efHal_i2c_ec_t ec)
+{
+    TEST_ASSERT_NOT_EQUAL(0, bus.onWire);
+    bus.onWire = 0;
+    efHal_internal_i2c_endOfTransfer((efHal_internal_dhD_t *)dh, ec);
+}
+
+static void doneCB(efHal_dh_t dhCb, efHal_i2c_xfer_t *xfer, void *ctx)
+{
+    efHal_i2c_xfer_t *next = pResubmit;
+
+    TEST_ASSERT_EQUAL_PTR(dh, dhCb);
+    TEST_ASSERT_FALSE(xfer->busy);
+    bus.done[bus.nDone++] = xfer;
+
+    if (next != NULL && ctx == xfer)
+    {
+        pResubmit = NULL;
+        TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NO_ERROR, efHal_i2c_submit(dh, next, doneCB, next));
+    }
+}
+
+static void submit(int32_t i)
+{
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NO_ERROR, efHal_i2c_submit(dh, &xfers[i], doneCB, &xfers[i]));
+}
+
+static void checkOrder(efHal_i2c_xfer_t **pLog, int32_t n, char const *order)
+{
+    int32_t i;
+
+    TEST_ASSERT_EQUAL_INT32(strlen(order), n);
+
+    for (i = 0 ; i < n ; i++)
+        TEST_ASSERT_EQUAL_PTR(&xfers[order[i] - '0'], pLog[i]);
+}
+
+/*==================[external functions definition]==========================*/
+
+void setUp(void)
+{
+    int32_t i;
+
+    memset(&bus, 0, sizeof(bus));
+    memset(xfers, 0, sizeof(xfers));
+    pResubmit = NULL;
+
+    for (i = 0 ; i < 4 ; i++)
+        xfers[i].da = 0x10 + i;
+
+    efHal_i2c_init();
+    dh = efHal_internal_i2c_deviceReg(busTransfer, NULL);
+    efHal_internal_i2c_setTransferSeg(dh, busTransferSeg);
+}
+
+void tearDown(void)
+{
+}
+
+void test_efHal_i2c_submit_startsWhenIdle(void)
+{
+    submit(0);
+
+    checkOrder(bus.started, bus.nStarted, "0");
+    TEST_ASSERT_TRUE(xfers[0].busy);
+    TEST_ASSERT_EQUAL_INT32(0, bus.nDone);
+
+    endOfTransfer(EF_HAL_I2C_EC_NO_ERROR);
+
+    checkOrder(bus.done, bus.nDone, "0");
+    TEST_ASSERT_FALSE(xfers[0].busy);
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NO_ERROR, xfers[0].ec);
+}
+
+void test_efHal_i2c_submit_queueOrder(void)
+{
+    submit(0);
+    submit(1);
+    submit(2);
+
+    /* the others wait for the end of the first */
+    checkOrder(bus.started, bus.nStarted, "0");
+    TEST_ASSERT_TRUE(xfers[2].busy);
+
+    endOfTransfer(EF_HAL_I2C_EC_NO_ERROR);
+    checkOrder(bus.started, bus.nStarted, "01");
+    endOfTransfer(EF_HAL_I2C_EC_NAK);
+    checkOrder(bus.started, bus.nStarted, "012");
+    endOfTransfer(EF_HAL_I2C_EC_NO_ERROR);
+
+    checkOrder(bus.done, bus.nDone, "012");
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NAK, xfers[1].ec);
+    TEST_ASSERT_EQUAL_INT32(0, bus.doubleStarts);
+}
+
+void test_efHal_i2c_submit_fromCallbackEmptyQueue(void)
+{
+    pResubmit = &xfers[1];
+    submit(0);
+
+    endOfTransfer(EF_HAL_I2C_EC_NO_ERROR);
+
+    /* started once, by the end of transfer and not again by submit */
+    checkOrder(bus.started, bus.nStarted, "01");
+    TEST_ASSERT_EQUAL_INT32(0, bus.doubleStarts);
+    TEST_ASSERT_TRUE(xfers[1].busy);
+
+    endOfTransfer(EF_HAL_I2C_EC_NO_ERROR);
+
+    checkOrder(bus.done, bus.nDone, "01");
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NO_ERROR, xfers[1].ec);
+}
+
+void test_efHal_i2c_submit_fromCallbackAfterQueued(void)
+{
+    pResubmit = &xfers[2];
+    submit(0);
+    submit(1);
+
+    endOfTransfer(EF_HAL_I2C_EC_NO_ERROR);
+    endOfTransfer(EF_HAL_I2C_EC_NO_ERROR);
+    endOfTransfer(EF_HAL_I2C_EC_NO_ERROR);
+
+    /* the one submitted by the callback goes after the queued one */
+    checkOrder(bus.started, bus.nStarted, "012");
+    checkOrder(bus.done, bus.nDone, "012");
+    TEST_ASSERT_EQUAL_INT32(0, bus.doubleStarts);
+}
+
+void test_efHal_i2c_submit_syncBsp(void)
+{
+    bus.sync = true;
+    pResubmit = &xfers[1];
+
+    /* each ends inside the BSP call, the callback chain doesn't recurse
+     * into the BSP */
+    submit(0);
+    submit(2);
+
+    checkOrder(bus.started, bus.nStarted, "012");
+    checkOrder(bus.done, bus.nDone, "012");
+    TEST_ASSERT_EQUAL_INT32(0, bus.doubleStarts);
+}
+
+void test_efHal_i2c_submit_startError(void)
+{
+    bus.startEc = EF_HAL_I2C_EC_NAK;
+    submit(0);
+    submit(1);
+
+    /* the first fails to start, the next one goes right away */
+    checkOrder(bus.done, bus.nDone, "0");
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NAK, xfers[0].ec);
+    checkOrder(bus.started, bus.nStarted, "01");
+
+    endOfTransfer(EF_HAL_I2C_EC_NO_ERROR);
+    checkOrder(bus.done, bus.nDone, "01");
+}
+
+void test_efHal_i2c_submit_invalidSeg(void)
+{
+    efHal_i2c_seg_t seg = {EF_HAL_I2C_DIR_WRITE, EF_HAL_I2C_SEG_FLAG_NO_START, NULL, 0};
+
+    xfers[0].pSeg = &seg;
+    xfers[0].nSeg = 1;
+
+    /* the first segment can't continue a previous one */
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_INVALID_PARAMS, efHal_i2c_submit(dh, &xfers[0], doneCB, NULL));
+    TEST_ASSERT_EQUAL_INT32(0, bus.nStarted);
+}
+
+void test_efHal_i2c_transfer_sync(void)
+{
+    uint8_t reg = 0;
+    efHal_i2c_seg_t seg[2] =
+    {
+        {EF_HAL_I2C_DIR_WRITE, 0, &reg, 1},
+        {EF_HAL_I2C_DIR_READ, 0, &reg, 1},
+    };
+
+    bus.sync = true;
+
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NO_ERROR, efHal_i2c_transfer(dh, 0x11, &reg, 1, &reg, 1));
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NO_ERROR, efHal_i2c_transferSeg(dh, 0x12, seg, 2));
+    checkOrder(bus.started, bus.nStarted, "12");
+
+    /* without a segment callback */
+    efHal_internal_i2c_setTransferSeg(dh, NULL);
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_TRANSFER_UNSUPPORTED, efHal_i2c_transferSeg(dh, 0x12, seg, 2));
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,327 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "unity.h"
+#include "efHal.h"
+#include "efHal_spi.h"
+#include "efHal_internal.h"
+#include "freertos_fake.h"
+#include "task.h"
+#include "stdio.h"
+#include "string.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define PIN_CS          3
+#define PIN_CS2         4
+#define PIN_DC          5
+
+#define BUS_CLOCK       1000000
+#define DEV_CLOCK       4000000
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static efHal_dh_t dh;
+
+/* everything the fake controller and GPIO see, in order */
+static char busLog[512];
+
+/* transfers end when the test calls efHal_internal_spi_endOfTransfer */
+static bool asyncXfer;
+
+/* efHal_spi_transaction issued from txnTask */
+static efHal_spi_seg_t const *txnSeg;
+static int32_t txnNSeg;
+static bool volatile txnDone;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+static void logEvent(char const *fmt, int32_t a, int32_t b)
+{
+    size_t len = strlen(busLog);
+
+    snprintf(&busLog[len], sizeof(busLog) - len, fmt, a, b);
+}
+
+static void gpio_setPin(efHal_gpio_id_t id, bool state)
+{
+    logEvent("pin%d=%d ", id, state);
+}
+
+static void gpio_confPin(efHal_gpio_id_t id, efHal_gpio_dir_t dir, efHal_gpio_pull_t pull, bool state)
+{
+}
+
+static void spi_conf(void *param, int32_t clockFrec, efHal_spi_mode_t mode)
+{
+    logEvent("conf%d,%d ", clockFrec, mode);
+}
+
+static void spi_autoCs(void *param, bool enable)
+{
+    logEvent("auto%d ", enable, 0);
+}
+
+/* ends at once, as a transfer interrupt before the task waits */
+static void spi_transfer(void* param, void *pTx, void *pRx, size_t length)
+{
+    logEvent("xfer%d ", length, 0);
+
+    if (!asyncXfer)
+        efHal_internal_spi_endOfTransfer(dh);
+}
+
+static void txnTask(void *param)
+{
+    efHal_spi_transaction(dh, txnSeg, txnNSeg);
+    txnDone = true;
+    vTaskDelete(NULL);
+}
+
+static void regBus(bool autoCs)
+{
+    efHal_spi_callBacks_t cb;
+
+    cb.conf = spi_conf;
+    cb.transfer = spi_transfer;
+    cb.autoCs = autoCs ? spi_autoCs : NULL;
+
+    efHal_spi_init();
+    dh = efHal_internal_spi_deviceReg(cb, NULL);
+}
+
+/*==================[external functions definition]==========================*/
+
+void setUp(void)
+{
+    efHal_gpio_callBacks_t gpioCb = {0};
+
+    gpioCb.setPin = gpio_setPin;
+    gpioCb.confPin = gpio_confPin;
+    efHal_internal_gpio_setCallBacks(gpioCb);
+
+    regBus(true);
+    busLog[0] = 0;
+    asyncXfer = false;
+}
+
+void tearDown(void)
+{
+}
+
+void test_efHal_spi_config_cached(void)
+{
+    uint8_t buf[4];
+
+    efHal_spi_config(dh, BUS_CLOCK, EF_HAL_SPI_CPOL_0_CPHA_O);
+    efHal_spi_config(dh, BUS_CLOCK, EF_HAL_SPI_CPOL_0_CPHA_O);
+    efHal_spi_transfer(dh, buf, NULL, 4);
+    efHal_spi_transfer(dh, buf, NULL, 2);
+
+    /* the controller is written once, CS mode on the first transfer */
+    TEST_ASSERT_EQUAL_STRING("conf1000000,0 auto1 xfer4 xfer2 ", busLog);
+}
+
+void test_efHal_spi_dev_gpioCsOrder(void)
+{
+    efHal_spi_dev_t dev;
+    uint8_t buf[4];
+
+    efHal_spi_config(dh, BUS_CLOCK, EF_HAL_SPI_CPOL_0_CPHA_O);
+    efHal_spi_devInit(&dev, dh, DEV_CLOCK, EF_HAL_SPI_CPOL_1_CPHA_1, PIN_CS);
+    busLog[0] = 0;
+
+    efHal_spi_devTransfer(&dev, buf, NULL, 3);
+    efHal_spi_devTransfer(&dev, buf, NULL, 1);
+
+    /* the controller CS is released before the GPIO one is asserted */
+    TEST_ASSERT_EQUAL_STRING(
+            "conf4000000,3 auto0 pin3=0 xfer3 pin3=1 "
+            "pin3=0 xfer1 pin3=1 ", busLog);
+
+    busLog[0] = 0;
+    efHal_spi_transfer(dh, buf, NULL, 2);
+
+    /* bus level users get their configuration and the controller CS back */
+    TEST_ASSERT_EQUAL_STRING("conf1000000,0 auto1 xfer2 ", busLog);
+}
+
+void test_efHal_spi_dev_twoDevices(void)
+{
+    efHal_spi_dev_t dev1;
+    efHal_spi_dev_t dev2;
+    uint8_t buf[4];
+
+    efHal_spi_devInit(&dev1, dh, DEV_CLOCK, EF_HAL_SPI_CPOL_0_CPHA_O, PIN_CS);
+    efHal_spi_devInit(&dev2, dh, DEV_CLOCK, EF_HAL_SPI_CPOL_0_CPHA_O, PIN_CS2);
+
+    efHal_spi_devTransfer(&dev1, buf, NULL, 1);
+    busLog[0] = 0;
+    efHal_spi_devTransfer(&dev2, buf, NULL, 1);
+
+    /* same configuration, nothing written to the controller */
+    TEST_ASSERT_EQUAL_STRING("pin4=0 xfer1 pin4=1 ", busLog);
+}
+
+void test_efHal_spi_dev_controllerCs(void)
+{
+    efHal_spi_dev_t dev1;
+    efHal_spi_dev_t dev2;
+    uint8_t buf[4];
+
+    efHal_spi_devInit(&dev1, dh, DEV_CLOCK, EF_HAL_SPI_CPOL_0_CPHA_O, PIN_CS);
+    efHal_spi_devInit(&dev2, dh, DEV_CLOCK, EF_HAL_SPI_CPOL_0_CPHA_O, EF_HAL_INVALID_ID);
+
+    efHal_spi_devTransfer(&dev1, buf, NULL, 1);
+    busLog[0] = 0;
+    efHal_spi_devTransfer(&dev2, buf, NULL, 1);
+
+    /* a device without CS pin is selected by the controller */
+    TEST_ASSERT_EQUAL_STRING("auto1 xfer1 ", busLog);
+}
+
+void test_efHal_spi_dev_noAutoCs(void)
+{
+    efHal_spi_dev_t dev;
+    uint8_t buf[4];
+
+    regBus(false);
+    efHal_spi_devInit(&dev, dh, DEV_CLOCK, EF_HAL_SPI_CPOL_0_CPHA_O, PIN_CS);
+    busLog[0] = 0;
+
+    efHal_spi_devTransfer(&dev, buf, NULL, 1);
+    efHal_spi_transfer(dh, buf, NULL, 1);
+
+    TEST_ASSERT_EQUAL_STRING("conf4000000,0 pin3=0 xfer1 pin3=1 xfer1 ", busLog);
+}
+
+void test_efHal_spi_transaction_sequence(void)
+{
+    uint8_t buf[4];
+    efHal_spi_seg_t const seg[] =
+    {
+        {NULL, NULL, 0, PIN_CS2, false},
+        {buf, NULL, 2, PIN_DC, false},
+        {NULL, NULL, 0, PIN_CS, false},
+        {buf, NULL, 3, PIN_DC, true},
+        {buf, NULL, 4, EF_HAL_INVALID_ID, false},
+        {NULL, NULL, 0, PIN_CS, true},
+        {NULL, NULL, 0, PIN_CS2, true},
+    };
+
+    efHal_spi_transaction(dh, seg, sizeof(seg) / sizeof(seg[0]));
+
+    /* each GPIO right before its segment, CS only segments included */
+    TEST_ASSERT_EQUAL_STRING(
+            "auto1 pin4=0 pin5=0 xfer2 pin3=0 pin5=1 xfer3 xfer4 "
+            "pin3=1 pin4=1 ", busLog);
+}
+
+void test_efHal_spi_transaction_onlyGpio(void)
+{
+    efHal_spi_seg_t const seg[] =
+    {
+        {NULL, NULL, 0, PIN_CS, false},
+        {NULL, NULL, 0, EF_HAL_INVALID_ID, false},
+        {NULL, NULL, 0, PIN_CS, true},
+    };
+
+    /* nothing to clock out, returns without waiting */
+    efHal_spi_transaction(dh, seg, sizeof(seg) / sizeof(seg[0]));
+    efHal_spi_transaction(dh, seg, 0);
+
+    TEST_ASSERT_EQUAL_STRING("auto1 pin3=0 pin3=1 ", busLog);
+}
+
+void test_efHal_spi_transaction_chainedFromIsr(void)
+{
+    uint8_t buf[4];
+    efHal_spi_seg_t const seg[] =
+    {
+        {buf, NULL, 1, PIN_DC, false},
+        {NULL, NULL, 0, PIN_CS, false},
+        {buf, NULL, 2, PIN_DC, true},
+        {NULL, NULL, 0, PIN_CS, true},
+    };
+
+    asyncXfer = true;
+    txnSeg = seg;
+    txnNSeg = sizeof(seg) / sizeof(seg[0]);
+    txnDone = false;
+    xTaskCreate(txnTask, "txn", 0, NULL, 1, NULL);
+    freertos_fake_sleep(5);
+
+    TEST_ASSERT_EQUAL_STRING("auto1 pin5=0 xfer1 ", busLog);
+    TEST_ASSERT_FALSE(txnDone);
+
+    /* the next segment starts from the interrupt, the task keeps waiting */
+    efHal_internal_spi_endOfTransfer(dh);
+    freertos_fake_sleep(5);
+    TEST_ASSERT_EQUAL_STRING("auto1 pin5=0 xfer1 pin3=0 pin5=1 xfer2 ", busLog);
+    TEST_ASSERT_FALSE(txnDone);
+
+    efHal_internal_spi_endOfTransfer(dh);
+    freertos_fake_sleep(5);
+    TEST_ASSERT_EQUAL_STRING("auto1 pin5=0 xfer1 pin3=0 pin5=1 xfer2 pin3=1 ", busLog);
+    TEST_ASSERT_TRUE(txnDone);
+}
+
+void test_efHal_spi_dev_transaction(void)
+{
+    efHal_spi_dev_t dev;
+    uint8_t buf[4];
+    efHal_spi_seg_t const seg[] =
+    {
+        {buf, NULL, 1, PIN_DC, false},
+        {NULL, NULL, 0, PIN_DC, true},
+        {buf, NULL, 2, EF_HAL_INVALID_ID, false},
+    };
+
+    efHal_spi_devInit(&dev, dh, DEV_CLOCK, EF_HAL_SPI_CPOL_0_CPHA_O, PIN_CS);
+    busLog[0] = 0;
+
+    efHal_spi_devTransaction(&dev, seg, sizeof(seg) / sizeof(seg[0]));
+
+    /* the device CS is held around the whole transaction */
+    TEST_ASSERT_EQUAL_STRING(
+            "conf4000000,0 auto0 pin3=0 pin5=0 xfer1 pin5=1 xfer2 pin3=1 ", busLog);
+}
+
+/*==================[end of file]============================================*/
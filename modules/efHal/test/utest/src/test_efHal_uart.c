@@ -0,0 +1,847 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "unity.h"
+#include "efHal.h"
+#include "efHal_uart.h"
+#include "efHal_internal.h"
+#include "freertos_fake.h"
+#include "task.h"
+#include "queue.h"
+#include "stdio.h"
+#include "string.h"
+#include "time.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include "x86intrin.h"
+#endif
+
+/*==================[macros and typedef]=====================================*/
+
+#define RX_RING_LENGTH      64      /* EF_HAL_UART_RX_RING_LENGTH default */
+#define TX_RING_LENGTH      64      /* EF_HAL_UART_TX_RING_LENGTH default */
+#define TX_FIFO_LENGTH      16      /* bytes the fake UART takes per interrupt */
+
+#define BENCH_BYTES         (1024 * 1024)
+#define BENCH_SEND_LENGTH   256     /* bytes per efHal_uart_send call */
+
+typedef enum
+{
+    OP_RECV = 0,
+    OP_RECV_UNTIL,
+    OP_RECV_FRAME,
+    OP_RECV_BULK,
+}op_t;
+
+/* request served by rxTask, the test plays the role of the UART ISR */
+typedef struct
+{
+    op_t op;
+    uint8_t delim;
+    int32_t max;
+    TickType_t blockTime;
+    uint8_t buf[256];
+    int32_t ret;
+    bool volatile done;
+}rxReq_t;
+
+/* what the fake UART shifted out */
+typedef struct
+{
+    uint8_t buf[1024];
+    int32_t len;
+    uint32_t sum;
+    int32_t readyCalls;
+    bool drainOnReady;          /* transmit everything from dataReadyTx */
+    int32_t doneCalls;          /* efHal_uart_sendv callback */
+    void *doneCtx;
+    int32_t doneAtLen;          /* tx.len when the callback ran */
+}txWire_t;
+
+/* efHal_uart_sendv issued from sendvTask */
+typedef struct
+{
+    efHal_uart_iov_t const *iov;
+    int32_t n;
+    int32_t ret;
+    bool volatile done;
+}sendvReq_t;
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static efHal_dh_t dh;
+static TaskHandle_t rxTaskHandle;
+static rxReq_t rx;
+static txWire_t tx;
+static sendvReq_t sv;
+
+/* efHal_uart_send before the TX ring: one queue item per byte */
+static QueueHandle_t qSend;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+static void rxTask(void *param)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        switch (rx.op)
+        {
+            case OP_RECV:
+                rx.ret = efHal_uart_recv(dh, rx.buf, rx.max, rx.blockTime);
+                break;
+            case OP_RECV_UNTIL:
+                rx.ret = efHal_uart_recvUntil(dh, rx.delim, rx.buf, rx.max, rx.blockTime);
+                break;
+            case OP_RECV_FRAME:
+                rx.ret = efHal_uart_recvFrame(dh, rx.buf, rx.max, rx.blockTime);
+                break;
+            case OP_RECV_BULK:
+                rx.ret = efHal_uart_recvBulk(dh, rx.buf, rx.max, rx.blockTime);
+                break;
+        }
+
+        rx.done = true;
+    }
+}
+
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    /* no cycle counter: nanoseconds */
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+static void wireOut(uint8_t const *pData, int32_t size)
+{
+    int32_t i;
+
+    for (i = 0 ; i < size ; i++)
+    {
+        if (tx.len < (int32_t)sizeof(tx.buf))
+            tx.buf[tx.len] = pData[i];
+
+        tx.sum += pData[i];
+        tx.len++;
+    }
+}
+
+/* one TX interrupt: refills the FIFO with up to size bytes */
+static int32_t txIsr(int32_t size)
+{
+    uint8_t fifo[TX_FIFO_LENGTH];
+    int32_t ret;
+
+    ret = efHal_internal_uart_getDataForTxBulk(dh, fifo, size);
+    wireOut(fifo, ret);
+
+    return ret;
+}
+
+static void dataReadyTx(void *param)
+{
+    tx.readyCalls++;
+
+    if (tx.drainOnReady)
+    {
+        while (txIsr(TX_FIFO_LENGTH) != 0)
+        {
+        }
+    }
+}
+
+static int32_t queueGetDataForTx(uint8_t *pData)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    return xQueueReceiveFromISR(qSend, pData, &xHigherPriorityTaskWoken) == pdTRUE;
+}
+
+static int32_t queueSend(uint8_t const *pBuf, int32_t size)
+{
+    int32_t ret;
+    uint8_t data;
+
+    for (ret = 0 ; ret < size ; ret++)
+    {
+        /* the ISR empties the queue when it is full */
+        while (xQueueSend(qSend, &pBuf[ret], 0) != pdTRUE)
+        {
+            while (queueGetDataForTx(&data))
+                wireOut(&data, 1);
+        }
+    }
+
+    while (queueGetDataForTx(&data))
+        wireOut(&data, 1);
+
+    return ret;
+}
+
+static uint32_t bench(bool ring)
+{
+    uint8_t data[BENCH_SEND_LENGTH];
+    uint32_t sum = 0;
+    uint64_t start;
+    uint64_t elapsed;
+    int32_t sent = 0;
+    uint32_t i;
+
+    for (i = 0 ; i < sizeof(data) ; i++)
+    {
+        data[i] = i * 7;
+        sum += data[i];
+    }
+
+    tx.len = 0;
+    tx.sum = 0;
+    tx.drainOnReady = true;
+
+    start = cycles();
+
+    for (i = 0 ; i < BENCH_BYTES / BENCH_SEND_LENGTH ; i++)
+    {
+        if (ring)
+            sent += efHal_uart_send(dh, data, sizeof(data), portMAX_DELAY);
+        else
+            sent += queueSend(data, sizeof(data));
+    }
+
+    elapsed = cycles() - start;
+
+    TEST_ASSERT_EQUAL_INT32(BENCH_BYTES, sent);
+    TEST_ASSERT_EQUAL_INT32(BENCH_BYTES, tx.len);
+    TEST_ASSERT_EQUAL_UINT32(sum * (BENCH_BYTES / BENCH_SEND_LENGTH), tx.sum);
+
+    /* bytes per 1000 cycles */
+    return (uint64_t)BENCH_BYTES * 1000 / (elapsed ? elapsed : 1);
+}
+
+static void sendTask(void *param)
+{
+    uint8_t *pData = param;
+
+    efHal_uart_send(dh, pData, 200, portMAX_DELAY);
+    vTaskDelete(NULL);
+}
+
+static void txDone(efHal_dh_t dh, void *ctx)
+{
+    tx.doneCalls++;
+    tx.doneCtx = ctx;
+    tx.doneAtLen = tx.len;
+}
+
+static void sendvTask(void *param)
+{
+    sv.ret = efHal_uart_sendv(dh, sv.iov, sv.n, txDone, param);
+    sv.done = true;
+    vTaskDelete(NULL);
+}
+
+/* hands the request to rxTask and lets it block in the driver */
+static void startRx(op_t op, int32_t max, TickType_t blockTime)
+{
+    rx.op = op;
+    rx.delim = '\n';
+    rx.max = max;
+    rx.blockTime = blockTime;
+    rx.ret = 0x7fffffff;
+    rx.done = false;
+    memset(rx.buf, 0, sizeof(rx.buf));
+
+    xTaskNotifyGive(rxTaskHandle);
+    freertos_fake_sleep(5);
+}
+
+static void feed(void const *pData, int32_t size)
+{
+    uint8_t const *p = pData;
+    int32_t i;
+
+    for (i = 0 ; i < size ; i++)
+        efHal_internal_uart_putDataForRx(dh, (void *)&p[i]);
+}
+
+/*==================[external functions definition]==========================*/
+
+void setUp(void)
+{
+    efHal_uart_callBacks_t cb =
+    {
+        .conf = NULL,
+        .dataReadyTx = dataReadyTx,
+        .sendBuffer = NULL,
+    };
+
+    efHal_uart_init();
+    dh = efHal_internal_uart_deviceReg(cb, NULL);
+
+    memset(&tx, 0, sizeof(tx));
+
+    if (rxTaskHandle == NULL)
+        xTaskCreate(rxTask, "rx", 0, NULL, 1, &rxTaskHandle);
+}
+
+void tearDown(void)
+{
+}
+
+void test_efHal_uart_recvUntil_delimiter(void)
+{
+    startRx(OP_RECV_UNTIL, 32, portMAX_DELAY);
+
+    feed("abc", 3);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_FALSE(rx.done);
+
+    feed("\nxy", 3);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(4, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("abc\n", rx.buf, 4);
+
+    /* bytes after the delimiter stay for the next call */
+    startRx(OP_RECV, 8, 0);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(2, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("xy", rx.buf, 2);
+}
+
+void test_efHal_uart_recvUntil_wakesWhenMaxBuffered(void)
+{
+    startRx(OP_RECV_UNTIL, 5, portMAX_DELAY);
+
+    feed("abcd", 4);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_FALSE(rx.done);
+
+    feed("e", 1);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(5, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("abcde", rx.buf, 5);
+}
+
+void test_efHal_uart_recvUntil_longerThanRing(void)
+{
+    uint8_t data[RX_RING_LENGTH * 2 + 8];
+    uint32_t i;
+
+    for (i = 0 ; i < sizeof(data) ; i++)
+        data[i] = 'A' + i % 26;
+
+    startRx(OP_RECV_UNTIL, sizeof(data), portMAX_DELAY);
+
+    /* the task is woken with the ring full, the ISR must not overrun it */
+    for (i = 0 ; i < sizeof(data) ; i += 16)
+    {
+        feed(&data[i], sizeof(data) - i < 16 ? sizeof(data) - i : 16);
+        freertos_fake_sleep(5);
+    }
+
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(sizeof(data), rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY(data, rx.buf, sizeof(data));
+}
+
+void test_efHal_uart_recvUntil_timeout(void)
+{
+    startRx(OP_RECV_UNTIL, 32, 30);
+
+    feed("ab", 2);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_FALSE(rx.done);
+
+    freertos_fake_sleep(40);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(0, rx.ret);
+
+    /* the incomplete line is kept for the next call */
+    startRx(OP_RECV_UNTIL, 32, portMAX_DELAY);
+    feed("c\n", 2);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(4, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("abc\n", rx.buf, 4);
+}
+
+void test_efHal_uart_recvFrame(void)
+{
+    startRx(OP_RECV_FRAME, 32, portMAX_DELAY);
+
+    feed("\x03xy", 3);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_FALSE(rx.done);
+
+    feed("z\x01", 2);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(3, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("xyz", rx.buf, 3);
+
+    /* second frame already has its length buffered */
+    startRx(OP_RECV_FRAME, 32, portMAX_DELAY);
+    feed("w", 1);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(1, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("w", rx.buf, 1);
+}
+
+void test_efHal_uart_recvFrame_tooLong(void)
+{
+    startRx(OP_RECV_FRAME, 2, portMAX_DELAY);
+    feed("\x03" "xyz" "\x02" "ab", 7);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(EF_HAL_UART_FRAME_TOO_LONG, rx.ret);
+
+    /* the long frame is dropped as a whole */
+    startRx(OP_RECV_FRAME, 2, portMAX_DELAY);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(2, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("ab", rx.buf, 2);
+}
+
+void test_efHal_uart_recvFrame_timeout(void)
+{
+    /* nothing received */
+    startRx(OP_RECV_FRAME, 32, 20);
+    freertos_fake_sleep(30);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(0, rx.ret);
+
+    /* a frame that fits in the ring is not touched until complete */
+    startRx(OP_RECV_FRAME, 32, 20);
+    feed("\x05" "ab", 3);
+    freertos_fake_sleep(30);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(0, rx.ret);
+
+    startRx(OP_RECV_FRAME, 32, portMAX_DELAY);
+    feed("cde", 3);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(5, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("abcde", rx.buf, 5);
+}
+
+void test_efHal_uart_recvFrame_timeoutMidFrame(void)
+{
+    uint8_t data[1 + RX_RING_LENGTH + 36];
+    uint32_t i;
+
+    data[0] = sizeof(data) - 1;
+    for (i = 1 ; i < sizeof(data) ; i++)
+        data[i] = i;
+
+    /* longer than the ring: consumed while it arrives */
+    startRx(OP_RECV_FRAME, sizeof(rx.buf), 30);
+    feed(data, RX_RING_LENGTH);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_FALSE(rx.done);
+
+    freertos_fake_sleep(40);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(EF_HAL_UART_FRAME_TIMEOUT, rx.ret);
+
+    /* the tail arrives late: drop input until the line is quiet */
+    feed(&data[RX_RING_LENGTH], sizeof(data) - RX_RING_LENGTH);
+    do
+    {
+        startRx(OP_RECV, sizeof(rx.buf), 10);
+        freertos_fake_sleep(15);
+        TEST_ASSERT_TRUE(rx.done);
+    }while (rx.ret != 0);
+
+    startRx(OP_RECV_FRAME, sizeof(rx.buf), portMAX_DELAY);
+    feed("\x02" "ok", 3);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(2, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("ok", rx.buf, 2);
+}
+
+void test_efHal_uart_recvBulk_threshold(void)
+{
+    efHal_uart_setRxThreshold(dh, 8);
+    startRx(OP_RECV_BULK, 32, portMAX_DELAY);
+
+    feed("abcdefg", 7);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_FALSE(rx.done);
+
+    feed("h", 1);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(8, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("abcdefgh", rx.buf, 8);
+
+    /* a smaller buffer lowers the wake level */
+    startRx(OP_RECV_BULK, 3, portMAX_DELAY);
+    feed("ijk", 3);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(3, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("ijk", rx.buf, 3);
+}
+
+void test_efHal_uart_setRxThreshold_invalid(void)
+{
+    efHal_uart_setRxThreshold(dh, 4);
+    efHal_uart_setRxThreshold(dh, 0);
+    efHal_uart_setRxThreshold(dh, RX_RING_LENGTH + 1);
+
+    /* the last valid threshold is kept */
+    startRx(OP_RECV_BULK, 32, portMAX_DELAY);
+    feed("abc", 3);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_FALSE(rx.done);
+
+    feed("d", 1);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(4, rx.ret);
+}
+
+void test_efHal_uart_recvBulk_idleWake(void)
+{
+    efHal_uart_setRxThreshold(dh, 16);
+    startRx(OP_RECV_BULK, 32, portMAX_DELAY);
+
+    feed("abc", 3);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_FALSE(rx.done);
+
+    efHal_internal_uart_rxIdle(dh);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(3, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("abc", rx.buf, 3);
+}
+
+void test_efHal_uart_recvBulk_idleLatched(void)
+{
+    efHal_uart_setRxThreshold(dh, 16);
+
+    /* the burst ends before anyone reads */
+    feed("abc", 3);
+    efHal_internal_uart_rxIdle(dh);
+
+    startRx(OP_RECV_BULK, 32, portMAX_DELAY);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(3, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("abc", rx.buf, 3);
+
+    /* idle with the ring empty doesn't wake, new bytes clear it */
+    efHal_internal_uart_rxIdle(dh);
+    startRx(OP_RECV_BULK, 32, portMAX_DELAY);
+    feed("de", 2);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_FALSE(rx.done);
+
+    efHal_internal_uart_rxIdle(dh);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(2, rx.ret);
+    TEST_ASSERT_EQUAL_MEMORY("de", rx.buf, 2);
+}
+
+void test_efHal_uart_recvBulk_timeout(void)
+{
+    efHal_uart_setRxThreshold(dh, 16);
+    startRx(OP_RECV_BULK, 32, 20);
+
+    feed("a", 1);
+    freertos_fake_sleep(10);
+    TEST_ASSERT_FALSE(rx.done);
+
+    /* what arrived is returned at the timeout */
+    freertos_fake_sleep(30);
+    TEST_ASSERT_TRUE(rx.done);
+    TEST_ASSERT_EQUAL_INT32(1, rx.ret);
+}
+
+void test_efHal_uart_send_ringWrapAround(void)
+{
+    uint8_t data[sizeof(tx.buf)];
+    int32_t sizes[] = {44, 30, 43, 44, 1, 17, 44, 40, 33};
+    int32_t pos = 0;
+    uint32_t i;
+
+    for (i = 0 ; i < sizeof(data) ; i++)
+        data[i] = i * 13 + 5;
+
+    /* odd sizes on both sides move head and tail across the end of the
+     * buffer at different places, the ring never runs dry */
+    for (i = 0 ; i < sizeof(sizes) / sizeof(sizes[0]) ; i++)
+    {
+        TEST_ASSERT_EQUAL_INT32(sizes[i], efHal_uart_send(dh, &data[pos], sizes[i], 0));
+        pos += sizes[i];
+
+        while (pos - tx.len > TX_RING_LENGTH - 44)
+            txIsr(i % 2 ? 7 : 5);
+    }
+
+    TEST_ASSERT_EQUAL_INT32(1, tx.readyCalls);
+
+    while (txIsr(3) != 0)
+    {
+    }
+
+    TEST_ASSERT_EQUAL_INT32(pos, tx.len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, tx.buf, pos);
+
+    /* once drained the next send starts the transmission again */
+    TEST_ASSERT_EQUAL_INT32(2, efHal_uart_send(dh, data, 2, 0));
+    TEST_ASSERT_EQUAL_INT32(2, tx.readyCalls);
+}
+
+void test_efHal_uart_send_waitsForRoom(void)
+{
+    static uint8_t data[200];
+    uint32_t i;
+
+    for (i = 0 ; i < sizeof(data) ; i++)
+        data[i] = i;
+
+    xTaskCreate(sendTask, "tx", 0, data, 1, NULL);
+    freertos_fake_sleep(5);
+
+    /* the sender filled the ring and sleeps until the ISR makes room */
+    TEST_ASSERT_EQUAL_INT32(1, tx.readyCalls);
+    TEST_ASSERT_EQUAL_INT32(0, tx.len);
+
+    while (tx.len < (int32_t)sizeof(data))
+    {
+        TEST_ASSERT_NOT_EQUAL(0, txIsr(TX_FIFO_LENGTH));
+        freertos_fake_sleep(1);
+    }
+
+    TEST_ASSERT_EQUAL_INT32(0, txIsr(TX_FIFO_LENGTH));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, tx.buf, sizeof(data));
+}
+
+void test_efHal_uart_sendv_segmentsInOrder(void)
+{
+    static uint8_t a[5], b[11], c[7];
+    static efHal_uart_iov_t const iov[] =
+    {
+        {a, sizeof(a)},
+        {NULL, 0},
+        {b, sizeof(b)},
+        {c, sizeof(c)},
+        {NULL, 0},
+        {NULL, 0},
+    };
+    uint8_t expected[sizeof(a) + sizeof(b) + sizeof(c)];
+    uint32_t i;
+
+    for (i = 0 ; i < sizeof(expected) ; i++)
+        expected[i] = i + 1;
+
+    memcpy(a, expected, sizeof(a));
+    memcpy(b, &expected[sizeof(a)], sizeof(b));
+    memcpy(c, &expected[sizeof(a) + sizeof(b)], sizeof(c));
+
+    TEST_ASSERT_EQUAL_INT32(sizeof(expected),
+            efHal_uart_sendv(dh, iov, sizeof(iov) / sizeof(iov[0]), txDone, &tx));
+    TEST_ASSERT_EQUAL_INT32(1, tx.readyCalls);
+
+    /* 4 bytes chunks split every segment, a TC before the end is ignored */
+    while (txIsr(4) != 0)
+    {
+        efHal_internal_uart_txComplete(dh);
+        if (tx.len < (int32_t)sizeof(expected))
+            TEST_ASSERT_EQUAL_INT32(0, tx.doneCalls);
+    }
+
+    TEST_ASSERT_EQUAL_INT32(sizeof(expected), tx.len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, tx.buf, sizeof(expected));
+    TEST_ASSERT_EQUAL_INT32(1, tx.doneCalls);
+    TEST_ASSERT_EQUAL_PTR(&tx, tx.doneCtx);
+
+    efHal_internal_uart_txComplete(dh);
+    TEST_ASSERT_EQUAL_INT32(1, tx.doneCalls);
+}
+
+void test_efHal_uart_sendv_doneAfterTc(void)
+{
+    static uint8_t const data[] = "0123456789";
+    static efHal_uart_iov_t const iov[] =
+    {
+        {data, 4},
+        {&data[4], 6},
+        {NULL, 0},
+    };
+
+    TEST_ASSERT_EQUAL_INT32(10, efHal_uart_sendv(dh, iov, 3, txDone, NULL));
+
+    /* the last byte is in the FIFO but not on the wire yet */
+    TEST_ASSERT_EQUAL_INT32(10, txIsr(TX_FIFO_LENGTH));
+    TEST_ASSERT_EQUAL_INT32(0, txIsr(TX_FIFO_LENGTH));
+    TEST_ASSERT_EQUAL_INT32(0, tx.doneCalls);
+
+    efHal_internal_uart_txComplete(dh);
+    TEST_ASSERT_EQUAL_INT32(1, tx.doneCalls);
+    TEST_ASSERT_EQUAL_INT32(10, tx.doneAtLen);
+    TEST_ASSERT_EQUAL_MEMORY(data, tx.buf, 10);
+}
+
+void test_efHal_uart_sendv_empty(void)
+{
+    static efHal_uart_iov_t const iov[] =
+    {
+        {NULL, 0},
+        {NULL, 0},
+    };
+
+    /* nothing to send: done at once and the UART isn't started */
+    TEST_ASSERT_EQUAL_INT32(0, efHal_uart_sendv(dh, iov, 2, txDone, NULL));
+    TEST_ASSERT_EQUAL_INT32(1, tx.doneCalls);
+
+    TEST_ASSERT_EQUAL_INT32(0, efHal_uart_sendv(dh, iov, 0, txDone, NULL));
+    TEST_ASSERT_EQUAL_INT32(2, tx.doneCalls);
+    TEST_ASSERT_EQUAL_INT32(0, tx.readyCalls);
+
+    efHal_internal_uart_txComplete(dh);
+    TEST_ASSERT_EQUAL_INT32(2, tx.doneCalls);
+
+    /* the next transfer starts normally */
+    TEST_ASSERT_EQUAL_INT32(3, efHal_uart_send(dh, "abc", 3, 0));
+    TEST_ASSERT_EQUAL_INT32(1, tx.readyCalls);
+    TEST_ASSERT_EQUAL_INT32(3, txIsr(TX_FIFO_LENGTH));
+}
+
+void test_efHal_uart_sendv_waitsForPrevious(void)
+{
+    static uint8_t const first[] = "first";
+    static uint8_t const second[] = "second";
+    static efHal_uart_iov_t const iov1[] = {{first, 5}};
+    static efHal_uart_iov_t const iov2[] = {{second, 6}};
+
+    TEST_ASSERT_EQUAL_INT32(5, efHal_uart_sendv(dh, iov1, 1, txDone, NULL));
+
+    sv.iov = iov2;
+    sv.n = 1;
+    sv.done = false;
+    xTaskCreate(sendvTask, "sendv", 0, NULL, 1, NULL);
+    freertos_fake_sleep(5);
+    TEST_ASSERT_FALSE(sv.done);
+
+    /* the first transfer is out of the FIFO but not of the shift register */
+    TEST_ASSERT_EQUAL_INT32(5, txIsr(TX_FIFO_LENGTH));
+    TEST_ASSERT_EQUAL_INT32(0, txIsr(TX_FIFO_LENGTH));
+    freertos_fake_sleep(5);
+    TEST_ASSERT_FALSE(sv.done);
+    TEST_ASSERT_EQUAL_INT32(1, tx.readyCalls);
+
+    efHal_internal_uart_txComplete(dh);
+    freertos_fake_sleep(5);
+    TEST_ASSERT_TRUE(sv.done);
+    TEST_ASSERT_EQUAL_INT32(6, sv.ret);
+    TEST_ASSERT_EQUAL_INT32(1, tx.doneCalls);
+    TEST_ASSERT_EQUAL_INT32(2, tx.readyCalls);
+
+    TEST_ASSERT_EQUAL_INT32(6, txIsr(TX_FIFO_LENGTH));
+    efHal_internal_uart_txComplete(dh);
+    TEST_ASSERT_EQUAL_INT32(2, tx.doneCalls);
+    TEST_ASSERT_EQUAL_INT32(11, tx.len);
+    TEST_ASSERT_EQUAL_MEMORY("firstsecond", tx.buf, 11);
+}
+
+void test_efHal_uart_sendv_waitsForRing(void)
+{
+    static uint8_t const data[] = "vec";
+    static efHal_uart_iov_t const iov[] = {{data, 3}};
+
+    /* bytes queued by efHal_uart_send go out first */
+    TEST_ASSERT_EQUAL_INT32(4, efHal_uart_send(dh, "ring", 4, 0));
+
+    sv.iov = iov;
+    sv.n = 1;
+    sv.done = false;
+    xTaskCreate(sendvTask, "sendv", 0, NULL, 1, NULL);
+    freertos_fake_sleep(5);
+    TEST_ASSERT_FALSE(sv.done);
+
+    txIsr(2);
+    freertos_fake_sleep(5);
+    TEST_ASSERT_FALSE(sv.done);
+
+    txIsr(2);
+    freertos_fake_sleep(5);
+    TEST_ASSERT_TRUE(sv.done);
+
+    while (txIsr(TX_FIFO_LENGTH) != 0)
+    {
+    }
+    efHal_internal_uart_txComplete(dh);
+
+    TEST_ASSERT_EQUAL_INT32(1, tx.doneCalls);
+    TEST_ASSERT_EQUAL_INT32(7, tx.len);
+    TEST_ASSERT_EQUAL_MEMORY("ringvec", tx.buf, 7);
+}
+
+void test_efHal_uart_send_bench(void)
+{
+    uint32_t queue;
+    uint32_t ring;
+
+    qSend = xQueueCreate(TX_RING_LENGTH, sizeof(uint8_t));
+
+    queue = bench(false);
+    ring = bench(true);
+
+    printf("efHal_uart_send: queue %lu, ring %lu bytes per 1000 cycles\n",
+            (unsigned long)queue, (unsigned long)ring);
+
+    vQueueDelete(qSend);
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,156 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+#ifndef EF_LINK_H_
+#define EF_LINK_H_
+
+/*==================[inclusions]=============================================*/
+#include "efHal_uart.h"
+#include "stdbool.h"
+
+#if __has_include("efLink_config.h")
+    #include "efLink_config.h"
+#endif
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros and typedef]=====================================*/
+
+#ifndef EF_LINK_TOTAL
+#define EF_LINK_TOTAL           1
+#endif
+
+#ifndef EF_LINK_MTU
+#define EF_LINK_MTU             128     /* max payload per packet */
+#endif
+
+#ifndef EF_LINK_POOL_SIZE
+#define EF_LINK_POOL_SIZE       4       /* RX packets shared by all links */
+#endif
+
+#ifndef EF_LINK_ACK_TIMEOUT
+#define EF_LINK_ACK_TIMEOUT     pdMS_TO_TICKS(50)
+#endif
+
+#ifndef EF_LINK_RETRIES
+#define EF_LINK_RETRIES         3
+#endif
+
+#ifndef EF_LINK_TASK_STACK
+#define EF_LINK_TASK_STACK      150
+#endif
+
+#ifndef EF_LINK_TASK_PRIORITY
+#define EF_LINK_TASK_PRIORITY   (configMAX_PRIORITIES - 1)
+#endif
+
+/* ctrl + seq before the payload, up to 4 bytes of CRC after it */
+#define EF_LINK_HEADER_LENGTH   2
+#define EF_LINK_FRAME_LENGTH    (EF_LINK_HEADER_LENGTH + EF_LINK_MTU + 4)
+
+typedef void* efLink_t;
+
+typedef enum
+{
+    EF_LINK_CRC_16 = 0,
+    EF_LINK_CRC_32,
+}efLink_crc_t;
+
+typedef struct
+{
+    efHal_dh_t uart;
+    efLink_crc_t crc;
+    bool reliable;                  /* sequence numbers with ACK/retransmit */
+}efLink_conf_t;
+
+typedef struct efLink_pkt_s
+{
+    struct efLink_pkt_s *next;
+    uint8_t *pData;                 /* payload */
+    int32_t size;                   /* payload length */
+    uint8_t frame[EF_LINK_FRAME_LENGTH];
+}efLink_pkt_t;
+
+typedef struct
+{
+    uint32_t txPackets;
+    uint32_t rxPackets;
+    uint32_t retries;
+    uint32_t crcErrors;
+    uint32_t framingErrors;
+    uint32_t drops;                 /* no free packet or full RX queue */
+    uint32_t duplicates;
+}efLink_stats_t;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+
+/** \brief initializes the packet pool, call before efLink_open */
+extern void efLink_init(void);
+
+/** \brief opens a link over an already configured UART
+ **
+ ** Creates the task that decodes the incoming frames.
+ **
+ ** \return link handle, NULL if there are no free links
+ **/
+extern efLink_t efLink_open(efLink_conf_t const *conf);
+
+/** \brief sends a packet, the payload is encoded straight from pData
+ **
+ ** \return true when sent (and acknowledged on reliable links)
+ **/
+extern bool efLink_send(efLink_t link, void const *pData, int32_t size, TickType_t blockTime);
+
+/** \brief waits for a packet, must be given back with efLink_release
+ **
+ ** \return received packet, NULL on timeout
+ **/
+extern efLink_pkt_t* efLink_recv(efLink_t link, TickType_t blockTime);
+
+extern void efLink_release(efLink_pkt_t *pkt);
+
+extern void efLink_getStats(efLink_t link, efLink_stats_t *pStats);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+/*==================[end of file]============================================*/
+#endif /* EF_LINK_H_ */
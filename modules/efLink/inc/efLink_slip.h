@@ -0,0 +1,103 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+#ifndef EF_LINK_SLIP_H_
+#define EF_LINK_SLIP_H_
+
+/*==================[inclusions]=============================================*/
+#include "stdint.h"
+#include "stdbool.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros and typedef]=====================================*/
+
+#define EF_LINK_SLIP_END        0xC0
+#define EF_LINK_SLIP_ESC        0xDB
+#define EF_LINK_SLIP_ESC_END    0xDC
+#define EF_LINK_SLIP_ESC_ESC    0xDD
+
+/** \brief sink of encoded bytes */
+typedef void (*efLink_write_t)(void *ctx, void const *pData, int32_t size);
+
+typedef enum
+{
+    EF_LINK_SLIP_ST_MORE = 0,       /* all input consumed, frame not ended */
+    EF_LINK_SLIP_ST_FRAME,          /* frame of dec->len bytes in dec->pBuf */
+    EF_LINK_SLIP_ST_ERROR,          /* frame too long or bad escape, dropped */
+}efLink_slipSt_t;
+
+typedef struct
+{
+    uint8_t *pBuf;
+    int32_t size;
+    int32_t len;
+    bool esc;
+    bool error;
+}efLink_slipDec_t;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+
+/** \brief encodes size bytes, unescaped runs are written straight from pData.
+ ** Can be called several times to build one frame from pieces.
+ **/
+extern void efLink_slip_encode(void const *pData, int32_t size, efLink_write_t write, void *ctx);
+
+/** \brief writes the END byte */
+extern void efLink_slip_end(efLink_write_t write, void *ctx);
+
+/** \brief sets the buffer where the next frame is decoded */
+extern void efLink_slip_decReset(efLink_slipDec_t *dec, uint8_t *pBuf, int32_t size);
+
+/** \brief decodes until input is consumed or a frame ends
+ **
+ ** \param[out] pUsed bytes consumed from pData
+ ** \return EF_LINK_SLIP_ST_FRAME when a frame is complete, efLink_slip_decReset
+ **         must be called before decoding more data
+ **/
+extern efLink_slipSt_t efLink_slip_decode(efLink_slipDec_t *dec, uint8_t const *pData,
+        int32_t size, int32_t *pUsed);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+/*==================[end of file]============================================*/
+#endif /* EF_LINK_SLIP_H_ */
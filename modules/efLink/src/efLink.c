@@ -0,0 +1,412 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "efLink.h"
+#include "efLink_crc.h"
+#include "efLink_slip.h"
+#include "efErrorHdl.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "string.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define CTRL_DATA           0x01
+#define CTRL_ACK            0x02
+#define CTRL_REL            0x04    /* sender waits for ACK */
+
+#define RX_CHUNK_LENGTH     16
+
+typedef struct
+{
+    bool used;
+    efLink_conf_t conf;
+    SemaphoreHandle_t sendMutex;    /* one packet (and its retries) at a time */
+    SemaphoreHandle_t frameMutex;   /* bytes of one frame kept together */
+    QueueHandle_t rxQueue;
+    TaskHandle_t volatile ackTask;
+    bool volatile acked;
+    uint8_t txSeq;
+    uint8_t rxSeq;
+    bool rxSeqValid;
+    efLink_slipDec_t dec;
+    efLink_pkt_t *rxPkt;
+    efLink_stats_t stats;
+}link_t;
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static link_t links[EF_LINK_TOTAL];
+
+static efLink_pkt_t pool[EF_LINK_POOL_SIZE];
+static efLink_pkt_t *freeList;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+static efLink_pkt_t* allocPkt(void)
+{
+    efLink_pkt_t *ret;
+
+    taskENTER_CRITICAL();
+
+    ret = freeList;
+    if (ret != NULL)
+        freeList = ret->next;
+
+    taskEXIT_CRITICAL();
+
+    return ret;
+}
+
+static int32_t crcLength(link_t const *link)
+{
+    return link->conf.crc == EF_LINK_CRC_32 ? 4 : 2;
+}
+
+static void uartWrite(void *ctx, void const *pData, int32_t size)
+{
+    efHal_uart_send(ctx, (void *)pData, size, portMAX_DELAY);
+}
+
+static void sendFrame(link_t *link, uint8_t ctrl, uint8_t seq, void const *pData, int32_t size)
+{
+    uint8_t hdr[EF_LINK_HEADER_LENGTH] = {ctrl, seq};
+    uint8_t crc[4];
+    uint32_t crcVal;
+
+    if (link->conf.crc == EF_LINK_CRC_32)
+    {
+        crcVal = efLink_crc32_update(EF_LINK_CRC32_INIT, hdr, sizeof(hdr));
+        crcVal = efLink_crc32_update(crcVal, pData, size) ^ EF_LINK_CRC32_XOROUT;
+    }
+    else
+    {
+        crcVal = efLink_crc16_update(EF_LINK_CRC16_INIT, hdr, sizeof(hdr));
+        crcVal = efLink_crc16_update(crcVal, pData, size) ^ EF_LINK_CRC16_XOROUT;
+    }
+
+    crc[0] = crcVal;
+    crc[1] = crcVal >> 8;
+    crc[2] = crcVal >> 16;
+    crc[3] = crcVal >> 24;
+
+    xSemaphoreTake(link->frameMutex, portMAX_DELAY);
+
+    /* leading END flushes any noise the receiver got between frames */
+    efLink_slip_end(uartWrite, link->conf.uart);
+    efLink_slip_encode(hdr, sizeof(hdr), uartWrite, link->conf.uart);
+    efLink_slip_encode(pData, size, uartWrite, link->conf.uart);
+    efLink_slip_encode(crc, crcLength(link), uartWrite, link->conf.uart);
+    efLink_slip_end(uartWrite, link->conf.uart);
+
+    xSemaphoreGive(link->frameMutex);
+}
+
+static bool checkCrc(link_t const *link, uint8_t const *pFrame, int32_t len)
+{
+    uint32_t crcVal;
+    uint32_t rxCrc;
+
+    if (link->conf.crc == EF_LINK_CRC_32)
+    {
+        len -= 4;
+        crcVal = efLink_crc32(pFrame, len);
+        rxCrc = pFrame[len] | ((uint32_t)pFrame[len + 1] << 8) |
+                ((uint32_t)pFrame[len + 2] << 16) | ((uint32_t)pFrame[len + 3] << 24);
+    }
+    else
+    {
+        len -= 2;
+        crcVal = efLink_crc16(pFrame, len);
+        rxCrc = pFrame[len] | ((uint32_t)pFrame[len + 1] << 8);
+    }
+
+    return crcVal == rxCrc;
+}
+
+/* returns true if the packet was handed to the application */
+static bool processFrame(link_t *link, efLink_pkt_t *pkt, int32_t len)
+{
+    uint8_t ctrl = pkt->frame[0];
+    uint8_t seq = pkt->frame[1];
+    bool ret = false;
+
+    if (len < EF_LINK_HEADER_LENGTH + crcLength(link) ||
+        !checkCrc(link, pkt->frame, len))
+    {
+        link->stats.crcErrors++;
+    }
+    else if (ctrl & CTRL_ACK)
+    {
+        if (seq == link->txSeq && link->ackTask != NULL)
+        {
+            link->acked = true;
+            xTaskNotifyGive(link->ackTask);
+        }
+    }
+    else if (ctrl & CTRL_DATA)
+    {
+        if (ctrl & CTRL_REL)
+            sendFrame(link, CTRL_ACK, seq, NULL, 0);
+
+        if ((ctrl & CTRL_REL) && link->rxSeqValid && seq == link->rxSeq)
+        {
+            /* our ACK got lost and the sender retransmitted */
+            link->stats.duplicates++;
+        }
+        else
+        {
+            link->rxSeq = seq;
+            link->rxSeqValid = true;
+
+            pkt->pData = &pkt->frame[EF_LINK_HEADER_LENGTH];
+            pkt->size = len - EF_LINK_HEADER_LENGTH - crcLength(link);
+
+            if (xQueueSend(link->rxQueue, &pkt, 0) == pdTRUE)
+            {
+                link->stats.rxPackets++;
+                ret = true;
+            }
+            else
+                link->stats.drops++;
+        }
+    }
+
+    return ret;
+}
+
+static void armDecoder(link_t *link)
+{
+    if (link->rxPkt == NULL)
+        link->rxPkt = allocPkt();
+
+    if (link->rxPkt != NULL)
+        efLink_slip_decReset(&link->dec, link->rxPkt->frame, EF_LINK_FRAME_LENGTH);
+    else
+        efLink_slip_decReset(&link->dec, NULL, 0);  /* frame will be dropped */
+}
+
+static void rxTask(void *pvParameters)
+{
+    link_t *link = pvParameters;
+    uint8_t chunk[RX_CHUNK_LENGTH];
+    efLink_slipSt_t st;
+    int32_t size;
+    int32_t pos;
+    int32_t used;
+
+    armDecoder(link);
+
+    for (;;)
+    {
+        size = efHal_uart_recvBulk(link->conf.uart, chunk, sizeof(chunk), portMAX_DELAY);
+
+        for (pos = 0 ; pos < size ; pos += used)
+        {
+            /* a packet released while the pool was empty is taken before
+             * the next frame starts, not after dropping it */
+            if (link->rxPkt == NULL && !link->dec.error && !link->dec.esc)
+                armDecoder(link);
+
+            /* decoded bytes go straight into the pool packet */
+            st = efLink_slip_decode(&link->dec, &chunk[pos], size - pos, &used);
+
+            if (st == EF_LINK_SLIP_ST_FRAME)
+            {
+                if (processFrame(link, link->rxPkt, link->dec.len))
+                    link->rxPkt = NULL;
+
+                armDecoder(link);
+            }
+            else if (st == EF_LINK_SLIP_ST_ERROR)
+            {
+                if (link->rxPkt != NULL)
+                    link->stats.framingErrors++;
+                else
+                    link->stats.drops++;
+
+                armDecoder(link);
+            }
+        }
+    }
+}
+
+/*==================[external functions definition]==========================*/
+
+extern void efLink_init(void)
+{
+    int i;
+
+    freeList = NULL;
+
+    for (i = 0 ; i < EF_LINK_POOL_SIZE ; i++)
+    {
+        pool[i].next = freeList;
+        freeList = &pool[i];
+    }
+
+    for (i = 0 ; i < EF_LINK_TOTAL ; i++)
+        links[i].used = false;
+}
+
+extern efLink_t efLink_open(efLink_conf_t const *conf)
+{
+    link_t *link = NULL;
+    int i;
+
+    taskENTER_CRITICAL();
+
+    for (i = 0 ; i < EF_LINK_TOTAL && link == NULL ; i++)
+    {
+        if (!links[i].used)
+        {
+            link = &links[i];
+            link->used = true;
+        }
+    }
+
+    taskEXIT_CRITICAL();
+
+    if (link == NULL)
+    {
+        efErrorHdl_error(EF_ERROR_HDL_NO_FREE_SLOT, "efLink");
+    }
+    else
+    {
+        link->conf = *conf;
+        link->sendMutex = xSemaphoreCreateMutex();
+        link->frameMutex = xSemaphoreCreateMutex();
+        link->rxQueue = xQueueCreate(EF_LINK_POOL_SIZE, sizeof(efLink_pkt_t *));
+        link->ackTask = NULL;
+        link->acked = false;
+        link->txSeq = 0;
+        link->rxSeqValid = false;
+        link->rxPkt = NULL;
+        memset(&link->stats, 0, sizeof(link->stats));
+
+        if (link->sendMutex == NULL || link->frameMutex == NULL || link->rxQueue == NULL)
+            efErrorHdl_error(EF_ERROR_HDL_NULL_POINTER, "efLink");
+
+        xTaskCreate(rxTask, "efLink", EF_LINK_TASK_STACK, link, EF_LINK_TASK_PRIORITY, NULL);
+    }
+
+    return link;
+}
+
+extern bool efLink_send(efLink_t link, void const *pData, int32_t size, TickType_t blockTime)
+{
+    link_t *pLink = link;
+    uint8_t ctrl = CTRL_DATA;
+    bool ret = false;
+    int retry;
+
+    if (size < 0 || size > EF_LINK_MTU)
+    {
+        efErrorHdl_error(EF_ERROR_HDL_INVALID_PARAMETER, "size");
+    }
+    else if (xSemaphoreTake(pLink->sendMutex, blockTime) == pdTRUE)
+    {
+        pLink->txSeq++;
+
+        if (!pLink->conf.reliable)
+        {
+            sendFrame(pLink, ctrl, pLink->txSeq, pData, size);
+            ret = true;
+        }
+        else
+        {
+            ctrl |= CTRL_REL;
+
+            for (retry = 0 ; retry <= EF_LINK_RETRIES && !ret ; retry++)
+            {
+                if (retry)
+                    pLink->stats.retries++;
+
+                xTaskNotifyStateClear(NULL);
+                pLink->acked = false;
+                pLink->ackTask = xTaskGetCurrentTaskHandle();
+
+                sendFrame(pLink, ctrl, pLink->txSeq, pData, size);
+
+                if (ulTaskNotifyTake(pdTRUE, EF_LINK_ACK_TIMEOUT) && pLink->acked)
+                    ret = true;
+            }
+
+            pLink->ackTask = NULL;
+        }
+
+        if (ret)
+            pLink->stats.txPackets++;
+
+        xSemaphoreGive(pLink->sendMutex);
+    }
+
+    return ret;
+}
+
+extern efLink_pkt_t* efLink_recv(efLink_t link, TickType_t blockTime)
+{
+    link_t *pLink = link;
+    efLink_pkt_t *ret = NULL;
+
+    xQueueReceive(pLink->rxQueue, &ret, blockTime);
+
+    return ret;
+}
+
+extern void efLink_release(efLink_pkt_t *pkt)
+{
+    taskENTER_CRITICAL();
+
+    pkt->next = freeList;
+    freeList = pkt;
+
+    taskEXIT_CRITICAL();
+}
+
+extern void efLink_getStats(efLink_t link, efLink_stats_t *pStats)
+{
+    link_t *pLink = link;
+
+    *pStats = pLink->stats;
+}
+
+/*==================[end of file]============================================*/
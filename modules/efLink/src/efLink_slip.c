@@ -0,0 +1,156 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "efLink_slip.h"
+
+/*==================[macros and typedef]=====================================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static const uint8_t escEnd[2] = {EF_LINK_SLIP_ESC, EF_LINK_SLIP_ESC_END};
+static const uint8_t escEsc[2] = {EF_LINK_SLIP_ESC, EF_LINK_SLIP_ESC_ESC};
+static const uint8_t end = EF_LINK_SLIP_END;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+
+extern void efLink_slip_encode(void const *pData, int32_t size, efLink_write_t write, void *ctx)
+{
+    uint8_t const *p = pData;
+    int32_t run = 0;
+
+    while (run < size)
+    {
+        if (p[run] == EF_LINK_SLIP_END || p[run] == EF_LINK_SLIP_ESC)
+        {
+            if (run)
+                write(ctx, p, run);
+
+            write(ctx, p[run] == EF_LINK_SLIP_END ? escEnd : escEsc, 2);
+
+            p += run + 1;
+            size -= run + 1;
+            run = 0;
+        }
+        else
+        {
+            run++;
+        }
+    }
+
+    if (run)
+        write(ctx, p, run);
+}
+
+extern void efLink_slip_end(efLink_write_t write, void *ctx)
+{
+    write(ctx, &end, 1);
+}
+
+extern void efLink_slip_decReset(efLink_slipDec_t *dec, uint8_t *pBuf, int32_t size)
+{
+    dec->pBuf = pBuf;
+    dec->size = size;
+    dec->len = 0;
+    dec->esc = false;
+    dec->error = false;
+}
+
+extern efLink_slipSt_t efLink_slip_decode(efLink_slipDec_t *dec, uint8_t const *pData,
+        int32_t size, int32_t *pUsed)
+{
+    efLink_slipSt_t ret = EF_LINK_SLIP_ST_MORE;
+    int32_t i;
+    uint8_t data;
+
+    for (i = 0 ; i < size && ret == EF_LINK_SLIP_ST_MORE ; i++)
+    {
+        data = pData[i];
+
+        if (data == EF_LINK_SLIP_END)
+        {
+            if (dec->error || dec->esc)
+            {
+                ret = EF_LINK_SLIP_ST_ERROR;
+                efLink_slip_decReset(dec, dec->pBuf, dec->size);
+            }
+            else if (dec->len != 0)
+            {
+                ret = EF_LINK_SLIP_ST_FRAME;
+            }
+            /* empty frames (back to back END) are ignored */
+        }
+        else if (dec->esc)
+        {
+            dec->esc = false;
+
+            if (data == EF_LINK_SLIP_ESC_END)
+                data = EF_LINK_SLIP_END;
+            else if (data == EF_LINK_SLIP_ESC_ESC)
+                data = EF_LINK_SLIP_ESC;
+            else
+                dec->error = true;
+
+            if (dec->len < dec->size)
+                dec->pBuf[dec->len++] = data;
+            else
+                dec->error = true;
+        }
+        else if (data == EF_LINK_SLIP_ESC)
+        {
+            dec->esc = true;
+        }
+        else if (dec->len < dec->size)
+        {
+            dec->pBuf[dec->len++] = data;
+        }
+        else
+        {
+            dec->error = true;
+        }
+    }
+
+    *pUsed = i;
+
+    return ret;
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,497 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "unity.h"
+#include "efLink.h"
+#include "efLink_crc.h"
+#include "efLink_slip.h"
+#include "efHal_internal.h"
+#include "freertos_fake.h"
+#include "stdio.h"
+#include "string.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define WIRE_LENGTH     32
+#define WIRE_CHUNK      16      /* bytes moved per TX interrupt */
+
+#define BENCH_PACKETS   64
+
+typedef struct
+{
+    uint8_t buf[WIRE_LENGTH];
+    int32_t len;
+}loopback_t;
+
+/* one end of a null modem cable between two efHal_uart devices */
+typedef struct fakeUart_s
+{
+    efHal_dh_t dh;
+    struct fakeUart_s *peer;
+    int32_t dropFrames;         /* frames sent by this end lost on the wire */
+    bool inFrame;
+    bool dropping;
+    uint32_t wireBytes;         /* sent by this end */
+}fakeUart_t;
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static loopback_t wire;
+static uint32_t seed;
+static fakeUart_t uartA;
+static fakeUart_t uartB;
+static efLink_t linkA;
+static efLink_t linkB;
+
+/* packets taken from linkB by sinkTask, it can't use the test asserts */
+static int32_t volatile sinkCount;
+static bool volatile sinkOk;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+static uint8_t rnd(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+static void wireWrite(void *ctx, void const *pData, int32_t size)
+{
+    loopback_t *lb = ctx;
+
+    TEST_ASSERT_TRUE(lb->len + size <= WIRE_LENGTH);
+
+    memcpy(&lb->buf[lb->len], pData, size);
+    lb->len += size;
+}
+
+/* plays the UART ISRs of both ends: every byte sent by one of them
+ * shows up in the RX ring of the other one */
+static void dataReadyTx(void *param)
+{
+    fakeUart_t *uart = param;
+    uint8_t buf[WIRE_CHUNK];
+    int32_t size;
+    int32_t i;
+
+    while ((size = efHal_internal_uart_getDataForTxBulk(uart->dh, buf, sizeof(buf))) > 0)
+    {
+        uart->wireBytes += size;
+
+        for (i = 0 ; i < size ; i++)
+        {
+            /* frames go between a leading and a trailing END */
+            if (buf[i] == EF_LINK_SLIP_END)
+            {
+                uart->inFrame = !uart->inFrame;
+
+                if (uart->inFrame)
+                {
+                    uart->dropping = uart->dropFrames > 0;
+                }
+                else if (uart->dropping)
+                {
+                    uart->dropFrames--;
+                    uart->dropping = false;
+                    continue;
+                }
+            }
+
+            if (!uart->dropping)
+                efHal_internal_uart_putDataForRx(uart->peer->dh, &buf[i]);
+        }
+
+        efHal_internal_uart_rxIdle(uart->peer->dh);
+
+        /* the line is slower than the CPU, let the other end read */
+        freertos_fake_sleep(1);
+    }
+
+    efHal_internal_uart_txComplete(uart->dh);
+}
+
+static efHal_dh_t fakeUart_open(fakeUart_t *uart, fakeUart_t *peer)
+{
+    efHal_uart_callBacks_t cb =
+    {
+        .conf = NULL,
+        .dataReadyTx = dataReadyTx,
+        .sendBuffer = NULL,
+    };
+
+    uart->peer = peer;
+    uart->dh = efHal_internal_uart_deviceReg(cb, uart);
+
+    return uart->dh;
+}
+
+static void fillPayload(uint8_t *pData, int32_t size)
+{
+    int32_t i;
+
+    for (i = 0 ; i < size ; i++)
+        pData[i] = rnd();
+
+    /* bytes SLIP has to escape */
+    pData[0] = EF_LINK_SLIP_END;
+    pData[size - 1] = EF_LINK_SLIP_ESC;
+}
+
+static void expectPacket(efLink_t link, uint8_t const *pData, int32_t size)
+{
+    efLink_pkt_t *pkt = efLink_recv(link, pdMS_TO_TICKS(100));
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT32(size, pkt->size);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(pData, pkt->pData, size);
+
+    efLink_release(pkt);
+}
+
+/* the application on the B end, checks packets are numbered in order */
+static void sinkTask(void *param)
+{
+    int32_t size = (intptr_t)param;
+    efLink_pkt_t *pkt;
+    int32_t i;
+
+    for (i = 0 ; i < BENCH_PACKETS ; i++)
+    {
+        pkt = efLink_recv(linkB, portMAX_DELAY);
+
+        if (pkt->size != size || memcmp(&pkt->pData[1], &i, sizeof(i)) != 0)
+            sinkOk = false;
+
+        efLink_release(pkt);
+        sinkCount++;
+    }
+
+    vTaskDelete(NULL);
+}
+
+/* packets per second from A to B, the wire moves WIRE_CHUNK bytes per ms */
+static uint32_t bench(int32_t size, uint32_t *pWireBytes)
+{
+    uint8_t payload[EF_LINK_MTU];
+    uint32_t wireBytes = uartA.wireBytes + uartB.wireBytes;
+    TickType_t start;
+    TickType_t elapsed;
+    int32_t i;
+
+    fillPayload(payload, size);
+    sinkCount = 0;
+    sinkOk = true;
+    xTaskCreate(sinkTask, "sink", 0, (void *)(intptr_t)size, 1, NULL);
+
+    start = xTaskGetTickCount();
+
+    for (i = 0 ; i < BENCH_PACKETS ; i++)
+    {
+        memcpy(&payload[1], &i, sizeof(i));
+        TEST_ASSERT_TRUE(efLink_send(linkA, payload, size, portMAX_DELAY));
+    }
+
+    while (sinkCount < BENCH_PACKETS && xTaskGetTickCount() - start < pdMS_TO_TICKS(5000))
+        freertos_fake_sleep(1);
+
+    elapsed = xTaskGetTickCount() - start;
+
+    TEST_ASSERT_EQUAL_INT32(BENCH_PACKETS, sinkCount);
+    TEST_ASSERT_TRUE(sinkOk);
+
+    /* both directions: frames and ACKs */
+    *pWireBytes = (uartA.wireBytes + uartB.wireBytes - wireBytes) / BENCH_PACKETS;
+
+    return (uint64_t)BENCH_PACKETS * configTICK_RATE_HZ / (elapsed ? elapsed : 1);
+}
+
+/*==================[external functions definition]==========================*/
+
+void setUp(void)
+{
+    efLink_conf_t conf =
+    {
+        .crc = EF_LINK_CRC_32,
+        .reliable = true,
+    };
+
+    wire.len = 0;
+    seed = 1;
+
+    /* the link tasks live as long as the test program */
+    if (linkA == NULL)
+    {
+        efHal_uart_init();
+        efLink_init();
+
+        conf.uart = fakeUart_open(&uartA, &uartB);
+        linkA = efLink_open(&conf);
+
+        conf.uart = fakeUart_open(&uartB, &uartA);
+        linkB = efLink_open(&conf);
+    }
+
+    uartA.dropFrames = 0;
+    uartB.dropFrames = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void test_efLink_crc_checkValues(void)
+{
+    TEST_ASSERT_EQUAL_HEX16(0x906E, efLink_crc16("123456789", 9));
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, efLink_crc32("123456789", 9));
+}
+
+void test_efLink_crc_sliceMatchesBytewise(void)
+{
+    uint8_t data[37];
+    uint32_t crc32 = EF_LINK_CRC32_INIT;
+    uint16_t crc16 = EF_LINK_CRC16_INIT;
+    uint32_t i;
+
+    for (i = 0 ; i < sizeof(data) ; i++)
+        data[i] = rnd();
+
+    /* one byte at a time only takes the byte-wise path */
+    for (i = 0 ; i < sizeof(data) ; i++)
+    {
+        crc32 = efLink_crc32_update(crc32, &data[i], 1);
+        crc16 = efLink_crc16_update(crc16, &data[i], 1);
+    }
+
+    TEST_ASSERT_EQUAL_HEX32(efLink_crc32(data, sizeof(data)), crc32 ^ EF_LINK_CRC32_XOROUT);
+    TEST_ASSERT_EQUAL_HEX16(efLink_crc16(data, sizeof(data)), crc16 ^ EF_LINK_CRC16_XOROUT);
+}
+
+void test_efLink_slip_escapes(void)
+{
+    const uint8_t data[] = {0x01, EF_LINK_SLIP_END, 0x02, EF_LINK_SLIP_ESC};
+    const uint8_t expected[] =
+    {
+        0x01,
+        EF_LINK_SLIP_ESC, EF_LINK_SLIP_ESC_END,
+        0x02,
+        EF_LINK_SLIP_ESC, EF_LINK_SLIP_ESC_ESC,
+        EF_LINK_SLIP_END,
+    };
+    uint8_t frame[8];
+    efLink_slipDec_t dec;
+    int32_t used;
+
+    efLink_slip_encode(data, sizeof(data), wireWrite, &wire);
+    efLink_slip_end(wireWrite, &wire);
+
+    TEST_ASSERT_EQUAL_INT32(sizeof(expected), wire.len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, wire.buf, sizeof(expected));
+
+    efLink_slip_decReset(&dec, frame, sizeof(frame));
+    TEST_ASSERT_EQUAL(EF_LINK_SLIP_ST_FRAME, efLink_slip_decode(&dec, wire.buf, wire.len, &used));
+    TEST_ASSERT_EQUAL_INT32(wire.len, used);
+    TEST_ASSERT_EQUAL_INT32(sizeof(data), dec.len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, frame, sizeof(data));
+}
+
+void test_efLink_slip_overflowDropsFrame(void)
+{
+    uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t frame[4];
+    efLink_slipDec_t dec;
+    int32_t used;
+
+    efLink_slip_encode(data, sizeof(data), wireWrite, &wire);
+    efLink_slip_end(wireWrite, &wire);
+    efLink_slip_encode(data, 3, wireWrite, &wire);
+    efLink_slip_end(wireWrite, &wire);
+
+    efLink_slip_decReset(&dec, frame, sizeof(frame));
+    TEST_ASSERT_EQUAL(EF_LINK_SLIP_ST_ERROR, efLink_slip_decode(&dec, wire.buf, wire.len, &used));
+    TEST_ASSERT_EQUAL_INT32(sizeof(data) + 1, used);
+
+    /* next frame is decoded in sync */
+    TEST_ASSERT_EQUAL(EF_LINK_SLIP_ST_FRAME,
+            efLink_slip_decode(&dec, &wire.buf[used], wire.len - used, &used));
+    TEST_ASSERT_EQUAL_INT32(3, dec.len);
+}
+
+void test_efLink_loopback_delivery(void)
+{
+    uint8_t payload[EF_LINK_MTU];
+    efLink_stats_t statsA;
+    efLink_stats_t statsB;
+
+    fillPayload(payload, sizeof(payload));
+    TEST_ASSERT_TRUE(efLink_send(linkA, payload, sizeof(payload), portMAX_DELAY));
+    expectPacket(linkB, payload, sizeof(payload));
+
+    fillPayload(payload, 5);
+    TEST_ASSERT_TRUE(efLink_send(linkB, payload, 5, portMAX_DELAY));
+    expectPacket(linkA, payload, 5);
+
+    TEST_ASSERT_NULL(efLink_recv(linkA, 0));
+    TEST_ASSERT_NULL(efLink_recv(linkB, 0));
+
+    efLink_getStats(linkA, &statsA);
+    efLink_getStats(linkB, &statsB);
+    TEST_ASSERT_EQUAL_UINT32(1, statsA.txPackets);
+    TEST_ASSERT_EQUAL_UINT32(1, statsA.rxPackets);
+    TEST_ASSERT_EQUAL_UINT32(1, statsB.txPackets);
+    TEST_ASSERT_EQUAL_UINT32(1, statsB.rxPackets);
+    TEST_ASSERT_EQUAL_UINT32(0, statsA.retries + statsA.crcErrors + statsA.framingErrors);
+    TEST_ASSERT_EQUAL_UINT32(0, statsB.retries + statsB.crcErrors + statsB.framingErrors);
+}
+
+void test_efLink_loopback_retransmitAfterLostAck(void)
+{
+    uint8_t payload[20];
+    efLink_stats_t before;
+    efLink_stats_t after;
+    efLink_stats_t rxBefore;
+    efLink_stats_t rxAfter;
+
+    efLink_getStats(linkA, &before);
+    efLink_getStats(linkB, &rxBefore);
+
+    /* B gets the packet but its ACK never reaches A */
+    uartB.dropFrames = 1;
+
+    fillPayload(payload, sizeof(payload));
+    TEST_ASSERT_TRUE(efLink_send(linkA, payload, sizeof(payload), portMAX_DELAY));
+    TEST_ASSERT_EQUAL_INT32(0, uartB.dropFrames);
+
+    /* the retransmission is acknowledged but not delivered twice */
+    expectPacket(linkB, payload, sizeof(payload));
+    TEST_ASSERT_NULL(efLink_recv(linkB, pdMS_TO_TICKS(100)));
+
+    efLink_getStats(linkA, &after);
+    efLink_getStats(linkB, &rxAfter);
+    TEST_ASSERT_EQUAL_UINT32(1, after.retries - before.retries);
+    TEST_ASSERT_EQUAL_UINT32(1, after.txPackets - before.txPackets);
+    TEST_ASSERT_EQUAL_UINT32(1, rxAfter.duplicates - rxBefore.duplicates);
+    TEST_ASSERT_EQUAL_UINT32(1, rxAfter.rxPackets - rxBefore.rxPackets);
+}
+
+void test_efLink_loopback_giveUpWithoutAck(void)
+{
+    uint8_t payload[8];
+    efLink_stats_t before;
+    efLink_stats_t after;
+
+    efLink_getStats(linkA, &before);
+
+    uartB.dropFrames = EF_LINK_RETRIES + 1;
+
+    fillPayload(payload, sizeof(payload));
+    TEST_ASSERT_FALSE(efLink_send(linkA, payload, sizeof(payload), portMAX_DELAY));
+
+    efLink_getStats(linkA, &after);
+    TEST_ASSERT_EQUAL_UINT32(EF_LINK_RETRIES, after.retries - before.retries);
+    TEST_ASSERT_EQUAL_UINT32(0, after.txPackets - before.txPackets);
+
+    expectPacket(linkB, payload, sizeof(payload));
+    TEST_ASSERT_NULL(efLink_recv(linkB, pdMS_TO_TICKS(100)));
+}
+
+void test_efLink_loopback_poolExhaustion(void)
+{
+    uint8_t payload[EF_LINK_POOL_SIZE][8];
+    efLink_pkt_t *pkt[EF_LINK_POOL_SIZE];
+    efLink_stats_t before;
+    efLink_stats_t after;
+    int32_t held = EF_LINK_POOL_SIZE - 1;
+    int32_t i;
+
+    efLink_getStats(linkB, &before);
+
+    /* each link decodes into a pool packet of its own, the application
+     * can hold all the others */
+    for (i = 0 ; i < held ; i++)
+    {
+        fillPayload(payload[i], sizeof(payload[i]));
+        TEST_ASSERT_TRUE(efLink_send(linkA, payload[i], sizeof(payload[i]), portMAX_DELAY));
+    }
+
+    for (i = 0 ; i < held ; i++)
+    {
+        pkt[i] = efLink_recv(linkB, pdMS_TO_TICKS(100));
+        TEST_ASSERT_NOT_NULL(pkt[i]);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(payload[i], pkt[i]->pData, sizeof(payload[i]));
+    }
+
+    /* B has nowhere to decode and never ACKs */
+    fillPayload(payload[held], sizeof(payload[held]));
+    TEST_ASSERT_FALSE(efLink_send(linkA, payload[held], sizeof(payload[held]), portMAX_DELAY));
+
+    efLink_getStats(linkB, &after);
+    TEST_ASSERT_EQUAL_UINT32(held, after.rxPackets - before.rxPackets);
+    TEST_ASSERT_EQUAL_UINT32(EF_LINK_RETRIES + 1, after.drops - before.drops);
+    TEST_ASSERT_NULL(efLink_recv(linkB, 0));
+
+    /* packets given back are used again from the next frame on */
+    for (i = 0 ; i < held ; i++)
+        efLink_release(pkt[i]);
+
+    TEST_ASSERT_TRUE(efLink_send(linkA, payload[held], sizeof(payload[held]), portMAX_DELAY));
+    expectPacket(linkB, payload[held], sizeof(payload[held]));
+
+    efLink_getStats(linkB, &before);
+    TEST_ASSERT_EQUAL_UINT32(after.drops, before.drops);
+}
+
+/* runs last: it leaves linkB to a task of its own while it measures */
+void test_efLink_loopback_bench(void)
+{
+    uint32_t small;
+    uint32_t smallWire;
+    uint32_t mtu;
+    uint32_t mtuWire;
+
+    small = bench(8, &smallWire);
+    mtu = bench(EF_LINK_MTU, &mtuWire);
+
+    printf("efLink loopback at %d bytes/ms: 8 bytes %lu packets/s (%lu wire bytes each), "
+            "%d bytes %lu packets/s (%lu wire bytes each)\n",
+            WIRE_CHUNK, (unsigned long)small, (unsigned long)smallWire,
+            EF_LINK_MTU, (unsigned long)mtu, (unsigned long)mtuWire);
+}
+
+/*==================[end of file]============================================*/
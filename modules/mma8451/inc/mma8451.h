@@ -37,6 +37,34 @@
 
 /*==================[inclusions]=============================================*/
 #include "efHal.h"
+#include "efHal_gpio.h"
+#include "stdbool.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#if __has_include("mma8451_config.h")
+    #include "mma8451_config.h"
+#endif
+
+/* samples kept by the stream for its readers, power of 2 */
+#ifndef MMA8451_STREAM_RING
+    #define MMA8451_STREAM_RING         128
+#endif
+
+/* timestamp of the stream samples, read in the interrupt, and its rate.
+ * The default is the tick count: its resolution is a whole tick (1 ms at
+ * 1 kHz, most of a period at 800 Hz), so it can't give jitter free stamps.
+ * For vibration analysis define both to a free running 32 bit timer, e.g.
+ * a TPM or LPTMR counter chained to 32 bits on the KL46Z, TIM2 on the
+ * F767ZI */
+#ifndef MMA8451_TIMESTAMP
+    #define MMA8451_TIMESTAMP()         ((uint32_t)xTaskGetTickCountFromISR())
+    #define MMA8451_TIMESTAMP_HZ        configTICK_RATE_HZ
+#endif
+
+#ifndef MMA8451_TIMESTAMP_HZ
+    #error "MMA8451_TIMESTAMP_HZ must be defined with MMA8451_TIMESTAMP"
+#endif
 
 /*==================[cplusplus]==============================================*/
 #ifdef __cplusplus
@@ -64,6 +92,16 @@ typedef enum
     MMA8451_DR_1p56hz = 0b111,
 }mma8451_DR_t;
 
+typedef enum
+{
+    MMA8451_FIFO_DISABLED = 0b00,
+    MMA8451_FIFO_CIRCULAR = 0b01,   /* the oldest sample is dropped when full */
+    MMA8451_FIFO_FILL = 0b10,       /* stops accepting samples when full */
+    MMA8451_FIFO_TRIGGER = 0b11,    /* circular until the trigger event */
+}mma8451_fifoMode_t;
+
+#define MMA8451_FIFO_SIZE       32
+
 typedef struct
 {
     unsigned ACTIVE:1;
@@ -104,6 +142,24 @@ typedef struct
     int16_t accZ;
 }mma8451_accIntCount_t;                /* acceleration in internal counts */
 
+/* a sample of the stream */
+typedef struct
+{
+    uint32_t seq;                   /* sample number, a jump means samples
+                                       were lost */
+    uint32_t timestamp;             /* MMA8451_TIMESTAMP() units */
+    mma8451_accIntCount_t acc;
+}mma8451_sample_t;
+
+/* a reader of the stream, owned by the caller */
+typedef struct mma8451_streamSub_s
+{
+    uint32_t rdIdx;
+    uint32_t lost;                  /* samples overwritten before being read */
+    SemaphoreHandle_t newData;
+    struct mma8451_streamSub_s *pNext;
+}mma8451_streamSub_t;
+
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -115,9 +171,101 @@ extern void mma8451_setCtrlReg1(mma8451_ctrlReg1_t reg1);
 extern void mma8451_setCtrlReg4(mma8451_ctrlReg4_t reg4);
 extern void mma8451_setCtrlReg5(mma8451_ctrlReg5_t reg5);
 
+/** \brief configures the sample FIFO (F_SETUP)
+ **
+ ** The watermark interrupt is enabled
+ ** with INT_EN_FIFO in CTRL_REG4.
+ **
+ ** \param[in] mode FIFO mode, MMA8451_FIFO_DISABLED to read single samples
+ ** \param[in] watermark samples that set F_WMRK_FLAG, 0 to
+ **            MMA8451_FIFO_SIZE (0 disables the flag)
+ **/
+extern void mma8451_setFifo(mma8451_fifoMode_t mode, uint8_t watermark);
+
+/** \brief defers the register writes of the following setters until
+ ** mma8451_configEnd, which sends them in one standby burst */
+extern void mma8451_configBegin(void);
+extern void mma8451_configEnd(void);
+
+
+/** \brief 8 bit samples (F_READ): 3 bytes per sample on the bus instead of
+ ** 6. Samples are still returned in 14 bit counts, the 6 LSBs are 0 */
+extern void mma8451_setFastRead(bool fastRead);
 
 extern mma8451_accIntCount_t mma8451_getAccIntCount(void);
 
+/** \brief drains the FIFO, oldest sample first
+ **
+ ** F_STATUS is read first and then the queued samples in one burst, so it
+ ** can be polled at any time. The stream (mma8451_streamStart) saves the
+ ** first read: woken by the watermark interrupt, it gets F_STATUS and the
+ ** watermark samples in a single burst.
+ **
+ ** \param[out] pBuf samples read
+ ** \param[in] max size of pBuf in samples
+ ** \return number of samples read
+ **/
+extern int32_t mma8451_readFifo(mma8451_accIntCount_t *pBuf, int32_t max);
+
+/** \brief drains the FIFO as mma8451_readFifo, without converting
+ **
+ ** \param[out] pRaw samples as read, 3 bytes each in fast read mode, 6
+ **            (MSB first, 14 bits left aligned) otherwise
+ ** \param[in] max size of pRaw in samples
+ ** \return number of samples read
+ **/
+extern int32_t mma8451_readFifoRaw(uint8_t *pRaw, int32_t max);
+
+/** \brief converts raw samples to X, Y, Z counts in one pass
+ **
+ ** \param[out] pXyz 3 * samples values, X, Y, Z of each sample
+ ** \param[in] pRaw samples as read from the device
+ ** \param[in] samples number of samples
+ ** \param[in] fastRead pRaw has 8 bit samples
+ **/
+extern void mma8451_convert(int16_t *pXyz, uint8_t const *pRaw, int32_t samples,
+        bool fastRead);
+
+/** \brief true if the FIFO overflowed (samples were lost) since the last
+ ** call, as seen by mma8451_readFifo */
+extern bool mma8451_getFifoOverflow(void);
+
+/** \brief starts streaming samples from the FIFO
+ **
+ ** The FIFO is set circular with the watermark interrupt routed to INT1 or
+ ** INT2 (the other interrupt enables are kept). The interrupt of intPin wakes
+ ** a task that drains the FIFO and stamps each sample: the one completing
+ ** the watermark gets the interrupt time, the rest are spaced by the data
+ ** rate, so the stamps carry no task latency. If the FIFO overflowed, the
+ ** samples lost are counted from the time elapsed and skipped in seq. The
+ ** stream owns the FIFO, don't use mma8451_readFifo meanwhile.
+ **
+ ** \param[in] intPin MCU pin connected to the chosen interrupt output
+ ** \param[in] int1 true to route the interrupt to INT1, false for INT2
+ ** \param[in] watermark samples per interrupt, 1 to MMA8451_FIFO_SIZE
+ ** \param[in] priority priority of the stream task
+ **/
+extern void mma8451_streamStart(efHal_gpio_id_t intPin, bool int1,
+        uint8_t watermark, UBaseType_t priority);
+
+/** \brief adds a reader, it gets the samples from now on */
+extern void mma8451_streamSubscribe(mma8451_streamSub_t *sub);
+
+/** \brief reads the samples of a reader, oldest first
+ **
+ ** Readers don't lock each other or the stream task. A reader keeps up to
+ ** MMA8451_STREAM_RING - 1 unread samples, the slot being written is never
+ ** read. Samples overwritten before being read are added to sub->lost.
+ **
+ ** \param[in] sub reader
+ ** \param[out] pBuf samples read
+ ** \param[in] max size of pBuf in samples
+ ** \param[in] blockTime time to wait for samples if there are none
+ ** \return number of samples read
+ **/
+extern int32_t mma8451_streamRead(mma8451_streamSub_t *sub,
+        mma8451_sample_t *pBuf, int32_t max, TickType_t blockTime);
+
 /*==================[cplusplus]==============================================*/
 #ifdef __cplusplus
 }
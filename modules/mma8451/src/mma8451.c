@@ -37,8 +37,11 @@
 #include "mma8451.h"
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "task.h"
 #include "efHal_i2c.h"
+#include "regmap.h"
 #include "stdbool.h"
+#include "string.h"
 
 /*==================[macros and typedef]=====================================*/
 
@@ -46,69 +49,307 @@
 
 #define STATUS_ADDRESS      0X00
 #define OUT_ADDRESS         0X01
+#define F_SETUP_ADDRESS     0X09
 #define CTRL_REG1_ADDRESS   0X2A
 #define CTRL_REG4_ADDRESS   0X2D
 #define CTRL_REG5_ADDRESS   0X2E
+#define SYSMOD_ADDRESS      0X0B
 #define INT_SOURCE_ADDRESS  0X0C
+#define PL_STATUS_ADDRESS   0X10
+#define FF_MT_SRC_ADDRESS   0X16
+#define TRANSIENT_SRC_ADDR  0X1E
+#define PULSE_SRC_ADDRESS   0X22
+
+#define TOTAL_REGS          0X32    /* STATUS to OFF_Z */
+
+#define CTRL_REG1_ACTIVE_MASK   0x01
 
 #define ACC_INT_COUNT_LENGTH    6
+#define FAST_READ_LENGTH        3       /* MSBs only, LSB registers skipped */
+
+#define F_STATUS_OVF_MASK       0x80
+#define F_STATUS_CNT_MASK       0x3F
+#define F_SETUP_MODE_SHIFT      6
+
+#define INT_FIFO_MASK           0x40    /* CTRL_REG4 and CTRL_REG5 */
+
+#ifndef MMA8451_STREAM_TASK_STACK
+    #define MMA8451_STREAM_TASK_STACK   250
+#endif
+
+#define RING_MASK               (MMA8451_STREAM_RING - 1)
+
+/* the ring slot is written before the index that publishes it */
+#define COMPILER_BARRIER()      __asm volatile ("" ::: "memory")
 
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
 
-static efHal_dh_t i2c_dh;
 static SemaphoreHandle_t xMutexAcc;
 
-static mma8451_ctrlReg1_t reg1;
+static regmap_t regmap;
+static uint8_t regCache[TOTAL_REGS];
+static uint8_t regFlags[TOTAL_REGS];
+
+static mma8451_ctrlReg1_t reg1;     /* requested CTRL_REG1, ACTIVE included */
+static bool configDeferred;
+
+static bool fifoEnabled;
+static uint8_t fifoWatermark;       /* 0 if the FIFO or the watermark is off */
+static bool fifoOverflow;
+
+/* F_STATUS and a full FIFO, the data address wraps from OUT_Z_LSB back to
+ * OUT_X_MSB while the FIFO is enabled */
+static uint8_t fifoBuf[1 + MMA8451_FIFO_SIZE * ACC_INT_COUNT_LENGTH];
+
+/* data rates in mHz, by mma8451_DR_t */
+static const uint32_t rateMilliHz[] =
+{
+    800000, 400000, 200000, 100000, 50000, 12500, 6250, 1563,
+};
+
+static mma8451_sample_t ring[MMA8451_STREAM_RING];
+static volatile uint32_t wrIdx;
+static mma8451_streamSub_t *pSubs;
+
+static SemaphoreHandle_t streamIrq;
+static volatile uint32_t irqTimestamp;
+static uint8_t streamWatermark;
 
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
 
-static void mma8451_write_reg(uint8_t addr, uint8_t data)
+/* the control registers can only be changed in standby. CTRL_REG1 in the
+ * register map is the one in the device, reg1 the requested one: ACTIVE is
+ * cleared alone, then the pending registers are written (in address order,
+ * F_SETUP goes before CTRL_REG1) and the requested CTRL_REG1 last */
+static void commit(void)
 {
-    uint8_t txBuf[] =
+    uint8_t ctrl1 = *(uint8_t*)&reg1;
+    uint8_t ctrl1Dev;
+
+    regmap_read(&regmap, CTRL_REG1_ADDRESS, &ctrl1Dev);
+
+    if (regmap_isDirty(&regmap) || ((ctrl1 ^ ctrl1Dev) & ~CTRL_REG1_ACTIVE_MASK))
     {
-        addr,
-        data,
-    };
+        regmap_write(&regmap, CTRL_REG1_ADDRESS, ctrl1Dev & ~CTRL_REG1_ACTIVE_MASK);
+        regmap_syncRange(&regmap, CTRL_REG1_ADDRESS, 1);
+        regmap_sync(&regmap);
+    }
 
-    efHal_i2c_transfer(i2c_dh, MMA8451_I2C_ADDRESS, txBuf, sizeof(txBuf), NULL, 0);
+    regmap_write(&regmap, CTRL_REG1_ADDRESS, ctrl1);
+    regmap_sync(&regmap);
 }
 
-static void mma8451_read_regs(uint8_t addr, uint8_t *buf, size_t length)
+/* mutex taken */
+static void setCtrlReg(uint8_t addr, uint8_t data)
 {
-    efHal_i2c_transfer(i2c_dh, MMA8451_I2C_ADDRESS, &addr, sizeof(addr), buf, length);
+    regmap_write(&regmap, addr, data);
+
+    if (!configDeferred)
+        commit();
+}
+
+static void writeCtrlReg(uint8_t addr, uint8_t data)
+{
+    xSemaphoreTake(xMutexAcc, portMAX_DELAY);
+    setCtrlReg(addr, data);
+    xSemaphoreGive(xMutexAcc);
+}
+
+/* bytes per sample on the bus, mutex taken */
+static int32_t sampleLength(void)
+{
+    return reg1.F_READ ? FAST_READ_LENGTH : ACC_INT_COUNT_LENGTH;
 }
 
-static void writeRegWithActiveLow(uint8_t addr, uint8_t data)
+/* reads up to max samples from the FIFO to fifoBuf, after F_STATUS. With
+ * atWatermark the watermark is known to be reached and its samples come in
+ * the burst of F_STATUS, otherwise F_STATUS is read alone first: a burst
+ * longer than the FIFO count would consume samples arriving meanwhile and
+ * drop them. Mutex taken */
+static int32_t drain(int32_t max, bool atWatermark)
 {
-    bool prevActive = 0;
-    uint8_t *pTmp = (uint8_t*)&reg1;
+    int32_t count, first, length;
+    uint8_t fStatus;
+
+    /* without the FIFO the first register is STATUS, not F_STATUS */
+    if (!fifoEnabled)
+        return 0;
+
+    if (max > MMA8451_FIFO_SIZE)
+        max = MMA8451_FIFO_SIZE;
+
+    length = sampleLength();
+
+    first = 0;
+
+    if (atWatermark)
+        first = (fifoWatermark < max) ? fifoWatermark : max;
+
+    if (!regmap_readBulk(&regmap, STATUS_ADDRESS, fifoBuf, 1 + first * length))
+        return 0;
+
+    fStatus = fifoBuf[0];
+    count = fStatus & F_STATUS_CNT_MASK;
+
+    if (fStatus & F_STATUS_OVF_MASK)
+        fifoOverflow = true;
+
+    if (count > max)
+        count = max;
 
-    if (reg1.ACTIVE)
+    if (count < first)
+        first = count;
+
+    /* the rest, all of them without the watermark */
+    if (count > first &&
+        !regmap_readBulk(&regmap, OUT_ADDRESS, &fifoBuf[1 + first * length],
+                (count - first) * length))
     {
-        prevActive = 1;
-        reg1.ACTIVE = 0;
-        mma8451_write_reg(CTRL_REG1_ADDRESS, *pTmp);
+        count = first;
     }
 
-    mma8451_write_reg(addr, data);
+    return count;
+}
+
+static int32_t readFifo(mma8451_accIntCount_t *pBuf, int32_t max, bool atWatermark)
+{
+    int32_t count;
+
+    xSemaphoreTake(xMutexAcc, portMAX_DELAY);
+    count = drain(max, atWatermark);
+
+    /* the structure is three int16_t, as the converter output */
+    mma8451_convert(&pBuf->accX, &fifoBuf[1], count, reg1.F_READ);
+    xSemaphoreGive(xMutexAcc);
+
+    return count;
+}
+
+/* sample period in 1/256 timestamp units */
+static uint32_t periodQ8(void)
+{
+    return ((uint64_t)MMA8451_TIMESTAMP_HZ * 256 * 1000) / rateMilliHz[reg1.DR];
+}
+
+static void streamIntCallback(efHal_gpio_id_t id)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    irqTimestamp = MMA8451_TIMESTAMP();
+    xSemaphoreGiveFromISR(streamIrq, &xHigherPriorityTaskWoken);
+
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
 
-    if (prevActive)
+static void streamTask(void *pvParameters)
+{
+    mma8451_accIntCount_t acc[MMA8451_FIFO_SIZE];
+    mma8451_streamSub_t *sub;
+    mma8451_sample_t *pSample;
+    uint32_t seq = 0, lastTs = 0, ts0, now, period, elapsed;
+    TickType_t timeout;
+    bool irq, first = true;
+    int32_t n, i;
+
+    for (;;)
     {
-        reg1.ACTIVE = 1;
-        mma8451_write_reg(CTRL_REG1_ADDRESS, *pTmp);
+        /* a missed edge leaves the line asserted, the timeout drains it */
+        timeout = pdMS_TO_TICKS((2000000 * streamWatermark) / rateMilliHz[reg1.DR]) + 1;
+        irq = xSemaphoreTake(streamIrq, timeout) == pdTRUE;
+
+        now = MMA8451_TIMESTAMP();
+        n = readFifo(acc, MMA8451_FIFO_SIZE, irq);
+
+        if (n == 0)
+            continue;
+
+        period = periodQ8();
+
+        if (mma8451_getFifoOverflow() && !first)
+        {
+            /* the oldest samples were dropped, the interrupt time no longer
+             * belongs to the watermark sample. The newest one was taken in
+             * the last period before the read, the ones between it and the
+             * last stamped sample that aren't in the FIFO were lost */
+            elapsed = (((uint64_t)(now - lastTs)) << 8) / period;
+
+            if (elapsed > (uint32_t)n)
+            {
+                seq += elapsed - n;
+                lastTs += ((uint64_t)(elapsed - n) * period) >> 8;
+            }
+
+            ts0 = lastTs;
+        }
+        else if (irq && n >= streamWatermark)
+        {
+            /* stamp of the first sample, minus a period */
+            ts0 = irqTimestamp - ((streamWatermark * period) >> 8);
+        }
+        else
+        {
+            ts0 = lastTs;
+        }
+
+        for (i = 0 ; i < n ; i++)
+        {
+            pSample = &ring[wrIdx & RING_MASK];
+            pSample->seq = seq++;
+            pSample->timestamp = ts0 + (((i + 1) * period) >> 8);
+            pSample->acc = acc[i];
+
+            COMPILER_BARRIER();
+            wrIdx++;
+        }
+
+        lastTs = ts0 + ((n * period) >> 8);
+        first = false;
+
+        /* subscribers are only prepended, the list from its head stays
+         * valid without the scheduler suspended */
+        vTaskSuspendAll();
+        sub = pSubs;
+        xTaskResumeAll();
+
+        for ( ; sub != NULL ; sub = sub->pNext)
+            xSemaphoreGive(sub->newData);
     }
 }
 
 /*==================[external functions definition]==========================*/
 void mma8451_init(efHal_dh_t dh)
 {
-    i2c_dh = dh;
+    regmap_conf_t conf =
+    {
+        .bus = REGMAP_BUS_I2C,
+        .dh = dh,
+        .da = MMA8451_I2C_ADDRESS,
+        .cs = EF_HAL_INVALID_ID,
+        .firstReg = STATUS_ADDRESS,
+        .numRegs = TOTAL_REGS,
+        .fillGaps = true,
+    };
 
     xMutexAcc = xSemaphoreCreateMutex();
+    configDeferred = false;
+    fifoEnabled = false;
+    fifoWatermark = 0;
+    fifoOverflow = false;
+
+    regmap_init(&regmap, &conf, regCache, regFlags);
+    regmap_setVolatile(&regmap, STATUS_ADDRESS, OUT_ADDRESS + ACC_INT_COUNT_LENGTH);
+    regmap_setVolatile(&regmap, SYSMOD_ADDRESS, 2);
+    regmap_setVolatile(&regmap, PL_STATUS_ADDRESS, 1);
+    regmap_setVolatile(&regmap, FF_MT_SRC_ADDRESS, 1);
+    regmap_setVolatile(&regmap, TRANSIENT_SRC_ADDR, 1);
+    regmap_setVolatile(&regmap, PULSE_SRC_ADDRESS, 1);
+
+    /* one read caches CTRL_REG1 to CTRL_REG5 so later bursts can cover them */
+    regmap_refresh(&regmap, CTRL_REG1_ADDRESS, CTRL_REG5_ADDRESS - CTRL_REG1_ADDRESS + 1);
 
     reg1.ACTIVE = 1;
     reg1.F_READ = 0;
@@ -128,11 +369,13 @@ void mma8451_setDataRate(mma8451_DR_t rate)
 
 extern void mma8451_setCtrlReg1(mma8451_ctrlReg1_t reg)
 {
-    uint8_t *pTmp = (uint8_t*)&reg;
-
+    /* F_READ changes the sample length of a drain */
     xSemaphoreTake(xMutexAcc, portMAX_DELAY);
     reg1 = reg;
-    writeRegWithActiveLow(CTRL_REG1_ADDRESS, *pTmp);
+
+    if (!configDeferred)
+        commit();
+
     xSemaphoreGive(xMutexAcc);
 }
 
@@ -140,32 +383,206 @@ extern void mma8451_setCtrlReg4(mma8451_ctrlReg4_t reg4)
 {
     uint8_t *pTmp = (uint8_t*)&reg4;
 
-    xSemaphoreTake(xMutexAcc, portMAX_DELAY);
-    writeRegWithActiveLow(CTRL_REG4_ADDRESS, *pTmp);
-    xSemaphoreGive(xMutexAcc);
+    writeCtrlReg(CTRL_REG4_ADDRESS, *pTmp);
 }
 
 extern void mma8451_setCtrlReg5(mma8451_ctrlReg5_t reg5)
 {
     uint8_t *pTmp = (uint8_t*)&reg5;
 
+    writeCtrlReg(CTRL_REG5_ADDRESS, *pTmp);
+}
+
+extern void mma8451_setFifo(mma8451_fifoMode_t mode, uint8_t watermark)
+{
+    if (watermark > MMA8451_FIFO_SIZE)
+        watermark = MMA8451_FIFO_SIZE;
+
+    /* changed with the register, a drain never sees one without the other */
+    xSemaphoreTake(xMutexAcc, portMAX_DELAY);
+    fifoEnabled = (mode != MMA8451_FIFO_DISABLED);
+    fifoWatermark = (mode == MMA8451_FIFO_DISABLED) ? 0 : watermark;
+    setCtrlReg(F_SETUP_ADDRESS, (mode << F_SETUP_MODE_SHIFT) | watermark);
+    xSemaphoreGive(xMutexAcc);
+}
+
+extern void mma8451_configBegin(void)
+{
     xSemaphoreTake(xMutexAcc, portMAX_DELAY);
-    writeRegWithActiveLow(CTRL_REG5_ADDRESS, *pTmp);
+    configDeferred = true;
     xSemaphoreGive(xMutexAcc);
 }
 
+extern void mma8451_configEnd(void)
+{
+    xSemaphoreTake(xMutexAcc, portMAX_DELAY);
+    configDeferred = false;
+    commit();
+    xSemaphoreGive(xMutexAcc);
+}
+
+extern void mma8451_setFastRead(bool fastRead)
+{
+    reg1.F_READ = fastRead;
+
+    mma8451_setCtrlReg1(reg1);
+}
+
 extern mma8451_accIntCount_t mma8451_getAccIntCount(void)
 {
     mma8451_accIntCount_t ret;
     uint8_t buf[ACC_INT_COUNT_LENGTH];
+    bool fastRead;
+
+    xSemaphoreTake(xMutexAcc, portMAX_DELAY);
+    fastRead = reg1.F_READ;
+    regmap_readBulk(&regmap, OUT_ADDRESS, buf, sampleLength());
+    xSemaphoreGive(xMutexAcc);
+
+    mma8451_convert(&ret.accX, buf, 1, fastRead);
+
+    return ret;
+}
+
+extern int32_t mma8451_readFifo(mma8451_accIntCount_t *pBuf, int32_t max)
+{
+    return readFifo(pBuf, max, false);
+}
+
+extern int32_t mma8451_readFifoRaw(uint8_t *pRaw, int32_t max)
+{
+    int32_t count;
+
+    xSemaphoreTake(xMutexAcc, portMAX_DELAY);
+    count = drain(max, false);
+    memcpy(pRaw, &fifoBuf[1], count * sampleLength());
+    xSemaphoreGive(xMutexAcc);
+
+    return count;
+}
+
+extern void mma8451_convert(int16_t *pXyz, uint8_t const *pRaw, int32_t samples,
+        bool fastRead)
+{
+    int32_t n = samples * 3;
+
+    if (fastRead)
+    {
+        /* MSB to the 14 bit count scale */
+        while (n--)
+            *pXyz++ = (int8_t)*pRaw++ * 64;
+    }
+    else
+    {
+        while (n--)
+        {
+            *pXyz++ = (int16_t)(pRaw[0] << 8 | pRaw[1]) >> 2;
+            pRaw += 2;
+        }
+    }
+}
+
+extern void mma8451_streamStart(efHal_gpio_id_t intPin, bool int1,
+        uint8_t watermark, UBaseType_t priority)
+{
+    if (watermark < 1)
+        watermark = 1;
+    if (watermark > MMA8451_FIFO_SIZE)
+        watermark = MMA8451_FIFO_SIZE;
+
+    streamWatermark = watermark;
+    streamIrq = xSemaphoreCreateBinary();
+    wrIdx = 0;
+    pSubs = NULL;
+
+    mma8451_configBegin();
+    mma8451_setFifo(MMA8451_FIFO_CIRCULAR, watermark);
 
     xSemaphoreTake(xMutexAcc, portMAX_DELAY);
-    mma8451_read_regs(OUT_ADDRESS, buf, ACC_INT_COUNT_LENGTH);
+    regmap_update(&regmap, CTRL_REG4_ADDRESS, INT_FIFO_MASK, INT_FIFO_MASK);
+    regmap_update(&regmap, CTRL_REG5_ADDRESS, INT_FIFO_MASK, int1 ? INT_FIFO_MASK : 0);
     xSemaphoreGive(xMutexAcc);
 
-    ret.accX = ((int16_t)((int16_t)buf[0]<<8 | buf[1])) >> 2;
-    ret.accY = ((int16_t)((int16_t)buf[2]<<8 | buf[3])) >> 2;
-    ret.accZ = ((int16_t)((int16_t)buf[4]<<8 | buf[5])) >> 2;
+    mma8451_configEnd();
+
+    efHal_gpio_setCallBackInt(intPin, streamIntCallback);
+    efHal_gpio_confInt(intPin, EF_HAL_GPIO_INT_TYPE_FALLING_EDGE);
+
+    xTaskCreate(streamTask, "mma8451", MMA8451_STREAM_TASK_STACK, NULL, priority, NULL);
+}
+
+extern void mma8451_streamSubscribe(mma8451_streamSub_t *sub)
+{
+    sub->lost = 0;
+    sub->newData = xSemaphoreCreateBinary();
+
+    vTaskSuspendAll();
+    sub->rdIdx = wrIdx;
+    sub->pNext = pSubs;
+    pSubs = sub;
+    xTaskResumeAll();
+}
+
+extern int32_t mma8451_streamRead(mma8451_streamSub_t *sub,
+        mma8451_sample_t *pBuf, int32_t max, TickType_t blockTime)
+{
+    uint32_t w, avail;
+    int32_t n, i, over;
+
+    w = wrIdx;
+
+    while (w == sub->rdIdx && xSemaphoreTake(sub->newData, blockTime) == pdTRUE)
+        w = wrIdx;
+
+    avail = w - sub->rdIdx;
+
+    /* the slot of w may be in use by the stream task, see below */
+    if (avail > MMA8451_STREAM_RING - 1)
+    {
+        sub->lost += avail - (MMA8451_STREAM_RING - 1);
+        sub->rdIdx = w - (MMA8451_STREAM_RING - 1);
+        avail = MMA8451_STREAM_RING - 1;
+    }
+
+    n = (avail < (uint32_t)max) ? (int32_t)avail : max;
+
+    for (i = 0 ; i < n ; i++)
+        pBuf[i] = ring[(sub->rdIdx + i) & RING_MASK];
+
+    COMPILER_BARRIER();
+
+    /* slots the stream task reused while they were copied. The slot of
+     * wrIdx is being written before wrIdx moves, so the oldest one still
+     * valid is wrIdx + 1 - MMA8451_STREAM_RING */
+    w = wrIdx;
+    over = (int32_t)(w + 1 - MMA8451_STREAM_RING - sub->rdIdx);
+
+    if (over > n)
+        over = n;
+
+    if (over > 0)
+    {
+        for (i = over ; i < n ; i++)
+            pBuf[i - over] = pBuf[i];
+
+        sub->lost += over;
+        n -= over;
+        sub->rdIdx += over;
+    }
+
+    sub->rdIdx += n;
+
+    return n;
+}
+
+extern bool mma8451_getFifoOverflow(void)
+{
+    bool ret;
+
+    xSemaphoreTake(xMutexAcc, portMAX_DELAY);
+    ret = fifoOverflow;
+    fifoOverflow = false;
+    xSemaphoreGive(xMutexAcc);
 
     return ret;
 }
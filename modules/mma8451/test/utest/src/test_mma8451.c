@@ -0,0 +1,538 @@
+/*
+###############################################################################
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "unity.h"
+#include "mma8451.h"
+#include "efHal_i2c.h"
+#include "efHal_spi.h"
+#include "string.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define TOTAL_REGS          0x32
+#define F_SETUP             0x09
+#define CTRL_REG1           0x2A
+#define CTRL_REG1_ACTIVE    0x01
+#define CTRL_REG1_F_READ    0x02
+#define CTRL_REG1_DR_SHIFT  3
+#define CTRL_REG1_DR_MASK   0x38
+
+#define INT_PIN             7
+#define WATERMARK           4
+#define PERIOD_US           10000       /* MMA8451_DR_100hz */
+#define BLOCK_TIME          pdMS_TO_TICKS(1000)
+#define KEPT                (MMA8451_STREAM_RING - 1)   /* unread samples a reader keeps */
+
+/* the device on the other side of the bus, samples are n, -n, 1000 + n */
+typedef struct
+{
+    uint8_t regs[TOTAL_REGS];
+    int16_t fifo[MMA8451_FIFO_SIZE];
+    int32_t count;
+    bool overflow;
+    int16_t next;               /* value of the next sample */
+    int32_t reads;              /* bus transactions */
+    int32_t writes;
+    int32_t rejected;           /* bytes written while active, ignored */
+    size_t lastSize;
+    int32_t overrun;            /* samples read from an empty FIFO */
+    int32_t arriveOnRead;       /* samples queued after F_STATUS is sent */
+}fakeDev_t;
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static fakeDev_t dev;
+static mma8451_accIntCount_t buf[MMA8451_FIFO_SIZE];
+
+/* the stream can't be stopped, the tests using it run last and share it */
+static bool streaming;
+static efHal_gpio_callBackInt_t intCb;
+static mma8451_sample_t samples[2 * MMA8451_STREAM_RING];
+
+/*==================[external data definition]===============================*/
+
+volatile uint32_t fakeTimestamp;
+
+/*==================[internal functions definition]==========================*/
+
+static void push(int32_t n)
+{
+    while (n--)
+    {
+        if (dev.count == MMA8451_FIFO_SIZE)
+        {
+            /* circular: the oldest one is dropped */
+            memmove(&dev.fifo[0], &dev.fifo[1], sizeof(dev.fifo) - sizeof(dev.fifo[0]));
+            dev.count--;
+            dev.overflow = true;
+        }
+
+        dev.fifo[dev.count++] = dev.next++;
+    }
+}
+
+static int16_t pop(void)
+{
+    int16_t v = dev.fifo[0];
+
+    if (dev.count == 0)
+    {
+        dev.overrun++;
+        return 0;
+    }
+
+    memmove(&dev.fifo[0], &dev.fifo[1], sizeof(dev.fifo) - sizeof(dev.fifo[0]));
+    dev.count--;
+
+    return v;
+}
+
+/* a sample on the bus, 14 bits left aligned MSB first or MSBs only */
+static uint8_t *putSample(uint8_t *p, int16_t v, bool fastRead)
+{
+    int16_t xyz[3] = {v, -v, 1000 + v};
+    int i;
+
+    for (i = 0 ; i < 3 ; i++)
+    {
+        *p++ = (uint16_t)(xyz[i] << 2) >> 8;
+
+        if (!fastRead)
+            *p++ = (uint16_t)(xyz[i] << 2) & 0xFF;
+    }
+
+    return p;
+}
+
+/* sample k is taken at (k + 1) * PERIOD_US, the clock is left at the last */
+static void pushAt(int32_t n)
+{
+    push(n);
+    fakeTimestamp = dev.next * PERIOD_US;
+}
+
+/* the stream numbers the samples as the device: seq is the value of X */
+static void checkStream(int32_t n)
+{
+    int32_t i;
+
+    for (i = 0 ; i < n ; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(samples[i].acc.accX, samples[i].seq);
+        TEST_ASSERT_EQUAL_UINT32((samples[i].seq + 1) * PERIOD_US, samples[i].timestamp);
+
+        if (i > 0)
+            TEST_ASSERT_EQUAL_UINT32(samples[i - 1].seq + 1, samples[i].seq);
+    }
+
+    TEST_ASSERT_EQUAL_INT32(0, dev.overrun);
+}
+
+static void startStream(void)
+{
+    if (streaming)
+        return;
+
+    mma8451_setDataRate(MMA8451_DR_100hz);
+    mma8451_streamStart(INT_PIN, true, WATERMARK, 2);
+    TEST_ASSERT_NOT_NULL(intCb);
+
+    streaming = true;
+}
+
+static void checkSamples(int16_t first, int32_t n)
+{
+    int32_t i;
+
+    for (i = 0 ; i < n ; i++)
+    {
+        TEST_ASSERT_EQUAL_INT16(first + i, buf[i].accX);
+        TEST_ASSERT_EQUAL_INT16(-(first + i), buf[i].accY);
+        TEST_ASSERT_EQUAL_INT16(1000 + first + i, buf[i].accZ);
+    }
+}
+
+/*==================[external functions definition]==========================*/
+
+efHal_i2c_ec_t efHal_i2c_transferSeg(efHal_dh_t dh, efHal_i2c_devAdd_t da, efHal_i2c_seg_t const *pSeg, int32_t nSeg)
+{
+    uint8_t reg = *(uint8_t *)pSeg[0].pBuf;
+    uint8_t const *pData = pSeg[1].pBuf;
+    size_t i;
+
+    TEST_ASSERT_EQUAL_INT32(2, nSeg);
+    dev.writes++;
+
+    /* while active only ACTIVE itself can be changed */
+    for (i = 0 ; i < pSeg[1].size ; i++, reg++)
+    {
+        if ((dev.regs[CTRL_REG1] & CTRL_REG1_ACTIVE) &&
+            (reg != CTRL_REG1 || ((pData[i] ^ dev.regs[reg]) & ~CTRL_REG1_ACTIVE)))
+            dev.rejected++;
+        else
+            dev.regs[reg] = pData[i];
+    }
+
+    return EF_HAL_I2C_EC_NO_ERROR;
+}
+
+efHal_i2c_ec_t efHal_i2c_transfer(efHal_dh_t dh, efHal_i2c_devAdd_t da, void *pTx, size_t sTx, void *pRx, size_t sRx)
+{
+    uint8_t reg = *(uint8_t *)pTx;
+    bool fastRead = dev.regs[CTRL_REG1] & CTRL_REG1_F_READ;
+    size_t length = fastRead ? 3 : 6;
+    uint8_t *p = pRx;
+
+    dev.reads++;
+    dev.lastSize = sRx;
+
+    /* with the FIFO on, STATUS is F_STATUS and the data address wraps */
+    if ((dev.regs[F_SETUP] >> 6) == 0 || reg > 1)
+    {
+        memcpy(pRx, &dev.regs[reg], sRx);
+        return EF_HAL_I2C_EC_NO_ERROR;
+    }
+
+    if (reg == 0)
+    {
+        *p++ = (dev.overflow ? 0x80 : 0) | dev.count;
+        dev.overflow = false;
+        sRx--;
+    }
+
+    push(dev.arriveOnRead);
+    dev.arriveOnRead = 0;
+
+    TEST_ASSERT_EQUAL_UINT32(0, sRx % length);
+
+    for ( ; sRx > 0 ; sRx -= length)
+        p = putSample(p, pop(), fastRead);
+
+    return EF_HAL_I2C_EC_NO_ERROR;
+}
+
+void efHal_spi_transaction(efHal_dh_t dh, efHal_spi_seg_t const *pSeg, int32_t nSeg)
+{
+    TEST_FAIL_MESSAGE("the device is on I2C");
+}
+
+void efHal_gpio_confPin(efHal_gpio_id_t id, efHal_gpio_dir_t dir, efHal_gpio_pull_t pull, bool state)
+{
+}
+
+void efHal_gpio_setCallBackInt(efHal_gpio_id_t id, efHal_gpio_callBackInt_t cb)
+{
+    TEST_ASSERT_EQUAL_INT32(INT_PIN, id);
+    intCb = cb;
+}
+
+void efHal_gpio_confInt(efHal_gpio_id_t id, efHal_gpio_intType_t intType)
+{
+}
+
+void setUp(void)
+{
+    if (streaming)
+        return;
+
+    memset(&dev, 0, sizeof(dev));
+    memset(buf, 0, sizeof(buf));
+
+    mma8451_init(NULL);
+}
+
+void tearDown(void)
+{
+}
+
+void test_mma8451_readFifo_disabled(void)
+{
+    dev.reads = 0;
+
+    /* STATUS is not F_STATUS, nothing is read */
+    TEST_ASSERT_EQUAL_INT32(0, mma8451_readFifo(buf, MMA8451_FIFO_SIZE));
+    TEST_ASSERT_EQUAL_INT32(0, dev.reads);
+}
+
+void test_mma8451_readFifo_polling(void)
+{
+    mma8451_setFifo(MMA8451_FIFO_CIRCULAR, 20);
+    push(5);
+    dev.reads = 0;
+
+    /* below the watermark: F_STATUS alone, then the queued samples */
+    TEST_ASSERT_EQUAL_INT32(5, mma8451_readFifo(buf, MMA8451_FIFO_SIZE));
+    TEST_ASSERT_EQUAL_INT32(2, dev.reads);
+    TEST_ASSERT_EQUAL_UINT32(5 * 6, dev.lastSize);
+    TEST_ASSERT_EQUAL_INT32(0, dev.overrun);
+    checkSamples(0, 5);
+
+    /* empty, only F_STATUS */
+    dev.reads = 0;
+    TEST_ASSERT_EQUAL_INT32(0, mma8451_readFifo(buf, MMA8451_FIFO_SIZE));
+    TEST_ASSERT_EQUAL_INT32(1, dev.reads);
+}
+
+void test_mma8451_readFifo_keepsArrivingSamples(void)
+{
+    mma8451_setFifo(MMA8451_FIFO_CIRCULAR, 20);
+    push(3);
+    dev.arriveOnRead = 1;
+
+    /* a sample queued during the read stays in the FIFO for the next one */
+    TEST_ASSERT_EQUAL_INT32(3, mma8451_readFifo(buf, MMA8451_FIFO_SIZE));
+    checkSamples(0, 3);
+    TEST_ASSERT_EQUAL_INT32(1, mma8451_readFifo(buf, MMA8451_FIFO_SIZE));
+    checkSamples(3, 1);
+    TEST_ASSERT_EQUAL_INT32(0, dev.overrun);
+}
+
+void test_mma8451_readFifo_max(void)
+{
+    mma8451_setFifo(MMA8451_FIFO_CIRCULAR, 0);
+    push(10);
+
+    TEST_ASSERT_EQUAL_INT32(4, mma8451_readFifo(buf, 4));
+    checkSamples(0, 4);
+    TEST_ASSERT_EQUAL_INT32(6, mma8451_readFifo(buf, MMA8451_FIFO_SIZE));
+    checkSamples(4, 6);
+}
+
+void test_mma8451_readFifo_fastRead(void)
+{
+    mma8451_setFifo(MMA8451_FIFO_CIRCULAR, 20);
+    mma8451_setFastRead(true);
+    dev.next = 64;
+    push(4);
+    dev.reads = 0;
+
+    /* 3 bytes per sample, the LSBs are lost */
+    TEST_ASSERT_EQUAL_INT32(4, mma8451_readFifo(buf, MMA8451_FIFO_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(4 * 3, dev.lastSize);
+    TEST_ASSERT_EQUAL_INT16(64, buf[0].accX);
+    TEST_ASSERT_EQUAL_INT16(64, buf[3].accX);
+    TEST_ASSERT_EQUAL_INT16(-128, buf[3].accY);
+}
+
+void test_mma8451_readFifo_overflow(void)
+{
+    mma8451_setFifo(MMA8451_FIFO_CIRCULAR, 20);
+    push(40);
+
+    TEST_ASSERT_EQUAL_INT32(MMA8451_FIFO_SIZE, mma8451_readFifo(buf, MMA8451_FIFO_SIZE));
+    checkSamples(8, MMA8451_FIFO_SIZE);
+    TEST_ASSERT_TRUE(mma8451_getFifoOverflow());
+    TEST_ASSERT_FALSE(mma8451_getFifoOverflow());
+}
+
+void test_mma8451_readFifoRaw(void)
+{
+    uint8_t raw[6 * 2];
+    uint8_t expected[6 * 2];
+
+    mma8451_setFifo(MMA8451_FIFO_FILL, 0);
+    dev.next = 7;
+    push(2);
+    putSample(putSample(expected, 7, false), 8, false);
+
+    TEST_ASSERT_EQUAL_INT32(2, mma8451_readFifoRaw(raw, 2));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, raw, sizeof(raw));
+}
+
+void test_mma8451_config_writes(void)
+{
+    uint8_t ctrl1 = dev.regs[CTRL_REG1] & ~CTRL_REG1_DR_MASK;
+
+    /* init leaves it active at 12.5 Hz */
+    TEST_ASSERT_EQUAL_HEX8(CTRL_REG1_ACTIVE | (MMA8451_DR_12p5hz << CTRL_REG1_DR_SHIFT),
+            dev.regs[CTRL_REG1] & (CTRL_REG1_ACTIVE | CTRL_REG1_DR_MASK));
+    dev.writes = 0;
+
+    mma8451_configBegin();
+    mma8451_setDataRate(MMA8451_DR_100hz);
+    mma8451_setFifo(MMA8451_FIFO_CIRCULAR, WATERMARK);
+    TEST_ASSERT_EQUAL_INT32(0, dev.writes);
+    mma8451_configEnd();
+
+    /* standby, F_SETUP, CTRL_REG1 with the new rate and ACTIVE */
+    TEST_ASSERT_EQUAL_INT32(3, dev.writes);
+    TEST_ASSERT_EQUAL_INT32(0, dev.rejected);
+    TEST_ASSERT_EQUAL_HEX8((MMA8451_FIFO_CIRCULAR << 6) | WATERMARK, dev.regs[F_SETUP]);
+    TEST_ASSERT_EQUAL_HEX8(ctrl1 | (MMA8451_DR_100hz << CTRL_REG1_DR_SHIFT), dev.regs[CTRL_REG1]);
+
+    /* nothing changes, nothing is written */
+    mma8451_configBegin();
+    mma8451_setDataRate(MMA8451_DR_100hz);
+    mma8451_setFifo(MMA8451_FIFO_CIRCULAR, WATERMARK);
+    mma8451_configEnd();
+    TEST_ASSERT_EQUAL_INT32(3, dev.writes);
+}
+
+void test_mma8451_config_immediate(void)
+{
+    uint8_t ctrl1 = dev.regs[CTRL_REG1];
+
+    dev.writes = 0;
+
+    /* each setter goes through standby on its own */
+    mma8451_setFifo(MMA8451_FIFO_CIRCULAR, WATERMARK);
+    TEST_ASSERT_EQUAL_INT32(3, dev.writes);
+
+    mma8451_setFastRead(true);
+    TEST_ASSERT_EQUAL_INT32(5, dev.writes);
+
+    TEST_ASSERT_EQUAL_INT32(0, dev.rejected);
+    TEST_ASSERT_EQUAL_HEX8((MMA8451_FIFO_CIRCULAR << 6) | WATERMARK, dev.regs[F_SETUP]);
+    TEST_ASSERT_EQUAL_HEX8(ctrl1 | CTRL_REG1_F_READ, dev.regs[CTRL_REG1]);
+}
+
+void test_mma8451_stream_stampsFromInterrupt(void)
+{
+    static mma8451_streamSub_t sub;
+
+    startStream();
+    mma8451_streamSubscribe(&sub);
+
+    pushAt(WATERMARK);
+    dev.reads = 0;
+    intCb(INT_PIN);
+
+    /* the task runs late, the stamps don't move */
+    fakeTimestamp += 7000;
+
+    TEST_ASSERT_EQUAL_INT32(WATERMARK, mma8451_streamRead(&sub, samples, MMA8451_STREAM_RING, BLOCK_TIME));
+    TEST_ASSERT_EQUAL_UINT32(0, samples[0].seq);
+    checkStream(WATERMARK);
+
+    /* F_STATUS and the watermark in one burst */
+    TEST_ASSERT_EQUAL_INT32(1, dev.reads);
+    TEST_ASSERT_EQUAL_UINT32(1 + WATERMARK * 6, dev.lastSize);
+    TEST_ASSERT_EQUAL_UINT32(0, sub.lost);
+}
+
+void test_mma8451_stream_beyondWatermark(void)
+{
+    static mma8451_streamSub_t sub;
+
+    mma8451_streamSubscribe(&sub);
+
+    /* 3 more samples queued before the task reads */
+    pushAt(WATERMARK);
+    intCb(INT_PIN);
+    pushAt(3);
+    dev.reads = 0;
+
+    TEST_ASSERT_EQUAL_INT32(WATERMARK + 3, mma8451_streamRead(&sub, samples, MMA8451_STREAM_RING, BLOCK_TIME));
+    TEST_ASSERT_EQUAL_UINT32(WATERMARK, samples[0].seq);
+    checkStream(WATERMARK + 3);
+    TEST_ASSERT_EQUAL_INT32(2, dev.reads);
+}
+
+void test_mma8451_stream_gapAfterMissedInterrupt(void)
+{
+    static mma8451_streamSub_t sub;
+
+    mma8451_streamSubscribe(&sub);
+
+    /* no edge, the FIFO overflows until the timeout drains it. The stamps
+     * and seq go on after the samples lost */
+    pushAt(MMA8451_FIFO_SIZE + 8);
+    fakeTimestamp += 3000;
+
+    TEST_ASSERT_EQUAL_INT32(KEPT, mma8451_streamRead(&sub, samples, 2 * MMA8451_STREAM_RING, BLOCK_TIME));
+    checkStream(KEPT);
+    TEST_ASSERT_EQUAL_UINT32(dev.next - 1, samples[KEPT - 1].seq);
+
+    /* the ring kept the newest of the 32 samples delivered */
+    TEST_ASSERT_EQUAL_UINT32(MMA8451_FIFO_SIZE - KEPT, sub.lost);
+}
+
+void test_mma8451_stream_gapAfterLateTask(void)
+{
+    static mma8451_streamSub_t sub;
+
+    mma8451_streamSubscribe(&sub);
+
+    /* the interrupt came at the watermark, the FIFO overflowed after it */
+    pushAt(WATERMARK);
+    intCb(INT_PIN);
+    pushAt(MMA8451_FIFO_SIZE + 4);
+    fakeTimestamp += 2000;
+
+    TEST_ASSERT_EQUAL_INT32(KEPT, mma8451_streamRead(&sub, samples, 2 * MMA8451_STREAM_RING, BLOCK_TIME));
+    checkStream(KEPT);
+    TEST_ASSERT_EQUAL_UINT32(dev.next - 1, samples[KEPT - 1].seq);
+}
+
+void test_mma8451_stream_ring(void)
+{
+    static mma8451_streamSub_t fast;
+    static mma8451_streamSub_t slow;
+    int32_t block;
+
+    mma8451_streamSubscribe(&fast);
+    mma8451_streamSubscribe(&slow);
+
+    /* nothing before subscribing */
+    TEST_ASSERT_EQUAL_INT32(0, mma8451_streamRead(&slow, samples, 2 * MMA8451_STREAM_RING, 0));
+
+    /* slow reads once every 5 blocks, 20 samples: the 5 oldest are lost */
+    for (block = 0 ; block < 5 ; block++)
+    {
+        pushAt(WATERMARK);
+        intCb(INT_PIN);
+        TEST_ASSERT_EQUAL_INT32(WATERMARK, mma8451_streamRead(&fast, samples, 2 * MMA8451_STREAM_RING, BLOCK_TIME));
+        checkStream(WATERMARK);
+    }
+
+    TEST_ASSERT_EQUAL_INT32(KEPT, mma8451_streamRead(&slow, samples, 2 * MMA8451_STREAM_RING, 0));
+    checkStream(KEPT);
+    TEST_ASSERT_EQUAL_UINT32(dev.next - 1, samples[KEPT - 1].seq);
+    TEST_ASSERT_EQUAL_UINT32(5 * WATERMARK - KEPT, slow.lost);
+    TEST_ASSERT_EQUAL_UINT32(0, fast.lost);
+
+    /* less than the ring, nothing lost */
+    pushAt(WATERMARK);
+    intCb(INT_PIN);
+    TEST_ASSERT_EQUAL_INT32(WATERMARK, mma8451_streamRead(&fast, samples, 2 * MMA8451_STREAM_RING, BLOCK_TIME));
+    TEST_ASSERT_EQUAL_INT32(WATERMARK, mma8451_streamRead(&slow, samples, 2 * MMA8451_STREAM_RING, 0));
+    checkStream(WATERMARK);
+    TEST_ASSERT_EQUAL_UINT32(5 * WATERMARK - KEPT, slow.lost);
+}
+
+/*==================[end of file]============================================*/
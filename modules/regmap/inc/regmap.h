@@ -0,0 +1,135 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+#ifndef REGMAP_H_
+#define REGMAP_H_
+
+/*==================[inclusions]=============================================*/
+#include "efHal_i2c.h"
+#include "efHal_spi.h"
+#include "efHal_gpio.h"
+#include "stdbool.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros and typedef]=====================================*/
+
+typedef enum
+{
+    REGMAP_BUS_I2C = 0,
+    REGMAP_BUS_SPI,
+}regmap_bus_t;
+
+typedef struct
+{
+    regmap_bus_t bus;
+    efHal_dh_t dh;
+    efHal_i2c_devAdd_t da;          /* I2C device address */
+    efHal_gpio_id_t cs;             /* SPI chip select (active low) or EF_HAL_INVALID_ID */
+    uint8_t spiReadFlag;            /* or'ed to the address on SPI reads, e.g. 0x80 */
+    uint8_t spiWriteFlag;           /* or'ed to the address on SPI writes */
+    uint8_t firstReg;
+    uint16_t numRegs;
+    bool fillGaps;                  /* a burst can rewrite clean cached registers
+                                       between dirty ones */
+}regmap_conf_t;
+
+typedef struct
+{
+    regmap_conf_t conf;
+    uint8_t *pCache;                /* numRegs bytes */
+    uint8_t *pFlags;                /* numRegs bytes */
+    uint32_t busWrites;             /* bus transactions, for profiling */
+    uint32_t busReads;
+}regmap_t;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+
+/** \brief initializes a register map, all registers start non-volatile
+ ** and not cached
+ **
+ ** \param pCache storage for the shadow, conf->numRegs bytes
+ ** \param pFlags storage for the register flags, conf->numRegs bytes
+ **/
+extern void regmap_init(regmap_t *map, regmap_conf_t const *conf, uint8_t *pCache, uint8_t *pFlags);
+
+/** \brief marks registers changed by the device, never read from cache */
+extern void regmap_setVolatile(regmap_t *map, uint8_t reg, uint16_t count);
+
+/** \brief sets a register in the shadow, written on regmap_sync
+ **
+ ** Nothing is written if the cached value is already the same.
+ **/
+extern void regmap_write(regmap_t *map, uint8_t reg, uint8_t value);
+
+/** \brief read-modify-write of the bits in mask, from the cache if possible */
+extern bool regmap_update(regmap_t *map, uint8_t reg, uint8_t mask, uint8_t value);
+
+extern bool regmap_isDirty(regmap_t const *map);
+
+/** \brief writes the dirty registers, adjacent ones in one burst
+ **
+ ** \return false on bus error, failed registers remain dirty
+ **/
+extern bool regmap_sync(regmap_t *map);
+
+/** \brief as regmap_sync, only for the dirty registers in count registers
+ ** from reg, e.g. a control register that must be written before others
+ **/
+extern bool regmap_syncRange(regmap_t *map, uint8_t reg, uint16_t count);
+
+/** \brief reads a register, from the cache if it is non-volatile and cached */
+extern bool regmap_read(regmap_t *map, uint8_t reg, uint8_t *pValue);
+
+/** \brief reads size consecutive registers from the device in one burst */
+extern bool regmap_readBulk(regmap_t *map, uint8_t reg, uint8_t *pBuf, size_t size);
+
+/** \brief syncs and reloads the shadow of count registers from the device */
+extern bool regmap_refresh(regmap_t *map, uint8_t reg, uint16_t count);
+
+/** \brief forgets cached values, e.g. after a device reset */
+extern void regmap_invalidate(regmap_t *map);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+/*==================[end of file]============================================*/
+#endif /* REGMAP_H_ */
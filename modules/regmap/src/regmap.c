@@ -0,0 +1,318 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "regmap.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define FLAG_VOLATILE   0x01
+#define FLAG_VALID      0x02
+#define FLAG_DIRTY      0x04
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+static bool checkRange(regmap_t const *map, uint8_t reg, uint16_t count)
+{
+    bool ret = reg >= map->conf.firstReg &&
+               reg - map->conf.firstReg + count <= map->conf.numRegs;
+
+    if (!ret)
+        efErrorHdl_error(EF_ERROR_HDL_INVALID_PARAMETER, "reg");
+
+    return ret;
+}
+
+/* CS, address and data in one transaction: the bus is taken once, so no
+ * other device can get in between while CS is asserted */
+static void spiAccess(regmap_t *map, uint8_t reg, void *pTx, void *pRx, size_t size)
+{
+    efHal_spi_seg_t seg[3];
+
+    seg[0].pTx = &reg;
+    seg[0].pRx = NULL;
+    seg[0].length = sizeof(reg);
+    seg[0].gpio = map->conf.cs;
+    seg[0].gpioState = 0;
+
+    seg[1].pTx = pTx;
+    seg[1].pRx = pRx;
+    seg[1].length = size;
+    seg[1].gpio = EF_HAL_INVALID_ID;
+
+    seg[2].pTx = NULL;
+    seg[2].pRx = NULL;
+    seg[2].length = 0;
+    seg[2].gpio = map->conf.cs;
+    seg[2].gpioState = 1;
+
+    efHal_spi_transaction(map->conf.dh, seg, 3);
+}
+
+static bool busWrite(regmap_t *map, uint8_t reg, uint8_t const *pData, size_t size)
+{
+    efHal_i2c_seg_t seg[2];
+    bool ret = true;
+
+    map->busWrites++;
+
+    if (map->conf.bus == REGMAP_BUS_I2C)
+    {
+        /* address and data are sent from where they are, no staging copy */
+        seg[0].dir = EF_HAL_I2C_DIR_WRITE;
+        seg[0].flags = 0;
+        seg[0].pBuf = &reg;
+        seg[0].size = sizeof(reg);
+
+        seg[1].dir = EF_HAL_I2C_DIR_WRITE;
+        seg[1].flags = EF_HAL_I2C_SEG_FLAG_NO_START;
+        seg[1].pBuf = (void *)pData;
+        seg[1].size = size;
+
+        ret = efHal_i2c_transferSeg(map->conf.dh, map->conf.da, seg, 2) == EF_HAL_I2C_EC_NO_ERROR;
+    }
+    else
+    {
+        spiAccess(map, reg | map->conf.spiWriteFlag, (void *)pData, NULL, size);
+    }
+
+    return ret;
+}
+
+static bool busRead(regmap_t *map, uint8_t reg, uint8_t *pBuf, size_t size)
+{
+    bool ret = true;
+
+    map->busReads++;
+
+    if (map->conf.bus == REGMAP_BUS_I2C)
+    {
+        ret = efHal_i2c_transfer(map->conf.dh, map->conf.da, &reg, sizeof(reg), pBuf, size) == EF_HAL_I2C_EC_NO_ERROR;
+    }
+    else
+    {
+        spiAccess(map, reg | map->conf.spiReadFlag, NULL, pBuf, size);
+    }
+
+    return ret;
+}
+
+/*==================[external functions definition]==========================*/
+
+extern void regmap_init(regmap_t *map, regmap_conf_t const *conf, uint8_t *pCache, uint8_t *pFlags)
+{
+    int i;
+
+    map->conf = *conf;
+    map->pCache = pCache;
+    map->pFlags = pFlags;
+    map->busWrites = 0;
+    map->busReads = 0;
+
+    for (i = 0 ; i < conf->numRegs ; i++)
+        pFlags[i] = 0;
+
+    if (conf->bus == REGMAP_BUS_SPI && conf->cs != EF_HAL_INVALID_ID)
+        efHal_gpio_confPin(conf->cs, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
+}
+
+extern void regmap_setVolatile(regmap_t *map, uint8_t reg, uint16_t count)
+{
+    int i;
+
+    if (checkRange(map, reg, count))
+    {
+        for (i = reg - map->conf.firstReg ; count-- ; i++)
+            map->pFlags[i] = FLAG_VOLATILE;
+    }
+}
+
+extern void regmap_write(regmap_t *map, uint8_t reg, uint8_t value)
+{
+    int i = reg - map->conf.firstReg;
+
+    if (checkRange(map, reg, 1))
+    {
+        if ((map->pFlags[i] & (FLAG_VALID | FLAG_VOLATILE)) != FLAG_VALID ||
+            map->pCache[i] != value)
+        {
+            map->pCache[i] = value;
+            map->pFlags[i] |= FLAG_DIRTY;
+        }
+    }
+}
+
+extern bool regmap_update(regmap_t *map, uint8_t reg, uint8_t mask, uint8_t value)
+{
+    uint8_t tmp;
+    bool ret;
+
+    ret = regmap_read(map, reg, &tmp);
+
+    if (ret)
+        regmap_write(map, reg, (tmp & ~mask) | (value & mask));
+
+    return ret;
+}
+
+extern bool regmap_isDirty(regmap_t const *map)
+{
+    bool ret = false;
+    int i;
+
+    for (i = 0 ; i < map->conf.numRegs && !ret ; i++)
+        ret = (map->pFlags[i] & FLAG_DIRTY) != 0;
+
+    return ret;
+}
+
+extern bool regmap_sync(regmap_t *map)
+{
+    return regmap_syncRange(map, map->conf.firstReg, map->conf.numRegs);
+}
+
+extern bool regmap_syncRange(regmap_t *map, uint8_t reg, uint16_t count)
+{
+    uint8_t *pFlags = map->pFlags;
+    int i = reg - map->conf.firstReg;
+    int last;
+    int j;
+    int end;
+    bool ret = checkRange(map, reg, count);
+
+    /* a failed burst leaves its registers dirty, the others are tried */
+    last = ret ? i + count : i;
+
+    while (i < last)
+    {
+        if (!(pFlags[i] & FLAG_DIRTY))
+        {
+            i++;
+        }
+        else
+        {
+            /* extends the burst over dirty registers and, if allowed, over
+             * clean cached ones that are followed by another dirty */
+            end = i + 1;
+
+            for (j = end ; j < last ; j++)
+            {
+                if (pFlags[j] & FLAG_DIRTY)
+                    end = j + 1;
+                else if (!map->conf.fillGaps ||
+                         (pFlags[j] & (FLAG_VALID | FLAG_VOLATILE)) != FLAG_VALID)
+                    break;
+            }
+
+            if (busWrite(map, map->conf.firstReg + i, &map->pCache[i], end - i))
+            {
+                for ( ; i < end ; i++)
+                    pFlags[i] = (pFlags[i] & ~FLAG_DIRTY) | FLAG_VALID;
+            }
+            else
+            {
+                ret = false;
+                i = end;
+            }
+        }
+    }
+
+    return ret;
+}
+
+extern bool regmap_read(regmap_t *map, uint8_t reg, uint8_t *pValue)
+{
+    int i = reg - map->conf.firstReg;
+    bool ret = checkRange(map, reg, 1);
+
+    if (ret)
+    {
+        if ((map->pFlags[i] & FLAG_DIRTY) ||
+            (map->pFlags[i] & (FLAG_VALID | FLAG_VOLATILE)) == FLAG_VALID)
+        {
+            *pValue = map->pCache[i];
+        }
+        else
+        {
+            ret = busRead(map, reg, pValue, 1);
+
+            if (ret && !(map->pFlags[i] & FLAG_VOLATILE))
+            {
+                map->pCache[i] = *pValue;
+                map->pFlags[i] |= FLAG_VALID;
+            }
+        }
+    }
+
+    return ret;
+}
+
+extern bool regmap_readBulk(regmap_t *map, uint8_t reg, uint8_t *pBuf, size_t size)
+{
+    return busRead(map, reg, pBuf, size);
+}
+
+extern bool regmap_refresh(regmap_t *map, uint8_t reg, uint16_t count)
+{
+    int i = reg - map->conf.firstReg;
+    bool ret = checkRange(map, reg, count);
+
+    if (ret)
+        ret = regmap_sync(map);
+
+    if (ret)
+        ret = busRead(map, reg, &map->pCache[i], count);
+
+    for ( ; ret && count-- ; i++)
+        map->pFlags[i] |= FLAG_VALID;
+
+    return ret;
+}
+
+extern void regmap_invalidate(regmap_t *map)
+{
+    int i;
+
+    for (i = 0 ; i < map->conf.numRegs ; i++)
+        map->pFlags[i] &= FLAG_VOLATILE;
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,380 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "unity.h"
+#include "regmap.h"
+#include "string.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define NUM_REGS        0x20
+#define CS_PIN          5
+#define SPI_READ_FLAG   0x80
+
+/* the device on the other side of the bus */
+typedef struct
+{
+    uint8_t regs[NUM_REGS];
+    int32_t writes;             /* bus transactions */
+    int32_t reads;
+    uint8_t lastReg;            /* first register of the last transaction */
+    size_t lastSize;
+    bool fail;                  /* next transactions end with NAK */
+}fakeDev_t;
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static fakeDev_t dev;
+static regmap_t map;
+static uint8_t cache[NUM_REGS];
+static uint8_t flags[NUM_REGS];
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+static void initMap(regmap_bus_t bus, bool fillGaps)
+{
+    regmap_conf_t conf =
+    {
+        .bus = bus,
+        .dh = NULL,
+        .da = 0x1d,
+        .cs = CS_PIN,
+        .spiReadFlag = SPI_READ_FLAG,
+        .spiWriteFlag = 0,
+        .firstReg = 0,
+        .numRegs = NUM_REGS,
+        .fillGaps = fillGaps,
+    };
+
+    regmap_init(&map, &conf, cache, flags);
+}
+
+static void checkAccess(uint8_t reg, size_t size)
+{
+    TEST_ASSERT_EQUAL_HEX8(reg, dev.lastReg);
+    TEST_ASSERT_EQUAL_UINT32(size, dev.lastSize);
+}
+
+/*==================[external functions definition]==========================*/
+
+/* bus fakes, one call is one transaction on the wire */
+
+efHal_i2c_ec_t efHal_i2c_transferSeg(efHal_dh_t dh, efHal_i2c_devAdd_t da, efHal_i2c_seg_t const *pSeg, int32_t nSeg)
+{
+    uint8_t reg = *(uint8_t *)pSeg[0].pBuf;
+
+    TEST_ASSERT_EQUAL_INT32(2, nSeg);
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_DIR_WRITE, pSeg[0].dir);
+    TEST_ASSERT_EQUAL_UINT32(1, pSeg[0].size);
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_DIR_WRITE, pSeg[1].dir);
+    TEST_ASSERT_EQUAL_HEX8(EF_HAL_I2C_SEG_FLAG_NO_START, pSeg[1].flags);
+
+    dev.writes++;
+    dev.lastReg = reg;
+    dev.lastSize = pSeg[1].size;
+
+    if (dev.fail)
+        return EF_HAL_I2C_EC_NAK;
+
+    memcpy(&dev.regs[reg], pSeg[1].pBuf, pSeg[1].size);
+
+    return EF_HAL_I2C_EC_NO_ERROR;
+}
+
+efHal_i2c_ec_t efHal_i2c_transfer(efHal_dh_t dh, efHal_i2c_devAdd_t da, void *pTx, size_t sTx, void *pRx, size_t sRx)
+{
+    uint8_t reg = *(uint8_t *)pTx;
+
+    TEST_ASSERT_EQUAL_UINT32(1, sTx);
+
+    dev.reads++;
+    dev.lastReg = reg;
+    dev.lastSize = sRx;
+
+    if (dev.fail)
+        return EF_HAL_I2C_EC_NAK;
+
+    memcpy(pRx, &dev.regs[reg], sRx);
+
+    return EF_HAL_I2C_EC_NO_ERROR;
+}
+
+void efHal_spi_transaction(efHal_dh_t dh, efHal_spi_seg_t const *pSeg, int32_t nSeg)
+{
+    uint8_t reg = *(uint8_t *)pSeg[0].pTx;
+
+    /* CS goes low with the address and high after the data */
+    TEST_ASSERT_EQUAL_INT32(3, nSeg);
+    TEST_ASSERT_EQUAL_INT32(CS_PIN, pSeg[0].gpio);
+    TEST_ASSERT_FALSE(pSeg[0].gpioState);
+    TEST_ASSERT_EQUAL_UINT32(1, pSeg[0].length);
+    TEST_ASSERT_EQUAL_INT32(EF_HAL_INVALID_ID, pSeg[1].gpio);
+    TEST_ASSERT_EQUAL_INT32(CS_PIN, pSeg[2].gpio);
+    TEST_ASSERT_TRUE(pSeg[2].gpioState);
+    TEST_ASSERT_EQUAL_UINT32(0, pSeg[2].length);
+
+    dev.lastReg = reg & ~SPI_READ_FLAG;
+    dev.lastSize = pSeg[1].length;
+
+    if (reg & SPI_READ_FLAG)
+    {
+        dev.reads++;
+        TEST_ASSERT_NULL(pSeg[1].pTx);
+        memcpy(pSeg[1].pRx, &dev.regs[dev.lastReg], pSeg[1].length);
+    }
+    else
+    {
+        dev.writes++;
+        TEST_ASSERT_NULL(pSeg[1].pRx);
+        memcpy(&dev.regs[dev.lastReg], pSeg[1].pTx, pSeg[1].length);
+    }
+}
+
+void efHal_spi_transfer(efHal_dh_t dh, void *pTx, void *pRx, size_t length)
+{
+    TEST_FAIL_MESSAGE("the bus would be released with CS asserted");
+}
+
+void efHal_gpio_setPin(efHal_gpio_id_t id, bool state)
+{
+    TEST_FAIL_MESSAGE("CS driven outside of the SPI transaction");
+}
+
+void efHal_gpio_confPin(efHal_gpio_id_t id, efHal_gpio_dir_t dir, efHal_gpio_pull_t pull, bool state)
+{
+    TEST_ASSERT_EQUAL_INT32(CS_PIN, id);
+    TEST_ASSERT_TRUE(state);
+}
+
+void setUp(void)
+{
+    int i;
+
+    memset(&dev, 0, sizeof(dev));
+
+    for (i = 0 ; i < NUM_REGS ; i++)
+        dev.regs[i] = 0xa0 + i;
+
+    initMap(REGMAP_BUS_I2C, false);
+}
+
+void tearDown(void)
+{
+}
+
+void test_regmap_sync_coalescesAdjacent(void)
+{
+    regmap_write(&map, 0x10, 1);
+    regmap_write(&map, 0x11, 2);
+    regmap_write(&map, 0x12, 3);
+    regmap_write(&map, 0x15, 4);
+    TEST_ASSERT_TRUE(regmap_isDirty(&map));
+    TEST_ASSERT_EQUAL_INT32(0, dev.writes);
+
+    TEST_ASSERT_TRUE(regmap_sync(&map));
+
+    /* the clean gap is not cached, it splits the burst */
+    TEST_ASSERT_EQUAL_INT32(2, dev.writes);
+    checkAccess(0x15, 1);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY("\x01\x02\x03", &dev.regs[0x10], 3);
+    TEST_ASSERT_EQUAL_HEX8(4, dev.regs[0x15]);
+    TEST_ASSERT_FALSE(regmap_isDirty(&map));
+
+    /* same value as cached: nothing to write */
+    regmap_write(&map, 0x11, 2);
+    TEST_ASSERT_FALSE(regmap_isDirty(&map));
+    TEST_ASSERT_TRUE(regmap_sync(&map));
+    TEST_ASSERT_EQUAL_INT32(2, dev.writes);
+}
+
+void test_regmap_sync_fillGaps(void)
+{
+    initMap(REGMAP_BUS_I2C, true);
+    regmap_setVolatile(&map, 0x17, 1);
+    TEST_ASSERT_TRUE(regmap_refresh(&map, 0x10, 8));
+    TEST_ASSERT_EQUAL_INT32(1, dev.reads);
+
+    /* cached registers between dirty ones are rewritten in the burst */
+    regmap_write(&map, 0x10, 1);
+    regmap_write(&map, 0x13, 2);
+    TEST_ASSERT_TRUE(regmap_sync(&map));
+    TEST_ASSERT_EQUAL_INT32(1, dev.writes);
+    checkAccess(0x10, 4);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY("\x01\xb1\xb2\x02", &dev.regs[0x10], 4);
+
+    /* a volatile register can't be rewritten from the cache */
+    regmap_write(&map, 0x16, 3);
+    regmap_write(&map, 0x18, 4);
+    TEST_ASSERT_TRUE(regmap_sync(&map));
+    TEST_ASSERT_EQUAL_INT32(3, dev.writes);
+    checkAccess(0x18, 1);
+}
+
+void test_regmap_read_volatileBypassesCache(void)
+{
+    uint8_t value;
+
+    regmap_setVolatile(&map, 0x01, 1);
+
+    TEST_ASSERT_TRUE(regmap_read(&map, 0x00, &value));
+    TEST_ASSERT_TRUE(regmap_read(&map, 0x01, &value));
+    TEST_ASSERT_EQUAL_INT32(2, dev.reads);
+
+    dev.regs[0x00] = 0x55;
+    dev.regs[0x01] = 0x66;
+
+    TEST_ASSERT_TRUE(regmap_read(&map, 0x00, &value));
+    TEST_ASSERT_EQUAL_HEX8(0xa0, value);
+    TEST_ASSERT_TRUE(regmap_read(&map, 0x01, &value));
+    TEST_ASSERT_EQUAL_HEX8(0x66, value);
+    TEST_ASSERT_EQUAL_INT32(3, dev.reads);
+
+    /* read-modify-write from the cache */
+    TEST_ASSERT_TRUE(regmap_update(&map, 0x00, 0x0f, 0x03));
+    TEST_ASSERT_TRUE(regmap_sync(&map));
+    TEST_ASSERT_EQUAL_INT32(3, dev.reads);
+    TEST_ASSERT_EQUAL_HEX8(0xa3, dev.regs[0x00]);
+}
+
+void test_regmap_refresh(void)
+{
+    uint8_t value;
+
+    TEST_ASSERT_TRUE(regmap_read(&map, 0x04, &value));
+    dev.regs[0x04] = 0x44;
+    dev.regs[0x05] = 0x55;
+
+    /* pending writes go first, then the shadow is reloaded in one read */
+    regmap_write(&map, 0x06, 0x66);
+    TEST_ASSERT_TRUE(regmap_refresh(&map, 0x04, 3));
+    TEST_ASSERT_EQUAL_INT32(1, dev.writes);
+    TEST_ASSERT_EQUAL_INT32(2, dev.reads);
+    checkAccess(0x04, 3);
+
+    TEST_ASSERT_TRUE(regmap_read(&map, 0x04, &value));
+    TEST_ASSERT_EQUAL_HEX8(0x44, value);
+    TEST_ASSERT_TRUE(regmap_read(&map, 0x05, &value));
+    TEST_ASSERT_EQUAL_HEX8(0x55, value);
+    TEST_ASSERT_TRUE(regmap_read(&map, 0x06, &value));
+    TEST_ASSERT_EQUAL_HEX8(0x66, value);
+    TEST_ASSERT_EQUAL_INT32(2, dev.reads);
+}
+
+void test_regmap_invalidate(void)
+{
+    uint8_t value;
+
+    regmap_setVolatile(&map, 0x02, 1);
+    TEST_ASSERT_TRUE(regmap_read(&map, 0x03, &value));
+    regmap_write(&map, 0x04, 0x11);
+
+    /* e.g. the device was reset: cache and pending writes are gone */
+    regmap_invalidate(&map);
+    TEST_ASSERT_FALSE(regmap_isDirty(&map));
+
+    dev.regs[0x03] = 0x33;
+    TEST_ASSERT_TRUE(regmap_read(&map, 0x03, &value));
+    TEST_ASSERT_EQUAL_HEX8(0x33, value);
+    TEST_ASSERT_EQUAL_INT32(2, dev.reads);
+
+    /* volatile registers stay volatile */
+    TEST_ASSERT_TRUE(regmap_read(&map, 0x02, &value));
+    TEST_ASSERT_TRUE(regmap_read(&map, 0x02, &value));
+    TEST_ASSERT_EQUAL_INT32(4, dev.reads);
+}
+
+void test_regmap_sync_busErrorKeepsDirty(void)
+{
+    regmap_write(&map, 0x08, 1);
+
+    dev.fail = true;
+    TEST_ASSERT_FALSE(regmap_sync(&map));
+    TEST_ASSERT_TRUE(regmap_isDirty(&map));
+
+    dev.fail = false;
+    TEST_ASSERT_TRUE(regmap_sync(&map));
+    TEST_ASSERT_FALSE(regmap_isDirty(&map));
+    TEST_ASSERT_EQUAL_INT32(2, dev.writes);
+    TEST_ASSERT_EQUAL_HEX8(1, dev.regs[0x08]);
+}
+
+void test_regmap_syncRange(void)
+{
+    initMap(REGMAP_BUS_I2C, true);
+    TEST_ASSERT_TRUE(regmap_refresh(&map, 0x10, 4));
+
+    regmap_write(&map, 0x08, 1);
+    regmap_write(&map, 0x10, 2);
+    regmap_write(&map, 0x12, 3);
+
+    /* only the range, the burst doesn't leave it */
+    TEST_ASSERT_TRUE(regmap_syncRange(&map, 0x10, 1));
+    TEST_ASSERT_EQUAL_INT32(1, dev.writes);
+    checkAccess(0x10, 1);
+    TEST_ASSERT_TRUE(regmap_isDirty(&map));
+
+    /* the rest in address order */
+    TEST_ASSERT_TRUE(regmap_sync(&map));
+    TEST_ASSERT_EQUAL_INT32(3, dev.writes);
+    checkAccess(0x12, 1);
+    TEST_ASSERT_EQUAL_HEX8(1, dev.regs[0x08]);
+    TEST_ASSERT_FALSE(regmap_isDirty(&map));
+}
+
+void test_regmap_spi_oneTransactionPerAccess(void)
+{
+    uint8_t buf[4];
+
+    initMap(REGMAP_BUS_SPI, false);
+
+    regmap_write(&map, 0x02, 0x12);
+    regmap_write(&map, 0x03, 0x13);
+    TEST_ASSERT_TRUE(regmap_sync(&map));
+    TEST_ASSERT_EQUAL_INT32(1, dev.writes);
+    checkAccess(0x02, 2);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY("\x12\x13", &dev.regs[0x02], 2);
+
+    TEST_ASSERT_TRUE(regmap_readBulk(&map, 0x01, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT32(1, dev.reads);
+    checkAccess(0x01, 4);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY("\xa1\x12\x13\xa4", buf, sizeof(buf));
+}
+
+/*==================[end of file]============================================*/
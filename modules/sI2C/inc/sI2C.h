@@ -48,16 +48,38 @@ extern "C" {
 
 typedef void* sI2C_dh_t; /* device handler */
 
-typedef void (*sI2C_delay_t)(int32_t delayUs);
-
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
 
 extern void sI2C_init(void);
-extern sI2C_dh_t sI2C_open(efHal_gpio_id_t scl, efHal_gpio_id_t sda, sI2C_delay_t delay);
+
+/** \brief opens a software I2C bus on two pins
+ **
+ ** Edges are driven through the BSP direct port access (efHal_gpioFast.h)
+ ** and timed against its cycle counter, so the code between edges is part
+ ** of each half period and not added to it.
+ **
+ ** \param[in] scl clock pin
+ ** \param[in] sda data pin
+ ** \param[in] freq SCL frequency in Hz, 0: as fast as the pins can toggle
+ **
+ ** \return device handler, NULL if there aren't free buses
+ **/
+extern sI2C_dh_t sI2C_open(efHal_gpio_id_t scl, efHal_gpio_id_t sda, uint32_t freq);
+
+/** \brief registers the bus in efHal_i2c, transfers and segment transfers
+ **
+ ** Afterwards the bus is used through efHal_i2c with the returned handler,
+ ** transfers end through efHal_internal_i2c_endOfTransfer.
+ **
+ ** \return efHal handler, NULL if there aren't free I2C devices
+ **/
+extern efHal_dh_t sI2C_efHalReg(sI2C_dh_t dh);
+
 extern void sI2C_set_efHal_dh(sI2C_dh_t dh, efHal_dh_t efHal_dh_I2C);
 extern efHal_i2c_ec_t sI2C_transfer(sI2C_dh_t dh, efHal_i2c_devAdd_t da, void *pTx, size_t sTx, void *pRx, size_t sRx);
+extern efHal_i2c_ec_t sI2C_transferSeg(sI2C_dh_t dh, efHal_i2c_devAdd_t da, efHal_i2c_seg_t const *pSeg, int32_t nSeg);
 
 
 /*==================[cplusplus]==============================================*/
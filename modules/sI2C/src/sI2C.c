@@ -37,6 +37,7 @@
 #include "sI2C.h"
 #include "efHal.h"
 #include "efHal_internal.h"
+#include "efHal_gpioFast.h"
 
 #if __has_include("sI2C_config.h")
     #include "sI2C_config.h"
@@ -48,17 +49,22 @@
     #define sI2C_TOTAL     (1)
 #endif
 
-#ifndef sI2C_PERIOD
-    #define sI2C_PERIOD              10      /* 10 microseconds -> 100000 khz */
+/* SCL held low by a device longer than this ends the transfer, it must be
+ * shorter than one SysTick period on the boards without DWT */
+#ifndef sI2C_STRETCH_TIMEOUT_US
+    #define sI2C_STRETCH_TIMEOUT_US  500
 #endif
 
-#define SEMI_PERIOD         (sI2C_PERIOD / 2)
-
 typedef struct
 {
     efHal_gpio_id_t scl;
     efHal_gpio_id_t sda;
-    sI2C_delay_t delay;
+    efHal_gpioFast_t fScl;
+    efHal_gpioFast_t fSda;
+    uint32_t semiPeriod;        /* cycles */
+    uint32_t stretchTimeout;    /* cycles */
+    uint32_t lastEdge;          /* cycle counter at the last edge */
+    bool timeout;
     efHal_dh_t efHal_dh_I2C;
 }sI2C_data_t;
 
@@ -72,89 +78,120 @@ static sI2C_data_t sI2C_data[sI2C_TOTAL];
 
 /*==================[internal functions definition]==========================*/
 
-static void sendStart(sI2C_data_t *sI2C_data)
+/* waits until half a period has passed since the previous edge */
+static inline void semiPeriod(sI2C_data_t *sI2C_data)
 {
-    efHal_gpio_setPin(sI2C_data->scl, 1);
-    efHal_gpio_setPin(sI2C_data->sda, 1);
-
-    sI2C_data->delay(SEMI_PERIOD);
-    efHal_gpio_setPin(sI2C_data->sda, 0);
-    sI2C_data->delay(SEMI_PERIOD);
-    efHal_gpio_setPin(sI2C_data->scl, 0);
-    sI2C_data->delay(SEMI_PERIOD);
+    while (efHal_gpioFast_elapsed(sI2C_data->lastEdge) < sI2C_data->semiPeriod);
+
+    sI2C_data->lastEdge = efHal_gpioFast_cycles();
 }
 
-static void sendStop(sI2C_data_t *sI2C_data)
+static inline void sclLow(sI2C_data_t *sI2C_data)
 {
-    efHal_gpio_setPin(sI2C_data->scl, 0);
-    efHal_gpio_setPin(sI2C_data->sda, 0);
-    sI2C_data->delay(SEMI_PERIOD);
-    efHal_gpio_setPin(sI2C_data->scl, 1);
-    sI2C_data->delay(SEMI_PERIOD);
-    efHal_gpio_setPin(sI2C_data->sda, 1);
+    efHal_gpioFast_drive0(&sI2C_data->fScl);
 }
 
-static bool waitACK(sI2C_data_t *sI2C_data)
+static inline void sclHigh(sI2C_data_t *sI2C_data)
 {
-    bool ret = true;
-    uint8_t timeout = 200;
+    uint32_t start;
 
-    efHal_gpio_setPin(sI2C_data->sda, 1);
-    sI2C_data->delay(SEMI_PERIOD);
-    efHal_gpio_setPin(sI2C_data->scl, 1);
+    efHal_gpioFast_release(&sI2C_data->fScl);
 
-    while (timeout--)
+    /* clock stretching, the high half period begins when SCL is seen high */
+    if (!sI2C_data->timeout && !efHal_gpioFast_read(&sI2C_data->fScl))
     {
-        sI2C_data->delay(SEMI_PERIOD);
-        if (efHal_gpio_getPin(sI2C_data->sda) == 0)
+        start = efHal_gpioFast_cycles();
+
+        while (!efHal_gpioFast_read(&sI2C_data->fScl))
         {
-            ret = 0;
-            break;
+            if (efHal_gpioFast_elapsed(start) > sI2C_data->stretchTimeout)
+            {
+                sI2C_data->timeout = true;
+                break;
+            }
         }
+
+        sI2C_data->lastEdge = efHal_gpioFast_cycles();
     }
+}
+
+static inline void sdaSet(sI2C_data_t *sI2C_data, bool state)
+{
+    if (state)
+        efHal_gpioFast_release(&sI2C_data->fSda);
+    else
+        efHal_gpioFast_drive0(&sI2C_data->fSda);
+}
+
+static void sendStart(sI2C_data_t *sI2C_data)
+{
+    /* SDA released before SCL so a repeated start isn't seen as a stop */
+    sdaSet(sI2C_data, 1);
+    semiPeriod(sI2C_data);
+    sclHigh(sI2C_data);
+    semiPeriod(sI2C_data);
+    sdaSet(sI2C_data, 0);
+    semiPeriod(sI2C_data);
+    sclLow(sI2C_data);
+}
+
+static void sendStop(sI2C_data_t *sI2C_data)
+{
+    sclLow(sI2C_data);
+    sdaSet(sI2C_data, 0);
+    semiPeriod(sI2C_data);
+    sclHigh(sI2C_data);
+    semiPeriod(sI2C_data);
+    sdaSet(sI2C_data, 1);
+}
 
-    efHal_gpio_setPin(sI2C_data->scl, 0);
+static inline void sendBit(sI2C_data_t *sI2C_data, bool bit)
+{
+    sdaSet(sI2C_data, bit);
+    semiPeriod(sI2C_data);
+    sclHigh(sI2C_data);
+    semiPeriod(sI2C_data);
+    sclLow(sI2C_data);
+}
+
+static inline bool readBit(sI2C_data_t *sI2C_data)
+{
+    bool ret;
+
+    sdaSet(sI2C_data, 1);
+    semiPeriod(sI2C_data);
+    sclHigh(sI2C_data);
+    semiPeriod(sI2C_data);
+    ret = efHal_gpioFast_read(&sI2C_data->fSda);
+    sclLow(sI2C_data);
 
     return ret;
 }
 
+/* the ACK is sampled once at the end of the 9th clock high period */
+static bool waitACK(sI2C_data_t *sI2C_data)
+{
+    return readBit(sI2C_data);
+}
+
 static void sendAck(sI2C_data_t *sI2C_data)
 {
-    efHal_gpio_setPin(sI2C_data->scl, 0);
-    efHal_gpio_setPin(sI2C_data->sda, 0);
-    sI2C_data->delay(SEMI_PERIOD);
-    efHal_gpio_setPin(sI2C_data->scl, 1);
-    sI2C_data->delay(SEMI_PERIOD);
-    efHal_gpio_setPin(sI2C_data->scl, 0);
+    sendBit(sI2C_data, 0);
 }
 
 static void sendNAck(sI2C_data_t *sI2C_data)
 {
-    efHal_gpio_setPin(sI2C_data->scl, 0);
-    efHal_gpio_setPin(sI2C_data->sda, 1);
-    sI2C_data->delay(SEMI_PERIOD);
-    efHal_gpio_setPin(sI2C_data->scl, 1);
-    sI2C_data->delay(SEMI_PERIOD);
-    efHal_gpio_setPin(sI2C_data->scl, 0);
+    sendBit(sI2C_data, 1);
 }
 
 static void sendByte(sI2C_data_t *sI2C_data, uint8_t data)
 {
     int i;
 
-    efHal_gpio_setPin(sI2C_data->scl, 0);
-
     for (i = 0 ; i < 8 ; i++)
     {
-        if (data & (0x80>>i))
-            efHal_gpio_setPin(sI2C_data->sda, 1);
-        else
-            efHal_gpio_setPin(sI2C_data->sda, 0);
-
-        sI2C_data->delay(SEMI_PERIOD);
-        efHal_gpio_setPin(sI2C_data->scl, 1);
-        sI2C_data->delay(SEMI_PERIOD);
-        efHal_gpio_setPin(sI2C_data->scl, 0);
+        sendBit(sI2C_data, data & 0x80);
+        data <<= 1;
     }
 }
 
@@ -163,19 +200,10 @@ static uint8_t readByte(sI2C_data_t *sI2C_data)
     int i;
     uint8_t ret = 0;
 
-    efHal_gpio_setPin(sI2C_data->sda, 1);
-    efHal_gpio_setPin(sI2C_data->scl, 0);
-
     for (i = 0 ; i < 8 ; i++)
     {
-        sI2C_data->delay(SEMI_PERIOD);
-        efHal_gpio_setPin(sI2C_data->scl, 1);
-        sI2C_data->delay(SEMI_PERIOD);
-
-        if (efHal_gpio_getPin(sI2C_data->sda))
-            ret |= 0x80 >> i;
-
-        efHal_gpio_setPin(sI2C_data->scl, 0);
+        ret <<= 1;
+        ret |= readBit(sI2C_data);
     }
 
     return ret;
@@ -195,10 +223,11 @@ extern void sI2C_init(void)
     }
 }
 
-extern sI2C_dh_t sI2C_open(efHal_gpio_id_t scl, efHal_gpio_id_t sda, sI2C_delay_t delay)
+extern sI2C_dh_t sI2C_open(efHal_gpio_id_t scl, efHal_gpio_id_t sda, uint32_t freq)
 {
     void* ret = NULL;
-
+    uint32_t cyclesFreq;
+    uint32_t cal;
     int i;
 
     for (i = 0 ; i < sI2C_TOTAL ; i++)
@@ -209,10 +238,23 @@ extern sI2C_dh_t sI2C_open(efHal_gpio_id_t scl, efHal_gpio_id_t sda, sI2C_delay_
 
             sI2C_data[i].scl = scl;
             sI2C_data[i].sda = sda;
-            sI2C_data[i].delay = delay;
 
-            efHal_gpio_confPin(scl, EF_HAL_GPIO_OUTPUT_OD, EF_HAL_GPIO_PULL_DISABLE, 1);
-            efHal_gpio_confPin(sda, EF_HAL_GPIO_OUTPUT_OD, EF_HAL_GPIO_PULL_DISABLE, 1);
+            efHal_gpioFast_open(scl, &sI2C_data[i].fScl);
+            efHal_gpioFast_open(sda, &sI2C_data[i].fSda);
+
+            cyclesFreq = efHal_gpioFast_freq();
+
+            sI2C_data[i].stretchTimeout = cyclesFreq / 1000000 * sI2C_STRETCH_TIMEOUT_US;
+            sI2C_data[i].semiPeriod = 0;
+
+            /* the cycles lost leaving an already expired wait are taken
+             * off every half period */
+            sI2C_data[i].lastEdge = efHal_gpioFast_cycles();
+            semiPeriod(&sI2C_data[i]);
+            cal = efHal_gpioFast_elapsed(sI2C_data[i].lastEdge);
+
+            if (freq && cyclesFreq / (freq * 2) > cal)
+                sI2C_data[i].semiPeriod = cyclesFreq / (freq * 2) - cal;
 
             break;
         }
@@ -221,6 +263,21 @@ extern sI2C_dh_t sI2C_open(efHal_gpio_id_t scl, efHal_gpio_id_t sda, sI2C_delay_
     return ret;
 }
 
+extern efHal_dh_t sI2C_efHalReg(sI2C_dh_t dh)
+{
+    efHal_dh_t ret;
+
+    ret = efHal_internal_i2c_deviceReg(sI2C_transfer, dh);
+
+    if (ret != NULL)
+    {
+        efHal_internal_i2c_setTransferSeg(ret, sI2C_transferSeg);
+        sI2C_set_efHal_dh(dh, ret);
+    }
+
+    return ret;
+}
+
 extern void sI2C_set_efHal_dh(sI2C_dh_t dh, efHal_dh_t efHal_dh_I2C)
 {
     sI2C_data_t *sI2C_data = dh;
@@ -230,8 +287,8 @@ extern void sI2C_set_efHal_dh(sI2C_dh_t dh, efHal_dh_t efHal_dh_I2C)
 extern efHal_i2c_ec_t sI2C_transfer(sI2C_dh_t dh, efHal_i2c_devAdd_t da, void *pTx, size_t sTx, void *pRx, size_t sRx)
 {
     efHal_i2c_ec_t ret = EF_HAL_I2C_EC_NO_ERROR;
-    sI2C_data_t *sI2C_data = dh;
-    uint8_t *pBytes;
+    efHal_i2c_seg_t seg[2];
+    int32_t nSeg = 0;
 
     /* there aren't reception */
     if (sRx == 0 || pRx == NULL)
@@ -243,53 +300,107 @@ extern efHal_i2c_ec_t sI2C_transfer(sI2C_dh_t dh, efHal_i2c_devAdd_t da, void *p
         }
     }
 
-    if (sTx && ret == EF_HAL_I2C_EC_NO_ERROR)
+    if (ret == EF_HAL_I2C_EC_NO_ERROR)
     {
-        pBytes = pTx;
+        if (sTx)
+        {
+            seg[nSeg].dir = EF_HAL_I2C_DIR_WRITE;
+            seg[nSeg].flags = 0;
+            seg[nSeg].pBuf = pTx;
+            seg[nSeg].size = sTx;
+            nSeg++;
+        }
+
+        if (sRx && pRx != NULL)
+        {
+            seg[nSeg].dir = EF_HAL_I2C_DIR_READ;
+            seg[nSeg].flags = 0;
+            seg[nSeg].pBuf = pRx;
+            seg[nSeg].size = sRx;
+            nSeg++;
+        }
+
+        ret = sI2C_transferSeg(dh, da, seg, nSeg);
+    }
+
+    return ret;
+}
+
+extern efHal_i2c_ec_t sI2C_transferSeg(sI2C_dh_t dh, efHal_i2c_devAdd_t da, efHal_i2c_seg_t const *pSeg, int32_t nSeg)
+{
+    efHal_i2c_ec_t ret = EF_HAL_I2C_EC_NO_ERROR;
+    sI2C_data_t *sI2C_data = dh;
+    uint8_t *pBytes;
+    size_t size;
+    bool read;
+    bool ackLast;
+    int32_t i;
 
-        sendStart(sI2C_data);
-        sendByte(sI2C_data, da<<1 | 0);
+    sI2C_data->timeout = false;
+    sI2C_data->lastEdge = efHal_gpioFast_cycles();
 
-        if (waitACK(sI2C_data) == 1)
-            ret = EF_HAL_I2C_EC_NAK;
+    for (i = 0 ; i < nSeg && ret == EF_HAL_I2C_EC_NO_ERROR ; i++)
+    {
+        pBytes = pSeg[i].pBuf;
+        size = pSeg[i].size;
+        read = pSeg[i].dir == EF_HAL_I2C_DIR_READ;
 
-        while (sTx && ret == EF_HAL_I2C_EC_NO_ERROR)
+        if (!(pSeg[i].flags & EF_HAL_I2C_SEG_FLAG_NO_START))
         {
-            sendByte(sI2C_data, *pBytes);
-            sTx--;
-            pBytes++;
+            /* start or repeated start */
+            sendStart(sI2C_data);
+            sendByte(sI2C_data, da<<1 | read);
 
             if (waitACK(sI2C_data) == 1)
                 ret = EF_HAL_I2C_EC_NAK;
-        }
-    }
-
-    if (sRx && ret == EF_HAL_I2C_EC_NO_ERROR)
-    {
-        pBytes = pRx;
 
-        sendStart(sI2C_data);
-        sendByte(sI2C_data, da<<1 | 1);
+            if (sI2C_data->timeout)
+                ret = EF_HAL_I2C_EC_TIMEOUT;
+        }
 
-        if (waitACK(sI2C_data) == 1)
-            ret = EF_HAL_I2C_EC_NAK;
+        /* a read continued by the next segment ACKs its last byte */
+        ackLast = (i + 1 < nSeg) && (pSeg[i+1].flags & EF_HAL_I2C_SEG_FLAG_NO_START);
 
-        while (sRx && ret == EF_HAL_I2C_EC_NO_ERROR)
+        while (size && ret == EF_HAL_I2C_EC_NO_ERROR)
         {
-            *pBytes = readByte(sI2C_data);
-            sRx--;
-            pBytes++;
+            size--;
+
+            if (read)
+            {
+                *pBytes = readByte(sI2C_data);
 
-            if (sRx)
-                sendAck(sI2C_data);
+                if (size || ackLast)
+                    sendAck(sI2C_data);
+                else
+                    sendNAck(sI2C_data);
+            }
             else
-                sendNAck(sI2C_data);
+            {
+                sendByte(sI2C_data, *pBytes);
+
+                if (waitACK(sI2C_data) == 1)
+                    ret = EF_HAL_I2C_EC_NAK;
+            }
+
+            if (sI2C_data->timeout)
+                ret = EF_HAL_I2C_EC_TIMEOUT;
+
+            pBytes++;
         }
+
+        if ((pSeg[i].flags & EF_HAL_I2C_SEG_FLAG_STOP) && i + 1 < nSeg)
+            sendStop(sI2C_data);
     }
 
     sendStop(sI2C_data);
 
-    efHal_internal_i2c_endOfTransfer(sI2C_data->efHal_dh_I2C, ret);
+    /* behind efHal_i2c the bus result is reported only here, returning it
+     * too would end the transfer twice. A bus used on its own returns it */
+    if (sI2C_data->efHal_dh_I2C != NULL)
+    {
+        efHal_internal_i2c_endOfTransfer(sI2C_data->efHal_dh_I2C, ret);
+        ret = EF_HAL_I2C_EC_NO_ERROR;
+    }
 
     return ret;
 }
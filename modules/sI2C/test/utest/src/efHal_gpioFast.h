@@ -0,0 +1,89 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+#ifndef EF_HAL_GPIO_FAST_H
+#define EF_HAL_GPIO_FAST_H
+
+/*==================[inclusions]=============================================*/
+#include "efHal_gpio.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros and typedef]=====================================*/
+
+/** \brief fast pin of the test, the pins are wired to the fake I2C device
+ ** implemented by the test */
+typedef struct
+{
+    efHal_gpio_id_t id;
+}efHal_gpioFast_t;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+
+extern void efHal_gpioFast_open(efHal_gpio_id_t id, efHal_gpioFast_t *pFast);
+extern uint32_t efHal_gpioFast_cycles(void);
+extern uint32_t efHal_gpioFast_elapsed(uint32_t start);
+extern uint32_t efHal_gpioFast_freq(void);
+
+/* the master drives the pin low or releases it, reads the wired AND */
+extern void efHal_gpioFast_fakeSet(efHal_gpio_id_t id, bool low);
+extern bool efHal_gpioFast_fakeGet(efHal_gpio_id_t id);
+
+static inline void efHal_gpioFast_release(efHal_gpioFast_t const *pFast)
+{
+    efHal_gpioFast_fakeSet(pFast->id, false);
+}
+
+static inline void efHal_gpioFast_drive0(efHal_gpioFast_t const *pFast)
+{
+    efHal_gpioFast_fakeSet(pFast->id, true);
+}
+
+static inline bool efHal_gpioFast_read(efHal_gpioFast_t const *pFast)
+{
+    return efHal_gpioFast_fakeGet(pFast->id);
+}
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+/*==================[end of file]============================================*/
+#endif /* EF_HAL_GPIO_FAST_H */
@@ -0,0 +1,377 @@
+/*
+###############################################################################
+#
+# Copyright 2022, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "unity.h"
+#include "sI2C.h"
+#include "efHal_i2c.h"
+#include "efHal_gpioFast.h"
+#include "stdio.h"
+#include "string.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define PIN_SCL         1
+#define PIN_SDA         2
+#define DEV_ADD         0x1d
+
+typedef enum
+{
+    BUS_IDLE = 0,
+    BUS_RX,                     /* address or data from the master */
+    BUS_TX,                     /* data to the master */
+}busState_t;
+
+/* register device with auto increment on the bus, it logs what it sees:
+ * S start, P stop, xx+ / xx- byte received and ACK / NAK, <xx+ / <xx-
+ * byte sent and the master ACK / NAK */
+typedef struct
+{
+    bool sclLow;                /* driven by the master */
+    bool sdaLow;
+    bool devSdaLow;             /* driven by the device */
+    bool scl;                   /* line levels */
+    bool sda;
+    busState_t state;
+    int32_t bit;                /* SCL rising edges in the current byte */
+    uint8_t shift;
+    bool addr;                  /* next byte received is the address */
+    bool first;                 /* next byte written is the register */
+    bool acked;
+    uint8_t reg;
+    uint8_t regs[256];
+    char log[256];
+}fakeDev_t;
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static fakeDev_t dev;
+static sI2C_dh_t dh;
+static uint32_t cycles;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+static void logBus(char const *fmt, int32_t a, int32_t b)
+{
+    size_t len = strlen(dev.log);
+
+    snprintf(&dev.log[len], sizeof(dev.log) - len, fmt, a, b);
+}
+
+static void devDriveBit(void)
+{
+    dev.devSdaLow = !((dev.regs[dev.reg] << dev.bit) & 0x80);
+}
+
+static void received(void)
+{
+    if (dev.addr)
+    {
+        dev.addr = false;
+        dev.acked = (dev.shift >> 1) == DEV_ADD;
+        dev.first = true;
+    }
+    else if (dev.first)
+    {
+        dev.reg = dev.shift;
+        dev.first = false;
+    }
+    else
+    {
+        dev.regs[dev.reg++] = dev.shift;
+    }
+
+    logBus("%02x%c ", dev.shift, dev.acked ? '+' : '-');
+}
+
+static void sclRising(void)
+{
+    if (dev.state == BUS_RX && dev.bit < 8)
+        dev.shift = dev.shift << 1 | dev.sda;
+
+    if (dev.state == BUS_TX && dev.bit == 8)
+    {
+        dev.acked = !dev.sda;
+        logBus("<%02x%c ", dev.regs[dev.reg++], dev.acked ? '+' : '-');
+    }
+
+    dev.bit++;
+}
+
+static void sclFalling(void)
+{
+    if (dev.state == BUS_RX)
+    {
+        if (dev.bit == 8)
+        {
+            received();
+            dev.devSdaLow = dev.acked;
+        }
+        else if (dev.bit == 9)
+        {
+            dev.devSdaLow = false;
+            dev.bit = 0;
+
+            if (!dev.acked)
+            {
+                dev.state = BUS_IDLE;
+            }
+            else if (dev.first && (dev.shift & 1))
+            {
+                dev.state = BUS_TX;
+                devDriveBit();
+            }
+        }
+    }
+    else if (dev.state == BUS_TX)
+    {
+        if (dev.bit < 8)
+        {
+            devDriveBit();
+        }
+        else if (dev.bit == 8)
+        {
+            dev.devSdaLow = false;
+        }
+        else
+        {
+            dev.bit = 0;
+
+            if (dev.acked)
+                devDriveBit();
+            else
+                dev.state = BUS_IDLE;
+        }
+    }
+}
+
+static void update(void)
+{
+    bool scl = !dev.sclLow;
+    bool sda = !(dev.sdaLow || dev.devSdaLow);
+
+    if (scl && dev.scl && sda != dev.sda)
+    {
+        /* SDA changes with SCL high: start or stop */
+        if (!sda)
+        {
+            logBus("S ", 0, 0);
+            dev.state = BUS_RX;
+            dev.addr = true;
+        }
+        else
+        {
+            logBus("P ", 0, 0);
+            dev.state = BUS_IDLE;
+        }
+
+        dev.bit = 0;
+        dev.devSdaLow = false;
+    }
+
+    dev.sda = sda;
+
+    if (scl != dev.scl)
+    {
+        dev.scl = scl;
+
+        if (scl)
+            sclRising();
+        else
+            sclFalling();
+
+        dev.sda = !(dev.sdaLow || dev.devSdaLow);
+    }
+}
+
+/*==================[external functions definition]==========================*/
+
+void efHal_gpioFast_open(efHal_gpio_id_t id, efHal_gpioFast_t *pFast)
+{
+    pFast->id = id;
+    efHal_gpioFast_fakeSet(id, false);
+}
+
+uint32_t efHal_gpioFast_cycles(void)
+{
+    return cycles++;
+}
+
+uint32_t efHal_gpioFast_elapsed(uint32_t start)
+{
+    return efHal_gpioFast_cycles() - start;
+}
+
+uint32_t efHal_gpioFast_freq(void)
+{
+    return 1000000;
+}
+
+void efHal_gpioFast_fakeSet(efHal_gpio_id_t id, bool low)
+{
+    if (id == PIN_SCL)
+        dev.sclLow = low;
+    else
+        dev.sdaLow = low;
+
+    update();
+}
+
+bool efHal_gpioFast_fakeGet(efHal_gpio_id_t id)
+{
+    return id == PIN_SCL ? dev.scl : dev.sda;
+}
+
+void setUp(void)
+{
+    int32_t i;
+
+    memset(&dev, 0, sizeof(dev));
+    dev.scl = true;
+    dev.sda = true;
+
+    for (i = 0 ; i < 256 ; i++)
+        dev.regs[i] = 0xa0 + i;
+
+    efHal_i2c_init();
+    sI2C_init();
+    dh = sI2C_open(PIN_SCL, PIN_SDA, 0);
+    dev.log[0] = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void test_sI2C_transfer_writeRead(void)
+{
+    uint8_t reg = 0x10;
+    uint8_t rx[2];
+
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NO_ERROR, sI2C_transfer(dh, DEV_ADD, &reg, 1, rx, 2));
+
+    /* repeated start between the address and the data */
+    TEST_ASSERT_EQUAL_STRING("S 3a+ 10+ S 3b+ <b0+ <b1- P ", dev.log);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY("\xb0\xb1", rx, 2);
+}
+
+void test_sI2C_transferSeg_noStartWrite(void)
+{
+    uint8_t reg = 0x20;
+    uint8_t data[2] = {0x55, 0x66};
+    efHal_i2c_seg_t seg[2] =
+    {
+        {EF_HAL_I2C_DIR_WRITE, 0, &reg, 1},
+        {EF_HAL_I2C_DIR_WRITE, EF_HAL_I2C_SEG_FLAG_NO_START, data, 2},
+    };
+
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NO_ERROR, sI2C_transferSeg(dh, DEV_ADD, seg, 2));
+
+    /* the data follows the register without start nor address */
+    TEST_ASSERT_EQUAL_STRING("S 3a+ 20+ 55+ 66+ P ", dev.log);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, &dev.regs[0x20], 2);
+}
+
+void test_sI2C_transferSeg_noStartRead(void)
+{
+    uint8_t reg = 0x30;
+    uint8_t rx[3];
+    efHal_i2c_seg_t seg[3] =
+    {
+        {EF_HAL_I2C_DIR_WRITE, 0, &reg, 1},
+        {EF_HAL_I2C_DIR_READ, 0, &rx[0], 1},
+        {EF_HAL_I2C_DIR_READ, EF_HAL_I2C_SEG_FLAG_NO_START, &rx[1], 2},
+    };
+
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NO_ERROR, sI2C_transferSeg(dh, DEV_ADD, seg, 3));
+
+    /* the last byte of a continued read is ACKed, only the end NAKs */
+    TEST_ASSERT_EQUAL_STRING("S 3a+ 30+ S 3b+ <d0+ <d1+ <d2- P ", dev.log);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY("\xd0\xd1\xd2", rx, 3);
+}
+
+void test_sI2C_transferSeg_stop(void)
+{
+    uint8_t reg = 0x10;
+    uint8_t rx;
+    efHal_i2c_seg_t seg[2] =
+    {
+        {EF_HAL_I2C_DIR_WRITE, EF_HAL_I2C_SEG_FLAG_STOP, &reg, 1},
+        {EF_HAL_I2C_DIR_READ, 0, &rx, 1},
+    };
+
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NO_ERROR, sI2C_transferSeg(dh, DEV_ADD, seg, 2));
+
+    /* stop and start instead of a repeated start */
+    TEST_ASSERT_EQUAL_STRING("S 3a+ 10+ P S 3b+ <b0- P ", dev.log);
+    TEST_ASSERT_EQUAL_HEX8(0xb0, rx);
+}
+
+void test_sI2C_transfer_nak(void)
+{
+    uint8_t reg = 0x10;
+
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NAK, sI2C_transfer(dh, DEV_ADD + 1, &reg, 1, NULL, 0));
+    TEST_ASSERT_EQUAL_STRING("S 3c- P ", dev.log);
+}
+
+void test_sI2C_efHalReg(void)
+{
+    efHal_dh_t efHal_dh = sI2C_efHalReg(dh);
+    uint8_t reg = 0x40;
+    uint8_t data = 0x77;
+    uint8_t rx;
+    efHal_i2c_seg_t seg[2] =
+    {
+        {EF_HAL_I2C_DIR_WRITE, 0, &reg, 1},
+        {EF_HAL_I2C_DIR_WRITE, EF_HAL_I2C_SEG_FLAG_NO_START, &data, 1},
+    };
+
+    TEST_ASSERT_NOT_NULL(efHal_dh);
+
+    /* the segment path is registered too */
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NO_ERROR, efHal_i2c_transferSeg(efHal_dh, DEV_ADD, seg, 2));
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NO_ERROR, efHal_i2c_transfer(efHal_dh, DEV_ADD, &reg, 1, &rx, 1));
+    TEST_ASSERT_EQUAL(EF_HAL_I2C_EC_NAK, efHal_i2c_transfer(efHal_dh, DEV_ADD + 1, &reg, 1, &rx, 1));
+
+    TEST_ASSERT_EQUAL_STRING("S 3a+ 40+ 77+ P S 3a+ 40+ S 3b+ <77- P S 3c- P ", dev.log);
+    TEST_ASSERT_EQUAL_HEX8(0x77, rx);
+}
+
+/*==================[end of file]============================================*/
@@ -1,17 +0,0 @@
-/*****************************************************************************
- *   oled.h:  Header file for OLED Display
- *
- *   Copyright(C) 2009, Embedded Artists AB
- *   All rights reserved.
- *
-******************************************************************************/
-#ifndef __FONT5x7_H
-#define __FONT5x7_H
-
-extern const unsigned char font5x7[][8];
-
-
-#endif /* end __FONT5x7_H */
-/****************************************************************************
-**                            End Of File
-*****************************************************************************/
@@ -41,6 +41,22 @@
 #include <stdint.h>
 #include "efHal.h"
 #include "efHal_gpio.h"
+#include "canvas.h"
+
+#if __has_include("oled_config.h")
+    #include "oled_config.h"
+#endif
+
+/* background flush task with a second frame buffer, see oled_present() */
+#ifndef OLED_FLUSH_TASK
+    #define OLED_FLUSH_TASK         0
+#endif
+
+#if OLED_FLUSH_TASK
+    #include "FreeRTOS.h"
+    #include "task.h"
+    #include "semphr.h"
+#endif
 
 /*==================[cplusplus]==============================================*/
 #ifdef __cplusplus
@@ -48,31 +64,120 @@ extern "C" {
 #endif
 
 /*==================[macros]=================================================*/
+
+/*==================[typedef]================================================*/
+
 typedef enum
 {
-    OLED_COLOR_BLACK,
-    OLED_COLOR_WHITE
-} oled_color_t;
+    OLED_CTRL_SSD1306 = 0,
+    OLED_CTRL_SH1106,
+} oled_ctrl_t;
 
-#define OLED_DISPLAY_WIDTH  128
-#define OLED_DISPLAY_HEIGHT 64
+/* continuous scroll directions, values are the SSD1306 commands */
+typedef enum
+{
+    OLED_SCROLL_RIGHT = 0x26,
+    OLED_SCROLL_LEFT = 0x27,
+    OLED_SCROLL_UP_RIGHT = 0x29,    /* vertical and right */
+    OLED_SCROLL_UP_LEFT = 0x2A,     /* vertical and left */
+} oled_scrollDir_t;
 
-/*==================[typedef]================================================*/
+/* frames between scroll steps, values are the SSD1306 codes */
+typedef enum
+{
+    OLED_SCROLL_2_FRAMES = 7,
+    OLED_SCROLL_3_FRAMES = 4,
+    OLED_SCROLL_4_FRAMES = 5,
+    OLED_SCROLL_5_FRAMES = 0,
+    OLED_SCROLL_25_FRAMES = 6,
+    OLED_SCROLL_64_FRAMES = 1,
+    OLED_SCROLL_128_FRAMES = 2,
+    OLED_SCROLL_256_FRAMES = 3,
+} oled_scrollStep_t;
+
+typedef struct
+{
+    efHal_dh_t spi;
+    efHal_gpio_id_t cmdPin;
+    efHal_gpio_id_t rstPin;
+    oled_ctrl_t ctrl;
+    uint8_t xOffset;                /* first visible column of the controller
+                                       RAM, 2 on most 132 column SH1106 */
+    int16_t width;
+    int16_t height;                 /* 32 or 64 */
+} oled_conf_t;
+
+/* called by the flush task when a presented frame is on the display */
+typedef void (*oled_frameDoneCB_t)(void *ctx);
+
+/* a display, drawing is done on canvas with the canvas module */
+typedef struct
+{
+    oled_conf_t conf;
+    canvas_t canvas;
+    bool scrolling;                 /* continuous scroll active, RAM is not
+                                       written meanwhile */
+    uint8_t startLine;              /* canvas row shown at the top */
+    uint8_t sentStartLine;
+#if OLED_FLUSH_TASK
+    uint8_t *pOtherBuf;             /* buffer not being drawn */
+    canvas_span_t *pOtherDirty;
+    uint8_t *pFrontBuf;             /* frame being sent by the flush task */
+    canvas_span_t *pFrontDirty;
+    uint8_t frontStartLine;
+    SemaphoreHandle_t frameReady;
+    SemaphoreHandle_t frameDone;
+    TickType_t framePeriod;
+    oled_frameDoneCB_t frameDoneCB;
+    void *frameDoneCtx;
+#endif
+} oled_t;
 
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions definition]==========================*/
 
-void oled_init(efHal_dh_t spi, efHal_gpio_id_t cmdPin, efHal_gpio_id_t rstPin);
-void oled_putPixel(uint8_t x, uint8_t y, oled_color_t color);
-void oled_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, oled_color_t color);
-void oled_circle(uint8_t x0, uint8_t y0, uint8_t r, oled_color_t color);
-void oled_rect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, oled_color_t color);
-void oled_fillRect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, oled_color_t color);
-void oled_clearScreen(oled_color_t color);
-void oled_putString(uint8_t x, uint8_t y, uint8_t *pStr, oled_color_t fb, oled_color_t bg);
-uint8_t oled_putChar(uint8_t x, uint8_t y, uint8_t ch, oled_color_t fb, oled_color_t bg);
-void oled_setContrast(uint8_t contrast);
+/* pBuf (CANVAS_BUF_SIZE(width, height) bytes) and pDirty
+ * (CANVAS_PAGES(height) spans) are owned by the caller, the first
+ * oled_flush() sends the whole cleared buffer */
+void oled_init(oled_t *oled, oled_conf_t const *pConf, uint8_t *pBuf,
+        canvas_span_t *pDirty);
+void oled_setContrast(oled_t *oled, uint8_t contrast);
+
+/* drawing functions only change the frame buffer, the display is updated
+ * with the changed columns of each page calling oled_flush() */
+void oled_flush(oled_t *oled);
+
+/* writes pData, (x1 - x0 + 1) bytes per page from page0 to page1, straight
+ * to the display in one transaction and to the frame buffer. The window must
+ * be inside the display */
+void oled_writeWindow(oled_t *oled, int16_t x0, int16_t page0, int16_t x1,
+        int16_t page1, uint8_t const *pData);
+
+/* continuous scroll done by the SSD1306 on its RAM, not available on the
+ * SH1106 (returns false). The frame buffer is sent again after
+ * oled_scrollStop(), flushes are held meanwhile */
+bool oled_scrollStart(oled_t *oled, oled_scrollDir_t dir, uint8_t page0,
+        uint8_t page1, oled_scrollStep_t step, uint8_t vOffset);
+void oled_scrollStop(oled_t *oled);
+
+/* log style scroll with the display start line, only for 64 row displays
+ * (the height of the controller RAM): the rows at the top move out and come
+ * back at the bottom, canvas row y is then shown at screen row
+ * (y - startLine) mod 64. Returns the canvas row of the first of the rows
+ * now at the bottom, to be redrawn, or -1. The start line is sent with the
+ * next flush, so a new text line costs one page */
+int16_t oled_scrollUp(oled_t *oled, int16_t rows);
+
+/* with OLED_FLUSH_TASK set to 1 in oled_config.h frames are sent by a
+ * background task, one per display: oled_present() hands the drawn frame
+ * and drawing continues on the other buffer meanwhile */
+#if OLED_FLUSH_TASK
+void oled_startFlushTask(oled_t *oled, uint8_t *pBuf2, canvas_span_t *pDirty2,
+        UBaseType_t priority, uint32_t maxFps, oled_frameDoneCB_t cb, void *ctx);
+void oled_present(oled_t *oled);
+bool oled_waitFrame(oled_t *oled, TickType_t blockTime);
+#endif
 
 /*==================[cplusplus]==============================================*/
 #ifdef __cplusplus
@@ -41,27 +41,39 @@
  *****************************************************************************/
 #include <string.h>
 #include "oled.h"
-#include "font5x7.h"
 #include "efHal_spi.h"
 
 /******************************************************************************
  * Defines and typedefs
  *****************************************************************************/
 
-#define OLED_DATA()   efHal_gpio_setPin(_cmdPin, true) 	//GPIOC7 --> OLED DATA/CMD pin
-#define OLED_CMD()    efHal_gpio_setPin(_cmdPin, false)
+#ifndef OLED_FLUSH_TASK_STACK
+    #define OLED_FLUSH_TASK_STACK   200
+#endif
 
-#define OLED_ENABLE() efHal_gpio_setPin(_rstPin, true) 		//GPIOC0 --> OLED reset pin
-#define OLED_DISABLE() efHal_gpio_setPin(_rstPin, false)
+#define OLED_ENABLE(o)  efHal_gpio_setPin((o)->conf.rstPin, true)
+#define OLED_DISABLE(o) efHal_gpio_setPin((o)->conf.rstPin, false)
 
-#define X_OFFSET 0
+#define TOTAL_PAGES(o)  CANVAS_PAGES((o)->conf.height)
 
-#define SHADOW_FB_SIZE (OLED_DISPLAY_WIDTH*OLED_DISPLAY_HEIGHT >> 3)
+/* controller RAM rows (start line range) and pages */
+#define RAM_ROWS        64
+#define RAM_PAGES       CANVAS_PAGES(RAM_ROWS)
+
+/* dirty pages are sent in one window covering all of them unless it adds
+ * more than this many bytes per extra transaction saved (command bytes,
+ * D/C switches and waking the task) */
+#ifndef OLED_WINDOW_MERGE_BYTES
+    #define OLED_WINDOW_MERGE_BYTES 16
+#endif
+
+/* arguments of 0xA8 (multiplex ratio) and 0xDA (COM pins) in the init
+ * sequences */
+#define SSD1306_MUX_POS     4
+#define SSD1306_COM_POS     15
+#define SH1106_MUX_POS      4
+#define SH1106_COM_POS      13
 
-#define setAddress(page,lowerAddr,higherAddr)\
-    writeCommand(page);\
-    writeCommand(lowerAddr);\
-    writeCommand(higherAddr);
 
 /******************************************************************************
  * External global variables
@@ -71,19 +83,28 @@
 /******************************************************************************
  * Local variables
  *****************************************************************************/
-efHal_dh_t _spi;
-efHal_gpio_id_t _cmdPin, _rstPin;
 
 /*
- * The SSD1306 doesn't support reading from the display memory when using
- * serial mode (only parallel mode). Since it isn't possible to write only
- * one pixel to the display (a minimum of one column, 8 pixels, is always
- * writen) a shadow framebuffer is needed to keep track of the display
- * data.
+ * Values extracted from Adafruit library (https://github.com/adafruit/Adafruit_SSD1306),
+ * horizontal addressing mode as flushes set a column and page window.
+ * Multiplex ratio and COM pins are set from the height in runInitSequence()
  */
-static uint8_t shadowFB[SHADOW_FB_SIZE];
+static uint8_t const initSeqSSD1306[] =
+{
+    0xAE, 0xD5, 0x80, 0xA8, 0x3F, 0xD3, 0x00, 0x40, 0x8D, 0x14, 0x20, 0x00,
+    0xA1, 0xC8, 0xDA, 0x12, 0x81, 0x7F, 0xD9, 0xF1, 0xDB, 0x40, 0xA4, 0xA6,
+    0x2E, 0xAF,
+};
 
-static uint8_t const  font_mask[8] = {0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01};
+/*
+ * SH1106: DC-DC on with 0xAD instead of the charge pump, there is only page
+ * addressing and no scroll
+ */
+static uint8_t const initSeqSH1106[] =
+{
+    0xAE, 0xD5, 0x80, 0xA8, 0x3F, 0xD3, 0x00, 0x40, 0xAD, 0x8B, 0xA1, 0xC8,
+    0xDA, 0x12, 0x81, 0x7F, 0xD9, 0x22, 0xDB, 0x35, 0xA4, 0xA6, 0xAF,
+};
 
 
 /******************************************************************************
@@ -93,163 +114,266 @@ static uint8_t const  font_mask[8] = {0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02,
 /******************************************************************************
  *
  * Description:
- *    Write a command to the display
+ *    Write commands to the display
  *
  * Params:
- *   [in] data - command to write to the display
+ *   [in] oled - display
+ *   [in] pCmd - commands to write to the display
+ *   [in] len  - number of commands
  *
  *****************************************************************************/
 static void
-writeCommand(uint8_t data)
+writeCommands(oled_t *oled, uint8_t const *pCmd, size_t len)
 {
-	OLED_CMD();
-	efHal_spi_transfer(_spi, &data, NULL, sizeof(data));
+    efHal_spi_seg_t seg = {(void *)pCmd, NULL, len, oled->conf.cmdPin, false};
+
+    efHal_spi_transaction(oled->conf.spi, &seg, 1);
 }
 
 /******************************************************************************
  *
  * Description:
- *    Write data to the display
+ *    Write a window of data to the display in one transaction. The SSD1306
+ *    sets the window with horizontal addressing and takes the data of all
+ *    pages in a row, the SH1106 only has page addressing and gets the
+ *    address of each page
  *
  * Params:
- *   [in] data - data (color) to write to the display
+ *   [in] oled   - display
+ *   [in] pData  - data of the first page of the window
+ *   [in] stride - bytes from a page to the next one in pData
+ *   [in] x0     - first column
+ *   [in] page0  - first page
+ *   [in] x1     - last column
+ *   [in] page1  - last page
  *
  *****************************************************************************/
 static void
-writeData(uint8_t data)
+writeWindow(oled_t *oled, uint8_t const *pData, size_t stride, int16_t x0,
+        int16_t page0, int16_t x1, int16_t page1)
 {
-    OLED_DATA();
-    efHal_spi_transfer(_spi, &data, NULL, sizeof(data));
+    uint8_t cmd[RAM_PAGES][3];
+    efHal_spi_seg_t seg[2 * RAM_PAGES];
+    size_t len = x1 - x0 + 1;
+    uint8_t add = x0 + oled->conf.xOffset;
+    int32_t n = 0;
+    int16_t page;
+    uint8_t *pCmd;
+
+    if (oled->conf.ctrl == OLED_CTRL_SH1106)
+    {
+        for (page = page0 ; page <= page1 ; page++)
+        {
+            pCmd = cmd[page - page0];
+            pCmd[0] = 0xB0 | page;
+            pCmd[1] = 0x0F & add;               // Low address
+            pCmd[2] = 0x10 | (add >> 4);        // High address
+
+            seg[n++] = (efHal_spi_seg_t){pCmd, NULL, 3, oled->conf.cmdPin, false};
+            seg[n++] = (efHal_spi_seg_t){(void *)pData, NULL, len, oled->conf.cmdPin, true};
+            pData += stride;
+        }
+    }
+    else
+    {
+        cmd[0][0] = 0x21;
+        cmd[0][1] = add;
+        cmd[0][2] = x1 + oled->conf.xOffset;
+        cmd[1][0] = 0x22;
+        cmd[1][1] = page0;
+        cmd[1][2] = page1;
+
+        seg[n++] = (efHal_spi_seg_t){cmd, NULL, 6, oled->conf.cmdPin, false};
+
+        /* contiguous in the frame buffer when the window is full width */
+        if (stride == len)
+        {
+            seg[n++] = (efHal_spi_seg_t){(void *)pData, NULL,
+                len * (page1 - page0 + 1), oled->conf.cmdPin, true};
+        }
+        else
+        {
+            for (page = page0 ; page <= page1 ; page++)
+            {
+                seg[n++] = (efHal_spi_seg_t){(void *)pData, NULL, len, oled->conf.cmdPin, true};
+                pData += stride;
+            }
+        }
+    }
+
+    efHal_spi_transaction(oled->conf.spi, seg, n);
 }
 
 /******************************************************************************
  *
  * Description:
- *    Write len number of data to the display
+ *    Run the init sequence of the controller
  *
  * Params:
- *   [in] data - data (color) to write to the display
- *   [in] len  - number of bytes to write
+ *   [in] oled - display
  *
  *****************************************************************************/
 static void
-writeDataLen(unsigned char data, unsigned int len)
+runInitSequence(oled_t *oled)
 {
-	int i;
-    uint8_t buf[140];
+    uint8_t seq[sizeof(initSeqSSD1306)];
+    size_t len;
+    uint8_t muxPos;
+    uint8_t comPos;
 
-    for (i = 0; i < len; i++) {
-        buf[i] = data;
+    if (oled->conf.ctrl == OLED_CTRL_SH1106)
+    {
+        len = sizeof(initSeqSH1106);
+        muxPos = SH1106_MUX_POS;
+        comPos = SH1106_COM_POS;
+        memcpy(seq, initSeqSH1106, len);
+    }
+    else
+    {
+        len = sizeof(initSeqSSD1306);
+        muxPos = SSD1306_MUX_POS;
+        comPos = SSD1306_COM_POS;
+        memcpy(seq, initSeqSSD1306, len);
     }
 
-    OLED_DATA();
+    /* sequential COM pins for 32 rows, alternative for 64 */
+    seq[muxPos] = oled->conf.height - 1;
+    seq[comPos] = (oled->conf.height <= 32) ? 0x02 : 0x12;
 
-    efHal_spi_transfer(_spi, buf, NULL, len);
+    writeCommands(oled, seq, len);
 }
 
 
 /******************************************************************************
  *
  * Description:
- *    Run display init sequence
+ *    Send the changed columns of a frame buffer and the start line. Pages
+ *    with changes go in a single window when it doesn't add much more data
+ *    than a transaction per page. Nothing is sent during a continuous scroll
+ *
+ * Params:
+ *   [in] oled      - display
+ *   [in] pBuf      - frame buffer
+ *   [in] pDirty    - changed columns of each page
+ *   [in] startLine - start line of the frame
  *
  *****************************************************************************/
 static void
-runInitSequence()
+sendFrame(oled_t *oled, uint8_t *pBuf, canvas_span_t const *pDirty,
+        uint8_t startLine)
 {
-    /*
-     * Values extracted from Adafruit library (https://github.com/adafruit/Adafruit_SSD1306)
-     */
-
-	 writeCommand(0xAE);
-	 writeCommand(0xD5);
-	 writeCommand(0x80);
-	 writeCommand(0xA8);
-	 writeCommand((uint8_t)(OLED_DISPLAY_HEIGHT-1));
-	 writeCommand(0xD3);
-	 writeCommand(0x00);
-	 writeCommand(0x40);
-	 writeCommand(0x8D);
-	 writeCommand(0x14);
-	 writeCommand(0x20);
-	 writeCommand(0x00);
-	 writeCommand(0xA1);
-	 writeCommand(0xC8);
-	 writeCommand(0xDA);
-	 writeCommand(0x12);
-	 writeCommand(0x81);
-	 writeCommand(0x7F);
-	 writeCommand(0xD9);
-	 writeCommand(0xF1);
-	 writeCommand(0xDB);
-	 writeCommand(0x40);
-	 writeCommand(0xA4);
-	 writeCommand(0xA6);
-	 writeCommand(0x2E);
-	 writeCommand(0xAF);
-}
+    int16_t w = oled->conf.width;
+    int16_t first = -1;
+    int16_t last = 0;
+    int16_t minX = w;
+    int16_t maxX = -1;
+    int32_t bytes = 0;
+    int32_t pages = 0;
+    int16_t i;
+    uint8_t cmd;
+
+    if (oled->scrolling)
+        return;
 
+    for(i=0;i<TOTAL_PAGES(oled);i++) {
+        if (pDirty[i].min <= pDirty[i].max) {
+            if (first < 0)
+                first = i;
+            last = i;
+            pages++;
+            bytes += pDirty[i].max - pDirty[i].min + 1;
+            if (pDirty[i].min < minX)
+                minX = pDirty[i].min;
+            if (pDirty[i].max > maxX)
+                maxX = pDirty[i].max;
+        }
+    }
+
+    if (first >= 0 && (int32_t)(maxX - minX + 1) * (last - first + 1) <=
+            bytes + (pages - 1) * OLED_WINDOW_MERGE_BYTES) {
+        writeWindow(oled, &pBuf[first*w+minX], w, minX, first, maxX, last);
+    }
+    else if (first >= 0) {
+        for(i=first;i<=last;i++) {
+            if (pDirty[i].min <= pDirty[i].max)
+                writeWindow(oled, &pBuf[i*w+pDirty[i].min], w,
+                        pDirty[i].min, i, pDirty[i].max, i);
+        }
+    }
+
+    if (startLine != oled->sentStartLine) {
+        cmd = 0x40 | startLine;
+        writeCommands(oled, &cmd, 1);
+        oled->sentStartLine = startLine;
+    }
+}
 
 /******************************************************************************
  *
  * Description:
- *    Draw a horizontal line
+ *    Wait for the flush task to be idle, so commands and data sent
+ *    meanwhile don't mix with a frame
  *
  * Params:
- *   [in] x0 - start x position
- *   [in] y0 - y position
- *   [in] x1 - end x position
- *   [in] color - color of the pixel
+ *   [in] oled - display
  *
  *****************************************************************************/
-static void hLine(uint8_t x0, uint8_t y0, uint8_t x1, oled_color_t color)
+static void
+lockFrame(oled_t *oled)
 {
-    uint8_t bak;
-
-    if (x0 > x1)
-    {
-        bak = x1;
-        x1 = x0;
-        x0 = bak;
-    }
+#if OLED_FLUSH_TASK
+    if (oled->frameDone != NULL)
+        xSemaphoreTake(oled->frameDone, portMAX_DELAY);
+#endif
+}
 
-    while(x1 >= x0)
-    {
-        oled_putPixel(x0, y0, color);
-        x0++;
-    }
+static void
+unlockFrame(oled_t *oled)
+{
+#if OLED_FLUSH_TASK
+    if (oled->frameDone != NULL)
+        xSemaphoreGive(oled->frameDone);
+#endif
 }
 
+#if OLED_FLUSH_TASK
 /******************************************************************************
  *
  * Description:
- *    Draw a vertical line
+ *    Send each presented frame, no sooner than framePeriod after the
+ *    previous one
  *
  * Params:
- *   [in] x0 - x position
- *   [in] y0 - start y position
- *   [in] y1 - end y position
- *   [in] color - color of the pixel
+ *   [in] pvParameters - display
  *
  *****************************************************************************/
-static void vLine(uint8_t x0, uint8_t y0, uint8_t y1, oled_color_t color)
+static void
+flushTask(void *pvParameters)
 {
-    uint8_t bak;
+    oled_t *oled = pvParameters;
+    TickType_t lastFrame = xTaskGetTickCount();
+    TickType_t elapsed;
 
-    if(y0 > y1)
+    for (;;)
     {
-        bak = y1;
-        y1 = y0;
-        y0 = bak;
-    }
+        xSemaphoreTake(oled->frameReady, portMAX_DELAY);
 
-    while(y1 >= y0)
-    {
-        oled_putPixel(x0, y0, color);
-        y0++;
+        elapsed = xTaskGetTickCount() - lastFrame;
+
+        if (elapsed < oled->framePeriod)
+            vTaskDelay(oled->framePeriod - elapsed);
+
+        lastFrame = xTaskGetTickCount();
+
+        sendFrame(oled, oled->pFrontBuf, oled->pFrontDirty, oled->frontStartLine);
+
+        xSemaphoreGive(oled->frameDone);
+
+        if (oled->frameDoneCB != NULL)
+            oled->frameDoneCB(oled->frameDoneCtx);
     }
-    return;
 }
+#endif
 
 
 /******************************************************************************
@@ -261,500 +385,357 @@ static void vLine(uint8_t x0, uint8_t y0, uint8_t y1, oled_color_t color)
  * Description:
  *    Initialize the OLED Display
  *
+ * Params:
+ *   [out] oled  - display
+ *   [in] pConf  - controller, pins and size
+ *   [in] pBuf   - frame buffer
+ *   [in] pDirty - changed columns of each page
+ *
  *****************************************************************************/
-void oled_init(efHal_dh_t spi, efHal_gpio_id_t cmdPin, efHal_gpio_id_t rstPin)
+void oled_init(oled_t *oled, oled_conf_t const *pConf, uint8_t *pBuf,
+        canvas_span_t *pDirty)
 {
     int i = 0;
 
-    _cmdPin = cmdPin;
-    _rstPin = rstPin;
-    _spi = spi;
+    oled->conf = *pConf;
+    oled->scrolling = false;
+    oled->startLine = 0;
+    oled->sentStartLine = 0;
 
-    efHal_spi_config(spi, 4000000, EF_HAL_SPI_CPOL_1_CPHA_1);
-    efHal_gpio_confPin(cmdPin, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, false);
-    efHal_gpio_confPin(rstPin, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, false);
+#if OLED_FLUSH_TASK
+    oled->frameDone = NULL;
+#endif
+
+    efHal_spi_config(pConf->spi, 4000000, EF_HAL_SPI_CPOL_1_CPHA_1);
+    efHal_gpio_confPin(pConf->cmdPin, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, false);
+    efHal_gpio_confPin(pConf->rstPin, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, false);
 
     /* make sure power is off */
-    OLED_DISABLE();
+    OLED_DISABLE(oled);
 
     /* small delay before turning on power */
     for (i = 0; i < 0xffff; i++);
 
     /* power on */
-    OLED_ENABLE();
+    OLED_ENABLE(oled);
 
-    runInitSequence();
+    runInitSequence(oled);
 
-    memset(shadowFB, 0, SHADOW_FB_SIZE);
+    /* display RAM is undefined after reset, everything is sent on the
+     * first flush */
+    canvas_init(&oled->canvas, pBuf, pDirty, pConf->width, pConf->height);
+    canvas_clear(&oled->canvas, CANVAS_COLOR_BLACK);
 }
 
 /******************************************************************************
  *
  * Description:
- *    Initialize the OLED Display
+ *    Set the display contrast
  *
  * Params:
+ *   [in] oled     - display
  * 	 [in] contrast - display contrast (0-255)
  *****************************************************************************/
 
-void oled_setContrast(uint8_t contrast){
-	writeCommand(0x81);
-	writeCommand(contrast);
+void oled_setContrast(oled_t *oled, uint8_t contrast){
+	uint8_t cmd[2] = {0x81, contrast};
+
+	writeCommands(oled, cmd, sizeof(cmd));
 }
 
 /******************************************************************************
  *
  * Description:
- *    Draw one pixel on the display
+ *    Send the changed columns of the canvas to the display
  *
  * Params:
- *   [in] x - x position
- *   [in] y - y position
- *   [in] color - color of the pixel
+ *   [in] oled - display
  *
  *****************************************************************************/
-void oled_putPixel(uint8_t x, uint8_t y, oled_color_t color) {
-    uint8_t page;
-    uint16_t add;
-    uint8_t lAddr;
-    uint8_t hAddr;
-    uint8_t mask;
-    uint32_t shadowPos = 0;
-
-    if (x > OLED_DISPLAY_WIDTH) {
-        return;
-    }
-    if (y > OLED_DISPLAY_HEIGHT) {
+void oled_flush(oled_t *oled)
+{
+    if (oled->scrolling)
         return;
-    }
 
-    /* page address */
-         if(y < 8)  page = 0xB0;
-    else if(y < 16) page = 0xB1;
-    else if(y < 24) page = 0xB2;
-    else if(y < 32) page = 0xB3;
-    else if(y < 40) page = 0xB4;
-    else if(y < 48) page = 0xB5;
-    else if(y < 56) page = 0xB6;
-    else            page = 0xB7;
-
-    add = x + X_OFFSET;
-    lAddr = 0x0F & add;             // Low address
-    hAddr = 0x10 | (add >> 4);      // High address
-
-    // Calculate mask from rows basically do a y%8 and remainder is bit position
-    add = y>>3;                     // Divide by 8
-    add <<= 3;                      // Multiply by 8
-    add = y - add;                  // Calculate bit position
-    mask = 1 << add;                // Left shift 1 by bit position
-
-    setAddress(page, lAddr, hAddr); // Set the address (sets the page,
-                                    // lower and higher column address pointers)
-
-    shadowPos = (page-0xB0)*OLED_DISPLAY_WIDTH+x;
-
-    if(color > 0)
-        shadowFB[shadowPos] |= mask;
-    else
-        shadowFB[shadowPos] &= ~mask;
+    sendFrame(oled, oled->canvas.pBuf, oled->canvas.pDirty, oled->startLine);
 
-    writeData(shadowFB[shadowPos]);
+    canvas_clearDirty(&oled->canvas);
 }
 
 /******************************************************************************
  *
  * Description:
- *    Draw a line on the display starting at x0,y0 and ending at x1,y1
+ *    Write a window straight to the display, e.g. a text line. The frame
+ *    buffer (and the other one of the flush task) gets the same data, so
+ *    it isn't sent again
  *
  * Params:
- *   [in] x0 - start x position
- *   [in] y0 - start y position
- *   [in] x1 - end x position
- *   [in] y1 - end y position
- *   [in] color - color of the line
+ *   [in] oled  - display
+ *   [in] x0    - first column
+ *   [in] page0 - first page
+ *   [in] x1    - last column
+ *   [in] page1 - last page
+ *   [in] pData - x1 - x0 + 1 bytes for each page
  *
  *****************************************************************************/
-void oled_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, oled_color_t color)
+void oled_writeWindow(oled_t *oled, int16_t x0, int16_t page0, int16_t x1,
+        int16_t page1, uint8_t const *pData)
 {
-    int16_t   dx = 0, dy = 0;
-    int8_t    dx_sym = 0, dy_sym = 0;
-    int16_t   dx_x2 = 0, dy_x2 = 0;
-    int16_t   di = 0;
-
-    dx = x1-x0;
-    dy = y1-y0;
-
-
-    if(dx == 0)           /* vertical line */
-    {
-        vLine(x0, y0, y1, color);
-        return;
-    }
-
-    if(dx > 0)
-    {
-        dx_sym = 1;
-    }
-    else
-    {
-        dx_sym = -1;
-    }
+    canvas_t *c = &oled->canvas;
+    size_t len = x1 - x0 + 1;
+    int16_t page;
 
+    lockFrame(oled);
 
-    if(dy == 0)           /* horizontal line */
-    {
-        hLine(x0, y0, x1, color);
-        return;
-    }
-
-
-    if(dy > 0)
-    {
-        dy_sym = 1;
-    }
-    else
+    for (page = page0 ; page <= page1 ; page++)
     {
-        dy_sym = -1;
+        memcpy(&c->pBuf[page*c->width+x0], &pData[(page-page0)*len], len);
+#if OLED_FLUSH_TASK
+        if (oled->frameDone != NULL)
+            memcpy(&oled->pOtherBuf[page*c->width+x0], &pData[(page-page0)*len], len);
+#endif
     }
 
-    dx = dx_sym*dx;
-    dy = dy_sym*dy;
+    /* RAM is sent again when the scroll stops */
+    if (!oled->scrolling)
+        writeWindow(oled, pData, len, x0, page0, x1, page1);
 
-    dx_x2 = dx*2;
-    dy_x2 = dy*2;
-
-    if(dx >= dy)
-    {
-        di = dy_x2 - dx;
-        while(x0 != x1)
-        {
-
-            oled_putPixel(x0, y0, color);
-            x0 += dx_sym;
-            if(di<0)
-            {
-                di += dy_x2;
-            }
-            else
-            {
-                di += dy_x2 - dx_x2;
-                y0 += dy_sym;
-            }
-        }
-        oled_putPixel(x0, y0, color);
-    }
-    else
-    {
-        di = dx_x2 - dy;
-        while(y0 != y1)
-        {
-            oled_putPixel(x0, y0, color);
-            y0 += dy_sym;
-            if(di < 0)
-            {
-                di += dx_x2;
-            }
-            else
-            {
-                di += dx_x2 - dy_x2;
-                x0 += dx_sym;
-            }
-        }
-        oled_putPixel(x0, y0, color);
-    }
-    return;
+    unlockFrame(oled);
 }
 
 /******************************************************************************
  *
  * Description:
- *    Draw a circle on the display starting at x0,y0 with radius r
+ *    Start a continuous scroll of the SSD1306
  *
  * Params:
- *   [in] x0 - start x position
- *   [in] y0 - start y position
- *   [in] r - radius
- *   [in] color - color of the circle
+ *   [in] oled    - display
+ *   [in] dir     - direction
+ *   [in] page0   - first page scrolled
+ *   [in] page1   - last page scrolled
+ *   [in] step    - frames between steps
+ *   [in] vOffset - rows of each vertical step, for OLED_SCROLL_UP_x
+ *
+ * Returns:
+ *   false if the controller has no scroll
  *
  *****************************************************************************/
-void oled_circle(uint8_t x0, uint8_t y0, uint8_t r, oled_color_t color)
+bool oled_scrollStart(oled_t *oled, oled_scrollDir_t dir, uint8_t page0,
+        uint8_t page1, oled_scrollStep_t step, uint8_t vOffset)
 {
-    int16_t draw_x0, draw_y0;
-    int16_t draw_x1, draw_y1;
-    int16_t draw_x2, draw_y2;
-    int16_t draw_x3, draw_y3;
-    int16_t draw_x4, draw_y4;
-    int16_t draw_x5, draw_y5;
-    int16_t draw_x6, draw_y6;
-    int16_t draw_x7, draw_y7;
-    int16_t xx, yy;
-    int16_t  di;
-
-    if(r == 0)          /* no radius */
-    {
-        return;
-    }
+    uint8_t cmd[11];
+    size_t len = 0;
+    bool vertical = (dir == OLED_SCROLL_UP_RIGHT || dir == OLED_SCROLL_UP_LEFT);
 
-    draw_x0 = draw_x1 = x0;
-    draw_y0 = draw_y1 = y0 + r;
-    if(draw_y0 < OLED_DISPLAY_HEIGHT)
-    {
-        oled_putPixel(draw_x0, draw_y0, color);     /* 90 degree */
-    }
+    if (oled->conf.ctrl == OLED_CTRL_SH1106)
+        return false;
 
-    draw_x2 = draw_x3 = x0;
-    draw_y2 = draw_y3 = y0 - r;
-    if(draw_y2 >= 0)
-    {
-        oled_putPixel(draw_x2, draw_y2, color);    /* 270 degree */
-    }
+    /* the scroll can only be set up while stopped */
+    cmd[len++] = 0x2E;
 
-    draw_x4 = draw_x6 = x0 + r;
-    draw_y4 = draw_y6 = y0;
-    if(draw_x4 < OLED_DISPLAY_WIDTH)
+    if (vertical)
     {
-        oled_putPixel(draw_x4, draw_y4, color);     /* 0 degree */
+        /* vertical scroll area: the whole display */
+        cmd[len++] = 0xA3;
+        cmd[len++] = 0x00;
+        cmd[len++] = oled->conf.height;
     }
 
-    draw_x5 = draw_x7 = x0 - r;
-    draw_y5 = draw_y7 = y0;
-    if(draw_x5>=0)
-    {
-        oled_putPixel(draw_x5, draw_y5, color);     /* 180 degree */
-    }
+    cmd[len++] = dir;
+    cmd[len++] = 0x00;
+    cmd[len++] = page0;
+    cmd[len++] = step;
+    cmd[len++] = page1;
 
-    if(r == 1)
+    if (vertical)
     {
-        return;
+        cmd[len++] = vOffset;
     }
-
-    di = 3 - 2*r;
-    xx = 0;
-    yy = r;
-    while(xx < yy)
+    else
     {
+        cmd[len++] = 0x00;
+        cmd[len++] = 0xFF;
+    }
 
-        if(di < 0)
-        {
-            di += 4*xx + 6;
-        }
-        else
-        {
-            di += 4*(xx - yy) + 10;
-            yy--;
-            draw_y0--;
-            draw_y1--;
-            draw_y2++;
-            draw_y3++;
-            draw_x4--;
-            draw_x5++;
-            draw_x6--;
-            draw_x7++;
-        }
-        xx++;
-        draw_x0++;
-        draw_x1--;
-        draw_x2++;
-        draw_x3--;
-        draw_y4++;
-        draw_y5++;
-        draw_y6--;
-        draw_y7--;
-
-        if( (draw_x0 <= OLED_DISPLAY_WIDTH) && (draw_y0>=0) )
-        {
-            oled_putPixel(draw_x0, draw_y0, color);
-        }
-
-        if( (draw_x1 >= 0) && (draw_y1 >= 0) )
-        {
-            oled_putPixel(draw_x1, draw_y1, color);
-        }
+    cmd[len++] = 0x2F;
 
-        if( (draw_x2 <= OLED_DISPLAY_WIDTH) && (draw_y2 <= OLED_DISPLAY_HEIGHT) )
-        {
-            oled_putPixel(draw_x2, draw_y2, color);
-        }
-
-        if( (draw_x3 >=0 ) && (draw_y3 <= OLED_DISPLAY_HEIGHT) )
-        {
-            oled_putPixel(draw_x3, draw_y3, color);
-        }
+    lockFrame(oled);
+    writeCommands(oled, cmd, len);
+    oled->scrolling = true;
+    unlockFrame(oled);
 
-        if( (draw_x4 <= /*OLED_DISPLAY_HEIGHT*/OLED_DISPLAY_WIDTH) && (draw_y4 >= 0) )
-        {
-            oled_putPixel(draw_x4, draw_y4, color);
-        }
-
-        if( (draw_x5 >= 0) && (draw_y5 >= 0) )
-        {
-            oled_putPixel(draw_x5, draw_y5, color);
-        }
-        if( (draw_x6 <= OLED_DISPLAY_WIDTH) && (draw_y6 <= OLED_DISPLAY_HEIGHT) )
-        {
-            oled_putPixel(draw_x6, draw_y6, color);
-        }
-        if( (draw_x7 >= 0) && (draw_y7 <= OLED_DISPLAY_HEIGHT) )
-        {
-            oled_putPixel(draw_x7, draw_y7, color);
-        }
-    }
-    return;
+    return true;
 }
 
 /******************************************************************************
  *
  * Description:
- *    Draw a rectangle on the display starting at x0,y0 and ending at x1,y1
+ *    Stop the continuous scroll, the scroll moved the display RAM so the
+ *    whole frame buffer is sent on the next flush
  *
  * Params:
- *   [in] x0 - start x position
- *   [in] y0 - start y position
- *   [in] x1 - end x position
- *   [in] y1 - end y position
- *   [in] color - color of the rectangle
+ *   [in] oled - display
  *
  *****************************************************************************/
-void oled_rect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, oled_color_t color)
+void oled_scrollStop(oled_t *oled)
 {
-    hLine(x0, y0, x1, color);
-    hLine(x0, y1, x1, color);
-    vLine(x0, y0, y1, color);
-    vLine(x1, y0, y1, color);
+    uint8_t cmd = 0x2E;
+    int16_t page;
+
+    if (!oled->scrolling)
+        return;
+
+    lockFrame(oled);
+    writeCommands(oled, &cmd, 1);
+    oled->scrolling = false;
+    unlockFrame(oled);
+
+    for (page = 0 ; page < TOTAL_PAGES(oled) ; page++)
+        canvas_setDirty(&oled->canvas, page, 0, oled->conf.width - 1);
 }
 
 /******************************************************************************
  *
  * Description:
- *    Fill a rectangle on the display starting at x0,y0 and ending at x1,y1
+ *    Scroll the display up moving its start line, see oled.h
  *
  * Params:
- *   [in] x0 - start x position
- *   [in] y0 - start y position
- *   [in] x1 - end x position
- *   [in] y1 - end y position
- *   [in] color - color of the rectangle
+ *   [in] oled - display
+ *   [in] rows - rows to scroll, 0 to 63
+ *
+ * Returns:
+ *   canvas row of the first row now at the bottom, -1 if the display is
+ *   not 64 rows high
  *
  *****************************************************************************/
-void oled_fillRect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, oled_color_t color)
+int16_t oled_scrollUp(oled_t *oled, int16_t rows)
 {
-    uint8_t i = 0;
+    int16_t ret = oled->startLine;
 
-    if(x0 > x1)
-    {
-        i  = x0;
-        x0 = x1;
-        x1 = i;
-    }
+    if (oled->conf.height != RAM_ROWS || rows < 0 || rows >= RAM_ROWS)
+        return -1;
 
-    if(y0 > y1)
-    {
-        i  = y0;
-        y0 = y1;
-        y1 = i;
-    }
-
-    if(y0 == y1)
-    {
-        hLine(x0, y0, x1, color);
-        return;
-    }
-
-    if(x0 == x1)
-    {
-        vLine(x0, y0, y1, color);
-        return;
-    }
+    oled->startLine = (oled->startLine + rows) % RAM_ROWS;
 
-    while(y0 <= y1)
-    {
-        hLine(x0, y0, x1, color);
-        y0++;
-    }
-    return;
+    return ret;
 }
 
+#if OLED_FLUSH_TASK
 /******************************************************************************
  *
  * Description:
- *    Clear the entire screen
+ *    Start the background flush task of a display, frames are then sent
+ *    with oled_present()
  *
  * Params:
- *   [in] color - color to fill the screen with
+ *   [in] oled     - display
+ *   [in] pBuf2    - second frame buffer, same size as the one of oled_init()
+ *   [in] pDirty2  - changed columns of the second buffer
+ *   [in] priority - priority of the flush task
+ *   [in] maxFps   - frame rate limit, 0 for no limit
+ *   [in] cb       - called by the flush task after each frame, can be NULL
+ *   [in] ctx      - parameter of cb
  *
  *****************************************************************************/
-void oled_clearScreen(oled_color_t color)
+void oled_startFlushTask(oled_t *oled, uint8_t *pBuf2, canvas_span_t *pDirty2,
+        UBaseType_t priority, uint32_t maxFps, oled_frameDoneCB_t cb, void *ctx)
 {
-    uint8_t i;
-    uint8_t c = 0;
+    /* the second buffer starts as the frame on the display */
+    oled_flush(oled);
+    memcpy(pBuf2, oled->canvas.pBuf, CANVAS_BUF_SIZE(oled->conf.width, oled->conf.height));
 
-    if (color == OLED_COLOR_WHITE)
-        c = 0xff;
+    oled->pOtherBuf = pBuf2;
+    oled->pOtherDirty = pDirty2;
 
+    oled->frameReady = xSemaphoreCreateBinary();
+    oled->frameDone = xSemaphoreCreateBinary();
+    xSemaphoreGive(oled->frameDone);
 
-    for(i=0xB0;i<0xB8;i++) {            // Go through all 8 pages
-        setAddress(i,0x00,0x10);
-        writeDataLen(c, 132);
-    }
+    oled->framePeriod = maxFps ? pdMS_TO_TICKS(1000 / maxFps) : 0;
+    oled->frameDoneCB = cb;
+    oled->frameDoneCtx = ctx;
 
-    memset(shadowFB, c, SHADOW_FB_SIZE);
+    xTaskCreate(flushTask, "oledFlush", OLED_FLUSH_TASK_STACK, oled, priority, NULL);
 }
 
-uint8_t oled_putChar(uint8_t x, uint8_t y, uint8_t ch, oled_color_t fb, oled_color_t bg)
+/******************************************************************************
+ *
+ * Description:
+ *    Hand the drawn frame to the flush task and continue drawing the next
+ *    one on the other buffer. Only waits if the previous frame is still
+ *    being sent. Without the flush task it is oled_flush()
+ *
+ * Params:
+ *   [in] oled - display
+ *
+ *****************************************************************************/
+void oled_present(oled_t *oled)
 {
-    unsigned char data = 0;
-    unsigned char i = 0, j = 0;
-
-    oled_color_t color = OLED_COLOR_BLACK;
+    canvas_t *c = &oled->canvas;
+    canvas_span_t *pDirty;
+    int16_t i;
 
-    if((x >= (OLED_DISPLAY_WIDTH - 8)) || (y >= (OLED_DISPLAY_HEIGHT - 8)) )
+    if (oled->frameDone == NULL)
     {
-        return 0;
+        oled_flush(oled);
+        return;
     }
 
-    if( (ch < 0x20) || (ch > 0x7f) )
-    {
-        ch = 0x20;      /* unknown character will be set to blank */
-    }
+    xSemaphoreTake(oled->frameDone, portMAX_DELAY);
+
+    oled->pFrontBuf = c->pBuf;
+    oled->pFrontDirty = c->pDirty;
+    oled->frontStartLine = oled->startLine;
 
-    ch -= 0x20;
-    for(i=0; i<8; i++)
+    /* the other buffer has the previous frame, it only lacks the columns
+     * changed in this one */
+    pDirty = oled->pFrontDirty;
+
+    for (i = 0 ; i < TOTAL_PAGES(oled) ; i++)
     {
-        data = font5x7[ch][i];
-        for(j=0; j<6; j++)
+        if (pDirty[i].min <= pDirty[i].max)
         {
-            if( (data&font_mask[j])==0 )
-            {
-                color = bg;
-            }
-            else
-            {
-                color = fb;
-            }
-            oled_putPixel(x, y, color);
-            x++;
+            memcpy(&oled->pOtherBuf[i*c->width+pDirty[i].min],
+                    &c->pBuf[i*c->width+pDirty[i].min],
+                    pDirty[i].max - pDirty[i].min + 1);
         }
-        y++;
-        x -= 6;
     }
-    return( 1 );
+
+    c->pBuf = oled->pOtherBuf;
+    c->pDirty = oled->pOtherDirty;
+    canvas_clearDirty(c);
+
+    oled->pOtherBuf = oled->pFrontBuf;
+    oled->pOtherDirty = oled->pFrontDirty;
+
+    xSemaphoreGive(oled->frameReady);
 }
 
-void oled_putString(uint8_t x, uint8_t y, uint8_t *pStr, oled_color_t fb,
-        oled_color_t bg)
+/******************************************************************************
+ *
+ * Description:
+ *    Wait until the last presented frame is on the display
+ *
+ * Params:
+ *   [in] oled      - display
+ *   [in] blockTime - maximum time to wait
+ *
+ * Returns:
+ *   true if the frame was sent
+ *
+ *****************************************************************************/
+bool oled_waitFrame(oled_t *oled, TickType_t blockTime)
 {
-  while(1)
-  {
-      if( (*pStr)=='\0' )
-      {
-          break;
-      }
-      if( oled_putChar(x, y, *pStr++, fb, bg) == 0 )
-      {
-        break;
+    bool ret = true;
+
+    if (oled->frameDone != NULL)
+    {
+        ret = xSemaphoreTake(oled->frameDone, blockTime) == pdTRUE;
+
+        if (ret)
+            xSemaphoreGive(oled->frameDone);
     }
-    x += 6;
-  }
-  return;
-}
 
+    return ret;
+}
+#endif
@@ -0,0 +1,673 @@
+/*
+###############################################################################
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "unity.h"
+#include "oled.h"
+#include "efHal_spi.h"
+#include "freertos_fake.h"
+#include "string.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define WIDTH           128
+#define HEIGHT          64
+#define PAGES           CANVAS_PAGES(HEIGHT)
+
+/* SH1106 RAM has 132 columns */
+#define GRAM_WIDTH      132
+
+#define CMD_PIN_A       1
+#define CMD_PIN_B       3
+#define RST_PIN         2
+
+#define MAX_CMDS        64
+
+#define FLUSH_PRIORITY  1
+#define MAX_FPS         20      /* 50 ms frame period */
+#define FRAME_WAIT      pdMS_TO_TICKS(1000)
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/* controller of each display rebuilt from what the driver sends, the
+ * display is selected by its command pin */
+typedef struct
+{
+    uint8_t gram[PAGES][GRAM_WIDTH];
+    uint8_t mode;                       /* 0x20 argument, page mode at reset */
+    uint8_t col;
+    uint8_t page;
+    uint8_t colStart;
+    uint8_t colEnd;
+    uint8_t pageStart;
+    uint8_t pageEnd;
+    uint8_t startLine;
+    bool scrolling;
+}display_t;
+
+static display_t disp[2];
+static int32_t transactions;
+static int32_t dataBytes;
+
+/* command bytes of the last transaction */
+static uint8_t cmds[MAX_CMDS];
+static int32_t nCmds;
+
+static uint8_t buf[2][CANVAS_BUF_SIZE(WIDTH, HEIGHT)];
+static canvas_span_t dirty[2][PAGES];
+static oled_t oled;
+
+/* second buffer of the flush task */
+static uint8_t buf2[CANVAS_BUF_SIZE(WIDTH, HEIGHT)];
+static canvas_span_t dirty2[PAGES];
+
+/* frames sent by the flush task */
+static int32_t frames;
+static TickType_t frameTick[8];
+
+static oled_conf_t const confA =
+{
+    .spi = NULL,
+    .cmdPin = CMD_PIN_A,
+    .rstPin = RST_PIN,
+    .ctrl = OLED_CTRL_SSD1306,
+    .xOffset = 0,
+    .width = WIDTH,
+    .height = HEIGHT,
+};
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+static bool findCmd(uint8_t cmd, uint8_t arg)
+{
+    int32_t i;
+
+    for (i = 0 ; i + 1 < nCmds ; i++)
+    {
+        if (cmds[i] == cmd && cmds[i + 1] == arg)
+            return true;
+    }
+
+    return false;
+}
+
+static int argsOf(uint8_t cmd)
+{
+    switch (cmd)
+    {
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xAD:
+        case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        case 0x21: case 0x22: case 0xA3:
+            return 2;
+        case 0x26: case 0x27:
+            return 6;
+        case 0x29: case 0x2A:
+            return 5;
+        default:
+            return 0;
+    }
+}
+
+static void runCmd(display_t *p, uint8_t const *cmd)
+{
+    if (cmd[0] == 0x20)
+        p->mode = cmd[1];
+    else if (cmd[0] == 0x21)
+    {
+        p->colStart = p->col = cmd[1];
+        p->colEnd = cmd[2];
+    }
+    else if (cmd[0] == 0x22)
+    {
+        p->pageStart = p->page = cmd[1];
+        p->pageEnd = cmd[2];
+    }
+    else if (cmd[0] == 0x2E)
+        p->scrolling = false;
+    else if (cmd[0] == 0x2F)
+        p->scrolling = true;
+    else if ((cmd[0] & 0xF8) == 0xB0)
+        p->page = cmd[0] & 0x07;
+    else if ((cmd[0] & 0xF0) == 0x00)
+        p->col = (p->col & 0xF0) | cmd[0];
+    else if ((cmd[0] & 0xF0) == 0x10)
+        p->col = (p->col & 0x0F) | (cmd[0] << 4);
+    else if ((cmd[0] & 0xC0) == 0x40)
+        p->startLine = cmd[0] & 0x3F;
+}
+
+static void writeData(display_t *p, uint8_t data)
+{
+    /* RAM can't be written during a continuous scroll */
+    TEST_ASSERT_FALSE(p->scrolling);
+    TEST_ASSERT_TRUE(p->page < PAGES && p->col < GRAM_WIDTH);
+
+    p->gram[p->page][p->col] = data;
+    dataBytes++;
+
+    if (p->mode != 0x00)
+    {
+        p->col++;
+    }
+    else if (p->col++ == p->colEnd)
+    {
+        p->col = p->colStart;
+        p->page = (p->page == p->pageEnd) ? p->pageStart : p->page + 1;
+    }
+}
+
+static void frameDone(void *ctx)
+{
+    if (frames < (int32_t)(sizeof(frameTick) / sizeof(frameTick[0])))
+        frameTick[frames] = xTaskGetTickCount();
+
+    frames++;
+    *(int32_t *)ctx = transactions;
+}
+
+static void startFlushTask(uint32_t maxFps, int32_t *pTransactions)
+{
+    frames = 0;
+    oled_startFlushTask(&oled, buf2, dirty2, FLUSH_PRIORITY, maxFps, frameDone, pTransactions);
+
+    transactions = 0;
+    dataBytes = 0;
+}
+
+/*==================[external functions definition]==========================*/
+
+/* efHal fakes, the display side of the bus */
+extern void efHal_spi_config(efHal_dh_t dh, int32_t clockFrec, efHal_spi_mode_t mode)
+{
+}
+
+extern void efHal_spi_transaction(efHal_dh_t dh, efHal_spi_seg_t const *pSeg, int32_t nSeg)
+{
+    static uint8_t cmd[8];
+    static int nCmd;
+    uint8_t *pData;
+    size_t i;
+    int32_t s;
+    display_t *p;
+
+    transactions++;
+    nCmds = 0;
+
+    for (s = 0 ; s < nSeg ; s++)
+    {
+        pData = pSeg[s].pTx;
+
+        TEST_ASSERT_TRUE(pSeg[s].gpio == CMD_PIN_A || pSeg[s].gpio == CMD_PIN_B);
+        p = &disp[pSeg[s].gpio == CMD_PIN_B];
+
+        for (i = 0 ; i < pSeg[s].length ; i++)
+        {
+            if (pSeg[s].gpioState)
+            {
+                writeData(p, pData[i]);
+                continue;
+            }
+
+            if (nCmds < MAX_CMDS)
+                cmds[nCmds++] = pData[i];
+
+            cmd[nCmd++] = pData[i];
+
+            if (nCmd > argsOf(cmd[0]))
+            {
+                runCmd(p, cmd);
+                nCmd = 0;
+            }
+        }
+    }
+}
+
+extern void efHal_gpio_confPin(efHal_gpio_id_t id, efHal_gpio_dir_t dir, efHal_gpio_pull_t pull, bool state)
+{
+}
+
+extern void efHal_gpio_setPin(efHal_gpio_id_t id, bool state)
+{
+}
+
+void setUp(void)
+{
+    disp[0].mode = 0x02;
+    disp[1].mode = 0x02;
+
+    oled_init(&oled, &confA, buf[0], dirty[0]);
+    oled_flush(&oled);
+
+    memset(disp[0].gram, 0x55, sizeof(disp[0].gram));
+    memset(disp[1].gram, 0x55, sizeof(disp[1].gram));
+    transactions = 0;
+    dataBytes = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void test_oled_init_firstFlushSendsAll(void)
+{
+    int page;
+    int x;
+
+    memset(buf[0], 0xAA, sizeof(buf[0]));
+    oled_init(&oled, &confA, buf[0], dirty[0]);
+
+    TEST_ASSERT_TRUE(findCmd(0xA8, HEIGHT - 1));
+    TEST_ASSERT_TRUE(findCmd(0xDA, 0x12));
+    TEST_ASSERT_TRUE(findCmd(0x8D, 0x14));
+
+    transactions = 0;
+    oled_flush(&oled);
+
+    /* one window for the whole display */
+    TEST_ASSERT_EQUAL_INT32(1, transactions);
+    TEST_ASSERT_EQUAL_INT32(WIDTH * PAGES, dataBytes);
+
+    for (page = 0 ; page < PAGES ; page++)
+    {
+        for (x = 0 ; x < WIDTH ; x++)
+            TEST_ASSERT_EQUAL_HEX8(0x00, disp[0].gram[page][x]);
+    }
+}
+
+void test_oled_init_32rows(void)
+{
+    oled_conf_t conf = confA;
+
+    conf.height = 32;
+    oled_init(&oled, &conf, buf[0], dirty[0]);
+
+    TEST_ASSERT_TRUE(findCmd(0xA8, 31));
+    TEST_ASSERT_TRUE(findCmd(0xDA, 0x02));
+
+    transactions = 0;
+    oled_flush(&oled);
+
+    TEST_ASSERT_EQUAL_INT32(1, transactions);
+    TEST_ASSERT_EQUAL_INT32(WIDTH * CANVAS_PAGES(32), dataBytes);
+}
+
+void test_oled_flush_onlyDirtySpan(void)
+{
+    canvas_putPixel(&oled.canvas, 10, 9, CANVAS_COLOR_WHITE);
+    canvas_putPixel(&oled.canvas, 20, 15, CANVAS_COLOR_WHITE);
+    oled_flush(&oled);
+
+    TEST_ASSERT_EQUAL_INT32(1, transactions);
+    TEST_ASSERT_EQUAL_HEX8(0x55, disp[0].gram[1][9]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, disp[0].gram[1][10]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, disp[0].gram[1][11]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, disp[0].gram[1][20]);
+    TEST_ASSERT_EQUAL_HEX8(0x55, disp[0].gram[1][21]);
+
+    /* nothing changed since */
+    oled_flush(&oled);
+    TEST_ASSERT_EQUAL_INT32(1, transactions);
+}
+
+void test_oled_flush_windows(void)
+{
+    /* close spans share a window */
+    canvas_putPixel(&oled.canvas, 10, 8, CANVAS_COLOR_WHITE);
+    canvas_putPixel(&oled.canvas, 12, 16, CANVAS_COLOR_WHITE);
+    oled_flush(&oled);
+
+    TEST_ASSERT_EQUAL_INT32(1, transactions);
+    TEST_ASSERT_EQUAL_INT32(6, dataBytes);
+    TEST_ASSERT_EQUAL_HEX8(0x01, disp[0].gram[1][10]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, disp[0].gram[1][12]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, disp[0].gram[2][10]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, disp[0].gram[2][12]);
+    TEST_ASSERT_EQUAL_HEX8(0x55, disp[0].gram[1][13]);
+
+    /* far apart ones don't */
+    transactions = 0;
+    dataBytes = 0;
+    canvas_putPixel(&oled.canvas, 0, 0, CANVAS_COLOR_WHITE);
+    canvas_putPixel(&oled.canvas, WIDTH - 1, HEIGHT - 1, CANVAS_COLOR_WHITE);
+    oled_flush(&oled);
+
+    TEST_ASSERT_EQUAL_INT32(2, transactions);
+    TEST_ASSERT_EQUAL_INT32(2, dataBytes);
+    TEST_ASSERT_EQUAL_HEX8(0x01, disp[0].gram[0][0]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, disp[0].gram[PAGES - 1][WIDTH - 1]);
+}
+
+void test_oled_writeWindow(void)
+{
+    uint8_t data[] = {1, 2, 3, 4, 5, 6};
+
+    oled_writeWindow(&oled, 20, 2, 22, 3, data);
+
+    TEST_ASSERT_EQUAL_INT32(1, transactions);
+    TEST_ASSERT_EQUAL_HEX8(0x55, disp[0].gram[2][19]);
+    TEST_ASSERT_EQUAL_HEX8(1, disp[0].gram[2][20]);
+    TEST_ASSERT_EQUAL_HEX8(3, disp[0].gram[2][22]);
+    TEST_ASSERT_EQUAL_HEX8(4, disp[0].gram[3][20]);
+    TEST_ASSERT_EQUAL_HEX8(6, disp[0].gram[3][22]);
+    TEST_ASSERT_EQUAL_HEX8(0x55, disp[0].gram[3][23]);
+
+    /* in the frame buffer too, without sending it again */
+    TEST_ASSERT_EQUAL_HEX8(5, buf[0][3 * WIDTH + 21]);
+    oled_flush(&oled);
+    TEST_ASSERT_EQUAL_INT32(1, transactions);
+}
+
+void test_oled_writeWindow_sh1106(void)
+{
+    oled_conf_t conf = confA;
+    uint8_t data[] = {1, 2, 3, 4};
+
+    conf.cmdPin = CMD_PIN_B;
+    conf.ctrl = OLED_CTRL_SH1106;
+    conf.xOffset = 2;
+    oled_init(&oled, &conf, buf[1], dirty[1]);
+
+    transactions = 0;
+    oled_writeWindow(&oled, 0, 6, 1, 7, data);
+
+    TEST_ASSERT_EQUAL_INT32(1, transactions);
+    TEST_ASSERT_EQUAL_HEX8(1, disp[1].gram[6][2]);
+    TEST_ASSERT_EQUAL_HEX8(2, disp[1].gram[6][3]);
+    TEST_ASSERT_EQUAL_HEX8(3, disp[1].gram[7][2]);
+    TEST_ASSERT_EQUAL_HEX8(4, disp[1].gram[7][3]);
+
+    TEST_ASSERT_FALSE(oled_scrollStart(&oled, OLED_SCROLL_LEFT, 0, 7, OLED_SCROLL_2_FRAMES, 0));
+}
+
+void test_oled_scrollStartStop(void)
+{
+    TEST_ASSERT_TRUE(oled_scrollStart(&oled, OLED_SCROLL_LEFT, 1, 3, OLED_SCROLL_5_FRAMES, 0));
+    TEST_ASSERT_TRUE(findCmd(0x27, 0x00));
+    TEST_ASSERT_TRUE(findCmd(0x03, 0x00));
+    TEST_ASSERT_TRUE(disp[0].scrolling);
+
+    /* RAM isn't written while scrolling */
+    transactions = 0;
+    canvas_putPixel(&oled.canvas, 0, 0, CANVAS_COLOR_WHITE);
+    oled_flush(&oled);
+    TEST_ASSERT_EQUAL_INT32(0, transactions);
+
+    TEST_ASSERT_TRUE(oled_scrollStart(&oled, OLED_SCROLL_UP_RIGHT, 0, 7, OLED_SCROLL_2_FRAMES, 1));
+    TEST_ASSERT_TRUE(findCmd(0xA3, 0x00));
+    TEST_ASSERT_TRUE(findCmd(0x29, 0x00));
+
+    oled_scrollStop(&oled);
+    TEST_ASSERT_FALSE(disp[0].scrolling);
+
+    /* the scroll moved the RAM, everything is sent */
+    oled_flush(&oled);
+    TEST_ASSERT_EQUAL_INT32(WIDTH * PAGES, dataBytes);
+    TEST_ASSERT_EQUAL_HEX8(0x01, disp[0].gram[0][0]);
+}
+
+void test_oled_scrollUp_log(void)
+{
+    oled_conf_t conf = confA;
+    int16_t y;
+    int line;
+
+    /* fill the screen, then each new line scrolls it up */
+    for (line = 0 ; line < 12 ; line++)
+    {
+        if (line < PAGES)
+        {
+            y = line * 8;
+        }
+        else
+        {
+            y = oled_scrollUp(&oled, 8);
+            TEST_ASSERT_EQUAL_INT16((line - PAGES) * 8, y);
+        }
+
+        canvas_fillRect(&oled.canvas, 0, y, WIDTH - 1, y + 7, CANVAS_COLOR_BLACK);
+        canvas_putString(&oled.canvas, 0, y, "log line", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+
+        transactions = 0;
+        dataBytes = 0;
+        oled_flush(&oled);
+
+        /* one row of text, plus the start line */
+        TEST_ASSERT_TRUE(dataBytes <= WIDTH);
+        TEST_ASSERT_EQUAL_INT32((line < PAGES) ? 1 : 2, transactions);
+    }
+
+    TEST_ASSERT_EQUAL_UINT8(32, disp[0].startLine);
+    TEST_ASSERT_EQUAL_INT16(-1, oled_scrollUp(&oled, 64));
+
+    conf.height = 32;
+    oled_init(&oled, &conf, buf[0], dirty[0]);
+    TEST_ASSERT_EQUAL_INT16(-1, oled_scrollUp(&oled, 8));
+}
+
+void test_oled_textScreen_transactions(void)
+{
+    int y;
+
+    for (y = 0 ; y < HEIGHT - 8 ; y += 8)
+        canvas_putString(&oled.canvas, 0, y, "0123456789ABCDEFGHIJ", CANVAS_COLOR_WHITE, CANVAS_COLOR_BLACK);
+
+    oled_flush(&oled);
+
+    TEST_ASSERT_TRUE(transactions <= PAGES);
+}
+
+void test_oled_sh1106_xOffset(void)
+{
+    oled_conf_t conf = confA;
+    int page;
+
+    conf.cmdPin = CMD_PIN_B;
+    conf.ctrl = OLED_CTRL_SH1106;
+    conf.xOffset = 2;
+
+    oled_init(&oled, &conf, buf[1], dirty[1]);
+
+    /* DC-DC instead of the SSD1306 charge pump */
+    TEST_ASSERT_TRUE(findCmd(0xAD, 0x8B));
+    TEST_ASSERT_FALSE(findCmd(0x8D, 0x14));
+
+    oled_flush(&oled);
+
+    for (page = 0 ; page < PAGES ; page++)
+    {
+        TEST_ASSERT_EQUAL_HEX8(0x55, disp[1].gram[page][1]);
+        TEST_ASSERT_EQUAL_HEX8(0x00, disp[1].gram[page][2]);
+        TEST_ASSERT_EQUAL_HEX8(0x00, disp[1].gram[page][WIDTH + 1]);
+        TEST_ASSERT_EQUAL_HEX8(0x55, disp[1].gram[page][WIDTH + 2]);
+    }
+
+    canvas_putPixel(&oled.canvas, 0, 0, CANVAS_COLOR_WHITE);
+    canvas_putPixel(&oled.canvas, WIDTH - 1, HEIGHT - 1, CANVAS_COLOR_WHITE);
+    oled_flush(&oled);
+
+    TEST_ASSERT_EQUAL_HEX8(0x01, disp[1].gram[0][2]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, disp[1].gram[PAGES - 1][WIDTH + 1]);
+}
+
+void test_oled_twoDisplays(void)
+{
+    oled_t oledB;
+    oled_conf_t conf = confA;
+
+    conf.cmdPin = CMD_PIN_B;
+    oled_init(&oledB, &conf, buf[1], dirty[1]);
+    oled_flush(&oledB);
+
+    canvas_fillRect(&oled.canvas, 0, 0, 7, 7, CANVAS_COLOR_WHITE);
+    canvas_fillRect(&oledB.canvas, 8, 8, 15, 15, CANVAS_COLOR_WHITE);
+    oled_flush(&oled);
+    oled_flush(&oledB);
+
+    TEST_ASSERT_EQUAL_HEX8(0xFF, disp[0].gram[0][0]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, disp[1].gram[0][0]);
+    TEST_ASSERT_EQUAL_HEX8(0x55, disp[0].gram[1][8]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, disp[1].gram[1][8]);
+}
+
+void test_oled_present_otherBufferHasFrame(void)
+{
+    int32_t sent;
+
+    startFlushTask(0, &sent);
+
+    canvas_putPixel(&oled.canvas, 5, 0, CANVAS_COLOR_WHITE);
+    canvas_putPixel(&oled.canvas, 100, 40, CANVAS_COLOR_WHITE);
+    oled_present(&oled);
+
+    /* drawing goes on in the other buffer, which has the presented frame */
+    TEST_ASSERT_EQUAL_PTR(buf2, oled.canvas.pBuf);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(buf[0], buf2, sizeof(buf2));
+
+    TEST_ASSERT_TRUE(oled_waitFrame(&oled, FRAME_WAIT));
+    TEST_ASSERT_EQUAL_HEX8(0x01, disp[0].gram[0][5]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, disp[0].gram[5][100]);
+
+    /* and back again */
+    canvas_putPixel(&oled.canvas, 5, 0, CANVAS_COLOR_BLACK);
+    canvas_putPixel(&oled.canvas, 60, 20, CANVAS_COLOR_WHITE);
+    oled_present(&oled);
+
+    TEST_ASSERT_EQUAL_PTR(buf[0], oled.canvas.pBuf);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(buf2, buf[0], sizeof(buf2));
+
+    TEST_ASSERT_TRUE(oled_waitFrame(&oled, FRAME_WAIT));
+    TEST_ASSERT_EQUAL_HEX8(0x00, disp[0].gram[0][5]);
+    TEST_ASSERT_EQUAL_HEX8(0x10, disp[0].gram[2][60]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, disp[0].gram[5][100]);
+}
+
+void test_oled_present_onlyDirtySpans(void)
+{
+    int32_t sent;
+
+    startFlushTask(0, &sent);
+
+    canvas_putPixel(&oled.canvas, 10, 9, CANVAS_COLOR_WHITE);
+    canvas_putPixel(&oled.canvas, 11, 9, CANVAS_COLOR_WHITE);
+    oled_present(&oled);
+    TEST_ASSERT_TRUE(oled_waitFrame(&oled, FRAME_WAIT));
+
+    TEST_ASSERT_EQUAL_INT32(1, transactions);
+    TEST_ASSERT_EQUAL_INT32(2, dataBytes);
+    TEST_ASSERT_EQUAL_HEX8(0x55, disp[0].gram[1][9]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, disp[0].gram[1][10]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, disp[0].gram[1][11]);
+    TEST_ASSERT_EQUAL_HEX8(0x55, disp[0].gram[1][12]);
+
+    /* the columns copied to the other buffer aren't sent again */
+    oled_present(&oled);
+    TEST_ASSERT_TRUE(oled_waitFrame(&oled, FRAME_WAIT));
+    TEST_ASSERT_EQUAL_INT32(1, transactions);
+    TEST_ASSERT_EQUAL_INT32(2, dataBytes);
+
+    canvas_putPixel(&oled.canvas, 30, 63, CANVAS_COLOR_WHITE);
+    oled_present(&oled);
+    TEST_ASSERT_TRUE(oled_waitFrame(&oled, FRAME_WAIT));
+    TEST_ASSERT_EQUAL_INT32(2, transactions);
+    TEST_ASSERT_EQUAL_INT32(3, dataBytes);
+    TEST_ASSERT_EQUAL_HEX8(0x80, disp[0].gram[PAGES - 1][30]);
+}
+
+void test_oled_present_framePeriod(void)
+{
+    TickType_t period = pdMS_TO_TICKS(1000 / MAX_FPS);
+    int32_t sent;
+    int i;
+
+    startFlushTask(MAX_FPS, &sent);
+
+    /* presented back to back, each frame waits for the previous one */
+    for (i = 0 ; i < 4 ; i++)
+    {
+        canvas_putPixel(&oled.canvas, i, 0, CANVAS_COLOR_WHITE);
+        oled_present(&oled);
+    }
+
+    TEST_ASSERT_TRUE(oled_waitFrame(&oled, FRAME_WAIT));
+    TEST_ASSERT_EQUAL_INT32(4, frames);
+
+    for (i = 1 ; i < 4 ; i++)
+        TEST_ASSERT_TRUE(frameTick[i] - frameTick[i - 1] + 1 >= period);
+
+    /* the frame after a pause goes out at once */
+    freertos_fake_sleep(2 * period);
+    canvas_putPixel(&oled.canvas, 4, 0, CANVAS_COLOR_WHITE);
+    oled_present(&oled);
+    TEST_ASSERT_TRUE(oled_waitFrame(&oled, FRAME_WAIT));
+    TEST_ASSERT_TRUE(frameTick[4] - frameTick[3] < 3 * period);
+    TEST_ASSERT_EQUAL_HEX8(0x01, disp[0].gram[0][4]);
+}
+
+void test_oled_present_frameDoneOncePerFrame(void)
+{
+    int32_t sent = -1;
+    int i;
+
+    startFlushTask(0, &sent);
+
+    for (i = 0 ; i < 3 ; i++)
+    {
+        canvas_putPixel(&oled.canvas, 2 * i, 0, CANVAS_COLOR_WHITE);
+        oled_present(&oled);
+        TEST_ASSERT_TRUE(oled_waitFrame(&oled, FRAME_WAIT));
+        freertos_fake_sleep(5);
+
+        /* called after the frame was sent */
+        TEST_ASSERT_EQUAL_INT32(i + 1, frames);
+        TEST_ASSERT_EQUAL_INT32(i + 1, sent);
+    }
+
+    /* an empty frame is reported too */
+    oled_present(&oled);
+    TEST_ASSERT_TRUE(oled_waitFrame(&oled, FRAME_WAIT));
+    freertos_fake_sleep(5);
+    TEST_ASSERT_EQUAL_INT32(4, frames);
+    TEST_ASSERT_EQUAL_INT32(3, sent);
+
+    freertos_fake_sleep(20);
+    TEST_ASSERT_EQUAL_INT32(4, frames);
+}
+
+/*==================[end of file]============================================*/
@@ -40,6 +40,7 @@
 /*==================[inclusions]=============================================*/
 #include "lvgl.h"
 #include "efHal_gpio.h"
+#include "FreeRTOS.h"
 
 /*==================[cplusplus]==============================================*/
 
@@ -53,6 +54,25 @@ extern "C" {
 #define DISPLAY_ORIENTATION_HORIZONTAL 2
 #define DISPLAY_ORIENTATION_HORIZONTAL_INV 3
 
+/* software draw context that keeps opaque fills of the whole draw buffer
+ * (backgrounds) out of memory, the flush streams their color instead.
+ * Registered with draw_ctx_init, draw_ctx_deinit and draw_ctx_size of the
+ * display driver */
+typedef struct {
+    lv_draw_sw_ctx_t base;
+    lv_disp_drv_t * drv;
+    bool solid;                     /* the buffer holds a pending fill */
+    lv_color_t color;
+    void * solid_buf;
+    lv_area_t solid_area;
+    void (*sw_blend)(lv_draw_ctx_t * draw_ctx, const lv_draw_sw_blend_dsc_t * dsc);
+    struct _lv_draw_layer_ctx_t * (*sw_layer_init)(lv_draw_ctx_t * draw_ctx,
+            struct _lv_draw_layer_ctx_t * layer_ctx, lv_draw_layer_flags_t flags);
+    void (*sw_buffer_copy)(lv_draw_ctx_t * draw_ctx,
+            void * dest_buf, lv_coord_t dest_stride, const lv_area_t * dest_area,
+            void * src_buf, lv_coord_t src_stride, const lv_area_t * src_area);
+} ili9486_draw_ctx_t;
+
 
 /*==================[external data declaration]==============================*/
 
@@ -61,6 +81,28 @@ extern "C" {
 void ili9486_init(int ori, efHal_gpio_id_t dc, efHal_gpio_id_t rst, efHal_gpio_id_t cs, efHal_gpio_busid_t bus);
 void ili9486_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map);
 
+/* after ili9486_init(), areas are sent by a task and ili9486_flush() only
+ * queues them, so LVGL renders into its other draw buffer meanwhile. The
+ * bus is driven by the CPU: the task should have a lower priority than the
+ * LVGL one, which must block between lv_timer_handler() calls */
+void ili9486_startFlushTask(UBaseType_t priority);
+
+/* wait_cb of the display driver, blocks until an area is sent instead of
+ * LVGL polling its flushing flag */
+void ili9486_wait(lv_disp_drv_t * drv);
+
+/* the bus pins are shared with the touch screen, hold the bus while
+ * reading it */
+bool ili9486_lockBus(TickType_t blockTime);
+void ili9486_unlockBus(void);
+
+/* fills an area with a color without a frame buffer, e.g. to clear the
+ * screen before LVGL draws */
+void ili9486_fillRect(const lv_area_t * area, lv_color_t color);
+
+void ili9486_draw_ctx_init(lv_disp_drv_t * drv, lv_draw_ctx_t * draw_ctx);
+void ili9486_draw_ctx_deinit(lv_disp_drv_t * drv, lv_draw_ctx_t * draw_ctx);
+
 /*==================[cplusplus]==============================================*/
 
 #ifdef __cplusplus
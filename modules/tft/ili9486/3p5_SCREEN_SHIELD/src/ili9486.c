@@ -39,11 +39,26 @@
 #include "ili9486.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "queue.h"
+#include "semphr.h"
 #include "efHal.h"
 
 /*==================[macros and typedef]=====================================*/
  #define TAG "ILI9486"
 
+#ifndef ILI9486_FLUSH_TASK_STACK
+    #define ILI9486_FLUSH_TASK_STACK    200
+#endif
+
+/* an area handed by LVGL, solid when its buffer holds a pending fill */
+typedef struct {
+    lv_disp_drv_t * drv;
+    lv_area_t area;
+    lv_color_t * color_map;
+    bool solid;
+    lv_color_t color;
+} flush_req_t;
+
 /*The LCD needs a bunch of command/argument values to be initialized. They are stored in this struct. */
 typedef struct {
     uint8_t cmd;
@@ -55,6 +70,17 @@ typedef struct {
 static void ili9486_set_orientation(uint8_t orientation);
 static void ili9486_send_cmd(uint8_t cmd);
 static void ili9486_send_data(void * data, uint32_t length);
+static void ili9486_set_window(const lv_area_t * area);
+static void ili9486_send_fill(const lv_area_t * area, lv_color_t color);
+static void ili9486_send_area(flush_req_t const * req);
+static void ili9486_flush_task(void * pvParameters);
+static void ili9486_draw_materialize(ili9486_draw_ctx_t * ctx);
+static void ili9486_draw_blend(lv_draw_ctx_t * draw_ctx, const lv_draw_sw_blend_dsc_t * dsc);
+static struct _lv_draw_layer_ctx_t * ili9486_draw_layer_init(lv_draw_ctx_t * draw_ctx,
+        struct _lv_draw_layer_ctx_t * layer_ctx, lv_draw_layer_flags_t flags);
+static void ili9486_draw_buffer_copy(lv_draw_ctx_t * draw_ctx,
+        void * dest_buf, lv_coord_t dest_stride, const lv_area_t * dest_area,
+        void * src_buf, lv_coord_t src_stride, const lv_area_t * src_area);
 
 /*==================[internal data definition]===============================*/
 static efHal_gpio_id_t idDC;
@@ -62,6 +88,16 @@ static efHal_gpio_id_t idRST;
 static efHal_gpio_id_t idCS;
 static efHal_gpio_busid_t idBUS;
 
+static SemaphoreHandle_t busMutex;      /* bus pins are shared with the touch screen */
+static QueueHandle_t flushQueue;        /* NULL: areas are sent by ili9486_flush() */
+static SemaphoreHandle_t flushDone;
+
+/* last window programmed, nextY is the row following the last pixel
+ * written when it completed a row of the window */
+static lv_area_t win;
+static lv_coord_t nextY;
+static lv_coord_t lastRow;
+
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
@@ -83,12 +119,187 @@ static void ili9486_send_data(void * data, uint32_t length)
     efHal_gpio_setPin(idCS, 1);
 }
 
+static void ili9486_set_window(const lv_area_t * area)
+{
+    uint8_t data[4] = {0};
+
+    /* consecutive strips of the same columns, LVGL renders them top down */
+    if (area->x1 == win.x1 && area->x2 == win.x2 && area->y1 == nextY)
+    {
+        /*Memory write continue*/
+        ili9486_send_cmd(0x3C);
+        nextY = area->y2 + 1;
+        return;
+    }
+
+    if (area->x1 != win.x1 || area->x2 != win.x2)
+    {
+        /*Column addresses*/
+        ili9486_send_cmd(0x2A);
+        data[0] = (area->x1 >> 8) & 0xFF;
+        data[1] = area->x1 & 0xFF;
+        data[2] = (area->x2 >> 8) & 0xFF;
+        data[3] = area->x2 & 0xFF;
+        ili9486_send_data(data, 4);
+
+        win.x1 = area->x1;
+        win.x2 = area->x2;
+    }
+
+    if (area->y1 != win.y1)
+    {
+        /*Page addresses, to the last row so the next strip only needs
+         * a write continue*/
+        ili9486_send_cmd(0x2B);
+        data[0] = (area->y1 >> 8) & 0xFF;
+        data[1] = area->y1 & 0xFF;
+        data[2] = (lastRow >> 8) & 0xFF;
+        data[3] = lastRow & 0xFF;
+        ili9486_send_data(data, 4);
+
+        win.y1 = area->y1;
+        win.y2 = lastRow;
+    }
+
+    /*Memory write*/
+    ili9486_send_cmd(0x2C);
+    nextY = area->y2 + 1;
+}
+
+static void ili9486_send_fill(const lv_area_t * area, lv_color_t color)
+{
+    uint32_t size = lv_area_get_width(area) * lv_area_get_height(area);
+    uint16_t value = color.full;
+
+#if LV_COLOR_16_SWAP
+    /* stored high byte first, as it goes on the bus */
+    value = (value << 8) | (value >> 8);
+#endif
+
+    ili9486_set_window(area);
+
+    efHal_gpio_setPin(idDC, 1);    /*Data mode*/
+    efHal_gpio_setPin(idCS, 0);
+    efHal_gpio_fillBus16(idBUS, value, size);
+    efHal_gpio_setPin(idCS, 1);
+}
+
+static void ili9486_send_area(flush_req_t const * req)
+{
+    uint32_t size = lv_area_get_width(&req->area) * lv_area_get_height(&req->area);
+
+    xSemaphoreTake(busMutex, portMAX_DELAY);
+
+    if (req->solid)
+    {
+        ili9486_send_fill(&req->area, req->color);
+    }
+    else
+    {
+        ili9486_set_window(&req->area);
+
+        efHal_gpio_setPin(idDC, 1);    /*Data mode*/
+        efHal_gpio_setPin(idCS, 0);
+#if LV_COLOR_16_SWAP
+        /* already high byte first in memory */
+        efHal_gpio_writeBus(idBUS, req->color_map, size * 2);
+#else
+        efHal_gpio_writeBus16(idBUS, (uint16_t const *) req->color_map, size);
+#endif
+        efHal_gpio_setPin(idCS, 1);
+    }
+
+    xSemaphoreGive(busMutex);
+
+    /* LVGL can render into the buffer again */
+    lv_disp_flush_ready(req->drv);
+}
+
+/* writes a fill kept out of the draw buffer, before something reads or
+ * draws over it */
+static void ili9486_draw_materialize(ili9486_draw_ctx_t * ctx)
+{
+    if (ctx->solid)
+    {
+        lv_color_fill(ctx->solid_buf, ctx->color, lv_area_get_size(&ctx->solid_area));
+        ctx->solid = false;
+    }
+}
+
+static void ili9486_draw_blend(lv_draw_ctx_t * draw_ctx, const lv_draw_sw_blend_dsc_t * dsc)
+{
+    ili9486_draw_ctx_t * ctx = (ili9486_draw_ctx_t *) draw_ctx;
+    lv_disp_drv_t * drv = ctx->drv;
+    lv_area_t area;
+
+    /* an opaque fill of the whole draw buffer, e.g. a background: only
+     * its color is kept and the flush streams it */
+    if (dsc->src_buf == NULL &&
+        (dsc->mask_buf == NULL || dsc->mask_res == LV_DRAW_MASK_RES_FULL_COVER) &&
+        dsc->opa >= LV_OPA_MAX &&
+        dsc->blend_mode == LV_BLEND_MODE_NORMAL &&
+        !drv->direct_mode && !drv->full_refresh &&
+        draw_ctx->buf == drv->draw_buf->buf_act &&
+        _lv_area_intersect(&area, dsc->blend_area, draw_ctx->clip_area) &&
+        _lv_area_is_in(draw_ctx->buf_area, &area, 0))
+    {
+        ctx->solid = true;
+        ctx->color = dsc->color;
+        ctx->solid_buf = draw_ctx->buf;
+        ctx->solid_area = *draw_ctx->buf_area;
+        return;
+    }
+
+    ili9486_draw_materialize(ctx);
+    ctx->sw_blend(draw_ctx, dsc);
+}
+
+static struct _lv_draw_layer_ctx_t * ili9486_draw_layer_init(lv_draw_ctx_t * draw_ctx,
+        struct _lv_draw_layer_ctx_t * layer_ctx, lv_draw_layer_flags_t flags)
+{
+    ili9486_draw_ctx_t * ctx = (ili9486_draw_ctx_t *) draw_ctx;
+
+    ili9486_draw_materialize(ctx);
+    return ctx->sw_layer_init(draw_ctx, layer_ctx, flags);
+}
+
+static void ili9486_draw_buffer_copy(lv_draw_ctx_t * draw_ctx,
+        void * dest_buf, lv_coord_t dest_stride, const lv_area_t * dest_area,
+        void * src_buf, lv_coord_t src_stride, const lv_area_t * src_area)
+{
+    ili9486_draw_ctx_t * ctx = (ili9486_draw_ctx_t *) draw_ctx;
+
+    ili9486_draw_materialize(ctx);
+    ctx->sw_buffer_copy(draw_ctx, dest_buf, dest_stride, dest_area, src_buf, src_stride, src_area);
+}
+
+static void ili9486_flush_task(void * pvParameters)
+{
+    flush_req_t req;
+
+    for (;;)
+    {
+        xQueueReceive(flushQueue, &req, portMAX_DELAY);
+
+        ili9486_send_area(&req);
+
+        xSemaphoreGive(flushDone);
+    }
+}
+
 static void ili9486_set_orientation(uint8_t orientation)
 {
     uint8_t data[] = {0x48, 0x88, 0x28, 0xE8};
 
     ili9486_send_cmd(0x36);
     ili9486_send_data((void *) &data[orientation], 1);
+
+    /* 320x480 panel */
+    lastRow = (orientation < DISPLAY_ORIENTATION_HORIZONTAL) ? 479 : 319;
+
+    /* the window is programmed again on the next write */
+    win.x1 = win.x2 = win.y1 = win.y2 = -1;
+    nextY = -1;
 }
 
 /*==================[external functions definition]==========================*/
@@ -113,6 +324,10 @@ void ili9486_init(int ori, efHal_gpio_id_t dc, efHal_gpio_id_t rst, efHal_gpio_i
 	idCS = cs;
 	idBUS = bus;
 
+	busMutex = xSemaphoreCreateMutex();
+	flushQueue = NULL;
+	flushDone = NULL;
+
 	//Initialize GPIOs
     efHal_gpio_confPin(idDC, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
     efHal_gpio_confPin(idRST, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
@@ -142,35 +357,80 @@ void ili9486_init(int ori, efHal_gpio_id_t dc, efHal_gpio_id_t rst, efHal_gpio_i
     ili9486_set_orientation(ori);
 }
 
+void ili9486_startFlushTask(UBaseType_t priority)
+{
+    /* LVGL hands at most one area per draw buffer */
+    flushQueue = xQueueCreate(2, sizeof(flush_req_t));
+    flushDone = xSemaphoreCreateBinary();
+
+    xTaskCreate(ili9486_flush_task, "ili9486", ILI9486_FLUSH_TASK_STACK, NULL, priority, NULL);
+}
+
 void ili9486_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
-    uint8_t data[4] = {0};
-    uint32_t size = 0;
-
-    /*Column addresses*/
-    ili9486_send_cmd(0x2A);
-    data[0] = (area->x1 >> 8) & 0xFF;
-    data[1] = area->x1 & 0xFF;
-    data[2] = (area->x2 >> 8) & 0xFF;
-    data[3] = area->x2 & 0xFF;
-    ili9486_send_data(data, 4);
-
-    /*Page addresses*/
-    ili9486_send_cmd(0x2B);
-    data[0] = (area->y1 >> 8) & 0xFF;
-    data[1] = area->y1 & 0xFF;
-    data[2] = (area->y2 >> 8) & 0xFF;
-    data[3] = area->y2 & 0xFF;
-    ili9486_send_data(data, 4);
+    flush_req_t req = {drv, *area, color_map, false};
+    ili9486_draw_ctx_t * ctx = (ili9486_draw_ctx_t *) drv->draw_ctx;
 
-    /*Memory write*/
-    ili9486_send_cmd(0x2C);
+    if (drv->draw_ctx_init == ili9486_draw_ctx_init && ctx->solid &&
+        ctx->solid_buf == color_map)
+    {
+        /* the buffer was never written */
+        req.solid = true;
+        req.color = ctx->color;
+        ctx->solid = false;
+    }
 
-    size = lv_area_get_width(area) * lv_area_get_height(area);
+    if (flushQueue != NULL)
+        xQueueSend(flushQueue, &req, portMAX_DELAY);
+    else
+        ili9486_send_area(&req);
+}
 
-    ili9486_send_data((void*) color_map, size * 2);
+void ili9486_wait(lv_disp_drv_t * drv)
+{
+    /* given after lv_disp_flush_ready(), a stale give only makes LVGL check
+     * its flag once more */
+    if (flushDone != NULL)
+        xSemaphoreTake(flushDone, portMAX_DELAY);
+}
+
+bool ili9486_lockBus(TickType_t blockTime)
+{
+    return xSemaphoreTake(busMutex, blockTime) == pdTRUE;
+}
 
-    drv->draw_buf->flushing = 0;
+void ili9486_unlockBus(void)
+{
+    xSemaphoreGive(busMutex);
+}
+
+void ili9486_fillRect(const lv_area_t * area, lv_color_t color)
+{
+    xSemaphoreTake(busMutex, portMAX_DELAY);
+    ili9486_send_fill(area, color);
+    xSemaphoreGive(busMutex);
+}
+
+void ili9486_draw_ctx_init(lv_disp_drv_t * drv, lv_draw_ctx_t * draw_ctx)
+{
+    ili9486_draw_ctx_t * ctx = (ili9486_draw_ctx_t *) draw_ctx;
+
+    lv_draw_sw_init_ctx(drv, draw_ctx);
+
+    ctx->drv = drv;
+    ctx->solid = false;
+
+    ctx->sw_blend = ctx->base.blend;
+    ctx->base.blend = ili9486_draw_blend;
+    ctx->sw_layer_init = draw_ctx->layer_init;
+    draw_ctx->layer_init = ili9486_draw_layer_init;
+    ctx->sw_buffer_copy = draw_ctx->buffer_copy;
+    draw_ctx->buffer_copy = ili9486_draw_buffer_copy;
+}
+
+void ili9486_draw_ctx_deinit(lv_disp_drv_t * drv, lv_draw_ctx_t * draw_ctx)
+{
+    lv_draw_sw_deinit_ctx(drv, draw_ctx);
 }
 
 /*==================[end of file]============================================*/
@@ -37,8 +37,25 @@
 
 /*==================[inclusions]=============================================*/
 #include "efHal_gpio.h"
+#include "FreeRTOS.h"
+#include "touchScreen_cal.h"
 #include "lvgl.h"
 
+#if __has_include("touchScreen_config.h")
+    #include "touchScreen_config.h"
+#endif
+
+/* conversions per axis, their median is taken */
+#ifndef TOUCHSCREEN_SAMPLES
+    #define TOUCHSCREEN_SAMPLES         5
+#endif
+
+/* IIR smoothing of the coordinates: 1 / 2^TOUCHSCREEN_IIR_SHIFT of each new
+ * sample, 0 to disable */
+#ifndef TOUCHSCREEN_IIR_SHIFT
+    #define TOUCHSCREEN_IIR_SHIFT       2
+#endif
+
 /*==================[cplusplus]==============================================*/
 #ifdef __cplusplus
 extern "C" {
@@ -46,6 +63,11 @@ extern "C" {
 
 /*==================[macros and typedef]=====================================*/
 
+/* takes and releases pins shared with a display bus, e.g. ili9486_lockBus
+ * and ili9486_unlockBus */
+typedef bool (*touchScreen_busLock_t)(TickType_t blockTime);
+typedef void (*touchScreen_busUnlock_t)(void);
+
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -55,11 +77,42 @@ extern void touchScreen_init(efHal_gpio_id_t xm, efHal_gpio_id_t xp,
 extern void touchScreen_conf(int32_t mix, int32_t max, int32_t miy, int32_t may,
         int32_t rx, int32_t ry);
 
+/** \brief sets the transform from raw readings to screen coordinates
+ **
+ ** Replaces the ranges of touchScreen_conf(), e.g. with the result of
+ ** touchScreen_cal_compute() or a transform saved with touchScreen_getCal().
+ ** Coordinates are clamped to [0, rx - 1] x [0, ry - 1].
+ **/
+extern void touchScreen_setCal(touchScreen_cal_t const *pCal, int32_t rx, int32_t ry);
+extern void touchScreen_getCal(touchScreen_cal_t *pCal);
+
 extern void touchScreen_swapXY(bool swXY);
 extern void touchScreen_enablePullUP(bool enPU);
 
+/* rejects touches lighter than minZ, see touchScreen_getPressure() */
+extern void touchScreen_confPressure(int32_t minZ);
+
+/** \brief starts a task sampling the screen every periodMs while touched
+ **
+ ** While not touched only a digital pin is checked: with lock == NULL the
+ ** task blocks on the interrupt of XM, with a shared bus it checks the pin
+ ** once per period holding the bus. Coordinates are median filtered and
+ ** smoothed, touchScreen_read() gets the last ones without locking.
+ **/
+extern void touchScreen_startTask(UBaseType_t priority, uint32_t periodMs,
+        touchScreen_busLock_t lock, touchScreen_busUnlock_t unlock);
+
+/* one synchronous sample, without the task */
 extern void touchScreen_performRead(void);
 
+/* pressure of the last sample, grows with the force of the touch (raw ADC
+ * units), 0 if not touched */
+extern int32_t touchScreen_getPressure(void);
+
+/* filtered raw readings of the last sample, after swapXY, to collect
+ * calibration points. Returns true if touched */
+extern bool touchScreen_getRaw(int32_t *rawX, int32_t *rawY);
+
 extern void touchScreen_read(lv_indev_drv_t * indev_drv, lv_indev_data_t * data);
 
 /*==================[cplusplus]==============================================*/
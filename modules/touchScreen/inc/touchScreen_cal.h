@@ -0,0 +1,107 @@
+/*
+###############################################################################
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+#ifndef TOUCH_SCREEN_CAL_H_
+#define TOUCH_SCREEN_CAL_H_
+
+/*==================[inclusions]=============================================*/
+#include "stdint.h"
+#include "stdbool.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros and typedef]=====================================*/
+
+#define TOUCHSCREEN_CAL_SHIFT       16
+
+/* affine transform from raw readings to screen coordinates, Q16:
+ *   x = (a * rawX + b * rawY + c) >> 16
+ *   y = (d * rawX + e * rawY + f) >> 16
+ * It covers scale, offset, rotation and skew of the panel. The structure
+ * can be stored as is and given back to touchScreen_setCal() */
+typedef struct
+{
+    int32_t a, b, c;
+    int32_t d, e, f;
+}touchScreen_cal_t;
+
+/* a target drawn at (x, y) and the raw reading when it was touched */
+typedef struct
+{
+    int32_t rawX;
+    int32_t rawY;
+    int32_t x;
+    int32_t y;
+}touchScreen_calPoint_t;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+
+/** \brief computes the transform fitting a set of points
+ **
+ ** With 3 points the transform is exact, with more it is the least squares
+ ** fit. Done once, the transform is then applied without divisions.
+ **
+ ** \param[out] cal computed transform
+ ** \param[in] pPoints calibration points
+ ** \param[in] n number of points, at least 3
+ ** \return false if the points are on a line (or too close), cal unchanged
+ **/
+extern bool touchScreen_cal_compute(touchScreen_cal_t *cal,
+        touchScreen_calPoint_t const *pPoints, int32_t n);
+
+/* transform scaling each axis from [min, max] to [0, res], as
+ * touchScreen_conf() */
+extern void touchScreen_cal_fromRange(touchScreen_cal_t *cal, int32_t minX,
+        int32_t maxX, int32_t minY, int32_t maxY, int32_t resX, int32_t resY);
+
+/* rounded to the nearest pixel, not clamped */
+static inline void touchScreen_cal_apply(touchScreen_cal_t const *cal,
+        int32_t rawX, int32_t rawY, int32_t *x, int32_t *y)
+{
+    *x = ((int64_t)cal->a * rawX + (int64_t)cal->b * rawY + cal->c) >> TOUCHSCREEN_CAL_SHIFT;
+    *y = ((int64_t)cal->d * rawX + (int64_t)cal->e * rawY + cal->f) >> TOUCHSCREEN_CAL_SHIFT;
+}
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+/*==================[end of file]============================================*/
+#endif /* TOUCH_SCREEN_CAL_H_ */
@@ -36,12 +36,23 @@
 /*==================[inclusions]=============================================*/
 #include "touchScreen.h"
 #include "efHal_analog.h"
-#include "stdlib.h"
+#include "task.h"
 
 /*==================[macros and typedef]=====================================*/
 
-#define SAMPLES_TOTAL        2
-#define SAMPLES_MAX_DIFF    16
+#ifndef TOUCHSCREEN_TASK_STACK
+    #define TOUCHSCREEN_TASK_STACK      200
+#endif
+
+/* without a bus lock the task waits for the touch interrupt at most this
+ * long, it covers a touch between checking the pin and waiting */
+#define IDLE_TIMEOUT_MS     500
+
+/* published state, one word so touchScreen_read() needs no lock */
+#define STATE_X_MASK        0x00000FFF
+#define STATE_Y_SHIFT       12
+#define STATE_Y_MASK        0x00FFF000
+#define STATE_PRESSED       0x01000000
 
 /*=================[internal functions declaration]=========================*/
 
@@ -51,46 +62,71 @@ static efHal_gpio_id_t gpioXP;
 static efHal_gpio_id_t gpioYM;
 static efHal_gpio_id_t gpioYP;
 static int32_t thresholdValid;
-static int32_t readX;
-static int32_t readY;
+static int32_t minPressure;
 
 struct
 {
-    unsigned pressed:1;
     unsigned swapXY:1;
     unsigned enablePullUp:1;
 }flags;
 
-static int32_t minX = 0, maxX = 1024, minY = 0, maxY = 1024;
+/* raw readings to screen, set by touchScreen_conf() or touchScreen_setCal() */
+static touchScreen_cal_t cal =
+{
+    /* [0, 1024] to [0, 480] and [0, 320] */
+    .a = 30720, .b = 0, .c = 1 << (TOUCHSCREEN_CAL_SHIFT - 1),
+    .d = 0, .e = 20480, .f = 1 << (TOUCHSCREEN_CAL_SHIFT - 1),
+};
 static int32_t resX = 480, resY = 320;
 
+/* written by the sampling task (or touchScreen_performRead), read by
+ * touchScreen_read */
+static volatile uint32_t state;
+static volatile uint32_t raw;
+static volatile int32_t pressure;
+
+/* IIR filter state, raw ADC units with TOUCHSCREEN_IIR_SHIFT fraction bits */
+static int32_t filtX;
+static int32_t filtY;
+static bool filtValid;
+
+static uint32_t samplePeriod;
+static touchScreen_busLock_t busLock;
+static touchScreen_busUnlock_t busUnlock;
 
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
 
-/*Return true is the touchpad is pressed*/
-static bool touchpad_is_pressed(void)
+static int32_t clamp(int32_t x, int32_t max)
 {
-    return flags.pressed;
+    return (x < 0) ? 0 : (x > max) ? max : x;
 }
 
-static int32_t map(int32_t x, int32_t in_min, int32_t in_max, int32_t out_min, int32_t out_max)
+/* median of n samples, insertion sort as n is small */
+static int32_t median(int32_t *samples, int n)
 {
-  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
-}
+    int32_t v;
+    int i, j;
 
-/*Get the x and y coordinates if the touchpad is pressed*/
-static void touchpad_get_xy(lv_coord_t * x, lv_coord_t * y)
-{
-    *x = map(readX, minX, maxX, 0, resX);
-    *y = map(readY, minY, maxY, 0, resY);
+    for (i = 1 ; i < n ; i++)
+    {
+        v = samples[i];
+
+        for (j = i ; j > 0 && samples[j-1] > v ; j--)
+            samples[j] = samples[j-1];
+
+        samples[j] = v;
+    }
+
+    return samples[n / 2];
 }
 
+/* median of TOUCHSCREEN_SAMPLES conversions on measure with plus driven
+ * high and minus low */
 static int32_t getValue(efHal_gpio_id_t plus, efHal_gpio_id_t minus, efHal_gpio_id_t measure, efHal_gpio_id_t ignore)
 {
-    int32_t samples[SAMPLES_TOTAL];
-    int32_t ret;
+    int32_t samples[TOUCHSCREEN_SAMPLES];
     int i;
 
     efHal_analog_confAsAnalog(measure);
@@ -100,31 +136,163 @@ static int32_t getValue(efHal_gpio_id_t plus, efHal_gpio_id_t minus, efHal_gpio_
     efHal_gpio_confPin(plus, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
     efHal_gpio_confPin(minus, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 0);
 
-    for (i = 0 ; i < SAMPLES_TOTAL ; i++)
+    for (i = 0 ; i < TOUCHSCREEN_SAMPLES ; i++)
     {
         efHal_analog_startConv(measure);
         efHal_analog_waitConv(measure, portMAX_DELAY);
         samples[i] = efHal_analog_read(measure);
     }
 
-    ret = samples[0];
-    for (i = 1 ; i < SAMPLES_TOTAL && ret >= 0; i++)
+    return median(samples, TOUCHSCREEN_SAMPLES);
+}
+
+/* the pins are shared with the display bus, they are left as it expects */
+static void releasePins(void)
+{
+    efHal_gpio_confPin(gpioYP, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
+    efHal_gpio_confPin(gpioYM, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
+    efHal_gpio_confPin(gpioXP, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
+    efHal_gpio_confPin(gpioXM, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
+}
+
+/* Y plate grounded and X plate pulled up, a touch pulls XM low */
+static void confDetect(void)
+{
+    efHal_gpio_confPin(gpioXP, EF_HAL_GPIO_INPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
+    efHal_gpio_confPin(gpioYP, EF_HAL_GPIO_INPUT, EF_HAL_GPIO_PULL_DISABLE, 1);
+    efHal_gpio_confPin(gpioYM, EF_HAL_GPIO_OUTPUT, EF_HAL_GPIO_PULL_DISABLE, 0);
+    efHal_gpio_confPin(gpioXM, EF_HAL_GPIO_INPUT, EF_HAL_GPIO_PULL_UP, 1);
+}
+
+static bool isTouched(void)
+{
+    return !efHal_gpio_getPin(gpioXM);
+}
+
+static void publish(bool pressed)
+{
+    touchScreen_cal_t c;
+    int32_t rx, ry, x, y;
+
+    if (!pressed)
+    {
+        filtValid = false;
+        state &= ~STATE_PRESSED;
+        pressure = 0;
+        return;
+    }
+
+    rx = filtX >> TOUCHSCREEN_IIR_SHIFT;
+    ry = filtY >> TOUCHSCREEN_IIR_SHIFT;
+
+    taskENTER_CRITICAL();
+    c = cal;
+    taskEXIT_CRITICAL();
+
+    touchScreen_cal_apply(&c, rx, ry, &x, &y);
+
+    raw = rx | (ry << 16);
+    state = clamp(x, resX - 1) |
+            (clamp(y, resY - 1) << STATE_Y_SHIFT) |
+            STATE_PRESSED;
+}
+
+/* reads X, Y and pressure, filters them and publishes the result */
+static void sample(void)
+{
+    int32_t x, y, z;
+
+    x = getValue(gpioXP, gpioXM, gpioYP, gpioYM);
+    y = getValue(gpioYP, gpioYM, gpioXP, gpioXM);
+
+    /* XM low and YP high: the voltage on XP rises as the touch resistance
+     * falls. Z2 would need an analog YM, this is the Z1 half only */
+    z = getValue(gpioYP, gpioXM, gpioXP, gpioYM);
+
+    if (flags.swapXY)
     {
-        if (abs(samples[i-1] - samples[i]) > SAMPLES_MAX_DIFF)
-            ret = -1;
-        else
-            ret += samples[i];
+        int32_t t = x;
+        x = y;
+        y = t;
     }
 
-    if (ret >= 0)
+    /* not touched, the pulled up plate reads near full scale */
+    if (x >= thresholdValid || y >= thresholdValid || z < minPressure)
     {
-        ret = ret / SAMPLES_TOTAL;
+        publish(false);
+        return;
+    }
 
-        if (ret >= thresholdValid)
-            ret = -1;
+    if (!filtValid)
+    {
+        filtX = x << TOUCHSCREEN_IIR_SHIFT;
+        filtY = y << TOUCHSCREEN_IIR_SHIFT;
+        filtValid = true;
+    }
+    else
+    {
+        filtX += x - (filtX >> TOUCHSCREEN_IIR_SHIFT);
+        filtY += y - (filtY >> TOUCHSCREEN_IIR_SHIFT);
     }
 
-    return ret;
+    pressure = z;
+    publish(true);
+}
+
+/* waits until the screen is touched, only a digital pin is read meanwhile */
+static void waitTouch(void)
+{
+    bool touched = false;
+
+    while (!touched)
+    {
+        if (busLock != NULL)
+        {
+            /* the pins can't be held in the detect configuration, the
+             * display needs them: check once per period */
+            busLock(portMAX_DELAY);
+            confDetect();
+            touched = isTouched();
+            releasePins();
+            busUnlock();
+
+            if (!touched)
+                vTaskDelay(pdMS_TO_TICKS(samplePeriod));
+        }
+        else
+        {
+            confDetect();
+            efHal_gpio_confInt(gpioXM, EF_HAL_GPIO_INT_TYPE_FALLING_EDGE);
+
+            if (!isTouched())
+                efHal_gpio_waitForInt(gpioXM, pdMS_TO_TICKS(IDLE_TIMEOUT_MS));
+
+            efHal_gpio_confInt(gpioXM, EF_HAL_GPIO_INT_TYPE_DISABLE);
+            touched = isTouched();
+        }
+    }
+}
+
+static void samplingTask(void *pvParameters)
+{
+    for (;;)
+    {
+        if (!(state & STATE_PRESSED))
+            waitTouch();
+
+        if (busLock != NULL)
+            busLock(portMAX_DELAY);
+
+        sample();
+
+        if (busLock != NULL)
+        {
+            releasePins();
+            busUnlock();
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(samplePeriod));
+    }
 }
 
 /*==================[external functions definition]==========================*/
@@ -138,17 +306,40 @@ extern void touchScreen_init(efHal_gpio_id_t xm, efHal_gpio_id_t xp,
     gpioYP = yp;
 
     thresholdValid = (efHal_analog_getFullValue(0) * 97) / 100;
+    minPressure = 0;
+    state = 0;
+    pressure = 0;
+    filtValid = false;
 }
 
 extern void touchScreen_conf(int32_t mix, int32_t max, int32_t miy, int32_t may,
         int32_t rx, int32_t ry)
 {
-    minX = mix;
-    maxX = max;
-    minY = miy;
-    maxY = may;
+    touchScreen_cal_t c;
+
+    touchScreen_cal_fromRange(&c, mix, max, miy, may, rx, ry);
+    touchScreen_setCal(&c, rx, ry);
+}
+
+extern void touchScreen_setCal(touchScreen_cal_t const *pCal, int32_t rx, int32_t ry)
+{
+    taskENTER_CRITICAL();
+    cal = *pCal;
     resX = rx;
     resY = ry;
+    taskEXIT_CRITICAL();
+}
+
+extern void touchScreen_getCal(touchScreen_cal_t *pCal)
+{
+    taskENTER_CRITICAL();
+    *pCal = cal;
+    taskEXIT_CRITICAL();
+}
+
+extern void touchScreen_confPressure(int32_t minZ)
+{
+    minPressure = minZ;
 }
 
 extern void touchScreen_swapXY(bool swXY)
@@ -161,39 +352,46 @@ extern void touchScreen_enablePullUP(bool enPU)
     flags.enablePullUp = enPU;
 }
 
+extern void touchScreen_startTask(UBaseType_t priority, uint32_t periodMs,
+        touchScreen_busLock_t lock, touchScreen_busUnlock_t unlock)
+{
+    samplePeriod = periodMs;
+    busLock = lock;
+    busUnlock = unlock;
+
+    xTaskCreate(samplingTask, "touchScreen", TOUCHSCREEN_TASK_STACK, NULL, priority, NULL);
+}
+
 extern void touchScreen_performRead(void)
 {
-    int32_t x, y;
+    sample();
+}
 
-    x = getValue(gpioXP, gpioXM, gpioYP, gpioYM);
-    y = getValue(gpioYP, gpioYM, gpioXP, gpioXM);
+extern bool touchScreen_getRaw(int32_t *rawX, int32_t *rawY)
+{
+    uint32_t r = raw;
 
-    if (flags.swapXY)
-    {
-        readY = x;
-        readX = y;
-    }
-    else
-    {
-        readX = x;
-        readY = y;
-    }
+    *rawX = r & 0xFFFF;
+    *rawY = r >> 16;
 
-    if (readX >= 0 && readY >= 0)
-        flags.pressed = true;
-    else
-        flags.pressed = false;
+    return (state & STATE_PRESSED) != 0;
 }
 
+extern int32_t touchScreen_getPressure(void)
+{
+    return pressure;
+}
 
 extern void touchScreen_read(lv_indev_drv_t * indev_drv, lv_indev_data_t * data)
 {
     static lv_coord_t last_x = 0;
     static lv_coord_t last_y = 0;
+    uint32_t s = state;
 
     /*Save the pressed coordinates and the state*/
-    if(touchpad_is_pressed()) {
-        touchpad_get_xy(&last_x, &last_y);
+    if(s & STATE_PRESSED) {
+        last_x = s & STATE_X_MASK;
+        last_y = (s & STATE_Y_MASK) >> STATE_Y_SHIFT;
         data->state = LV_INDEV_STATE_PR;
     }
     else {
@@ -0,0 +1,148 @@
+/*
+###############################################################################
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "touchScreen_cal.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define ONE         ((double)(1 << TOUCHSCREEN_CAL_SHIFT))
+
+/* points whose raw readings are closer to a line than this (squared
+ * correlation of rawX and rawY) are rejected */
+#define MAX_CORR2   0.999
+
+/*=================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/* coefficient to Q16, rounded */
+static int32_t toFixed(double v)
+{
+    v *= ONE;
+
+    return (int32_t)(v < 0 ? v - 0.5 : v + 0.5);
+}
+
+/* offset to Q16, half a pixel added so the shift rounds */
+static int32_t toFixedOffset(double v)
+{
+    return toFixed(v) + (1 << (TOUCHSCREEN_CAL_SHIFT - 1));
+}
+
+/*==================[external functions definition]==========================*/
+
+extern bool touchScreen_cal_compute(touchScreen_cal_t *cal,
+        touchScreen_calPoint_t const *pPoints, int32_t n)
+{
+    double mx = 0, my = 0, mu = 0, mv = 0;
+    double sxx = 0, sxy = 0, syy = 0;
+    double sxu = 0, syu = 0, sxv = 0, syv = 0;
+    double dx, dy, du, dv, det;
+    double a, b, d, e;
+    int32_t i;
+
+    if (n < 3)
+        return false;
+
+    for (i = 0 ; i < n ; i++)
+    {
+        mx += pPoints[i].rawX;
+        my += pPoints[i].rawY;
+        mu += pPoints[i].x;
+        mv += pPoints[i].y;
+    }
+
+    mx /= n;
+    my /= n;
+    mu /= n;
+    mv /= n;
+
+    /* normal equations around the mean, the offsets then drop out */
+    for (i = 0 ; i < n ; i++)
+    {
+        dx = pPoints[i].rawX - mx;
+        dy = pPoints[i].rawY - my;
+        du = pPoints[i].x - mu;
+        dv = pPoints[i].y - mv;
+
+        sxx += dx * dx;
+        sxy += dx * dy;
+        syy += dy * dy;
+        sxu += dx * du;
+        syu += dy * du;
+        sxv += dx * dv;
+        syv += dy * dv;
+    }
+
+    det = sxx * syy - sxy * sxy;
+
+    if (sxx <= 0 || syy <= 0 || det <= (1 - MAX_CORR2) * sxx * syy)
+        return false;
+
+    a = (sxu * syy - syu * sxy) / det;
+    b = (syu * sxx - sxu * sxy) / det;
+    d = (sxv * syy - syv * sxy) / det;
+    e = (syv * sxx - sxv * sxy) / det;
+
+    cal->a = toFixed(a);
+    cal->b = toFixed(b);
+    cal->c = toFixedOffset(mu - a * mx - b * my);
+    cal->d = toFixed(d);
+    cal->e = toFixed(e);
+    cal->f = toFixedOffset(mv - d * mx - e * my);
+
+    return true;
+}
+
+extern void touchScreen_cal_fromRange(touchScreen_cal_t *cal, int32_t minX,
+        int32_t maxX, int32_t minY, int32_t maxY, int32_t resX, int32_t resY)
+{
+    double sx = (double)resX / (maxX - minX);
+    double sy = (double)resY / (maxY - minY);
+
+    cal->a = toFixed(sx);
+    cal->b = 0;
+    cal->c = toFixedOffset(-minX * sx);
+    cal->d = 0;
+    cal->e = toFixed(sy);
+    cal->f = toFixedOffset(-minY * sy);
+}
+
+/*==================[end of file]============================================*/
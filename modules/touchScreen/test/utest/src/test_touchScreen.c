@@ -0,0 +1,384 @@
+/*
+###############################################################################
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "unity.h"
+#include "touchScreen.h"
+#include "efHal_analog.h"
+#include "string.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define RES_X           480
+#define RES_Y           320
+#define FULL_SCALE      4096
+
+/* any ids, only compared by the fake */
+#define PIN_XM          1
+#define PIN_XP          2
+#define PIN_YM          3
+#define PIN_YP          4
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/* what the ADC reads on each measure of touchScreen_performRead() */
+static int32_t rawX;
+static int32_t rawY;
+static int32_t rawZ;
+
+/* pin driven low on the last measure, tells Y from Z on XP */
+static efHal_gpio_id_t lowPin;
+
+/* conversions returned in order instead of rawX, rawY and rawZ: the X, Y
+ * and Z samples of one touchScreen_performRead() */
+static int32_t const *adcSeq;
+static int32_t adcSeqLen;
+
+/*==================[internal functions definition]==========================*/
+
+/* swapped axes and X reversed, raw = M * screen + t */
+static void rawOf(int32_t x, int32_t y, int32_t *pRawX, int32_t *pRawY)
+{
+    *pRawX = (int32_t)(0.35 * x + 9.6 * y + 420 + 0.5);
+    *pRawY = (int32_t)(-6.8 * x + 0.6 * y + 3700 + 0.5);
+}
+
+static void calOf(touchScreen_cal_t *pCal)
+{
+    touchScreen_calPoint_t pts[3] =
+    {
+        {.x = 48, .y = 32},
+        {.x = 432, .y = 160},
+        {.x = 240, .y = 288},
+    };
+    int i;
+
+    for (i = 0 ; i < 3 ; i++)
+        rawOf(pts[i].x, pts[i].y, &pts[i].rawX, &pts[i].rawY);
+
+    TEST_ASSERT_TRUE(touchScreen_cal_compute(pCal, pts, 3));
+}
+
+static void readSeq(int32_t const *pSeq)
+{
+    adcSeq = pSeq;
+    adcSeqLen = 3 * TOUCHSCREEN_SAMPLES;
+    touchScreen_performRead();
+    TEST_ASSERT_EQUAL_INT32(0, adcSeqLen);
+}
+
+static void readRaw(int32_t x, int32_t y, int32_t z)
+{
+    rawX = x;
+    rawY = y;
+    rawZ = z;
+    touchScreen_performRead();
+}
+
+static void touchAt(int32_t x, int32_t y, lv_indev_data_t *pData)
+{
+    lv_indev_drv_t drv;
+
+    rawOf(x, y, &rawX, &rawY);
+    touchScreen_performRead();
+    touchScreen_read(&drv, pData);
+}
+
+/*==================[external functions definition]==========================*/
+
+void efHal_gpio_confPin(efHal_gpio_id_t id, efHal_gpio_dir_t dir, efHal_gpio_pull_t pull, bool state)
+{
+    if (dir == EF_HAL_GPIO_OUTPUT && !state)
+        lowPin = id;
+}
+
+/* only used by the sampling task, not started here */
+bool efHal_gpio_getPin(efHal_gpio_id_t id)
+{
+    return true;
+}
+
+void efHal_gpio_confInt(efHal_gpio_id_t id, efHal_gpio_intType_t intType)
+{
+}
+
+bool efHal_gpio_waitForInt(efHal_gpio_id_t id, TickType_t xBlockTime)
+{
+    return false;
+}
+
+void efHal_analog_confAsAnalog(efHal_gpio_id_t id)
+{
+}
+
+bool efHal_analog_startConv(efHal_gpio_id_t id)
+{
+    return true;
+}
+
+bool efHal_analog_waitConv(efHal_gpio_id_t id, TickType_t xBlockTime)
+{
+    return true;
+}
+
+int32_t efHal_analog_read(efHal_gpio_id_t id)
+{
+    if (adcSeqLen > 0)
+    {
+        adcSeqLen--;
+        return *adcSeq++;
+    }
+
+    if (id == PIN_YP)
+        return rawX;
+
+    return (lowPin == PIN_YM) ? rawY : rawZ;
+}
+
+int32_t efHal_analog_getFullValue(efHal_gpio_id_t id)
+{
+    return FULL_SCALE;
+}
+
+void setUp(void)
+{
+    rawZ = 1000;
+    adcSeqLen = 0;
+    touchScreen_init(PIN_XM, PIN_XP, PIN_YM, PIN_YP);
+    touchScreen_swapXY(false);
+    touchScreen_confPressure(0);
+}
+
+void tearDown(void)
+{
+}
+
+void test_touchScreen_setCal_getCal(void)
+{
+    touchScreen_cal_t cal;
+    touchScreen_cal_t saved;
+
+    calOf(&cal);
+    touchScreen_setCal(&cal, RES_X, RES_Y);
+
+    memset(&saved, 0, sizeof(saved));
+    touchScreen_getCal(&saved);
+
+    TEST_ASSERT_EQUAL_MEMORY(&cal, &saved, sizeof(cal));
+}
+
+void test_touchScreen_setCal_mapsReadings(void)
+{
+    static const int16_t targets[][2] =
+    {
+        {0, 0}, {479, 0}, {240, 160}, {17, 301}, {479, 319},
+    };
+    touchScreen_cal_t cal;
+    lv_indev_data_t data;
+    size_t i;
+
+    calOf(&cal);
+    touchScreen_setCal(&cal, RES_X, RES_Y);
+
+    for (i = 0 ; i < sizeof(targets) / sizeof(targets[0]) ; i++)
+    {
+        /* new touch each time, the filter starts from the sample */
+        rawZ = 0;
+        touchScreen_confPressure(1);
+        touchScreen_performRead();
+        rawZ = 1000;
+
+        touchAt(targets[i][0], targets[i][1], &data);
+
+        TEST_ASSERT_EQUAL_INT(LV_INDEV_STATE_PR, data.state);
+        TEST_ASSERT_INT_WITHIN(1, targets[i][0], data.point.x);
+        TEST_ASSERT_INT_WITHIN(1, targets[i][1], data.point.y);
+    }
+}
+
+void test_touchScreen_setCal_clamps(void)
+{
+    touchScreen_cal_t cal;
+    lv_indev_data_t data;
+
+    calOf(&cal);
+    touchScreen_setCal(&cal, 200, 100);
+
+    touchAt(300, 150, &data);
+
+    TEST_ASSERT_EQUAL_INT(LV_INDEV_STATE_PR, data.state);
+    TEST_ASSERT_EQUAL_INT(199, data.point.x);
+    TEST_ASSERT_EQUAL_INT(99, data.point.y);
+}
+
+void test_touchScreen_conf_setsCal(void)
+{
+    touchScreen_cal_t expected;
+    touchScreen_cal_t cal;
+
+    touchScreen_conf(350, 3660, 550, 3558, RES_X, RES_Y);
+    touchScreen_getCal(&cal);
+
+    touchScreen_cal_fromRange(&expected, 350, 3660, 550, 3558, RES_X, RES_Y);
+    TEST_ASSERT_EQUAL_MEMORY(&expected, &cal, sizeof(cal));
+}
+
+void test_touchScreen_performRead_median(void)
+{
+    /* spikes on both ends are dropped */
+    static int32_t const seq[3 * TOUCHSCREEN_SAMPLES] =
+    {
+        100, 4095, 105, 0, 110,
+        2000, 2010, 1990, 4095, 5,
+        900, 0, 1000, 1100, 4000,
+    };
+    int32_t x, y;
+
+    readSeq(seq);
+
+    TEST_ASSERT_TRUE(touchScreen_getRaw(&x, &y));
+    TEST_ASSERT_EQUAL_INT32(105, x);
+    TEST_ASSERT_EQUAL_INT32(2000, y);
+    TEST_ASSERT_EQUAL_INT32(1000, touchScreen_getPressure());
+
+    /* swapped after the median */
+    touchScreen_init(PIN_XM, PIN_XP, PIN_YM, PIN_YP);
+    touchScreen_swapXY(true);
+    readSeq(seq);
+
+    TEST_ASSERT_TRUE(touchScreen_getRaw(&x, &y));
+    TEST_ASSERT_EQUAL_INT32(2000, x);
+    TEST_ASSERT_EQUAL_INT32(105, y);
+}
+
+void test_touchScreen_performRead_iir(void)
+{
+    static int32_t const expected[] = {1250, 1437, 1578, 1683};
+    int32_t x, y;
+    size_t i;
+
+    /* the first sample of a touch is taken as is */
+    readRaw(1000, 3000, 1000);
+    TEST_ASSERT_TRUE(touchScreen_getRaw(&x, &y));
+    TEST_ASSERT_EQUAL_INT32(1000, x);
+    TEST_ASSERT_EQUAL_INT32(3000, y);
+
+    /* then a step moves 1 / 2^TOUCHSCREEN_IIR_SHIFT of the way each time */
+    for (i = 0 ; i < sizeof(expected) / sizeof(expected[0]) ; i++)
+    {
+        readRaw(2000, 3000, 1000);
+        TEST_ASSERT_TRUE(touchScreen_getRaw(&x, &y));
+        TEST_ASSERT_EQUAL_INT32(expected[i], x);
+        TEST_ASSERT_EQUAL_INT32(3000, y);
+    }
+
+    /* a new touch doesn't start from the old one */
+    readRaw(FULL_SCALE - 1, 3000, 1000);
+    TEST_ASSERT_FALSE(touchScreen_getRaw(&x, &y));
+
+    readRaw(500, 600, 1000);
+    TEST_ASSERT_TRUE(touchScreen_getRaw(&x, &y));
+    TEST_ASSERT_EQUAL_INT32(500, x);
+    TEST_ASSERT_EQUAL_INT32(600, y);
+}
+
+void test_touchScreen_performRead_pressure(void)
+{
+    int32_t x, y;
+
+    touchScreen_confPressure(500);
+
+    readRaw(1000, 1000, 499);
+    TEST_ASSERT_FALSE(touchScreen_getRaw(&x, &y));
+    TEST_ASSERT_EQUAL_INT32(0, touchScreen_getPressure());
+
+    readRaw(1000, 1000, 500);
+    TEST_ASSERT_TRUE(touchScreen_getRaw(&x, &y));
+    TEST_ASSERT_EQUAL_INT32(500, touchScreen_getPressure());
+
+    readRaw(1000, 1000, 1800);
+    TEST_ASSERT_EQUAL_INT32(1800, touchScreen_getPressure());
+
+    /* a light touch ends the press and restarts the filter */
+    readRaw(2000, 2000, 100);
+    TEST_ASSERT_FALSE(touchScreen_getRaw(&x, &y));
+    TEST_ASSERT_EQUAL_INT32(0, touchScreen_getPressure());
+
+    readRaw(2000, 2000, 600);
+    TEST_ASSERT_TRUE(touchScreen_getRaw(&x, &y));
+    TEST_ASSERT_EQUAL_INT32(2000, x);
+}
+
+void test_touchScreen_performRead_release(void)
+{
+    touchScreen_cal_t cal;
+    lv_indev_data_t data;
+    lv_indev_drv_t drv;
+
+    calOf(&cal);
+    touchScreen_setCal(&cal, RES_X, RES_Y);
+
+    touchAt(100, 200, &data);
+    TEST_ASSERT_EQUAL_INT(LV_INDEV_STATE_PR, data.state);
+    TEST_ASSERT_INT_WITHIN(1, 100, data.point.x);
+    TEST_ASSERT_INT_WITHIN(1, 200, data.point.y);
+
+    /* plates near full scale: released on either axis */
+    readRaw(FULL_SCALE * 97 / 100, rawY, 1000);
+    touchScreen_read(&drv, &data);
+    TEST_ASSERT_EQUAL_INT(LV_INDEV_STATE_REL, data.state);
+
+    /* the last point is kept for LVGL */
+    TEST_ASSERT_INT_WITHIN(1, 100, data.point.x);
+    TEST_ASSERT_INT_WITHIN(1, 200, data.point.y);
+
+    touchAt(300, 50, &data);
+    TEST_ASSERT_EQUAL_INT(LV_INDEV_STATE_PR, data.state);
+
+    readRaw(rawX, FULL_SCALE - 1, 1000);
+    touchScreen_read(&drv, &data);
+    TEST_ASSERT_EQUAL_INT(LV_INDEV_STATE_REL, data.state);
+    TEST_ASSERT_INT_WITHIN(1, 300, data.point.x);
+    TEST_ASSERT_INT_WITHIN(1, 50, data.point.y);
+
+    /* just below the threshold is a touch */
+    readRaw(FULL_SCALE * 97 / 100 - 1, 1000, 1000);
+    touchScreen_read(&drv, &data);
+    TEST_ASSERT_EQUAL_INT(LV_INDEV_STATE_PR, data.state);
+}
+
+/*==================[end of file]============================================*/
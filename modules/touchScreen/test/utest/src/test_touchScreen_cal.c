@@ -0,0 +1,200 @@
+/*
+###############################################################################
+#
+# Copyright 2023, Gustavo Muro
+# All rights reserved
+#
+# This file is part of EmbeddedFirmware.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#                                                                             */
+
+/*==================[inclusions]=============================================*/
+#include "unity.h"
+#include "touchScreen_cal.h"
+#include "stdlib.h"
+#include "string.h"
+
+/*==================[macros and typedef]=====================================*/
+
+#define RES_X           480
+#define RES_Y           320
+
+/* synthetic panel, raw = M * screen + t */
+typedef struct
+{
+    double m00, m01, m10, m11;
+    double tx, ty;
+}panel_t;
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/* 12 bit ADC, axes as wired on the example */
+static const panel_t straight =
+{
+    .m00 = 6.9, .m01 = 0.0, .m10 = 0.0, .m11 = 9.4,
+    .tx = 350, .ty = 550,
+};
+
+/* swapped axes, X reversed and a few degrees of rotation and skew */
+static const panel_t rotated =
+{
+    .m00 = 0.35, .m01 = 9.6, .m10 = -6.8, .m11 = 0.6,
+    .tx = 420, .ty = 3700,
+};
+
+static touchScreen_cal_t cal;
+
+/*==================[internal functions definition]==========================*/
+
+static void rawOf(panel_t const *p, int32_t x, int32_t y, int32_t *rawX, int32_t *rawY)
+{
+    *rawX = (int32_t)(p->m00 * x + p->m01 * y + p->tx + 0.5);
+    *rawY = (int32_t)(p->m10 * x + p->m11 * y + p->ty + 0.5);
+}
+
+static void point(touchScreen_calPoint_t *pt, panel_t const *p, int32_t x, int32_t y)
+{
+    pt->x = x;
+    pt->y = y;
+    rawOf(p, x, y, &pt->rawX, &pt->rawY);
+}
+
+/* worst error over a grid of the screen */
+static int32_t maxError(panel_t const *p)
+{
+    int32_t x, y, rawX, rawY, cx, cy, err = 0;
+
+    for (y = 0 ; y < RES_Y ; y += 8)
+    {
+        for (x = 0 ; x < RES_X ; x += 8)
+        {
+            rawOf(p, x, y, &rawX, &rawY);
+            touchScreen_cal_apply(&cal, rawX, rawY, &cx, &cy);
+
+            if (abs(cx - x) > err)
+                err = abs(cx - x);
+            if (abs(cy - y) > err)
+                err = abs(cy - y);
+        }
+    }
+
+    return err;
+}
+
+/*==================[external functions definition]==========================*/
+
+void setUp(void)
+{
+    memset(&cal, 0, sizeof(cal));
+}
+
+void tearDown(void)
+{
+}
+
+void test_touchScreen_cal_threePoints(void)
+{
+    touchScreen_calPoint_t pts[3];
+
+    point(&pts[0], &straight, 48, 32);
+    point(&pts[1], &straight, 432, 160);
+    point(&pts[2], &straight, 240, 288);
+
+    TEST_ASSERT_TRUE(touchScreen_cal_compute(&cal, pts, 3));
+    TEST_ASSERT_EQUAL_INT32(0, cal.b);
+    TEST_ASSERT_EQUAL_INT32(0, cal.d);
+    TEST_ASSERT_INT_WITHIN(1, 0, maxError(&straight));
+}
+
+void test_touchScreen_cal_rotated(void)
+{
+    touchScreen_calPoint_t pts[3];
+
+    point(&pts[0], &rotated, 48, 32);
+    point(&pts[1], &rotated, 432, 160);
+    point(&pts[2], &rotated, 240, 288);
+
+    TEST_ASSERT_TRUE(touchScreen_cal_compute(&cal, pts, 3));
+    TEST_ASSERT_INT_WITHIN(1, 0, maxError(&rotated));
+}
+
+void test_touchScreen_cal_leastSquares(void)
+{
+    /* readings off by a few counts, as a finger on the targets */
+    static const int8_t noise[9][2] =
+    {
+        {3, -2}, {-4, 1}, {2, 4}, {-1, -3}, {0, 2},
+        {4, 0}, {-3, -4}, {1, 3}, {-2, -1},
+    };
+    touchScreen_calPoint_t pts[9];
+    int i;
+
+    for (i = 0 ; i < 9 ; i++)
+    {
+        point(&pts[i], &rotated, 40 + (i % 3) * 200, 30 + (i / 3) * 130);
+        pts[i].rawX += noise[i][0];
+        pts[i].rawY += noise[i][1];
+    }
+
+    TEST_ASSERT_TRUE(touchScreen_cal_compute(&cal, pts, 9));
+    TEST_ASSERT_INT_WITHIN(2, 0, maxError(&rotated));
+}
+
+void test_touchScreen_cal_degenerate(void)
+{
+    touchScreen_calPoint_t pts[3];
+    touchScreen_cal_t prev;
+
+    point(&pts[0], &straight, 0, 0);
+    point(&pts[1], &straight, 100, 100);
+    point(&pts[2], &straight, 200, 200);
+
+    memset(&prev, 0, sizeof(prev));
+    TEST_ASSERT_FALSE(touchScreen_cal_compute(&cal, pts, 3));
+    TEST_ASSERT_FALSE(touchScreen_cal_compute(&cal, pts, 2));
+    TEST_ASSERT_EQUAL_MEMORY(&prev, &cal, sizeof(cal));
+}
+
+void test_touchScreen_cal_fromRange(void)
+{
+    int32_t raw, x, y;
+
+    touchScreen_cal_fromRange(&cal, 350, 3660, 550, 3558, RES_X, RES_Y);
+
+    /* as the division it replaces, within rounding */
+    for (raw = 350 ; raw <= 3558 ; raw += 13)
+    {
+        touchScreen_cal_apply(&cal, raw, raw, &x, &y);
+        TEST_ASSERT_INT_WITHIN(1, (raw - 350) * RES_X / (3660 - 350), x);
+        TEST_ASSERT_INT_WITHIN(1, (raw - 550) * RES_Y / (3558 - 550), y);
+    }
+}
+
+/*==================[end of file]============================================*/